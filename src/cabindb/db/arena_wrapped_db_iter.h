@@ -76,7 +76,7 @@ class ArenaWrappedDBIter : public Iterator {
             const SequenceNumber& sequence,
             uint64_t max_sequential_skip_in_iterations, uint64_t version_number,
             ReadCallback* read_callback, DBImpl* db_impl, ColumnFamilyData* cfd,
-            bool allow_blob, bool allow_refresh);
+            bool allow_blob, bool allow_refresh, const Version* version);
 
   // Store some parameters so we can refresh the iterator at a later point
   // with these same params
@@ -110,5 +110,5 @@ extern ArenaWrappedDBIter* NewArenaWrappedDbIterator(
     uint64_t max_sequential_skip_in_iterations, uint64_t version_number,
     ReadCallback* read_callback, DBImpl* db_impl = nullptr,
     ColumnFamilyData* cfd = nullptr, bool allow_blob = false,
-    bool allow_refresh = true);
+    bool allow_refresh = true, const Version* version = nullptr);
 }  // namespace CABINDB_NAMESPACE
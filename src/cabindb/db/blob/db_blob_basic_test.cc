@@ -44,6 +44,115 @@ TEST_F(DBBlobBasicTest, GetBlob) {
                   .IsIncomplete());
 }
 
+TEST_F(DBBlobBasicTest, IterateBlobs) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+
+  Reopen(options);
+
+  constexpr int num_keys = 16;
+
+  auto get_key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%02d", i);
+    return std::string(buf);
+  };
+  auto get_value = [](int i) { return "blob_value" + ToString(i); };
+
+  for (int i = 0; i < num_keys; ++i) {
+    ASSERT_OK(Put(get_key(i), get_value(i)));
+  }
+  ASSERT_OK(Flush());
+
+  // a newer inline value hides the blob underneath it
+  ASSERT_OK(Put(get_key(3), "inline_value"));
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+    ASSERT_EQ(get_key(i), iter->key());
+    ASSERT_EQ(i == 3 ? "inline_value" : get_value(i), iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(num_keys, i);
+
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    --i;
+    ASSERT_EQ(get_key(i), iter->key());
+    ASSERT_EQ(i == 3 ? "inline_value" : get_value(i), iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(0, i);
+
+  iter->Seek(get_key(7));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(get_value(7), iter->value());
+  iter->SeekForPrev(get_key(9));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(get_value(9), iter->value());
+
+  // no I/O allowed: the blob itself cannot be read
+  ReadOptions read_options;
+  read_options.read_tier = kBlockCacheTier;
+  iter.reset(db_->NewIterator(read_options));
+  iter->Seek(get_key(7));
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_TRUE(iter->status().IsIncomplete());
+}
+
+TEST_F(DBBlobBasicTest, MultiGetBlobs) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+
+  Reopen(options);
+
+  constexpr size_t num_keys = 4;
+
+  constexpr char first_key[] = "first_key";
+  constexpr char first_value[] = "first_value";
+  constexpr char second_key[] = "second_key";
+  constexpr char second_value[] = "second_value";
+  constexpr char third_key[] = "third_key";
+  constexpr char third_value[] = "third_value";
+  constexpr char missing_key[] = "missing_key";
+
+  ASSERT_OK(Put(first_key, first_value));
+  ASSERT_OK(Put(second_key, second_value));
+  ASSERT_OK(Put(third_key, third_value));
+  ASSERT_OK(Flush());
+
+  std::array<Slice, num_keys> keys{
+      {first_key, second_key, third_key, missing_key}};
+  std::array<PinnableSlice, num_keys> values;
+  std::array<Status, num_keys> statuses;
+
+  db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), num_keys,
+                &keys[0], &values[0], &statuses[0]);
+
+  ASSERT_OK(statuses[0]);
+  ASSERT_EQ(values[0], first_value);
+  ASSERT_OK(statuses[1]);
+  ASSERT_EQ(values[1], second_value);
+  ASSERT_OK(statuses[2]);
+  ASSERT_EQ(values[2], third_value);
+  ASSERT_TRUE(statuses[3].IsNotFound());
+
+  // no I/O allowed: the blobs themselves cannot be read
+  ReadOptions read_options;
+  read_options.read_tier = kBlockCacheTier;
+
+  db_->MultiGet(read_options, db_->DefaultColumnFamily(), num_keys, &keys[0],
+                &values[0], &statuses[0]);
+
+  ASSERT_TRUE(statuses[0].IsIncomplete());
+  ASSERT_TRUE(statuses[1].IsIncomplete());
+  ASSERT_TRUE(statuses[2].IsIncomplete());
+  ASSERT_TRUE(statuses[3].IsNotFound());
+}
+
 TEST_F(DBBlobBasicTest, GetBlob_CorruptIndex) {
   Options options = GetDefaultOptions();
   options.enable_blob_files = true;
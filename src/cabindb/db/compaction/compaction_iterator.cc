@@ -6,8 +6,12 @@
 #include "db/compaction/compaction_iterator.h"
 
 #include <cinttypes>
+#include <iterator>
+#include <limits>
 
 #include "db/blob/blob_file_builder.h"
+#include "db/blob/blob_index.h"
+#include "db/blob/blob_log_format.h"
 #include "db/snapshot_checker.h"
 #include "port/likely.h"
 #include "include/cabindb/listener.h"
@@ -105,6 +109,8 @@ CompactionIterator::CompactionIterator(
   if (compaction_ != nullptr) {
     level_ptrs_ = std::vector<size_t>(compaction_->number_levels(), 0);
   }
+  blob_garbage_collection_cutoff_file_number_ =
+      ComputeBlobGarbageCollectionCutoffFileNumber(compaction_.get());
   if (snapshots_->size() == 0) {
     // optimize for fast path if there are no snapshots
     visible_at_tip_ = true;
@@ -733,25 +739,116 @@ void CompactionIterator::NextFromInput() {
   }
 }
 
+bool CompactionIterator::ExtractLargeValueIfNeeded() {
+  if (!blob_file_builder_) {
+    return false;
+  }
+
+  blob_index_.clear();
+  const Status s = blob_file_builder_->Add(user_key(), value_, &blob_index_);
+
+  if (!s.ok()) {
+    status_ = s;
+    valid_ = false;
+    return false;
+  }
+  if (blob_index_.empty()) {
+    return false;
+  }
+
+  value_ = blob_index_;
+  ikey_.type = kTypeBlobIndex;
+  current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
+  return true;
+}
+
+bool CompactionIterator::GarbageCollectBlobIfNeeded() {
+  assert(ikey_.type == kTypeBlobIndex);
+
+  BlobIndex blob_index;
+  {
+    const Status s = blob_index.DecodeFrom(value_);
+    if (!s.ok()) {
+      status_ = s;
+      valid_ = false;
+      return false;
+    }
+  }
+
+  if (blob_index.IsInlined() || blob_index.HasTTL()) {
+    status_ = Status::Corruption("Unexpected TTL/inlined blob index");
+    valid_ = false;
+    return false;
+  }
+
+  if (blob_index.file_number() >=
+      blob_garbage_collection_cutoff_file_number_) {
+    return false;
+  }
+
+  const Version* const version = compaction_->input_version();
+  assert(version);
+
+  // Version::GetBlob() replaces the blob reference with the blob itself
+  blob_value_.PinSelf(value_);
+  {
+    const Status s = version->GetBlob(ReadOptions(), user_key(), &blob_value_);
+    if (!s.ok()) {
+      status_ = s;
+      valid_ = false;
+      return false;
+    }
+  }
+
+  auto& relocated = relocated_blobs_[blob_index.file_number()];
+  ++relocated.first;
+  relocated.second +=
+      blob_index.size() +
+      BlobLogRecord::CalculateAdjustmentForRecordHeader(user_key().size());
+
+  value_ = blob_value_;
+  if (ExtractLargeValueIfNeeded() || !valid_) {
+    return valid_;
+  }
+
+  ikey_.type = kTypeValue;
+  current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
+  return true;
+}
+
+uint64_t CompactionIterator::ComputeBlobGarbageCollectionCutoffFileNumber(
+    const CompactionProxy* compaction) {
+  if (!compaction || !compaction->enable_blob_garbage_collection()) {
+    return 0;
+  }
+
+  Version* const version = compaction->input_version();
+  if (!version) {
+    return 0;
+  }
+
+  const auto& blob_files = version->storage_info()->GetBlobFiles();
+  auto it = blob_files.begin();
+  std::advance(it, static_cast<size_t>(
+                       compaction->blob_garbage_collection_age_cutoff() *
+                       blob_files.size()));
+
+  return it != blob_files.end() ? it->first
+                                : std::numeric_limits<uint64_t>::max();
+}
+
 void CompactionIterator::PrepareOutput() {
   if (valid_) {
     if (ikey_.type == kTypeValue) {
-      if (blob_file_builder_) {
-        blob_index_.clear();
-        const Status s =
-            blob_file_builder_->Add(user_key(), value_, &blob_index_);
-
-        if (!s.ok()) {
-          status_ = s;
-          valid_ = false;
-        } else if (!blob_index_.empty()) {
-          value_ = blob_index_;
-          ikey_.type = kTypeBlobIndex;
-          current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
-        }
-      }
+      ExtractLargeValueIfNeeded();
     } else if (ikey_.type == kTypeBlobIndex) {
-      if (compaction_filter_) {
+      // A blob that garbage collection leaves in place, which is every blob
+      // while it is disabled, is still offered to the compaction filter.
+      bool relocated = false;
+      if (blob_garbage_collection_cutoff_file_number_ != 0) {
+        relocated = GarbageCollectBlobIfNeeded();
+      }
+      if (valid_ && !relocated && compaction_filter_) {
         const auto blob_decision = compaction_filter_->PrepareBlobOutput(
             user_key(), value_, &compaction_filter_value_);
 
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <deque>
+#include <map>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -45,6 +46,12 @@ class CompactionIterator {
     virtual bool allow_ingest_behind() const = 0;
 
     virtual bool preserve_deletes() const = 0;
+
+    virtual bool enable_blob_garbage_collection() const = 0;
+
+    virtual double blob_garbage_collection_age_cutoff() const = 0;
+
+    virtual Version* input_version() const = 0;
   };
 
   class RealCompaction : public CompactionProxy {
@@ -80,6 +87,19 @@ class CompactionIterator {
       return compaction_->immutable_cf_options()->preserve_deletes;
     }
 
+    bool enable_blob_garbage_collection() const override {
+      return compaction_->mutable_cf_options()->enable_blob_garbage_collection;
+    }
+
+    double blob_garbage_collection_age_cutoff() const override {
+      return compaction_->mutable_cf_options()
+          ->blob_garbage_collection_age_cutoff;
+    }
+
+    Version* input_version() const override {
+      return compaction_->input_version();
+    }
+
    private:
     const Compaction* compaction_;
   };
@@ -142,6 +162,13 @@ class CompactionIterator {
   const Slice& user_key() const { return current_user_key_; }
   const CompactionIterationStats& iter_stats() const { return iter_stats_; }
 
+  // Blobs moved out of old blob files by garbage collection, keyed by blob
+  // file number: the number of blobs and their size including the record
+  // headers. Once the compaction is installed they are garbage in those
+  // files.
+  using RelocatedBlobs = std::map<uint64_t, std::pair<uint64_t, uint64_t>>;
+  const RelocatedBlobs& relocated_blobs() const { return relocated_blobs_; }
+
  private:
   // Processes the input stream to find the next output
   void NextFromInput();
@@ -155,6 +182,21 @@ class CompactionIterator {
   // Return true on success, false on failures (e.g.: kIOError).
   bool InvokeFilterIfNeeded(bool* need_skip, Slice* skip_until);
 
+  // Writes value_ to a blob file if it is large enough and blob files are
+  // enabled. Returns true if value_ was replaced by a blob reference.
+  bool ExtractLargeValueIfNeeded();
+
+  // Reads the blob of a kTypeBlobIndex entry back into value_ if it lives
+  // in one of the oldest blob files, so that it is relocated to a new blob
+  // file or inlined, and the old file can eventually be dropped. Returns
+  // true if the blob was relocated.
+  bool GarbageCollectBlobIfNeeded();
+
+  // Blob files numbered below the returned value are old enough for
+  // garbage collection in this compaction.
+  static uint64_t ComputeBlobGarbageCollectionCutoffFileNumber(
+      const CompactionProxy* compaction);
+
   // Given a sequence number, return the sequence number of the
   // earliest snapshot that this sequence number is visible in.
   // The snapshots themselves are arranged in ascending order of
@@ -258,6 +300,10 @@ class CompactionIterator {
 
   IterKey current_key_;
   Slice current_user_key_;
+  // Holds the blob read by garbage collection, which value_ points to.
+  PinnableSlice blob_value_;
+  uint64_t blob_garbage_collection_cutoff_file_number_;
+  RelocatedBlobs relocated_blobs_;
   std::string curr_ts_;
   SequenceNumber current_user_key_sequence_;
   SequenceNumber current_user_key_snapshot_;
@@ -22,6 +22,7 @@
 
 #include "db/blob/blob_file_addition.h"
 #include "db/blob/blob_file_builder.h"
+#include "db/blob/blob_file_garbage.h"
 #include "db/builder.h"
 #include "db/db_impl/db_impl.h"
 #include "db/db_iter.h"
@@ -141,6 +142,8 @@ struct CompactionJob::SubcompactionState {
   // State kept for output being generated
   std::vector<Output> outputs;
   std::vector<BlobFileAddition> blob_file_additions;
+  // Garbage left in old blob files by the blobs this subcompaction relocated
+  std::vector<BlobFileGarbage> blob_file_garbages;
   std::unique_ptr<WritableFileWriter> outfile;
   std::unique_ptr<TableBuilder> builder;
 
@@ -475,6 +478,27 @@ void CompactionJob::GenSubcompactionBoundaries() {
           bounds.emplace_back(flevel->files[i].smallest_key);
           bounds.emplace_back(flevel->files[i].largest_key);
         }
+        // Level 0 files often each span most of the key range, which leaves
+        // few boundaries in between. Add keys sampled from the data block
+        // boundaries of every file; the table readers may do I/O, so unlock
+        // db mutex while sampling
+        db_mutex_->Unlock();
+        for (size_t i = 0; i < num_files; i++) {
+          std::vector<TableReader::Anchor> anchors;
+          Status s = cfd->table_cache()->ApproximateKeyAnchors(
+              ReadOptions(), cfd->internal_comparator(), flevel->files[i].fd,
+              &anchors, c->mutable_cf_options()->prefix_extractor.get());
+          if (!s.ok()) {
+            // the file boundaries above are still used
+            s.PermitUncheckedError();
+            continue;
+          }
+          for (const auto& anchor : anchors) {
+            anchor_keys_.emplace_back(anchor.user_key, kMaxSequenceNumber,
+                                      kValueTypeForSeek);
+          }
+        }
+        db_mutex_->Lock();
       } else {
         // For all other levels add the smallest/largest key in the level to
         // encompass the range covered by that level
@@ -492,6 +516,11 @@ void CompactionJob::GenSubcompactionBoundaries() {
       }
     }
   }
+  for (const auto& key : anchor_keys_) {
+    bounds.emplace_back(key.Encode());
+  }
+  TEST_SYNC_POINT_CALLBACK("CompactionJob::GenSubcompactionBoundaries:Anchors",
+                           &anchor_keys_);
 
   std::sort(bounds.begin(), bounds.end(),
             [cfd_comparator](const Slice& a, const Slice& b) -> bool {
@@ -587,17 +616,22 @@ Status CompactionJob::Run() {
   assert(num_threads > 0);
   const uint64_t start_micros = env_->NowMicros();
 
+  // Subcompactions either run here or are sent to the compaction service
+  void (CompactionJob::*process)(SubcompactionState*) =
+      ShouldUseCompactionService()
+          ? &CompactionJob::ProcessKeyValueCompactionWithCompactionService
+          : &CompactionJob::ProcessKeyValueCompaction;
+
   // Launch a thread for each of subcompactions 1...num_threads-1
   std::vector<port::Thread> thread_pool;
   thread_pool.reserve(num_threads - 1);
   for (size_t i = 1; i < compact_->sub_compact_states.size(); i++) {
-    thread_pool.emplace_back(&CompactionJob::ProcessKeyValueCompaction, this,
-                             &compact_->sub_compact_states[i]);
+    thread_pool.emplace_back(process, this, &compact_->sub_compact_states[i]);
   }
 
   // Always schedule the first subcompaction (whether or not there are also
   // others) in the current thread to be efficient with resources
-  ProcessKeyValueCompaction(&compact_->sub_compact_states[0]);
+  (this->*process)(&compact_->sub_compact_states[0]);
 
   // Wait for all other threads (if there are any) to finish execution
   for (auto& thread : thread_pool) {
@@ -894,6 +928,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   assert(sub_compact);
   assert(sub_compact->compaction);
 
+  const uint64_t start_micros = env_->NowMicros();
   uint64_t prev_cpu_micros = env_->NowCPUNanos() / 1000;
 
   ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
@@ -1183,8 +1218,17 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     blob_file_builder.reset();
   }
 
+  if (status.ok()) {
+    for (const auto& relocated : c_iter->relocated_blobs()) {
+      sub_compact->blob_file_garbages.emplace_back(
+          relocated.first, relocated.second.first, relocated.second.second);
+    }
+  }
+
   sub_compact->compaction_job_stats.cpu_micros =
       env_->NowCPUNanos() / 1000 - prev_cpu_micros;
+  RecordTimeToHistogram(stats_, SUBCOMPACTION_TIME,
+                        env_->NowMicros() - start_micros);
 
   if (measure_io_stats_) {
     sub_compact->compaction_job_stats.file_write_nanos +=
@@ -1497,9 +1541,7 @@ Status CompactionJob::FinishCompactionOutputFile(
     // If there is nothing to output, no necessary to generate a sst file.
     // This happens when the output level is bottom level, at the same time
     // the sub_compact output nothing.
-    std::string fname =
-        TableFileName(sub_compact->compaction->immutable_cf_options()->cf_paths,
-                      meta->fd.GetNumber(), meta->fd.GetPathId());
+    std::string fname = GetTableFileName(meta->fd.GetNumber());
     env_->DeleteFile(fname);
 
     // Also need to remove the file from outputs, or it will be added to the
@@ -1524,9 +1566,7 @@ Status CompactionJob::FinishCompactionOutputFile(
   FileDescriptor output_fd;
   uint64_t oldest_blob_file_number = kInvalidBlobFileNumber;
   if (meta != nullptr) {
-    fname =
-        TableFileName(sub_compact->compaction->immutable_cf_options()->cf_paths,
-                      meta->fd.GetNumber(), meta->fd.GetPathId());
+    fname = GetTableFileName(meta->fd.GetNumber());
     output_fd = meta->fd;
     oldest_blob_file_number = meta->oldest_blob_file_number;
   } else {
@@ -1612,6 +1652,10 @@ Status CompactionJob::InstallCompactionResults(
     for (const auto& blob : sub_compact.blob_file_additions) {
       edit->AddBlobFile(blob);
     }
+
+    for (const auto& garbage : sub_compact.blob_file_garbages) {
+      edit->AddBlobFileGarbage(garbage);
+    }
   }
 
   return versions_->LogAndApply(compaction->column_family_data(),
@@ -1648,9 +1692,7 @@ Status CompactionJob::OpenCompactionOutputFile(
   assert(sub_compact->builder == nullptr);
   // no need to lock because VersionSet::next_file_number_ is atomic
   uint64_t file_number = versions_->NewFileNumber();
-  std::string fname =
-      TableFileName(sub_compact->compaction->immutable_cf_options()->cf_paths,
-                    file_number, sub_compact->compaction->output_path_id());
+  std::string fname = GetTableFileName(file_number);
   // Fire events.
   ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
 #ifndef CABINDB_LITE
@@ -1905,4 +1947,496 @@ void CompactionJob::LogCompaction() {
   }
 }
 
+
+std::string CompactionJob::GetTableFileName(uint64_t file_number) {
+  return TableFileName(
+      compact_->compaction->immutable_cf_options()->cf_paths, file_number,
+      compact_->compaction->output_path_id());
+}
+
+bool CompactionJob::ShouldUseCompactionService() const {
+  // The worker cannot call back into a snapshot checker, and blob files,
+  // new or relocated by garbage collection, would have to be installed
+  // along with the tables
+  const MutableCFOptions* cf_options =
+      compact_->compaction->mutable_cf_options();
+  return db_options_.compaction_service != nullptr &&
+         snapshot_checker_ == nullptr && !cf_options->enable_blob_files &&
+         !cf_options->enable_blob_garbage_collection;
+}
+
+namespace {
+const uint32_t kCompactionServiceFormatVersion = 1;
+
+void PutStatus(std::string* dst, const Status& s) {
+  PutVarint32(dst, static_cast<uint32_t>(s.code()));
+  PutLengthPrefixedSlice(dst, s.getState() ? s.getState() : "");
+}
+
+bool GetStatus(Slice* input, Status* s) {
+  uint32_t code;
+  Slice msg;
+  if (!GetVarint32(input, &code) || !GetLengthPrefixedSlice(input, &msg)) {
+    return false;
+  }
+  switch (code) {
+    case Status::kOk:
+      *s = Status::OK();
+      break;
+    case Status::kNotFound:
+      *s = Status::NotFound(msg);
+      break;
+    case Status::kCorruption:
+      *s = Status::Corruption(msg);
+      break;
+    case Status::kNotSupported:
+      *s = Status::NotSupported(msg);
+      break;
+    case Status::kInvalidArgument:
+      *s = Status::InvalidArgument(msg);
+      break;
+    case Status::kIOError:
+      *s = Status::IOError(msg);
+      break;
+    case Status::kShutdownInProgress:
+      *s = Status::ShutdownInProgress(msg);
+      break;
+    case Status::kAborted:
+      *s = Status::Aborted(msg);
+      break;
+    default:
+      *s = Status::Incomplete(msg);
+      break;
+  }
+  return true;
+}
+
+bool GetBool(Slice* input, bool* value) {
+  uint32_t v;
+  if (!GetVarint32(input, &v)) {
+    return false;
+  }
+  *value = v != 0;
+  return true;
+}
+
+Status BadCompactionServiceFormat(const char* what) {
+  return Status::Corruption("bad compaction service", what);
+}
+}  // namespace
+
+void CompactionServiceInput::EncodeTo(std::string* output) const {
+  PutVarint32(output, kCompactionServiceFormatVersion);
+  PutLengthPrefixedSlice(output, column_family_name);
+  PutVarint32(output, static_cast<uint32_t>(input_files.size()));
+  for (uint64_t number : input_files) {
+    PutVarint64(output, number);
+  }
+  PutVarint32(output, static_cast<uint32_t>(output_level));
+  PutVarint64(output, target_file_size);
+  PutVarint64(output, max_compaction_bytes);
+  PutVarint32(output, static_cast<uint32_t>(compression));
+  PutVarint32(output, manual_compaction ? 1 : 0);
+  PutVarint32(output, static_cast<uint32_t>(compaction_reason));
+  PutVarint32(output, static_cast<uint32_t>(snapshots.size()));
+  for (SequenceNumber snapshot : snapshots) {
+    PutVarint64(output, snapshot);
+  }
+  PutVarint64(output, earliest_write_conflict_snapshot);
+  PutVarint64(output, preserve_deletes_seqnum);
+  PutLengthPrefixedSlice(output, full_history_ts_low);
+  PutVarint32(output, has_begin ? 1 : 0);
+  PutLengthPrefixedSlice(output, begin);
+  PutVarint32(output, has_end ? 1 : 0);
+  PutLengthPrefixedSlice(output, end);
+  PutLengthPrefixedSlice(output, output_directory);
+}
+
+Status CompactionServiceInput::DecodeFrom(const Slice& src) {
+  Slice input = src;
+  uint32_t version, count, level, compression_type, reason;
+  Slice str;
+  if (!GetVarint32(&input, &version) ||
+      version != kCompactionServiceFormatVersion) {
+    return BadCompactionServiceFormat("input version");
+  }
+  if (!GetLengthPrefixedSlice(&input, &str) || !GetVarint32(&input, &count)) {
+    return BadCompactionServiceFormat("input column family");
+  }
+  column_family_name = str.ToString();
+  input_files.resize(count);
+  for (uint32_t i = 0; i < count; i++) {
+    if (!GetVarint64(&input, &input_files[i])) {
+      return BadCompactionServiceFormat("input files");
+    }
+  }
+  if (!GetVarint32(&input, &level) ||
+      !GetVarint64(&input, &target_file_size) ||
+      !GetVarint64(&input, &max_compaction_bytes) ||
+      !GetVarint32(&input, &compression_type) ||
+      !GetBool(&input, &manual_compaction) ||
+      !GetVarint32(&input, &reason) || !GetVarint32(&input, &count)) {
+    return BadCompactionServiceFormat("input compaction");
+  }
+  output_level = static_cast<int>(level);
+  compression = static_cast<CompressionType>(compression_type);
+  compaction_reason = static_cast<CompactionReason>(reason);
+  snapshots.resize(count);
+  for (uint32_t i = 0; i < count; i++) {
+    if (!GetVarint64(&input, &snapshots[i])) {
+      return BadCompactionServiceFormat("input snapshots");
+    }
+  }
+  if (!GetVarint64(&input, &earliest_write_conflict_snapshot) ||
+      !GetVarint64(&input, &preserve_deletes_seqnum) ||
+      !GetLengthPrefixedSlice(&input, &str)) {
+    return BadCompactionServiceFormat("input sequence numbers");
+  }
+  full_history_ts_low = str.ToString();
+  if (!GetBool(&input, &has_begin) || !GetLengthPrefixedSlice(&input, &str)) {
+    return BadCompactionServiceFormat("input begin");
+  }
+  begin = str.ToString();
+  if (!GetBool(&input, &has_end) || !GetLengthPrefixedSlice(&input, &str)) {
+    return BadCompactionServiceFormat("input end");
+  }
+  end = str.ToString();
+  if (!GetLengthPrefixedSlice(&input, &str)) {
+    return BadCompactionServiceFormat("input output directory");
+  }
+  output_directory = str.ToString();
+  return Status::OK();
+}
+
+void CompactionServiceResult::EncodeTo(std::string* output) const {
+  PutVarint32(output, kCompactionServiceFormatVersion);
+  PutStatus(output, status);
+  PutVarint32(output, static_cast<uint32_t>(output_files.size()));
+  for (const auto& file : output_files) {
+    PutLengthPrefixedSlice(output, file.file_name);
+    PutLengthPrefixedSlice(output, file.smallest_internal_key);
+    PutLengthPrefixedSlice(output, file.largest_internal_key);
+    PutVarint64(output, file.smallest_seqno);
+    PutVarint64(output, file.largest_seqno);
+    PutVarint64(output, file.oldest_ancester_time);
+    PutVarint64(output, file.file_creation_time);
+    PutVarint64(output, file.oldest_blob_file_number);
+    PutFixed64(output, file.paranoid_hash);
+    PutVarint32(output, file.marked_for_compaction ? 1 : 0);
+    PutLengthPrefixedSlice(output, file.file_checksum);
+    PutLengthPrefixedSlice(output, file.file_checksum_func_name);
+  }
+  PutVarint64(output, num_output_records);
+  PutVarint64(output, total_bytes);
+  PutVarint64(output, cpu_micros);
+}
+
+Status CompactionServiceResult::DecodeFrom(const Slice& src) {
+  Slice input = src;
+  uint32_t version, count;
+  if (!GetVarint32(&input, &version) ||
+      version != kCompactionServiceFormatVersion) {
+    return BadCompactionServiceFormat("result version");
+  }
+  if (!GetStatus(&input, &status) || !GetVarint32(&input, &count)) {
+    return BadCompactionServiceFormat("result status");
+  }
+  output_files.resize(count);
+  for (auto& file : output_files) {
+    Slice name, smallest, largest, checksum, checksum_func_name;
+    if (!GetLengthPrefixedSlice(&input, &name) ||
+        !GetLengthPrefixedSlice(&input, &smallest) ||
+        !GetLengthPrefixedSlice(&input, &largest) ||
+        !GetVarint64(&input, &file.smallest_seqno) ||
+        !GetVarint64(&input, &file.largest_seqno) ||
+        !GetVarint64(&input, &file.oldest_ancester_time) ||
+        !GetVarint64(&input, &file.file_creation_time) ||
+        !GetVarint64(&input, &file.oldest_blob_file_number) ||
+        !GetFixed64(&input, &file.paranoid_hash) ||
+        !GetBool(&input, &file.marked_for_compaction) ||
+        !GetLengthPrefixedSlice(&input, &checksum) ||
+        !GetLengthPrefixedSlice(&input, &checksum_func_name)) {
+      return BadCompactionServiceFormat("result file");
+    }
+    file.file_name = name.ToString();
+    file.smallest_internal_key = smallest.ToString();
+    file.largest_internal_key = largest.ToString();
+    file.file_checksum = checksum.ToString();
+    file.file_checksum_func_name = checksum_func_name.ToString();
+  }
+  if (!GetVarint64(&input, &num_output_records) ||
+      !GetVarint64(&input, &total_bytes) || !GetVarint64(&input, &cpu_micros)) {
+    return BadCompactionServiceFormat("result stats");
+  }
+  return Status::OK();
+}
+
+void CompactionJob::ProcessKeyValueCompactionWithCompactionService(
+    SubcompactionState* sub_compact) {
+  assert(sub_compact);
+  assert(sub_compact->compaction);
+  assert(db_options_.compaction_service);
+
+  const uint64_t start_micros = env_->NowMicros();
+  const Compaction* c = sub_compact->compaction;
+  ColumnFamilyData* cfd = c->column_family_data();
+  const auto& cf_paths = c->immutable_cf_options()->cf_paths;
+
+  CompactionServiceInput input;
+  input.column_family_name = cfd->GetName();
+  for (size_t i = 0; i < c->num_input_levels(); i++) {
+    for (const FileMetaData* f : *c->inputs(i)) {
+      input.input_files.push_back(f->fd.GetNumber());
+    }
+  }
+  input.output_level = c->output_level();
+  input.target_file_size = c->max_output_file_size();
+  input.max_compaction_bytes = c->max_compaction_bytes();
+  input.compression = c->output_compression();
+  input.manual_compaction = c->is_manual_compaction();
+  input.compaction_reason = compact_->compaction->compaction_reason();
+  input.snapshots = existing_snapshots_;
+  input.earliest_write_conflict_snapshot = earliest_write_conflict_snapshot_;
+  input.preserve_deletes_seqnum = preserve_deletes_seqnum_;
+  input.full_history_ts_low = full_history_ts_low_;
+  if (sub_compact->start != nullptr) {
+    input.has_begin = true;
+    input.begin = sub_compact->start->ToString();
+  }
+  if (sub_compact->end != nullptr) {
+    input.has_end = true;
+    input.end = sub_compact->end->ToString();
+  }
+  // The worker writes next to the output path so that its files can be
+  // renamed into the DB
+  const std::string service_dir =
+      cf_paths[c->output_path_id()].path + "/compaction_service";
+  input.output_directory =
+      service_dir + "/" + ToString(versions_->NewFileNumber());
+
+  Status s = fs_->CreateDirIfMissing(service_dir, IOOptions(), nullptr);
+  if (s.ok()) {
+    s = fs_->CreateDir(input.output_directory, IOOptions(), nullptr);
+  }
+  CompactionServiceResult result;
+  if (s.ok()) {
+    std::string input_str, result_str;
+    input.EncodeTo(&input_str);
+    CABIN_LOG_INFO(db_options_.info_log,
+                   "[%s] [JOB %d] Sending subcompaction to %s, output in %s",
+                   cfd->GetName().c_str(), job_id_,
+                   db_options_.compaction_service->Name(),
+                   input.output_directory.c_str());
+    s = db_options_.compaction_service->Run(input_str, &result_str);
+    if (s.ok()) {
+      s = result.DecodeFrom(result_str);
+    }
+    if (s.ok()) {
+      s = result.status;
+    }
+  }
+
+  // Move the output files into the DB under new file numbers
+  for (const auto& file : result.output_files) {
+    if (!s.ok()) {
+      break;
+    }
+    const uint64_t file_number = versions_->NewFileNumber();
+    const std::string fname = GetTableFileName(file_number);
+    s = fs_->RenameFile(input.output_directory + "/" + file.file_name, fname,
+                        IOOptions(), nullptr);
+    uint64_t file_size = 0;
+    if (s.ok()) {
+      s = fs_->GetFileSize(fname, IOOptions(), &file_size, nullptr);
+    }
+    if (!s.ok()) {
+      break;
+    }
+
+    FileMetaData meta;
+    meta.fd = FileDescriptor(file_number, c->output_path_id(), file_size,
+                             file.smallest_seqno, file.largest_seqno);
+    meta.smallest.DecodeFrom(file.smallest_internal_key);
+    meta.largest.DecodeFrom(file.largest_internal_key);
+    meta.oldest_ancester_time = file.oldest_ancester_time;
+    meta.file_creation_time = file.file_creation_time;
+    meta.oldest_blob_file_number = file.oldest_blob_file_number;
+    meta.marked_for_compaction = file.marked_for_compaction;
+    meta.file_checksum = file.file_checksum;
+    meta.file_checksum_func_name = file.file_checksum_func_name;
+    sub_compact->outputs.emplace_back(std::move(meta),
+                                      cfd->internal_comparator(),
+                                      /*enable_order_check=*/false,
+                                      /*enable_hash=*/paranoid_file_checks_);
+    auto* output = sub_compact->current_output();
+    output->validator.SetHash(file.paranoid_hash);
+    output->finished = true;
+
+    std::shared_ptr<const TableProperties> tp;
+    s = cfd->table_cache()->GetTableProperties(
+        file_options_, cfd->internal_comparator(), output->meta.fd, &tp,
+        c->mutable_cf_options()->prefix_extractor.get());
+    output->table_properties = tp;
+#ifndef CABINDB_LITE
+    auto sfm =
+        static_cast<SstFileManagerImpl*>(db_options_.sst_file_manager.get());
+    if (s.ok() && sfm) {
+      s = sfm->OnAddFile(fname);
+    }
+#endif
+    CABIN_LOG_INFO(db_options_.info_log,
+                   "[%s] [JOB %d] Installed table #%" PRIu64
+                   " from %s, %" PRIu64 " bytes",
+                   cfd->GetName().c_str(), job_id_, file_number,
+                   file.file_name.c_str(), file_size);
+  }
+
+  if (s.ok()) {
+    sub_compact->num_output_records = result.num_output_records;
+    sub_compact->total_bytes = result.total_bytes;
+    sub_compact->compaction_job_stats.cpu_micros = result.cpu_micros;
+  } else {
+    CABIN_LOG_WARN(db_options_.info_log,
+                   "[%s] [JOB %d] Compaction service failed: %s",
+                   cfd->GetName().c_str(), job_id_, s.ToString().c_str());
+  }
+
+  // Drop whatever the worker left behind
+  std::vector<std::string> children;
+  if (fs_->GetChildren(input.output_directory, IOOptions(), &children, nullptr)
+          .ok()) {
+    for (const auto& child : children) {
+      if (child != "." && child != "..") {
+        fs_->DeleteFile(input.output_directory + "/" + child, IOOptions(),
+                        nullptr)
+            .PermitUncheckedError();
+      }
+    }
+  }
+  fs_->DeleteDir(input.output_directory, IOOptions(), nullptr)
+      .PermitUncheckedError();
+
+  // Nothing was installed yet, so the subcompaction can still run here
+  if (!s.ok() && sub_compact->outputs.empty() &&
+      !shutting_down_->load(std::memory_order_acquire)) {
+    CABIN_LOG_INFO(db_options_.info_log,
+                   "[%s] [JOB %d] Running the subcompaction locally",
+                   cfd->GetName().c_str(), job_id_);
+    ProcessKeyValueCompaction(sub_compact);
+    return;
+  }
+
+  RecordTimeToHistogram(stats_, SUBCOMPACTION_TIME,
+                        env_->NowMicros() - start_micros);
+  sub_compact->status = s;
+}
+
+CompactionServiceCompactionJob::CompactionServiceCompactionJob(
+    int job_id, Compaction* compaction, const ImmutableDBOptions& db_options,
+    const FileOptions& file_options, VersionSet* versions,
+    const std::atomic<bool>* shutting_down, LogBuffer* log_buffer,
+    FSDirectory* output_directory, Statistics* stats,
+    InstrumentedMutex* db_mutex, ErrorHandler* db_error_handler,
+    std::shared_ptr<Cache> table_cache, EventLogger* event_logger,
+    const std::string& dbname, const std::shared_ptr<IOTracer>& io_tracer,
+    const std::string& db_id, const std::string& db_session_id,
+    CompactionJobStats* compaction_job_stats,
+    const CompactionServiceInput& compaction_service_input,
+    CompactionServiceResult* compaction_service_result)
+    : CompactionJob(
+          job_id, compaction, db_options, file_options, versions,
+          shutting_down, compaction_service_input.preserve_deletes_seqnum,
+          log_buffer, /*db_directory=*/nullptr, output_directory,
+          /*blob_output_directory=*/nullptr, stats, db_mutex,
+          db_error_handler, compaction_service_input.snapshots,
+          compaction_service_input.earliest_write_conflict_snapshot,
+          /*snapshot_checker=*/nullptr, std::move(table_cache), event_logger,
+          compaction->mutable_cf_options()->paranoid_file_checks,
+          /*measure_io_stats=*/false, dbname, compaction_job_stats,
+          Env::Priority::USER, io_tracer,
+          /*manual_compaction_paused=*/nullptr, db_id, db_session_id,
+          compaction_service_input.full_history_ts_low),
+      compaction_input_(compaction_service_input),
+      compaction_result_(compaction_service_result),
+      begin_(compaction_service_input.begin),
+      end_(compaction_service_input.end) {}
+
+void CompactionServiceCompactionJob::Prepare() {
+  AutoThreadOperationStageUpdater stage_updater(
+      ThreadStatus::STAGE_COMPACTION_PREPARE);
+
+  // The primary already split the compaction, so this job is always a
+  // single subcompaction over the range it was given
+  auto* c = compact_->compaction;
+  write_hint_ =
+      c->column_family_data()->CalculateSSTWriteHint(c->output_level());
+  bottommost_level_ = c->bottommost_level();
+  compact_->sub_compact_states.emplace_back(
+      c, compaction_input_.has_begin ? &begin_ : nullptr,
+      compaction_input_.has_end ? &end_ : nullptr, /*size=*/0);
+}
+
+Status CompactionServiceCompactionJob::Run() {
+  AutoThreadOperationStageUpdater stage_updater(
+      ThreadStatus::STAGE_COMPACTION_RUN);
+  log_buffer_->FlushBufferToLog();
+  LogCompaction();
+
+  assert(compact_->sub_compact_states.size() == 1);
+  SubcompactionState* sub_compact = &compact_->sub_compact_states[0];
+  ProcessKeyValueCompaction(sub_compact);
+
+  Status status = sub_compact->status;
+  IOStatus io_s = sub_compact->io_status;
+  if (io_status_.ok()) {
+    io_status_ = io_s;
+  }
+  if (status.ok() && output_directory_) {
+    io_s = output_directory_->Fsync(IOOptions(), nullptr);
+    if (io_status_.ok()) {
+      io_status_ = io_s;
+    }
+    status = io_s;
+  }
+
+  compaction_result_->status = status;
+  compaction_result_->output_files.clear();
+  if (status.ok()) {
+    for (const auto& output : sub_compact->outputs) {
+      const FileMetaData& meta = output.meta;
+      if (!meta.fd.file_size) {
+        continue;
+      }
+      CompactionServiceOutputFile file;
+      file.file_name = MakeTableFileName(meta.fd.GetNumber());
+      file.smallest_internal_key = meta.smallest.Encode().ToString();
+      file.largest_internal_key = meta.largest.Encode().ToString();
+      file.smallest_seqno = meta.fd.smallest_seqno;
+      file.largest_seqno = meta.fd.largest_seqno;
+      file.oldest_ancester_time = meta.oldest_ancester_time;
+      file.file_creation_time = meta.file_creation_time;
+      file.oldest_blob_file_number = meta.oldest_blob_file_number;
+      file.paranoid_hash = output.validator.GetHash();
+      file.marked_for_compaction = meta.marked_for_compaction;
+      file.file_checksum = meta.file_checksum;
+      file.file_checksum_func_name = meta.file_checksum_func_name;
+      compaction_result_->output_files.push_back(std::move(file));
+    }
+    compaction_result_->num_output_records = sub_compact->num_output_records;
+    compaction_result_->total_bytes = sub_compact->total_bytes;
+    compaction_result_->cpu_micros =
+        sub_compact->compaction_job_stats.cpu_micros;
+  }
+
+  RecordCompactionIOStats();
+  LogFlush(db_options_.info_log);
+  compact_->status = status;
+  return status;
+}
+
+std::string CompactionServiceCompactionJob::GetTableFileName(
+    uint64_t file_number) {
+  return MakeTableFileName(compaction_input_.output_directory, file_number);
+}
+
 }  // namespace CABINDB_NAMESPACE
@@ -81,7 +81,7 @@ class CompactionJob {
       const std::string& db_id = "", const std::string& db_session_id = "",
       std::string full_history_ts_low = "");
 
-  ~CompactionJob();
+  virtual ~CompactionJob();
 
   // no copy/move
   CompactionJob(CompactionJob&& job) = delete;
@@ -104,7 +104,7 @@ class CompactionJob {
   // Return the IO status
   IOStatus io_status() const { return io_status_; }
 
- private:
+ protected:
   struct SubcompactionState;
 
   void AggregateStatistics();
@@ -122,6 +122,14 @@ class CompactionJob {
   // Call compaction filter. Then iterate through input and compact the
   // kv-pairs
   void ProcessKeyValueCompaction(SubcompactionState* sub_compact);
+  // Whether the subcompactions are sent to DBOptions::compaction_service
+  bool ShouldUseCompactionService() const;
+  // Runs the subcompaction in the compaction service and moves the files it
+  // wrote into the DB
+  void ProcessKeyValueCompactionWithCompactionService(
+      SubcompactionState* sub_compact);
+  // Path of the output table file with the given number
+  virtual std::string GetTableFileName(uint64_t file_number);
 
   Status FinishCompactionOutputFile(
       const Status& input_status, SubcompactionState* sub_compact,
@@ -197,6 +205,8 @@ class CompactionJob {
   bool measure_io_stats_;
   // Stores the Slices that designate the boundaries for each subcompaction
   std::vector<Slice> boundaries_;
+  // Stores the keys sampled from level 0 files that boundaries_ may refer to
+  std::vector<InternalKey> anchor_keys_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
   Env::WriteLifeTimeHint write_hint_;
@@ -205,4 +215,95 @@ class CompactionJob {
   std::string full_history_ts_low_;
 };
 
+// A subcompaction as sent to a CompactionService.
+struct CompactionServiceInput {
+  std::string column_family_name;
+  // numbers of the input table files, on any level
+  std::vector<uint64_t> input_files;
+  int output_level = 0;
+  uint64_t target_file_size = 0;
+  uint64_t max_compaction_bytes = 0;
+  CompressionType compression = kNoCompression;
+  bool manual_compaction = false;
+  CompactionReason compaction_reason = CompactionReason::kUnknown;
+  std::vector<SequenceNumber> snapshots;
+  SequenceNumber earliest_write_conflict_snapshot = kMaxSequenceNumber;
+  SequenceNumber preserve_deletes_seqnum = 0;
+  std::string full_history_ts_low;
+  // key range of the subcompaction, begin inclusive and end exclusive
+  bool has_begin = false;
+  std::string begin;
+  bool has_end = false;
+  std::string end;
+  // where the worker writes the output table files
+  std::string output_directory;
+
+  void EncodeTo(std::string* output) const;
+  Status DecodeFrom(const Slice& input);
+};
+
+// A table file written by a compaction service job.
+struct CompactionServiceOutputFile {
+  // file name in CompactionServiceInput::output_directory
+  std::string file_name;
+  std::string smallest_internal_key;
+  std::string largest_internal_key;
+  SequenceNumber smallest_seqno = 0;
+  SequenceNumber largest_seqno = 0;
+  uint64_t oldest_ancester_time = 0;
+  uint64_t file_creation_time = 0;
+  uint64_t oldest_blob_file_number = kInvalidBlobFileNumber;
+  uint64_t paranoid_hash = 0;
+  bool marked_for_compaction = false;
+  std::string file_checksum;
+  std::string file_checksum_func_name;
+};
+
+// The result of a compaction service job.
+struct CompactionServiceResult {
+  Status status;
+  std::vector<CompactionServiceOutputFile> output_files;
+  uint64_t num_output_records = 0;
+  uint64_t total_bytes = 0;
+  uint64_t cpu_micros = 0;
+
+  void EncodeTo(std::string* output) const;
+  Status DecodeFrom(const Slice& input);
+};
+
+// Runs a CompactionServiceInput in a compaction service worker. The output
+// files are written to the directory named by the input and described in a
+// CompactionServiceResult instead of being installed.
+class CompactionServiceCompactionJob : private CompactionJob {
+ public:
+  CompactionServiceCompactionJob(
+      int job_id, Compaction* compaction, const ImmutableDBOptions& db_options,
+      const FileOptions& file_options, VersionSet* versions,
+      const std::atomic<bool>* shutting_down, LogBuffer* log_buffer,
+      FSDirectory* output_directory, Statistics* stats,
+      InstrumentedMutex* db_mutex, ErrorHandler* db_error_handler,
+      std::shared_ptr<Cache> table_cache, EventLogger* event_logger,
+      const std::string& dbname, const std::shared_ptr<IOTracer>& io_tracer,
+      const std::string& db_id, const std::string& db_session_id,
+      CompactionJobStats* compaction_job_stats,
+      const CompactionServiceInput& compaction_service_input,
+      CompactionServiceResult* compaction_service_result);
+
+  // REQUIRED: mutex held
+  void Prepare();
+  // REQUIRED: mutex not held
+  Status Run();
+  // REQUIRED: mutex held
+  using CompactionJob::CleanupCompaction;
+
+ protected:
+  std::string GetTableFileName(uint64_t file_number) override;
+
+ private:
+  const CompactionServiceInput& compaction_input_;
+  CompactionServiceResult* compaction_result_;
+  Slice begin_;
+  Slice end_;
+};
+
 }  // namespace CABINDB_NAMESPACE
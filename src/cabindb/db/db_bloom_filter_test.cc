@@ -523,7 +523,9 @@ INSTANTIATE_TEST_CASE_P(
         std::make_tuple(BFP::kDeprecatedBlock, false,
                         test::kDefaultFormatVersion),
         std::make_tuple(BFP::kAutoBloom, true, test::kDefaultFormatVersion),
-        std::make_tuple(BFP::kAutoBloom, false, test::kDefaultFormatVersion)));
+        std::make_tuple(BFP::kAutoBloom, false, test::kDefaultFormatVersion),
+        std::make_tuple(BFP::kStandard128Ribbon, false,
+                        test::kDefaultFormatVersion)));
 
 INSTANTIATE_TEST_CASE_P(
     FormatLatest, DBBloomFilterTestWithParam,
@@ -531,7 +533,9 @@ INSTANTIATE_TEST_CASE_P(
         std::make_tuple(BFP::kDeprecatedBlock, false,
                         test::kLatestFormatVersion),
         std::make_tuple(BFP::kAutoBloom, true, test::kLatestFormatVersion),
-        std::make_tuple(BFP::kAutoBloom, false, test::kLatestFormatVersion)));
+        std::make_tuple(BFP::kAutoBloom, false, test::kLatestFormatVersion),
+        std::make_tuple(BFP::kStandard128Ribbon, false,
+                        test::kLatestFormatVersion)));
 #endif  // CABINDB_VALGRIND_RUN
 
 TEST_F(DBBloomFilterTest, BloomFilterRate) {
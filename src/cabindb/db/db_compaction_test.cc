@@ -5925,6 +5925,247 @@ TEST_F(DBCompactionTest, CompactionWithBlob) {
   ASSERT_EQ(compaction_stats[1].num_output_files, 2);
 }
 
+TEST_F(DBCompactionTest, BottomPriCompactionColumnFamily) {
+  Env::Default()->SetBackgroundThreads(1, Env::Priority::BOTTOM);
+  Options options = CurrentOptions();
+  options.level0_file_num_compaction_trigger = 2;
+  options.bottom_pri_compaction = true;
+  DestroyAndReopen(options);
+
+  std::atomic<int> num_forwarded(0);
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:ForwardToBottomPriPool",
+      [&](void* /*arg*/) { ++num_forwarded; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // L0->L1 does not reach the last level, yet it runs in the bottom pool
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK(Put(Key(i), "value"));
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_EQ(1, num_forwarded);
+
+  ASSERT_OK(dbfull()->SetOptions({{"bottom_pri_compaction", "false"}}));
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK(Put(Key(i), "value"));
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_EQ(1, num_forwarded);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Env::Default()->SetBackgroundThreads(0, Env::Priority::BOTTOM);
+}
+
+TEST_F(DBCompactionTest, HighPriCompactionColumnFamily) {
+  Options options = CurrentOptions();
+  options.level0_file_num_compaction_trigger = 2;
+  options.max_background_compactions = 1;
+  CreateAndReopenWithCF({"one", "two"}, options);
+  ASSERT_OK(dbfull()->SetOptions(handles_[2], {{"high_pri_compaction", "true"}}));
+
+  // hold the only compaction thread while both column families queue up
+  env_->SetBackgroundThreads(1, Env::LOW);
+  test::SleepingBackgroundTask sleeping_task;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                 Env::Priority::LOW);
+  sleeping_task.WaitUntilSleeping();
+
+  std::vector<std::string> compacted;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:AfterCompaction", [&](void* arg) {
+        compacted.push_back(static_cast<ColumnFamilyData*>(arg)->GetName());
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // column family one is queued first
+  for (int cf : {1, 2}) {
+    for (int i = 0; i < 2; ++i) {
+      ASSERT_OK(Put(cf, Key(i), "value"));
+      ASSERT_OK(Flush(cf));
+    }
+  }
+
+  sleeping_task.WakeUp();
+  sleeping_task.WaitUntilDone();
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+
+  ASSERT_EQ(2, compacted.size());
+  ASSERT_EQ("two", compacted[0]);
+  ASSERT_EQ("one", compacted[1]);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBCompactionTest, ColumnFamilySubcompactions) {
+  Options options = CurrentOptions();
+  options.max_subcompactions = 1;
+  options.max_cf_subcompactions = 4;
+  options.level0_file_num_compaction_trigger = 4;
+  options.target_file_size_base = 8 << 10;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // a level 0 compaction is only split when level 1 is not empty
+  ASSERT_OK(Put(Key(0), "value"));
+  ASSERT_OK(Put(Key(999), "value"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+
+  size_t num_anchors = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::GenSubcompactionBoundaries:Anchors", [&](void* arg) {
+        num_anchors += static_cast<std::vector<InternalKey>*>(arg)->size();
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // every level 0 file spans the whole key range
+  Random rnd(301);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      ASSERT_OK(Put(Key(j * 10 + i), rnd.RandomString(100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_GT(num_anchors, 4);
+
+  HistogramData num_subcompactions;
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &num_subcompactions);
+  ASSERT_EQ(1, num_subcompactions.count);
+  ASSERT_GT(num_subcompactions.max, 1);
+  HistogramData subcompaction_time;
+  options.statistics->histogramData(SUBCOMPACTION_TIME, &subcompaction_time);
+  ASSERT_GE(subcompaction_time.count, num_subcompactions.max);
+
+  // back to DBOptions::max_subcompactions
+  ASSERT_OK(dbfull()->SetOptions({{"max_cf_subcompactions", "0"}}));
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      ASSERT_OK(Put(Key(j * 10 + i), rnd.RandomString(100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &num_subcompactions);
+  ASSERT_EQ(1, num_subcompactions.count);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBCompactionTest, CompactionBlobGarbageCollection) {
+  Options options;
+  options.disable_auto_compactions = true;
+  options.enable_blob_files = true;
+  options.enable_blob_garbage_collection = true;
+  options.blob_garbage_collection_age_cutoff = 1.0;
+  options.env = env_;
+
+  Reopen(options);
+
+  constexpr char first_key[] = "first_key";
+  constexpr char second_key[] = "second_key";
+  constexpr char first_value[] = "first_value";
+  constexpr char second_value[] = "second_value";
+
+  ASSERT_OK(Put(first_key, first_value));
+  ASSERT_OK(Flush());
+
+  ASSERT_OK(Put(second_key, second_value));
+  ASSERT_OK(Flush());
+
+  VersionSet* const versions = dbfull()->TEST_GetVersionSet();
+  assert(versions);
+
+  ColumnFamilyData* const cfd = versions->GetColumnFamilySet()->GetDefault();
+  assert(cfd);
+
+  uint64_t newest_old_blob_file_number = 0;
+  {
+    const auto& blob_files = cfd->current()->storage_info()->GetBlobFiles();
+    ASSERT_EQ(blob_files.size(), 2);
+    newest_old_blob_file_number = blob_files.rbegin()->first;
+  }
+
+  constexpr Slice* begin = nullptr;
+  constexpr Slice* end = nullptr;
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), begin, end));
+
+  ASSERT_EQ(Get(first_key), first_value);
+  ASSERT_EQ(Get(second_key), second_value);
+
+  // With an age cutoff of 1.0 every blob is relocated, so the old blob files
+  // are left with nothing but garbage and are dropped.
+  const auto& blob_files = cfd->current()->storage_info()->GetBlobFiles();
+  ASSERT_EQ(blob_files.size(), 1);
+  ASSERT_GT(blob_files.begin()->first, newest_old_blob_file_number);
+  ASSERT_EQ(blob_files.begin()->second->GetTotalBlobCount(), 2);
+
+  uint64_t value = 0;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kNumBlobFiles, &value));
+  ASSERT_EQ(value, 1);
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kTotalBlobFileSize, &value));
+  ASSERT_EQ(value, blob_files.begin()->second->GetTotalBlobBytes());
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kBlobGarbageSize, &value));
+  ASSERT_EQ(value, 0);
+}
+
+TEST_F(DBCompactionTest, CompactionBlobGarbageCollectionWithFilter) {
+  // Records the keys whose blob references reach the filter
+  class BlobOutputFilter : public CompactionFilter {
+   public:
+    const char* Name() const override { return "BlobOutputFilter"; }
+    BlobDecision PrepareBlobOutput(const Slice& key,
+                                   const Slice& /* existing_value */,
+                                   std::string* /* new_value */) const override {
+      keys_.push_back(key.ToString());
+      return BlobDecision::kKeep;
+    }
+    mutable std::vector<std::string> keys_;
+  };
+  BlobOutputFilter filter;
+
+  Options options;
+  options.disable_auto_compactions = true;
+  options.enable_blob_files = true;
+  options.enable_blob_garbage_collection = true;
+  options.blob_garbage_collection_age_cutoff = 0.5;
+  options.compaction_filter = &filter;
+  options.env = env_;
+
+  Reopen(options);
+
+  ASSERT_OK(Put("first_key", "first_value"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("second_key", "second_value"));
+  ASSERT_OK(Flush());
+
+  constexpr Slice* begin = nullptr;
+  constexpr Slice* end = nullptr;
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), begin, end));
+
+  // The blob in the older file is relocated by garbage collection; the one
+  // left in place still goes through the filter.
+  ASSERT_EQ(filter.keys_, std::vector<std::string>{"second_key"});
+  ASSERT_EQ(Get("first_key"), "first_value");
+  ASSERT_EQ(Get("second_key"), "second_value");
+}
+
 class DBCompactionTestBlobError
     : public DBCompactionTest,
       public testing::WithParamInterface<std::string> {
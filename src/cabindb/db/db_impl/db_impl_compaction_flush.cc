@@ -1712,7 +1712,8 @@ Status DBImpl::RunManualCompaction(
       manual.incomplete = false;
       bg_compaction_scheduled_++;
       Env::Priority thread_pool_pri = Env::Priority::LOW;
-      if (compaction->bottommost_level() &&
+      if ((compaction->bottommost_level() ||
+           compaction->mutable_cf_options()->bottom_pri_compaction) &&
           env_->GetBackgroundThreads(Env::Priority::BOTTOM) > 0) {
         thread_pool_pri = Env::Priority::BOTTOM;
       }
@@ -2257,7 +2258,11 @@ DBImpl::BGJobLimits DBImpl::GetBGJobLimits(int max_background_flushes,
 void DBImpl::AddToCompactionQueue(ColumnFamilyData* cfd) {
   assert(!cfd->queued_for_compaction());
   cfd->Ref();
-  compaction_queue_.push_back(cfd);
+  if (cfd->GetLatestMutableCFOptions()->high_pri_compaction) {
+    compaction_queue_.push_front(cfd);
+  } else {
+    compaction_queue_.push_back(cfd);
+  }
   cfd->set_queued_for_compaction(true);
 }
 
@@ -2979,17 +2984,20 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
     ThreadStatusUtil::ResetThreadStatus();
     TEST_SYNC_POINT_CALLBACK("DBImpl::BackgroundCompaction:AfterCompaction",
                              c->column_family_data());
-  } else if (!is_prepicked && c->output_level() > 0 &&
-             c->output_level() ==
-                 c->column_family_data()
-                     ->current()
-                     ->storage_info()
-                     ->MaxOutputLevel(
-                         immutable_db_options_.allow_ingest_behind) &&
+  } else if (!is_prepicked &&
+             ((c->output_level() > 0 &&
+               c->output_level() ==
+                   c->column_family_data()
+                       ->current()
+                       ->storage_info()
+                       ->MaxOutputLevel(
+                           immutable_db_options_.allow_ingest_behind)) ||
+              c->mutable_cf_options()->bottom_pri_compaction) &&
              env_->GetBackgroundThreads(Env::Priority::BOTTOM) > 0) {
     // Forward compactions involving last level to the bottom pool if it exists,
     // such that compactions unlikely to contribute to write stalls can be
-    // delayed or deprioritized.
+    // delayed or deprioritized. Column families with bottom_pri_compaction
+    // send all their compactions there.
     TEST_SYNC_POINT("DBImpl::BackgroundCompaction:ForwardToBottomPriPool");
     CompactionArg* ca = new CompactionArg;
     ca->db = this;
@@ -8,6 +8,8 @@
 #include <cinttypes>
 
 #include "db/arena_wrapped_db_iter.h"
+#include "db/compaction/compaction_job.h"
+#include "db/compaction/compaction_picker.h"
 #include "db/merge_context.h"
 #include "logging/auto_roll_logger.h"
 #include "monitoring/perf_context_imp.h"
@@ -423,7 +425,9 @@ ArenaWrappedDBIter* DBImplSecondary::NewIteratorImpl(
       env_, read_options, *cfd->ioptions(), super_version->mutable_cf_options,
       snapshot,
       super_version->mutable_cf_options.max_sequential_skip_in_iterations,
-      super_version->version_number, read_callback);
+      super_version->version_number, read_callback, /*db_impl=*/nullptr,
+      /*cfd=*/nullptr, /*allow_blob=*/false, /*allow_refresh=*/true,
+      super_version->current);
   auto internal_iter = NewInternalIterator(
       db_iter->GetReadOptions(), cfd, super_version, db_iter->GetArena(),
       db_iter->GetRangeDelAggregator(), snapshot,
@@ -574,6 +578,68 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
   return s;
 }
 
+Status DBImplSecondary::CompactWithoutInstallation(
+    ColumnFamilyHandle* cfh, const CompactionServiceInput& input,
+    CompactionServiceResult* result) {
+  InstrumentedMutexLock l(&mutex_);
+  auto cfd = static_cast_with_check<ColumnFamilyHandleImpl>(cfh)->cfd();
+  if (!cfd) {
+    return Status::InvalidArgument("Cannot find column family" +
+                                   cfh->GetName());
+  }
+
+  std::unordered_set<uint64_t> input_set(input.input_files.begin(),
+                                         input.input_files.end());
+  Version* version = cfd->current();
+  VersionStorageInfo* vstorage = version->storage_info();
+  std::vector<CompactionInputFiles> input_files;
+  Status s = cfd->compaction_picker()->GetCompactionInputsFromFileNumbers(
+      &input_files, &input_set, vstorage, CompactionOptions());
+  if (!s.ok()) {
+    return s;
+  }
+
+  // The primary picked the files and the output, and already split the
+  // compaction, so grandparents are not needed to cut the output files
+  const MutableCFOptions* mutable_cf_options = cfd->GetLatestMutableCFOptions();
+  std::unique_ptr<Compaction> c(new Compaction(
+      vstorage, *cfd->ioptions(), *mutable_cf_options, mutable_db_options_,
+      input_files, input.output_level, input.target_file_size,
+      input.max_compaction_bytes, /*output_path_id=*/0, input.compression,
+      GetCompressionOptions(*mutable_cf_options, vstorage, input.output_level),
+      /*max_subcompactions=*/1, /*grandparents=*/{}, input.manual_compaction,
+      /*score=*/-1, /*deletion_compaction=*/false, input.compaction_reason));
+  c->SetInputVersion(version);
+
+  std::unique_ptr<FSDirectory> output_dir;
+  s = fs_->NewDirectory(input.output_directory, IOOptions(), &output_dir,
+                        nullptr);
+  if (!s.ok()) {
+    c->ReleaseCompactionFiles(s);
+    return s;
+  }
+
+  const int job_id = next_job_id_.fetch_add(1);
+  LogBuffer log_buffer(InfoLogLevel::INFO_LEVEL,
+                       immutable_db_options_.info_log.get());
+  CompactionJobStats compaction_job_stats;
+  CompactionServiceCompactionJob compaction_job(
+      job_id, c.get(), immutable_db_options_, file_options_for_compaction_,
+      versions_.get(), &shutting_down_, &log_buffer, output_dir.get(), stats_,
+      &mutex_, &error_handler_, table_cache_, &event_logger_, dbname_,
+      io_tracer_, db_id_, db_session_id_, &compaction_job_stats, input,
+      result);
+
+  compaction_job.Prepare();
+  mutex_.Unlock();
+  s = compaction_job.Run();
+  mutex_.Lock();
+  compaction_job.CleanupCompaction();
+  c->ReleaseCompactionFiles(s);
+  log_buffer.FlushBufferToLog();
+  return s;
+}
+
 Status DB::OpenAsSecondary(const Options& options, const std::string& dbname,
                            const std::string& secondary_path, DB** dbptr) {
   *dbptr = nullptr;
@@ -662,6 +728,59 @@ Status DB::OpenAsSecondary(
   }
   return s;
 }
+
+Status DB::OpenAndCompact(
+    const DBOptions& db_options, const std::string& name,
+    const std::string& secondary_path,
+    const std::vector<ColumnFamilyDescriptor>& column_families,
+    const std::string& input, std::string* output) {
+  CompactionServiceInput compaction_input;
+  Status s = compaction_input.DecodeFrom(input);
+  if (!s.ok()) {
+    return s;
+  }
+
+  // Only the default column family and the one being compacted are opened
+  std::vector<ColumnFamilyDescriptor> open_cfs;
+  open_cfs.emplace_back(kDefaultColumnFamilyName, ColumnFamilyOptions());
+  bool found = false;
+  for (const auto& cf : column_families) {
+    if (cf.name == kDefaultColumnFamilyName) {
+      open_cfs[0] = cf;
+    } else if (cf.name == compaction_input.column_family_name) {
+      open_cfs.push_back(cf);
+    }
+    found = found || cf.name == compaction_input.column_family_name;
+  }
+  if (!found) {
+    return Status::InvalidArgument("Column family not found",
+                                   compaction_input.column_family_name);
+  }
+
+  DBOptions secondary_options(db_options);
+  secondary_options.max_open_files = -1;
+  secondary_options.compaction_service = nullptr;
+  std::vector<ColumnFamilyHandle*> handles;
+  DB* db = nullptr;
+  s = DB::OpenAsSecondary(secondary_options, name, secondary_path, open_cfs,
+                          &handles, &db);
+  if (!s.ok()) {
+    return s;
+  }
+
+  CompactionServiceResult result;
+  auto impl = static_cast_with_check<DBImplSecondary>(db);
+  s = impl->CompactWithoutInstallation(handles.back(), compaction_input,
+                                       &result);
+  result.status = s;
+  result.EncodeTo(output);
+
+  for (auto h : handles) {
+    delete h;
+  }
+  delete db;
+  return s;
+}
 #else   // !CABINDB_LITE
 
 Status DB::OpenAsSecondary(const Options& /*options*/,
@@ -678,6 +797,14 @@ Status DB::OpenAsSecondary(
     std::vector<ColumnFamilyHandle*>* /*handles*/, DB** /*dbptr*/) {
   return Status::NotSupported("Not supported in CABINDB_LITE.");
 }
+
+Status DB::OpenAndCompact(
+    const DBOptions& /*db_options*/, const std::string& /*name*/,
+    const std::string& /*secondary_path*/,
+    const std::vector<ColumnFamilyDescriptor>& /*column_families*/,
+    const std::string& /*input*/, std::string* /*output*/) {
+  return Status::NotSupported("Not supported in CABINDB_LITE.");
+}
 #endif  // !CABINDB_LITE
 
 }  // namespace CABINDB_NAMESPACE
@@ -13,6 +13,9 @@
 
 namespace CABINDB_NAMESPACE {
 
+struct CompactionServiceInput;
+struct CompactionServiceResult;
+
 // A wrapper class to hold log reader, log reporter, log status.
 class LogReaderContainer {
  public:
@@ -222,6 +225,12 @@ class DBImplSecondary : public DBImpl {
   // not flag the missing file as inconsistency.
   Status CheckConsistency() override;
 
+  // Runs a compaction sent by the compaction service of the primary and
+  // describes its output files in result. Nothing is installed.
+  Status CompactWithoutInstallation(ColumnFamilyHandle* cfh,
+                                    const CompactionServiceInput& input,
+                                    CompactionServiceResult* result);
+
  protected:
   // ColumnFamilyCollector is a write batch handler which does nothing
   // except recording unique column family IDs
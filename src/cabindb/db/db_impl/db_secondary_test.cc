@@ -919,6 +919,95 @@ TEST_F(DBSecondaryTest, InconsistencyDuringCatchUp) {
   Status s = db_secondary_->TryCatchUpWithPrimary();
   ASSERT_TRUE(s.IsCorruption());
 }
+
+// Runs the compactions of the primary in the same process, through
+// DB::OpenAndCompact
+class InProcessCompactionService : public CompactionService {
+ public:
+  InProcessCompactionService(const std::string& db_path,
+                             const std::string& secondary_path,
+                             const Options& options)
+      : db_path_(db_path), secondary_path_(secondary_path), options_(options) {}
+
+  const char* Name() const override { return "InProcessCompactionService"; }
+
+  Status Run(const std::string& input, std::string* output) override {
+    num_jobs_++;
+    std::vector<ColumnFamilyDescriptor> column_families;
+    column_families.emplace_back(kDefaultColumnFamilyName, options_);
+    return DB::OpenAndCompact(options_, db_path_, secondary_path_,
+                              column_families, input, output);
+  }
+
+  int num_jobs() const { return num_jobs_.load(); }
+
+ private:
+  const std::string db_path_;
+  const std::string secondary_path_;
+  const Options options_;
+  std::atomic<int> num_jobs_{0};
+};
+
+TEST_F(DBSecondaryTest, CompactionService) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  options.paranoid_file_checks = true;
+  auto service = std::make_shared<InProcessCompactionService>(
+      dbname_, secondary_path_, options);
+  options.compaction_service = service;
+  Reopen(options);
+
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 100; j++) {
+      ASSERT_OK(Put(Key(j * 4 + i), "value" + ToString(i)));
+    }
+    ASSERT_OK(Delete(Key(i)));
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ("4", FilesPerLevel());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(service->num_jobs(), 0);
+  ASSERT_EQ("0,1", FilesPerLevel());
+  for (int k = 0; k < 400; k++) {
+    ASSERT_EQ(k < 4 ? "NOT_FOUND" : "value" + ToString(k % 4), Get(Key(k)));
+  }
+
+  // the output directories of the worker are removed
+  std::vector<std::string> children;
+  ASSERT_OK(env_->GetChildren(dbname_ + "/compaction_service", &children));
+  for (const auto& child : children) {
+    ASSERT_TRUE(child == "." || child == "..") << child;
+  }
+
+  // the installed files survive a reopen
+  Reopen(options);
+  ASSERT_EQ("0,1", FilesPerLevel());
+  ASSERT_EQ("value3", Get(Key(399)));
+}
+
+TEST_F(DBSecondaryTest, CompactionServiceSkipsBlobGarbageCollection) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  // blobs written earlier may still be relocated after blob files are off
+  options.enable_blob_garbage_collection = true;
+  auto service = std::make_shared<InProcessCompactionService>(
+      dbname_, secondary_path_, options);
+  options.compaction_service = service;
+  Reopen(options);
+
+  for (int i = 0; i < 2; i++) {
+    ASSERT_OK(Put(Key(0), "value" + ToString(i)));
+    ASSERT_OK(Put(Key(1), "value" + ToString(i)));
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, service->num_jobs());
+  ASSERT_EQ("0,1", FilesPerLevel());
+  ASSERT_EQ("value1", Get(Key(0)));
+}
 #endif  //! CABINDB_LITE
 
 }  // namespace CABINDB_NAMESPACE
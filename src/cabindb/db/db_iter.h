@@ -117,7 +117,7 @@ class DBIter final : public Iterator {
          InternalIterator* iter, SequenceNumber s, bool arena_mode,
          uint64_t max_sequential_skip_in_iterations,
          ReadCallback* read_callback, DBImpl* db_impl, ColumnFamilyData* cfd,
-         bool allow_blob);
+         bool allow_blob, const Version* version);
 
   // No copying allowed
   DBIter(const DBIter&) = delete;
@@ -159,7 +159,10 @@ class DBIter final : public Iterator {
   }
   Slice value() const override {
     assert(valid_);
-    if (current_entry_is_merged_) {
+    if (is_blob_ && !allow_blob_) {
+      // integrated blob files: the value was read from the blob file
+      return blob_value_;
+    } else if (current_entry_is_merged_) {
       // If pinned_value_ is set then the result of merge operator is one of
       // the merge operands and we should return it.
       return pinned_value_.data() ? pinned_value_ : saved_value_;
@@ -185,8 +188,8 @@ class DBIter final : public Iterator {
     return ExtractTimestampFromUserKey(ukey_and_ts, timestamp_size_);
   }
   bool IsBlob() const {
-    assert(valid_ && (allow_blob_ || !is_blob_));
-    return is_blob_;
+    assert(valid_);
+    return allow_blob_ && is_blob_;
   }
 
   Status GetProperty(std::string prop_name, std::string* prop) override;
@@ -233,6 +236,14 @@ class DBIter final : public Iterator {
   bool FindNextUserEntryInternal(bool skipping_saved_key, const Slice* prefix);
   bool ParseKey(ParsedInternalKey* key);
   bool MergeValuesNewToOld();
+  // Read the value that `blob_index` points to into blob_value_, unless the
+  // iterator exposes blob indexes to a stacked BlobDB. Returns false and sets
+  // status_ on error.
+  bool SetBlobValueIfNeeded(const Slice& user_key, const Slice& blob_index);
+  inline void ResetBlobValue() {
+    is_blob_ = false;
+    blob_value_.Reset();
+  }
 
   // If prefix is not null, we need to set the iterator to invalid if no more
   // entry can be found within the prefix.
@@ -335,9 +346,17 @@ class DBIter final : public Iterator {
   // Expect the inner iterator to maintain a total order.
   // prefix_extractor_ must be non-NULL if the value is false.
   const bool expect_total_order_inner_iter_;
+  // True if blob indexes are handed to a stacked BlobDB as they are; otherwise
+  // blob values are read from the blob files of version_.
   bool allow_blob_;
   bool is_blob_;
   bool arena_mode_;
+  // The version the internal iterator reads from; may be null, in which case
+  // blob indexes cannot be resolved.
+  const Version* version_;
+  PinnableSlice blob_value_;
+  const ReadTier read_tier_;
+  const bool verify_checksums_;
   // List of operands for merge operator.
   MergeContext merge_context_;
   ReadRangeDelAggregator range_del_agg_;
@@ -369,6 +388,7 @@ extern Iterator* NewDBIterator(
     const Comparator* user_key_comparator, InternalIterator* internal_iter,
     const SequenceNumber& sequence, uint64_t max_sequential_skip_in_iterations,
     ReadCallback* read_callback, DBImpl* db_impl = nullptr,
-    ColumnFamilyData* cfd = nullptr, bool allow_blob = false);
+    ColumnFamilyData* cfd = nullptr, bool allow_blob = false,
+    const Version* version = nullptr);
 
 }  // namespace CABINDB_NAMESPACE
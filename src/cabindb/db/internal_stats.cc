@@ -243,6 +243,9 @@ static const std::string min_obsolete_sst_number_to_keep_str =
 static const std::string base_level_str = "base-level";
 static const std::string total_sst_files_size = "total-sst-files-size";
 static const std::string live_sst_files_size = "live-sst-files-size";
+static const std::string num_blob_files = "num-blob-files";
+static const std::string total_blob_file_size = "total-blob-file-size";
+static const std::string blob_garbage_size = "blob-garbage-size";
 static const std::string estimate_pending_comp_bytes =
     "estimate-pending-compaction-bytes";
 static const std::string aggregated_table_properties =
@@ -327,6 +330,12 @@ const std::string DB::Properties::kTotalSstFilesSize =
     cabindb_prefix + total_sst_files_size;
 const std::string DB::Properties::kLiveSstFilesSize =
     cabindb_prefix + live_sst_files_size;
+const std::string DB::Properties::kNumBlobFiles =
+    cabindb_prefix + num_blob_files;
+const std::string DB::Properties::kTotalBlobFileSize =
+    cabindb_prefix + total_blob_file_size;
+const std::string DB::Properties::kBlobGarbageSize =
+    cabindb_prefix + blob_garbage_size;
 const std::string DB::Properties::kBaseLevel = cabindb_prefix + base_level_str;
 const std::string DB::Properties::kEstimatePendingCompactionBytes =
     cabindb_prefix + estimate_pending_comp_bytes;
@@ -457,6 +466,15 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kLiveSstFilesSize,
          {false, nullptr, &InternalStats::HandleLiveSstFilesSize, nullptr,
           nullptr}},
+        {DB::Properties::kNumBlobFiles,
+         {false, nullptr, &InternalStats::HandleNumBlobFiles, nullptr,
+          nullptr}},
+        {DB::Properties::kTotalBlobFileSize,
+         {false, nullptr, &InternalStats::HandleTotalBlobFileSize, nullptr,
+          nullptr}},
+        {DB::Properties::kBlobGarbageSize,
+         {false, nullptr, &InternalStats::HandleBlobGarbageSize, nullptr,
+          nullptr}},
         {DB::Properties::kEstimatePendingCompactionBytes,
          {false, nullptr, &InternalStats::HandleEstimatePendingCompactionBytes,
           nullptr, nullptr}},
@@ -822,6 +840,35 @@ bool InternalStats::HandleLiveSstFilesSize(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+bool InternalStats::HandleNumBlobFiles(uint64_t* value, DBImpl* /*db*/,
+                                       Version* /*version*/) {
+  const auto* vstorage = cfd_->current()->storage_info();
+  *value = vstorage->GetBlobFiles().size();
+  return true;
+}
+
+bool InternalStats::HandleTotalBlobFileSize(uint64_t* value, DBImpl* /*db*/,
+                                            Version* /*version*/) {
+  const auto* vstorage = cfd_->current()->storage_info();
+  uint64_t total = 0;
+  for (const auto& pair : vstorage->GetBlobFiles()) {
+    total += pair.second->GetTotalBlobBytes();
+  }
+  *value = total;
+  return true;
+}
+
+bool InternalStats::HandleBlobGarbageSize(uint64_t* value, DBImpl* /*db*/,
+                                          Version* /*version*/) {
+  const auto* vstorage = cfd_->current()->storage_info();
+  uint64_t garbage = 0;
+  for (const auto& pair : vstorage->GetBlobFiles()) {
+    garbage += pair.second->GetGarbageBlobBytes();
+  }
+  *value = garbage;
+  return true;
+}
+
 bool InternalStats::HandleEstimatePendingCompactionBytes(uint64_t* value,
                                                          DBImpl* /*db*/,
                                                          Version* /*version*/) {
@@ -33,10 +33,14 @@ class OutputValidator {
     return GetHash() == other_validator.GetHash();
   }
 
- private:
   // Not (yet) intended to be persisted, so subject to change
-  // without notice between releases.
+  // without notice between releases. Only passed between a DB and its
+  // compaction service, which run the same version.
   uint64_t GetHash() const { return paranoid_hash_; }
+  // Takes the hash computed by a compaction service for a file it wrote
+  void SetHash(uint64_t hash) { paranoid_hash_ = hash; }
+
+ private:
 
   const InternalKeyComparator& icmp_;
   std::string prev_key_;
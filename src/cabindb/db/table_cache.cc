@@ -701,4 +701,30 @@ uint64_t TableCache::ApproximateSize(
 
   return result;
 }
+
+Status TableCache::ApproximateKeyAnchors(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileDescriptor& fd, std::vector<TableReader::Anchor>* anchors,
+    const SliceTransform* prefix_extractor) {
+  Status s;
+  TableReader* table_reader = fd.table_reader;
+  Cache::Handle* table_handle = nullptr;
+  if (table_reader == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, fd, &table_handle,
+                  prefix_extractor, false /* no_io */,
+                  false /* record_read_stats */);
+    if (s.ok()) {
+      table_reader = GetTableReaderFromHandle(table_handle);
+    }
+  }
+
+  if (s.ok()) {
+    s = table_reader->ApproximateKeyAnchors(ro, anchors);
+  }
+  if (table_handle != nullptr) {
+    ReleaseHandle(table_handle);
+  }
+
+  return s;
+}
 }  // namespace CABINDB_NAMESPACE
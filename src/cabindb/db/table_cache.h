@@ -178,6 +178,14 @@ class TableCache {
                            const InternalKeyComparator& internal_comparator,
                            const SliceTransform* prefix_extractor = nullptr);
 
+  // Appends key anchors of the file represented by fd, as returned by
+  // TableReader::ApproximateKeyAnchors().
+  Status ApproximateKeyAnchors(const ReadOptions& ro,
+                               const InternalKeyComparator& internal_comparator,
+                               const FileDescriptor& fd,
+                               std::vector<TableReader::Anchor>* anchors,
+                               const SliceTransform* prefix_extractor = nullptr);
+
   // Release the handle from a cache
   void ReleaseHandle(Cache::Handle* handle);
 
@@ -2026,7 +2026,7 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
         iter->ukey_with_ts, iter->value, iter->timestamp, nullptr,
         &(iter->merge_context), true, &iter->max_covering_tombstone_seq,
         this->env_, nullptr, merge_operator_ ? &pinned_iters_mgr : nullptr,
-        callback, is_blob, tracing_mget_id);
+        callback, is_blob ? is_blob : &iter->is_blob_index, tracing_mget_id);
     // MergeInProgress status, if set, has been transferred to the get_context
     // state, so we set status to ok here. From now on, the iter status will
     // be used for IO errors, and get_context state will be used for any
@@ -2121,6 +2121,16 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
           // TODO: update per-level perfcontext user_key_return_count for kMerge
           break;
         case GetContext::kFound:
+          if (!is_blob && iter->is_blob_index && iter->value) {
+            *status = GetBlob(read_options, iter->ukey_with_ts, iter->value);
+            if (!status->ok()) {
+              if (status->IsIncomplete()) {
+                get_context.MarkKeyMayExist();
+              }
+              file_range.MarkKeyDone(iter);
+              continue;
+            }
+          }
           if (fp.GetHitFileLevel() == 0) {
             RecordTick(db_statistics_, GET_HIT_L0);
           } else if (fp.GetHitFileLevel() == 1) {
@@ -259,7 +259,7 @@ class PosixFileSystem : public FileSystem {
           options
 #if defined(CABINDB_IOURING_PRESENT)
           ,
-          thread_local_io_urings_.get()
+          thread_local_io_urings_.get(), thread_local_async_io_urings_.get()
 #endif
               ));
     }
@@ -968,6 +968,8 @@ class PosixFileSystem : public FileSystem {
 #if defined(CABINDB_IOURING_PRESENT)
   // io_uring instance
   std::unique_ptr<ThreadLocalPtr> thread_local_io_urings_;
+  // io_uring instance for ReadAsync()
+  std::unique_ptr<ThreadLocalPtr> thread_local_async_io_urings_;
 #endif
 
   size_t page_size_;
@@ -1029,7 +1031,9 @@ PosixFileSystem::PosixFileSystem()
   struct io_uring* new_io_uring = CreateIOUring();
   if (new_io_uring != nullptr) {
     thread_local_io_urings_.reset(new ThreadLocalPtr(DeleteIOUring));
-    delete new_io_uring;
+    thread_local_async_io_urings_.reset(
+        new ThreadLocalPtr(DeleteAsyncIOUring));
+    DeleteIOUring(new_io_uring);
   }
 #endif
 }
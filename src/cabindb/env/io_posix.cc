@@ -544,7 +544,8 @@ PosixRandomAccessFile::PosixRandomAccessFile(
     const EnvOptions& options
 #if defined(CABINDB_IOURING_PRESENT)
     ,
-    ThreadLocalPtr* thread_local_io_urings
+    ThreadLocalPtr* thread_local_io_urings,
+    ThreadLocalPtr* thread_local_async_io_urings
 #endif
     )
     : filename_(fname),
@@ -553,7 +554,8 @@ PosixRandomAccessFile::PosixRandomAccessFile(
       logical_sector_size_(logical_block_size)
 #if defined(CABINDB_IOURING_PRESENT)
       ,
-      thread_local_io_urings_(thread_local_io_urings)
+      thread_local_io_urings_(thread_local_io_urings),
+      thread_local_async_io_urings_(thread_local_async_io_urings)
 #endif
 {
   assert(!options.use_direct_reads || !options.use_mmap_reads);
@@ -746,6 +748,126 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
 #endif
 }
 
+#if defined(CABINDB_IOURING_PRESENT)
+// A read started by PosixRandomAccessFile::ReadAsync(), and the handle
+// returned for it.
+struct PosixAsyncRead {
+  std::shared_ptr<AsyncIOUring> iu;
+  FSReadRequest* req;
+  IOOptions opts;
+  struct iovec iov;
+  bool done = false;
+  int res = 0;
+};
+
+IOStatus PosixRandomAccessFile::ReadAsync(FSReadRequest& req,
+                                          const IOOptions& opts,
+                                          void** io_handle,
+                                          IODebugContext* /*dbg*/) {
+  if (use_direct_io()) {
+    assert(IsSectorAligned(req.offset, GetRequiredBufferAlignment()));
+    assert(IsSectorAligned(req.len, GetRequiredBufferAlignment()));
+    assert(IsSectorAligned(req.scratch, GetRequiredBufferAlignment()));
+  }
+
+  std::shared_ptr<AsyncIOUring>* iu = nullptr;
+  if (thread_local_async_io_urings_) {
+    iu = static_cast<std::shared_ptr<AsyncIOUring>*>(
+        thread_local_async_io_urings_->Get());
+    if (iu == nullptr) {
+      iu = CreateAsyncIOUring();
+      if (iu != nullptr) {
+        thread_local_async_io_urings_->Reset(iu);
+      }
+    }
+  }
+  if (iu == nullptr) {
+    return IOStatus::NotSupported("ReadAsync");
+  }
+
+  std::unique_ptr<PosixAsyncRead> read(new PosixAsyncRead);
+  read->iu = *iu;
+  read->req = &req;
+  read->opts = opts;
+  read->iov.iov_base = req.scratch;
+  read->iov.iov_len = req.len;
+
+  AsyncIOUring* ring = read->iu.get();
+  MutexLock lock(&ring->mu);
+  struct io_uring_sqe* sqe = io_uring_get_sqe(&ring->ring);
+  if (sqe == nullptr) {
+    return IOStatus::Busy("io_uring submission queue is full");
+  }
+  io_uring_prep_readv(sqe, fd_, &read->iov, 1, req.offset);
+  io_uring_sqe_set_data(sqe, read.get());
+  // If the submit fails the entry stays queued, and goes to the kernel with
+  // the io_uring_submit_and_wait() of the next WaitAsync() on this ring.
+  io_uring_submit(&ring->ring);
+  ring->inflight++;
+  *io_handle = read.release();
+  return IOStatus::OK();
+}
+
+IOStatus PosixRandomAccessFile::WaitAsync(void* io_handle) {
+  std::unique_ptr<PosixAsyncRead> read(
+      static_cast<PosixAsyncRead*>(io_handle));
+  AsyncIOUring* ring = read->iu.get();
+  {
+    // Completions are reaped in order, so finishing this read may reap reads
+    // that other callers wait for; they find theirs already done.
+    MutexLock lock(&ring->mu);
+    while (!read->done) {
+      struct io_uring_cqe* cqe = nullptr;
+      int ret = io_uring_peek_cqe(&ring->ring, &cqe);
+      if (ret == -EAGAIN) {
+        ret = io_uring_submit_and_wait(&ring->ring, 1);
+        if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+          // The read may still complete into req->scratch, so the handle is
+          // leaked rather than reused.
+          read.release();
+          return IOError("While waiting for io_uring", filename_, -ret);
+        }
+        continue;
+      }
+      assert(!ret);
+      PosixAsyncRead* finished =
+          static_cast<PosixAsyncRead*>(io_uring_cqe_get_data(cqe));
+      finished->res = cqe->res;
+      finished->done = true;
+      io_uring_cqe_seen(&ring->ring, cqe);
+      ring->inflight--;
+    }
+  }
+
+  FSReadRequest* req = read->req;
+  if (read->res < 0) {
+    req->result = Slice(req->scratch, 0);
+    req->status = IOError("While reading offset " + ToString(req->offset) +
+                              " len " + ToString(req->len),
+                          filename_, -read->res);
+    return IOStatus::OK();
+  }
+
+  size_t bytes_read = static_cast<size_t>(read->res);
+  TEST_SYNC_POINT_CALLBACK("PosixRandomAccessFile::WaitAsync:io_uring_result",
+                           &bytes_read);
+  if (bytes_read < req->len &&
+      (!use_direct_io() ||
+       IsSectorAligned(bytes_read, GetRequiredBufferAlignment()))) {
+    // Short read, which is not the end of a direct IO file. Finish it with
+    // pread() like MultiRead() does; Read() stops at the end of the file.
+    Slice tmp;
+    req->status = Read(req->offset + bytes_read, req->len - bytes_read,
+                       read->opts, &tmp, req->scratch + bytes_read, nullptr);
+    req->result = Slice(req->scratch, bytes_read + tmp.size());
+  } else {
+    req->result = Slice(req->scratch, std::min(bytes_read, req->len));
+    req->status = IOStatus::OK();
+  }
+  return IOStatus::OK();
+}
+#endif  // defined(CABINDB_IOURING_PRESENT)
+
 IOStatus PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n,
                                          const IOOptions& /*opts*/,
                                          IODebugContext* /*dbg*/) {
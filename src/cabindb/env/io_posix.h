@@ -16,6 +16,7 @@
 #include <atomic>
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include "port/port.h"
 #include "include/cabindb/env.h"
@@ -155,6 +156,7 @@ const unsigned int kIoUringDepth = 256;
 
 inline void DeleteIOUring(void* p) {
   struct io_uring* iu = static_cast<struct io_uring*>(p);
+  io_uring_queue_exit(iu);
   delete iu;
 }
 
@@ -167,6 +169,38 @@ inline struct io_uring* CreateIOUring() {
   }
   return new_io_uring;
 }
+
+// The io_uring that the reads started by PosixRandomAccessFile::ReadAsync()
+// on one thread are submitted to. A read may be waited for from another
+// thread, so the ring is locked, and the reads still in flight on it keep it
+// alive after its thread exits.
+struct AsyncIOUring {
+  port::Mutex mu;
+  struct io_uring ring;
+  bool initialized;
+  // reads submitted and not reaped yet
+  unsigned int inflight = 0;
+
+  AsyncIOUring()
+      : initialized(io_uring_queue_init(kIoUringDepth, &ring, 0) == 0) {}
+  ~AsyncIOUring() {
+    if (initialized) {
+      io_uring_queue_exit(&ring);
+    }
+  }
+};
+
+inline void DeleteAsyncIOUring(void* p) {
+  delete static_cast<std::shared_ptr<AsyncIOUring>*>(p);
+}
+
+inline std::shared_ptr<AsyncIOUring>* CreateAsyncIOUring() {
+  auto iu = std::make_shared<AsyncIOUring>();
+  if (!iu->initialized) {
+    return nullptr;
+  }
+  return new std::shared_ptr<AsyncIOUring>(std::move(iu));
+}
 #endif  // defined(CABINDB_IOURING_PRESENT)
 
 class PosixRandomAccessFile : public FSRandomAccessFile {
@@ -177,6 +211,7 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   size_t logical_sector_size_;
 #if defined(CABINDB_IOURING_PRESENT)
   ThreadLocalPtr* thread_local_io_urings_;
+  ThreadLocalPtr* thread_local_async_io_urings_;
 #endif
 
  public:
@@ -185,7 +220,8 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
                         const EnvOptions& options
 #if defined(CABINDB_IOURING_PRESENT)
                         ,
-                        ThreadLocalPtr* thread_local_io_urings
+                        ThreadLocalPtr* thread_local_io_urings,
+                        ThreadLocalPtr* thread_local_async_io_urings
 #endif
   );
   virtual ~PosixRandomAccessFile();
@@ -201,6 +237,13 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   virtual IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& opts,
                             IODebugContext* dbg) override;
 
+#if defined(CABINDB_IOURING_PRESENT)
+  virtual IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                             void** io_handle, IODebugContext* dbg) override;
+
+  virtual IOStatus WaitAsync(void* io_handle) override;
+#endif
+
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
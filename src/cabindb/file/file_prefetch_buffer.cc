@@ -21,6 +21,13 @@
 #include "util/rate_limiter.h"
 
 namespace CABINDB_NAMESPACE {
+FilePrefetchBuffer::~FilePrefetchBuffer() {
+  if (async_handle_ != nullptr) {
+    // async_buffer_ must outlive the read
+    file_reader_->WaitAsync(&async_req_, async_handle_).PermitUncheckedError();
+  }
+}
+
 Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
                                     RandomAccessFileReader* reader,
                                     uint64_t offset, size_t n,
@@ -107,6 +114,85 @@ Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
   return s;
 }
 
+void FilePrefetchBuffer::PrefetchAsync(const IOOptions& opts,
+                                       bool for_compaction) {
+  if (!async_io_ || async_handle_ != nullptr || buffer_.CurrentSize() == 0) {
+    return;
+  }
+  size_t alignment = file_reader_->file()->GetRequiredBufferAlignment();
+  uint64_t offset = buffer_offset_ + buffer_.CurrentSize();
+  if (offset % alignment != 0) {
+    // buffer_ ends with a short read, i.e. at the end of the file.
+    return;
+  }
+
+  size_t len = Roundup(readahead_size_, alignment);
+  if (async_buffer_.Capacity() < len) {
+    async_buffer_.Alignment(alignment);
+    async_buffer_.AllocateNewBuffer(len);
+  }
+  async_req_.offset = offset;
+  async_req_.len = len;
+  async_req_.scratch = async_buffer_.BufferStart();
+  async_req_.result = Slice();
+  async_req_.status = IOStatus::OK();
+  Status s = file_reader_->ReadAsync(opts, &async_req_, &async_handle_,
+                                     for_compaction);
+  if (s.IsNotSupported()) {
+    async_io_ = false;
+  }
+  // On any other error the data is read synchronously when it is needed.
+  s.PermitUncheckedError();
+}
+
+bool FilePrefetchBuffer::TryReadFromAsync(uint64_t offset, size_t n) {
+  if (async_handle_ == nullptr) {
+    return false;
+  }
+  Status s = file_reader_->WaitAsync(&async_req_, async_handle_);
+  async_handle_ = nullptr;
+  if (!s.ok() || !async_req_.status.ok()) {
+    s.PermitUncheckedError();
+    async_req_.status.PermitUncheckedError();
+    return false;
+  }
+
+  uint64_t async_offset = async_req_.offset;
+  size_t async_size = async_req_.result.size();
+  if (offset + n > async_offset + async_size) {
+    return false;
+  }
+  if (offset >= async_offset) {
+    std::swap(buffer_, async_buffer_);
+    buffer_offset_ = async_offset;
+    buffer_.Size(async_size);
+    return true;
+  }
+
+  // The requested bytes start in buffer_ and end in the async read: keep the
+  // tail of buffer_ and append the async data to it.
+  if (offset < buffer_offset_ ||
+      buffer_offset_ + buffer_.CurrentSize() != async_offset) {
+    return false;
+  }
+  size_t alignment = file_reader_->file()->GetRequiredBufferAlignment();
+  size_t chunk_offset_in_buffer =
+      Rounddown(static_cast<size_t>(offset - buffer_offset_), alignment);
+  size_t chunk_len = buffer_.CurrentSize() - chunk_offset_in_buffer;
+  if (buffer_.Capacity() < chunk_len + async_size) {
+    buffer_.Alignment(alignment);
+    buffer_.AllocateNewBuffer(chunk_len + async_size, true /* copy_data */,
+                              chunk_offset_in_buffer, chunk_len);
+  } else {
+    buffer_.RefitTail(chunk_offset_in_buffer, chunk_len);
+  }
+  memcpy(buffer_.BufferStart() + chunk_len, async_buffer_.BufferStart(),
+         async_size);
+  buffer_offset_ += chunk_offset_in_buffer;
+  buffer_.Size(chunk_len + async_size);
+  return true;
+}
+
 bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
                                           uint64_t offset, size_t n,
                                           Slice* result, bool for_compaction) {
@@ -125,19 +211,21 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
     if (readahead_size_ > 0) {
       assert(file_reader_ != nullptr);
       assert(max_readahead_size_ >= readahead_size_);
-      Status s;
-      if (for_compaction) {
-        s = Prefetch(opts, file_reader_, offset, std::max(n, readahead_size_),
-                     for_compaction);
-      } else {
-        s = Prefetch(opts, file_reader_, offset, n + readahead_size_,
-                     for_compaction);
-      }
-      if (!s.ok()) {
+      if (!TryReadFromAsync(offset, n)) {
+        Status s;
+        if (for_compaction) {
+          s = Prefetch(opts, file_reader_, offset,
+                       std::max(n, readahead_size_), for_compaction);
+        } else {
+          s = Prefetch(opts, file_reader_, offset, n + readahead_size_,
+                       for_compaction);
+        }
+        if (!s.ok()) {
 #ifndef NDEBUG
-        IGNORE_STATUS_IF_ERROR(s);
+          IGNORE_STATUS_IF_ERROR(s);
 #endif
-        return false;
+          return false;
+        }
       }
       readahead_size_ = std::min(max_readahead_size_, readahead_size_ * 2);
     } else {
@@ -147,6 +235,9 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
 
   uint64_t offset_in_buffer = offset - buffer_offset_;
   *result = Slice(buffer_.BufferStart() + offset_in_buffer, n);
+  if (readahead_size_ > 0) {
+    PrefetchAsync(opts, for_compaction);
+  }
   return true;
 }
 }  // namespace CABINDB_NAMESPACE
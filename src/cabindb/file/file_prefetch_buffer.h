@@ -38,6 +38,9 @@ class FilePrefetchBuffer {
   //   for the minimum offset if track_min_offset = true.
   // track_min_offset : Track the minimum offset ever read and collect stats on
   //   it. Used for adaptable readahead of the file footer/metadata.
+  // async_io : with readahead, keep reading the next readahead_size bytes
+  //   asynchronously while the buffer is being consumed, if the file supports
+  //   RandomAccessFileReader::ReadAsync().
   //
   // Automatic readhead is enabled for a file if file_reader, readahead_size,
   // and max_readahead_size are passed in.
@@ -47,14 +50,18 @@ class FilePrefetchBuffer {
   // `Prefetch` to load data into the buffer.
   FilePrefetchBuffer(RandomAccessFileReader* file_reader = nullptr,
                      size_t readadhead_size = 0, size_t max_readahead_size = 0,
-                     bool enable = true, bool track_min_offset = false)
+                     bool enable = true, bool track_min_offset = false,
+                     bool async_io = false)
       : buffer_offset_(0),
         file_reader_(file_reader),
         readahead_size_(readadhead_size),
         max_readahead_size_(max_readahead_size),
         min_offset_read_(port::kMaxSizet),
         enable_(enable),
-        track_min_offset_(track_min_offset) {}
+        track_min_offset_(track_min_offset),
+        async_io_(async_io && file_reader != nullptr) {}
+
+  ~FilePrefetchBuffer();
 
   // Load data into the buffer from a file.
   // reader : the file reader.
@@ -82,6 +89,14 @@ class FilePrefetchBuffer {
   size_t min_offset_read() const { return min_offset_read_; }
 
  private:
+  // Starts reading the readahead_size_ bytes that follow buffer_ into
+  // async_buffer_, unless such a read is already in flight.
+  void PrefetchAsync(const IOOptions& opts, bool for_compaction);
+
+  // Waits for the read started by PrefetchAsync() and moves its data into
+  // buffer_ if that makes buffer_ hold [offset, offset + n).
+  bool TryReadFromAsync(uint64_t offset, size_t n);
+
   AlignedBuffer buffer_;
   uint64_t buffer_offset_;
   RandomAccessFileReader* file_reader_;
@@ -95,5 +110,11 @@ class FilePrefetchBuffer {
   // If true, track minimum `offset` ever passed to TryReadFromCache(), which
   // can be fetched from min_offset_read().
   bool track_min_offset_;
+  // Cleared once the file turns out not to support asynchronous reads.
+  bool async_io_;
+  // The read ahead of buffer_ in flight, if async_handle_ is set.
+  AlignedBuffer async_buffer_;
+  FSReadRequest async_req_;
+  void* async_handle_ = nullptr;
 };
 }  // namespace CABINDB_NAMESPACE
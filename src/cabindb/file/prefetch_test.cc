@@ -13,11 +13,14 @@ class MockFS;
 class MockRandomAccessFile : public FSRandomAccessFileWrapper {
  public:
   MockRandomAccessFile(std::unique_ptr<FSRandomAccessFile>& file,
-                       bool support_prefetch, std::atomic_int& prefetch_count)
+                       bool support_prefetch, std::atomic_int& prefetch_count,
+                       bool support_async_io, std::atomic_int& async_count)
       : FSRandomAccessFileWrapper(file.get()),
         file_(std::move(file)),
         support_prefetch_(support_prefetch),
-        prefetch_count_(prefetch_count) {}
+        prefetch_count_(prefetch_count),
+        support_async_io_(support_async_io),
+        async_count_(async_count) {}
 
   IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& options,
                     IODebugContext* dbg) override {
@@ -29,17 +32,42 @@ class MockRandomAccessFile : public FSRandomAccessFileWrapper {
     }
   }
 
+  // The data is only read by WaitAsync(), so a caller that touches the
+  // buffer before waiting sees stale bytes.
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& options,
+                     void** io_handle, IODebugContext* /*dbg*/) override {
+    if (!support_async_io_) {
+      return IOStatus::NotSupported("ReadAsync not supported");
+    }
+    async_count_.fetch_add(1);
+    *io_handle = new std::pair<FSReadRequest*, IOOptions>(&req, options);
+    return IOStatus::OK();
+  }
+
+  IOStatus WaitAsync(void* io_handle) override {
+    std::unique_ptr<std::pair<FSReadRequest*, IOOptions>> read(
+        static_cast<std::pair<FSReadRequest*, IOOptions>*>(io_handle));
+    FSReadRequest* req = read->first;
+    req->status = target()->Read(req->offset, req->len, read->second,
+                                 &req->result, req->scratch, nullptr);
+    return IOStatus::OK();
+  }
+
  private:
   std::unique_ptr<FSRandomAccessFile> file_;
   const bool support_prefetch_;
   std::atomic_int& prefetch_count_;
+  const bool support_async_io_;
+  std::atomic_int& async_count_;
 };
 
 class MockFS : public FileSystemWrapper {
  public:
   explicit MockFS(const std::shared_ptr<FileSystem>& wrapped,
-                  bool support_prefetch)
-      : FileSystemWrapper(wrapped), support_prefetch_(support_prefetch) {}
+                  bool support_prefetch, bool support_async_io = false)
+      : FileSystemWrapper(wrapped),
+        support_prefetch_(support_prefetch),
+        support_async_io_(support_async_io) {}
 
   IOStatus NewRandomAccessFile(const std::string& fname,
                                const FileOptions& opts,
@@ -48,8 +76,9 @@ class MockFS : public FileSystemWrapper {
     std::unique_ptr<FSRandomAccessFile> file;
     IOStatus s;
     s = target()->NewRandomAccessFile(fname, opts, &file, dbg);
-    result->reset(
-        new MockRandomAccessFile(file, support_prefetch_, prefetch_count_));
+    result->reset(new MockRandomAccessFile(file, support_prefetch_,
+                                           prefetch_count_, support_async_io_,
+                                           async_count_));
     return s;
   }
 
@@ -57,9 +86,13 @@ class MockFS : public FileSystemWrapper {
 
   bool IsPrefetchCalled() { return prefetch_count_ > 0; }
 
+  int async_count() const { return async_count_; }
+
  private:
   const bool support_prefetch_;
   std::atomic_int prefetch_count_{0};
+  const bool support_async_io_;
+  std::atomic_int async_count_{0};
 };
 
 class PrefetchTest
@@ -173,6 +206,74 @@ TEST_P(PrefetchTest, Basic) {
   Close();
 }
 
+TEST_P(PrefetchTest, AsyncReadahead) {
+  // First param is if the mockFS supports asynchronous reads or not
+  bool support_async_io = std::get<0>(GetParam());
+
+  // Second param is if directIO is enabled or not
+  bool use_direct_io = std::get<1>(GetParam());
+  const int kNumKeys = 2000;
+  std::shared_ptr<MockFS> fs = std::make_shared<MockFS>(
+      env_->GetFileSystem(), false /* support_prefetch */, support_async_io);
+  std::unique_ptr<Env> env(new CompositeEnvWrapper(env_, fs));
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.env = env.get();
+  options.statistics = CreateDBStatistics();
+  if (use_direct_io) {
+    options.use_direct_reads = true;
+    options.use_direct_io_for_flush_and_compaction = true;
+  }
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  Status s = TryReopen(options);
+  if (use_direct_io && (s.IsNotSupported() || s.IsInvalidArgument())) {
+    // If direct IO is not supported, skip the test
+    return;
+  } else {
+    ASSERT_OK(s);
+  }
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(BuildKey(i), "value " + std::to_string(i)));
+  }
+  ASSERT_OK(Flush());
+
+  ReadOptions ro;
+  ro.async_io = true;
+  ro.readahead_size = 16 * 1024;
+  {
+    auto iter = std::unique_ptr<Iterator>(db_->NewIterator(ro));
+    int num_keys = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(iter->value().ToString(),
+                "value " + iter->key().ToString().substr(7));
+      num_keys++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumKeys, num_keys);
+  }
+
+  HistogramData queue_depth;
+  options.statistics->histogramData(READ_QUEUE_DEPTH, &queue_depth);
+  if (support_async_io) {
+    ASSERT_GT(fs->async_count(), 0);
+    ASSERT_GT(options.statistics->getTickerCount(ASYNC_READ_BYTES), 0);
+    ASSERT_GT(queue_depth.count, 0);
+  } else {
+    // The first ReadAsync() returns NotSupported and the prefetch buffer
+    // falls back to synchronous reads.
+    ASSERT_EQ(0, fs->async_count());
+    ASSERT_EQ(0, options.statistics->getTickerCount(ASYNC_READ_BYTES));
+    ASSERT_EQ(0, queue_depth.count);
+  }
+  Close();
+}
+
 INSTANTIATE_TEST_CASE_P(PrefetchTest, PrefetchTest,
                         ::testing::Combine(::testing::Bool(),
                                            ::testing::Bool()));
@@ -14,6 +14,7 @@
 
 #include "monitoring/histogram.h"
 #include "monitoring/iostats_context_imp.h"
+#include "monitoring/statistics.h"
 #include "port/port.h"
 #include "table/format.h"
 #include "test_util/sync_point.h"
@@ -258,6 +259,7 @@ Status RandomAccessFileReader::MultiRead(const IOOptions& opts,
     }
 #endif  // CABINDB_LITE
 
+    RecordInHistogram(stats_, READ_QUEUE_DEPTH, num_fs_reqs);
     {
       IOSTATS_CPU_TIMER_GUARD(cpu_read_nanos, env_);
       s = file_->MultiRead(fs_reqs, num_fs_reqs, opts, nullptr);
@@ -304,4 +306,67 @@ Status RandomAccessFileReader::MultiRead(const IOOptions& opts,
   return s;
 }
 
+Status RandomAccessFileReader::ReadAsync(const IOOptions& opts,
+                                         FSReadRequest* req, void** io_handle,
+                                         bool for_compaction) const {
+  size_t alignment = file_->GetRequiredBufferAlignment();
+  if (use_direct_io()) {
+    assert(req->offset % alignment == 0);
+    assert(req->len % alignment == 0);
+    assert(reinterpret_cast<uintptr_t>(req->scratch) % alignment == 0);
+  }
+
+  std::unique_ptr<AsyncRead> read(new AsyncRead);
+#ifndef CABINDB_LITE
+  if (ShouldNotifyListeners()) {
+    read->start_ts = FileOperationInfo::StartNow();
+  }
+#endif  // CABINDB_LITE
+  IOStatus s = file_->ReadAsync(*req, opts, &read->io_handle, nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  size_t depth =
+      async_reads_in_flight_.fetch_add(1, std::memory_order_relaxed) + 1;
+  RecordInHistogram(stats_, READ_QUEUE_DEPTH, depth);
+
+  if (for_compaction && rate_limiter_ != nullptr) {
+    size_t charged = 0;
+    while (charged < req->len) {
+      charged += rate_limiter_->RequestToken(
+          req->len - charged, use_direct_io() ? alignment : 0,
+          Env::IOPriority::IO_LOW, stats_, RateLimiter::OpType::kRead);
+    }
+  }
+  *io_handle = read.release();
+  return Status::OK();
+}
+
+Status RandomAccessFileReader::WaitAsync(FSReadRequest* req,
+                                         void* io_handle) const {
+  std::unique_ptr<AsyncRead> read(static_cast<AsyncRead*>(io_handle));
+  IOStatus s;
+  {
+    IOSTATS_TIMER_GUARD(read_nanos);
+    s = file_->WaitAsync(read->io_handle);
+  }
+  async_reads_in_flight_.fetch_sub(1, std::memory_order_relaxed);
+  if (!s.ok()) {
+    req->result = Slice();
+    req->status = s;
+    return s;
+  }
+
+#ifndef CABINDB_LITE
+  if (ShouldNotifyListeners()) {
+    auto finish_ts = FileOperationInfo::FinishNow();
+    NotifyOnFileReadFinish(req->offset, req->result.size(), read->start_ts,
+                           finish_ts, req->status);
+  }
+#endif  // CABINDB_LITE
+  IOSTATS_ADD_IF_POSITIVE(bytes_read, req->result.size());
+  RecordTick(stats_, ASYNC_READ_BYTES, req->result.size());
+  return Status::OK();
+}
+
 }  // namespace CABINDB_NAMESPACE
@@ -65,6 +65,14 @@ class RandomAccessFileReader {
 
   bool ShouldNotifyListeners() const { return !listeners_.empty(); }
 
+  // A read started by ReadAsync().
+  struct AsyncRead {
+    void* io_handle = nullptr;
+#ifndef CABINDB_LITE
+    FileOperationInfo::StartTimePoint start_ts;
+#endif  // CABINDB_LITE
+  };
+
   FSRandomAccessFilePtr file_;
   std::string file_name_;
   Env* env_;
@@ -73,6 +81,8 @@ class RandomAccessFileReader {
   HistogramImpl* file_read_hist_;
   RateLimiter* rate_limiter_;
   std::vector<std::shared_ptr<EventListener>> listeners_;
+  // Reads started by ReadAsync() and not waited for yet.
+  mutable std::atomic<size_t> async_reads_in_flight_{0};
 
  public:
   explicit RandomAccessFileReader(
@@ -127,6 +137,19 @@ class RandomAccessFileReader {
   Status MultiRead(const IOOptions& opts, FSReadRequest* reqs, size_t num_reqs,
                    AlignedBuf* aligned_buf) const;
 
+  // Starts reading req->len bytes at req->offset into req->scratch and
+  // returns without waiting. On success *io_handle must be passed to
+  // WaitAsync() once, and req and req->scratch must stay valid until then.
+  // Returns NotSupported if the file system can only read synchronously.
+  // In direct IO mode offset, len and scratch must be aligned. Compaction
+  // reads are charged to the rate limiter once they are issued.
+  Status ReadAsync(const IOOptions& opts, FSReadRequest* req, void** io_handle,
+                   bool for_compaction = false) const;
+
+  // Waits for a read started by ReadAsync(). The data and the status of the
+  // read are in req->result and req->status.
+  Status WaitAsync(FSReadRequest* req, void* io_handle) const;
+
   Status Prefetch(uint64_t offset, size_t n) const {
     return file_->Prefetch(offset, n, IOOptions(), nullptr);
   }
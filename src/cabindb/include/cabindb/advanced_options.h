@@ -675,6 +675,35 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   bool report_bg_io_stats = false;
 
+  // If true, every automatic compaction of this column family is run in the
+  // BOTTOM priority thread pool, not only those writing to the last level,
+  // so that it does not hold up compactions of other column families. Has no
+  // effect unless the BOTTOM pool has threads.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool bottom_pri_compaction = false;
+
+  // If true, this column family is queued for compaction ahead of column
+  // families without the flag, so it is picked first when a background
+  // compaction slot frees up. Its output is still written at Env::IO_LOW;
+  // flushes keep precedence in DBOptions::rate_limiter.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool high_pri_compaction = false;
+
+  // Maximum number of threads a compaction of this column family is split
+  // into, overriding DBOptions::max_subcompactions. 0 uses the DB option.
+  // A compaction is split on the key ranges of its input files.
+  //
+  // Default: 0
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t max_cf_subcompactions = 0;
+
   // Files older than TTL will go through the compaction process.
   // Pre-req: This needs max_open_files to be set to -1.
   // In Level: Non-bottom-level files older than TTL will go through the
@@ -221,6 +221,19 @@ class DB {
       const std::vector<ColumnFamilyDescriptor>& column_families,
       std::vector<ColumnFamilyHandle*>* handles, DB** dbptr);
 
+  // EXPERIMENTAL: Runs a compaction sent by DBOptions::compaction_service of
+  // the primary db `name`, without installing it. The input argument is the
+  // job passed to CompactionService::Run and the result for the primary is
+  // written to output. The db is opened as a secondary instance that keeps
+  // its info log in secondary_path, so the worker must see the same files
+  // as the primary. column_families must hold the options of the column
+  // family being compacted; the others are not opened.
+  static Status OpenAndCompact(
+      const DBOptions& db_options, const std::string& name,
+      const std::string& secondary_path,
+      const std::vector<ColumnFamilyDescriptor>& column_families,
+      const std::string& input, std::string* output);
+
   // Open DB with column families.
   // db_options specify database specific options
   // column_families is the vector of all column families in the database,
@@ -881,6 +894,19 @@ class DB {
     //      files belong to the latest LSM tree.
     static const std::string kLiveSstFilesSize;
 
+    //  "cabindb.num-blob-files" - returns number of blob files in the current
+    //      version.
+    static const std::string kNumBlobFiles;
+
+    //  "cabindb.total-blob-file-size" - returns total size (bytes) of the blob
+    //      files in the current version.
+    static const std::string kTotalBlobFileSize;
+
+    //  "cabindb.blob-garbage-size" - returns the part (bytes) of
+    //      total-blob-file-size taken by blobs that garbage collection has
+    //      relocated to newer blob files.
+    static const std::string kBlobGarbageSize;
+
     //  "cabindb.base-level" - returns number of level to which L0 data will be
     //      compacted.
     static const std::string kBaseLevel;
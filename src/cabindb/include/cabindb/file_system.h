@@ -659,6 +659,23 @@ class FSRandomAccessFile {
     return IOStatus::OK();
   }
 
+  // Start reading req.len bytes at req.offset into req.scratch and return
+  // without waiting for the data. On success *io_handle must be passed to
+  // WaitAsync() exactly once, and req and req.scratch must stay valid until
+  // then. If it's not implemented (default: `NotSupported`), callers read
+  // synchronously instead. The same alignment rules as Read() apply.
+  virtual IOStatus ReadAsync(FSReadRequest& /*req*/,
+                             const IOOptions& /*options*/, void** /*io_handle*/,
+                             IODebugContext* /*dbg*/) {
+    return IOStatus::NotSupported("ReadAsync");
+  }
+
+  // Wait for the read started by ReadAsync() and set the result and status
+  // of its request. The handle is released on return.
+  virtual IOStatus WaitAsync(void* /*io_handle*/) {
+    return IOStatus::NotSupported("WaitAsync");
+  }
+
   // Tries to get an unique ID for this file that will be the same each time
   // the file is opened (and will stay the same while the file is open).
   // Furthermore, it tries to make this ID at most "max_size" bytes. If such an
@@ -1289,6 +1306,13 @@ class FSRandomAccessFileWrapper : public FSRandomAccessFile {
                     IODebugContext* dbg) override {
     return target_->Prefetch(offset, n, options, dbg);
   }
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& options,
+                     void** io_handle, IODebugContext* dbg) override {
+    return target_->ReadAsync(req, options, io_handle, dbg);
+  }
+  IOStatus WaitAsync(void* io_handle) override {
+    return target_->WaitAsync(io_handle);
+  }
   size_t GetUniqueId(char* id, size_t max_size) const override {
     return target_->GetUniqueId(id, max_size);
   };
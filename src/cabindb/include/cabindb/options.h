@@ -355,6 +355,27 @@ struct DbPath {
 
 extern const char* kHostnameForDbHostId;
 
+// CompactionService runs the compactions of a DB outside of the DB instance,
+// typically in a separate worker process that opens the same DB with
+// DB::OpenAndCompact(). The DB still picks and splits compactions and
+// installs their results; each subcompaction becomes one job, described by
+// an opaque string. The worker writes its table files into a directory named
+// by the job, so it must share the DB's file system.
+// EXPERIMENTAL
+class CompactionService {
+ public:
+  virtual ~CompactionService() {}
+
+  // Returns the name of this compaction service.
+  virtual const char* Name() const = 0;
+
+  // Runs the compaction job `input` and stores the result, as returned by
+  // DB::OpenAndCompact(), in `output`. Blocks until the job finishes; called
+  // from the compaction threads of the DB. A non-OK status fails the
+  // compaction.
+  virtual Status Run(const std::string& input, std::string* output) = 0;
+};
+
 struct DBOptions {
   // The function recovers options to the option as in version 4.6.
   DBOptions* OldDefaults(int cabindb_major_version = 4,
@@ -1200,6 +1221,13 @@ struct DBOptions {
   //
   // Default: hostname
   std::string db_host_id = kHostnameForDbHostId;
+
+  // If set, the input of every compaction (other than a trivial move or a
+  // deletion compaction) is read and its output written by this service
+  // instead of the compaction threads of the DB. See CompactionService.
+  //
+  // Default: nullptr
+  std::shared_ptr<CompactionService> compaction_service = nullptr;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1430,6 +1458,16 @@ struct ReadOptions {
   // Default: std::numeric_limits<uint64_t>::max()
   uint64_t value_size_soft_limit;
 
+  // If true, iterators that read ahead keep the next readahead window in
+  // flight with asynchronous reads while the current one is consumed, and
+  // implicit auto readahead uses an internal prefetch buffer instead of
+  // FSRandomAccessFile::Prefetch(). Only file systems that implement
+  // FSRandomAccessFile::ReadAsync() (the posix one with io_uring) read
+  // asynchronously; on others this option only changes the buffering.
+  // Compaction always reads ahead asynchronously when it can.
+  // Default: false
+  bool async_io;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -70,4 +70,28 @@ Status NewPersistentCache(Env* const env, const std::string& path,
                           const std::shared_ptr<Logger>& log,
                           const bool optimized_for_nvm,
                           std::shared_ptr<PersistentCache>* cache);
+
+// Settings of a persistent cache beyond its location and size
+struct PersistentCacheTierOptions {
+  // The cache is made of files of this size and evicts a whole file at a time
+  uint32_t file_size = 100 * 1024 * 1024;
+
+  // Use direct writes and more parallel IO, which suits NVM devices
+  bool optimized_for_nvm = false;
+
+  // Insert from a background thread, so that a read that fills the cache does
+  // not wait for the cache device. Inserts are dropped when the backlog is
+  // full.
+  bool pipeline_writes = true;
+
+  // If not empty, the blocks left in path by an earlier cache with the same
+  // identity are kept on open. Table files must have stable unique ids.
+  std::string identity;
+};
+
+Status NewPersistentCache(Env* const env, const std::string& path,
+                          const uint64_t size,
+                          const std::shared_ptr<Logger>& log,
+                          const PersistentCacheTierOptions& options,
+                          std::shared_ptr<PersistentCache>* cache);
 }  // namespace CABINDB_NAMESPACE
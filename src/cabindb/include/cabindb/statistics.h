@@ -374,6 +374,9 @@ enum Tickers : uint32_t {
   // # of files deleted immediately by sst file manger through delete scheduler.
   FILES_DELETED_IMMEDIATELY,
 
+  // # of bytes prefetched by table readers with asynchronous reads.
+  ASYNC_READ_BYTES,
+
   TICKER_ENUM_MAX
 };
 
@@ -472,6 +475,14 @@ enum Histograms : uint32_t {
   // Num of sst files read from file system per level.
   NUM_SST_READ_PER_LEVEL,
 
+  // Number of reads of a table file in flight when a read is issued: the
+  // batch size of MultiRead, or the asynchronous reads outstanding.
+  READ_QUEUE_DEPTH,
+
+  // Time spent by each subcompaction of a compaction; a compaction that is
+  // not split is a single subcompaction.
+  SUBCOMPACTION_TIME,
+
   HISTOGRAM_ENUM_MAX,
 };
 
@@ -204,6 +204,16 @@ struct BlockBasedTableOptions {
     // Makes the index significantly bigger (2x or more), especially when keys
     // are long.
     kBinarySearchWithFirstKey = 0x03,
+
+    // Like kBinarySearch, plus a piecewise linear model of the restart keys
+    // of the index block that narrows each index lookup to a small window of
+    // restart points. Since the model finds the restart interval, a larger
+    // index_block_restart_interval (e.g. 16) keeps the index block small
+    // without a long binary search. Works best for fixed width or numeric
+    // keys that are dense in their key space. Requires the bytewise
+    // comparator; otherwise, or when the model cannot be read, the index is
+    // searched like kBinarySearch.
+    kLearnedIndexSearch = 0x04,
   };
 
   IndexType index_type = kBinarySearch;
@@ -142,7 +142,9 @@ class EnvLibrados : public EnvWrapper {
       const std::string& cluster_name, const uint64_t flags,
       const std::string& db_name, const std::string& config_path,
       const std::string& db_pool, const std::string& wal_dir,
-      const std::string& wal_pool, const uint64_t write_buffer_size);
+      const std::string& wal_pool, const uint64_t write_buffer_size,
+      const uint64_t stripe_size = 4 << 20,
+      const uint64_t readahead_size = 2 << 20);
   ~EnvLibrados() { _rados.shutdown(); }
 
  private:
@@ -159,6 +161,8 @@ class EnvLibrados : public EnvWrapper {
   std::string _wal_pool_name;
   librados::IoCtx _wal_pool_ioctx;  // IoCtx for connecting wal_pool
   uint64_t _write_buffer_size;      // WritableFile buffer max size
+  uint64_t _stripe_size;            // file bytes per RADOS object
+  uint64_t _readahead_size;         // SequentialFile readahead window
 
   /* private function to communicate with rados */
   std::string _CreateFid();
@@ -4982,6 +4982,8 @@ class TickerTypeJni {
         return -0x14;
       case CABINDB_NAMESPACE::Tickers::COMPACT_WRITE_BYTES_TTL:
         return -0x15;
+      case CABINDB_NAMESPACE::Tickers::ASYNC_READ_BYTES:
+        return -0x16;
 
       case CABINDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
         // 0x5F for backwards compatibility on current minor version.
@@ -5294,6 +5296,8 @@ class TickerTypeJni {
         return CABINDB_NAMESPACE::Tickers::COMPACT_WRITE_BYTES_PERIODIC;
       case -0x15:
         return CABINDB_NAMESPACE::Tickers::COMPACT_WRITE_BYTES_TTL;
+      case -0x16:
+        return CABINDB_NAMESPACE::Tickers::ASYNC_READ_BYTES;
       case 0x5F:
         // 0x5F for backwards compatibility on current minor version.
         return CABINDB_NAMESPACE::Tickers::TICKER_ENUM_MAX;
@@ -5413,6 +5417,10 @@ class HistogramTypeJni {
         return 0x30;
       case CABINDB_NAMESPACE::Histograms::NUM_SST_READ_PER_LEVEL:
         return 0x31;
+      case CABINDB_NAMESPACE::Histograms::READ_QUEUE_DEPTH:
+        return 0x32;
+      case CABINDB_NAMESPACE::Histograms::SUBCOMPACTION_TIME:
+        return 0x33;
       case CABINDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX:
         // 0x1F for backwards compatibility on current minor version.
         return 0x1F;
@@ -5527,6 +5535,10 @@ class HistogramTypeJni {
         return CABINDB_NAMESPACE::Histograms::NUM_DATA_BLOCKS_READ_PER_LEVEL;
       case 0x31:
         return CABINDB_NAMESPACE::Histograms::NUM_SST_READ_PER_LEVEL;
+      case 0x32:
+        return CABINDB_NAMESPACE::Histograms::READ_QUEUE_DEPTH;
+      case 0x33:
+        return CABINDB_NAMESPACE::Histograms::SUBCOMPACTION_TIME;
       case 0x1F:
         // 0x1F for backwards compatibility on current minor version.
         return CABINDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX;
@@ -175,6 +175,16 @@ public enum HistogramType {
    */
   NUM_SST_READ_PER_LEVEL((byte) 0x31),
 
+  /**
+   * Number of reads of a table file in flight when a read is issued.
+   */
+  READ_QUEUE_DEPTH((byte) 0x32),
+
+  /**
+   * Time spent by each subcompaction of a compaction.
+   */
+  SUBCOMPACTION_TIME((byte) 0x33),
+
   // 0x1F for backwards compatibility on current minor version.
   HISTOGRAM_ENUM_MAX((byte) 0x1F);
 
@@ -742,6 +742,11 @@ public enum TickerType {
     COMPACT_WRITE_BYTES_PERIODIC((byte) -0x14),
     COMPACT_WRITE_BYTES_TTL((byte) -0x15),
 
+    /**
+     * # of bytes prefetched by table readers with asynchronous reads.
+     */
+    ASYNC_READ_BYTES((byte) -0x16),
+
     TICKER_ENUM_MAX((byte) 0x5F);
 
     private final byte value;
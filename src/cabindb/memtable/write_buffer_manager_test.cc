@@ -50,6 +50,35 @@ TEST_F(WriteBufferManagerTest, ShouldFlush) {
   ASSERT_FALSE(wbf->ShouldFlush());
 }
 
+TEST_F(WriteBufferManagerTest, SetBufferSize) {
+  // A write buffer manager of size 10MB
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(10 * 1024 * 1024));
+
+  wbf->ReserveMem(6 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  // Shrinking below the mutable usage triggers a flush right away
+  wbf->SetBufferSize(6 * 1024 * 1024);
+  ASSERT_EQ(6 * 1024 * 1024, wbf->buffer_size());
+  ASSERT_TRUE(wbf->enabled());
+  ASSERT_TRUE(wbf->ShouldFlush());
+
+  // 6MB total, 2MB mutable. Most of it is already being flushed.
+  wbf->ScheduleFreeMem(4 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  // Growing the limit again keeps accepting writes
+  wbf->FreeMem(4 * 1024 * 1024);
+  wbf->SetBufferSize(20 * 1024 * 1024);
+  wbf->ReserveMem(10 * 1024 * 1024);
+  // 12MB total, 12MB mutable.
+  ASSERT_FALSE(wbf->ShouldFlush());
+  wbf->ReserveMem(6 * 1024 * 1024);
+  // 18MB total, 18MB mutable, above 7/8 of the limit.
+  ASSERT_TRUE(wbf->ShouldFlush());
+}
+
 TEST_F(WriteBufferManagerTest, CacheCost) {
   LRUCacheOptions co;
   // 1GB cache
@@ -191,6 +191,7 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
      "cabindb.block.cache.compression.dict.add.redundant"},
     {FILES_MARKED_TRASH, "cabindb.files.marked.trash"},
     {FILES_DELETED_IMMEDIATELY, "cabindb.files.deleted.immediately"},
+    {ASYNC_READ_BYTES, "cabindb.async.read.bytes"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -246,6 +247,8 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
      "cabindb.num.index.and.filter.blocks.read.per.level"},
     {NUM_DATA_BLOCKS_READ_PER_LEVEL, "cabindb.num.data.blocks.read.per.level"},
     {NUM_SST_READ_PER_LEVEL, "cabindb.num.sst.read.per.level"},
+    {READ_QUEUE_DEPTH, "cabindb.read.queue.depth"},
+    {SUBCOMPACTION_TIME, "cabindb.subcompaction.times.micros"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
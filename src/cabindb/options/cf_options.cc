@@ -216,6 +216,18 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, report_bg_io_stats),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"bottom_pri_compaction",
+         {offsetof(struct MutableCFOptions, bottom_pri_compaction),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"high_pri_compaction",
+         {offsetof(struct MutableCFOptions, high_pri_compaction),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"max_cf_subcompactions",
+         {offsetof(struct MutableCFOptions, max_cf_subcompactions),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"disable_auto_compactions",
          {offsetof(struct MutableCFOptions, disable_auto_compactions),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -977,6 +989,12 @@ void MutableCFOptions::Dump(Logger* log) const {
                  paranoid_file_checks);
   CABIN_LOG_INFO(log, "                       report_bg_io_stats: %d",
                  report_bg_io_stats);
+  CABIN_LOG_INFO(log, "                    bottom_pri_compaction: %d",
+                 bottom_pri_compaction);
+  CABIN_LOG_INFO(log, "                      high_pri_compaction: %d",
+                 high_pri_compaction);
+  CABIN_LOG_INFO(log, "                    max_cf_subcompactions: %" PRIu32,
+                 max_cf_subcompactions);
   CABIN_LOG_INFO(log, "                              compression: %d",
                  static_cast<int>(compression));
 
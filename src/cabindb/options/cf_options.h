@@ -174,6 +174,9 @@ struct MutableCFOptions {
             options.check_flush_compaction_key_order),
         paranoid_file_checks(options.paranoid_file_checks),
         report_bg_io_stats(options.report_bg_io_stats),
+        bottom_pri_compaction(options.bottom_pri_compaction),
+        high_pri_compaction(options.high_pri_compaction),
+        max_cf_subcompactions(options.max_cf_subcompactions),
         compression(options.compression),
         bottommost_compression(options.bottommost_compression),
         compression_opts(options.compression_opts),
@@ -217,6 +220,9 @@ struct MutableCFOptions {
         check_flush_compaction_key_order(true),
         paranoid_file_checks(false),
         report_bg_io_stats(false),
+        bottom_pri_compaction(false),
+        high_pri_compaction(false),
+        max_cf_subcompactions(0),
         compression(Snappy_Supported() ? kSnappyCompression : kNoCompression),
         bottommost_compression(kDisableCompressionOption),
         sample_for_compression(0) {}
@@ -282,6 +288,9 @@ struct MutableCFOptions {
   bool check_flush_compaction_key_order;
   bool paranoid_file_checks;
   bool report_bg_io_stats;
+  bool bottom_pri_compaction;
+  bool high_pri_compaction;
+  uint32_t max_cf_subcompactions;
   CompressionType compression;
   CompressionType bottommost_compression;
   CompressionOptions compression_opts;
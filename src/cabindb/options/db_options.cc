@@ -580,7 +580,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       max_bgerror_resume_count(options.max_bgerror_resume_count),
       bgerror_resume_retry_interval(options.bgerror_resume_retry_interval),
       allow_data_in_errors(options.allow_data_in_errors),
-      db_host_id(options.db_host_id) {
+      db_host_id(options.db_host_id),
+      compaction_service(options.compaction_service) {
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
@@ -744,6 +745,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    allow_data_in_errors);
   CABIN_LOG_HEADER(log, "            Options.db_host_id: %s",
                    db_host_id.c_str());
+  CABIN_LOG_HEADER(log, "            Options.compaction_service: %s",
+                   compaction_service ? compaction_service->Name() : "None");
 }
 
 MutableDBOptions::MutableDBOptions()
@@ -93,6 +93,7 @@ struct ImmutableDBOptions {
   uint64_t bgerror_resume_retry_interval;
   bool allow_data_in_errors;
   std::string db_host_id;
+  std::shared_ptr<CompactionService> compaction_service;
 };
 
 struct MutableDBOptions {
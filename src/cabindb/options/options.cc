@@ -86,6 +86,9 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       paranoid_file_checks(options.paranoid_file_checks),
       force_consistency_checks(options.force_consistency_checks),
       report_bg_io_stats(options.report_bg_io_stats),
+      bottom_pri_compaction(options.bottom_pri_compaction),
+      high_pri_compaction(options.high_pri_compaction),
+      max_cf_subcompactions(options.max_cf_subcompactions),
       ttl(options.ttl),
       periodic_compaction_seconds(options.periodic_compaction_seconds),
       sample_for_compression(options.sample_for_compression),
@@ -371,6 +374,12 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      force_consistency_checks);
     CABIN_LOG_HEADER(log, "               Options.report_bg_io_stats: %d",
                      report_bg_io_stats);
+    CABIN_LOG_HEADER(log, "            Options.bottom_pri_compaction: %d",
+                     bottom_pri_compaction);
+    CABIN_LOG_HEADER(log, "              Options.high_pri_compaction: %d",
+                     high_pri_compaction);
+    CABIN_LOG_HEADER(log, "            Options.max_cf_subcompactions: %" PRIu32,
+                     max_cf_subcompactions);
     CABIN_LOG_HEADER(log, "                              Options.ttl: %" PRIu64,
                      ttl);
     CABIN_LOG_HEADER(log,
@@ -635,7 +644,8 @@ ReadOptions::ReadOptions()
       iter_start_ts(nullptr),
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
-      value_size_soft_limit(std::numeric_limits<uint64_t>::max()) {}
+      value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
+      async_io(false) {}
 
 ReadOptions::ReadOptions(bool cksum, bool cache)
     : snapshot(nullptr),
@@ -659,6 +669,7 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       iter_start_ts(nullptr),
       deadline(std::chrono::microseconds::zero()),
       io_timeout(std::chrono::microseconds::zero()),
-      value_size_soft_limit(std::numeric_limits<uint64_t>::max()) {}
+      value_size_soft_limit(std::numeric_limits<uint64_t>::max()),
+      async_io(false) {}
 
 }  // namespace CABINDB_NAMESPACE
@@ -168,6 +168,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.bgerror_resume_retry_interval;
   options.db_host_id = immutable_db_options.db_host_id;
   options.allow_data_in_errors = immutable_db_options.allow_data_in_errors;
+  options.compaction_service = immutable_db_options.compaction_service;
   return options;
 }
 
@@ -242,6 +243,9 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
       mutable_cf_options.check_flush_compaction_key_order;
   cf_opts.paranoid_file_checks = mutable_cf_options.paranoid_file_checks;
   cf_opts.report_bg_io_stats = mutable_cf_options.report_bg_io_stats;
+  cf_opts.bottom_pri_compaction = mutable_cf_options.bottom_pri_compaction;
+  cf_opts.high_pri_compaction = mutable_cf_options.high_pri_compaction;
+  cf_opts.max_cf_subcompactions = mutable_cf_options.max_cf_subcompactions;
   cf_opts.compression = mutable_cf_options.compression;
   cf_opts.compression_opts = mutable_cf_options.compression_opts;
   cf_opts.bottommost_compression = mutable_cf_options.bottommost_compression;
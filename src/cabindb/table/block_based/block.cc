@@ -21,6 +21,7 @@
 #include "include/cabindb/comparator.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/learned_index.h"
 #include "table/format.h"
 #include "util/coding.h"
 
@@ -396,6 +397,8 @@ void IndexBlockIter::SeekImpl(const Slice& target) {
     // restart interval must be one when hash search is enabled so the binary
     // search simply lands at the right place.
     skip_linear_scan = true;
+  } else if (learned_index_) {
+    ok = LearnedSeek(target, seek_key, &index, &skip_linear_scan);
   } else if (value_delta_encoded_) {
     ok = BinarySeek<DecodeKeyV4>(seek_key, &index, &skip_linear_scan);
   } else {
@@ -408,6 +411,33 @@ void IndexBlockIter::SeekImpl(const Slice& target) {
   FindKeyAfterBinarySeek(seek_key, index, skip_linear_scan);
 }
 
+bool IndexBlockIter::LearnedSeek(const Slice& target, const Slice& seek_key,
+                                 uint32_t* index, bool* skip_linear_scan) {
+  int64_t left = -1, right = num_restarts_ - 1;
+  // The model describes the keys at the restart points; a block it was not
+  // built for is searched as a whole.
+  if (restarts_ != 0 && learned_index_->num_entries() == num_restarts_) {
+    uint32_t lo, hi;
+    learned_index_->Predict(ExtractUserKey(target), &lo, &hi);
+    // Keep each bound only if the keys around the window confirm it
+    if (lo > 0 && CompareBlockKey(lo, seek_key) <= 0) {
+      left = lo;
+    }
+    if (hi + 1 < num_restarts_ && CompareBlockKey(hi + 1, seek_key) > 0) {
+      right = hi;
+    }
+    if (!status_.ok()) {
+      return false;
+    }
+  }
+  if (value_delta_encoded_) {
+    return BinarySeekRange<DecodeKeyV4>(seek_key, left, right, index,
+                                        skip_linear_scan);
+  }
+  return BinarySeekRange<DecodeKey>(seek_key, left, right, index,
+                                    skip_linear_scan);
+}
+
 void DataBlockIter::SeekForPrevImpl(const Slice& target) {
   PERF_TIMER_GUARD(block_seek_nanos);
   Slice seek_key = target;
@@ -685,6 +715,15 @@ template <class TValue>
 template <typename DecodeKeyFunc>
 bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
                                    bool* skip_linear_scan) {
+  return BinarySeekRange<DecodeKeyFunc>(target, -1, num_restarts_ - 1, index,
+                                        skip_linear_scan);
+}
+
+template <class TValue>
+template <typename DecodeKeyFunc>
+bool BlockIter<TValue>::BinarySeekRange(const Slice& target, int64_t left,
+                                        int64_t right, uint32_t* index,
+                                        bool* skip_linear_scan) {
   if (restarts_ == 0) {
     // SST files dedicated to range tombstones are written with index blocks
     // that have no keys while also having `num_restarts_ == 1`. This would
@@ -702,7 +741,7 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   //   keys.
   // - Any restart keys after index `right` are strictly greater than the target
   //   key.
-  int64_t left = -1, right = num_restarts_ - 1;
+  assert(left >= -1 && left <= right && right < num_restarts_);
   while (left != right) {
     // The `mid` is computed by rounding up so it lands in (`left`, `right`].
     int64_t mid = left + (right - left + 1) / 2;
@@ -1006,7 +1045,8 @@ IndexBlockIter* Block::NewIndexIterator(
     const Comparator* raw_ucmp, SequenceNumber global_seqno,
     IndexBlockIter* iter, Statistics* /*stats*/, bool total_order_seek,
     bool have_first_key, bool key_includes_seq, bool value_is_full,
-    bool block_contents_pinned, BlockPrefixIndex* prefix_index) {
+    bool block_contents_pinned, BlockPrefixIndex* prefix_index,
+    const LearnedIndexModel* learned_index) {
   IndexBlockIter* ret_iter;
   if (iter != nullptr) {
     ret_iter = iter;
@@ -1027,7 +1067,7 @@ IndexBlockIter* Block::NewIndexIterator(
     ret_iter->Initialize(raw_ucmp, data_, restart_offset_, num_restarts_,
                          global_seqno, prefix_index_ptr, have_first_key,
                          key_includes_seq, value_is_full,
-                         block_contents_pinned);
+                         block_contents_pinned, learned_index);
   }
 
   return ret_iter;
@@ -36,6 +36,7 @@ class BlockIter;
 class DataBlockIter;
 class IndexBlockIter;
 class BlockPrefixIndex;
+class LearnedIndexModel;
 
 // BlockReadAmpBitmap is a bitmap that map the CABINDB_NAMESPACE::Block data
 // bytes to a bitmap with ratio bytes_per_bit. Whenever we access a range of
@@ -204,6 +205,9 @@ class Block {
   // If `prefix_index` is not nullptr this block will do hash lookup for the key
   // prefix. If total_order_seek is true, prefix_index_ is ignored.
   //
+  // If `learned_index` is not nullptr it is used to narrow the binary search
+  // of every Seek to the window of entries it predicts for the key.
+  //
   // `have_first_key` controls whether IndexValue will contain
   // first_internal_key. It affects data serialization format, so the same value
   // have_first_key must be used when writing and reading index.
@@ -214,7 +218,9 @@ class Block {
                                    bool total_order_seek, bool have_first_key,
                                    bool key_includes_seq, bool value_is_full,
                                    bool block_contents_pinned = false,
-                                   BlockPrefixIndex* prefix_index = nullptr);
+                                   BlockPrefixIndex* prefix_index = nullptr,
+                                   const LearnedIndexModel* learned_index =
+                                       nullptr);
 
   // Report an approximation of how much memory has been used.
   size_t ApproximateMemoryUsage() const;
@@ -468,6 +474,14 @@ class BlockIter : public InternalIteratorBase<TValue> {
   inline bool BinarySeek(const Slice& target, uint32_t* index,
                          bool* is_index_key_result);
 
+  // Same as BinarySeek(), but only searches restart points in (left, right].
+  // The caller must know that the restart key at `left` (if left >= 0) is
+  // less than or equal to `target`, and that the one at `right + 1` (if any)
+  // is strictly greater.
+  template <typename DecodeKeyFunc>
+  inline bool BinarySeekRange(const Slice& target, int64_t left, int64_t right,
+                              uint32_t* index, bool* is_index_key_result);
+
   void FindKeyAfterBinarySeek(const Slice& target, uint32_t index,
                               bool is_index_key_result);
 };
@@ -593,7 +607,8 @@ class DataBlockIter final : public BlockIter<Slice> {
 
 class IndexBlockIter final : public BlockIter<IndexValue> {
  public:
-  IndexBlockIter() : BlockIter(), prefix_index_(nullptr) {}
+  IndexBlockIter()
+      : BlockIter(), prefix_index_(nullptr), learned_index_(nullptr) {}
 
   // key_includes_seq, default true, means that the keys are in internal key
   // format.
@@ -603,11 +618,13 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                   uint32_t restarts, uint32_t num_restarts,
                   SequenceNumber global_seqno, BlockPrefixIndex* prefix_index,
                   bool have_first_key, bool key_includes_seq,
-                  bool value_is_full, bool block_contents_pinned) {
+                  bool value_is_full, bool block_contents_pinned,
+                  const LearnedIndexModel* learned_index = nullptr) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts,
                    kDisableGlobalSequenceNumber, block_contents_pinned);
     raw_key_.SetIsUserKey(!key_includes_seq);
     prefix_index_ = prefix_index;
+    learned_index_ = learned_index;
     value_delta_encoded_ = !value_is_full;
     have_first_key_ = have_first_key;
     if (have_first_key_ && global_seqno != kDisableGlobalSequenceNumber) {
@@ -675,6 +692,7 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   bool value_delta_encoded_;
   bool have_first_key_;  // value includes first_internal_key
   BlockPrefixIndex* prefix_index_;
+  const LearnedIndexModel* learned_index_;
   // Whether the value is delta encoded. In that case the value is assumed to be
   // BlockHandle. The first value in each restart interval is the full encoded
   // BlockHandle; the restart of encoded size part of the BlockHandle. The
@@ -709,6 +727,11 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                             uint32_t left, uint32_t right, uint32_t* index,
                             bool* prefix_may_exist);
   inline int CompareBlockKey(uint32_t block_index, const Slice& target);
+  // Binary search limited to the window learned_index_ predicts for
+  // `target`. Falls back to a full binary search when the window does not
+  // bracket the target.
+  bool LearnedSeek(const Slice& target, const Slice& seek_key,
+                   uint32_t* index, bool* skip_linear_scan);
 
   inline bool ParseNextIndexKey();
 
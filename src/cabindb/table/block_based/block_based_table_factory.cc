@@ -177,7 +177,9 @@ static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
         {"kTwoLevelIndexSearch",
          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch},
         {"kBinarySearchWithFirstKey",
-         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey}};
+         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey},
+        {"kLearnedIndexSearch",
+         BlockBasedTableOptions::IndexType::kLearnedIndexSearch}};
 
 static std::unordered_map<std::string,
                           BlockBasedTableOptions::DataBlockIndexType>
@@ -833,6 +835,7 @@ const std::string BlockBasedTablePropertyNames::kPrefixFiltering =
 const std::string kHashIndexPrefixesBlock = "cabindb.hashindex.prefixes";
 const std::string kHashIndexPrefixesMetadataBlock =
     "cabindb.hashindex.metadata";
+const std::string kLearnedIndexBlock = "cabindb.learnedindex";
 const std::string kPropTrue = "1";
 const std::string kPropFalse = "0";
 
@@ -43,6 +43,7 @@
 #include "table/block_based/filter_block.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/hash_index_reader.h"
+#include "table/block_based/learned_index_reader.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/block_based/partitioned_index_reader.h"
 #include "table/block_fetcher.h"
@@ -68,6 +69,7 @@ namespace CABINDB_NAMESPACE {
 extern const uint64_t kBlockBasedTableMagicNumber;
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kLearnedIndexBlock;
 
 
 // Found that 256 KB readahead size provides the best performance, based on
@@ -2980,6 +2982,10 @@ BlockType BlockBasedTable::GetBlockTypeForMetaBlockByName(
     return BlockType::kHashIndexMetadata;
   }
 
+  if (meta_block_name == kLearnedIndexBlock) {
+    return BlockType::kLearnedIndex;
+  }
+
   assert(false);
   return BlockType::kInvalid;
 }
@@ -3117,6 +3123,28 @@ Status BlockBasedTable::CreateIndexReader(
                                        pin, lookup_context, index_reader);
       }
     }
+    case BlockBasedTableOptions::kLearnedIndexSearch: {
+      std::unique_ptr<Block> metaindex_guard;
+      std::unique_ptr<InternalIterator> metaindex_iter_guard;
+      auto meta_index_iter = preloaded_meta_index_iter;
+      if (meta_index_iter == nullptr) {
+        auto s = ReadMetaIndexBlock(ro, prefetch_buffer, &metaindex_guard,
+                                    &metaindex_iter_guard);
+        if (!s.ok()) {
+          // the model is only an accelerator, binary search still works
+          CABIN_LOG_WARN(rep_->ioptions.info_log,
+                         "Unable to read the metaindex block."
+                         " Fall back to binary search index.");
+          return BinarySearchIndexReader::Create(this, ro, prefetch_buffer,
+                                                 use_cache, prefetch, pin,
+                                                 lookup_context, index_reader);
+        }
+        meta_index_iter = metaindex_iter_guard.get();
+      }
+      return LearnedIndexReader::Create(this, ro, prefetch_buffer,
+                                        meta_index_iter, use_cache, prefetch,
+                                        pin, lookup_context, index_reader);
+    }
     default: {
       std::string error_message =
           "Unrecognized index type: " + ToString(rep_->index_type);
@@ -3218,6 +3246,52 @@ uint64_t BlockBasedTable::ApproximateSize(const Slice& start, const Slice& end,
                                static_cast<double>(rep_->file_size));
 }
 
+Status BlockBasedTable::ApproximateKeyAnchors(const ReadOptions& read_options,
+                                              std::vector<Anchor>* anchors) {
+  BlockCacheLookupContext context(TableReaderCaller::kCompaction);
+  IndexBlockIter iiter_on_stack;
+  ReadOptions ro = read_options;
+  ro.total_order_seek = true;
+  auto index_iter =
+      NewIndexIterator(ro, /*disable_prefix_seek=*/true,
+                       /*input_iter=*/&iiter_on_stack, /*get_context=*/nullptr,
+                       /*lookup_context=*/&context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (index_iter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(index_iter);
+  }
+
+  uint64_t num_blocks = 0;
+  if (rep_->table_properties) {
+    num_blocks = rep_->table_properties->num_data_blocks;
+  }
+  const uint64_t step =
+      std::max<uint64_t>(1, (num_blocks + kMaxNumAnchors - 1) / kMaxNumAnchors);
+
+  // Each index entry separates a data block from the next one, so the data
+  // between two sampled entries is the sum of the blocks in between.
+  uint64_t range_start = 0;
+  uint64_t range_end = 0;
+  uint64_t n = 0;
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    BlockHandle handle = index_iter->value().handle;
+    range_end = handle.offset() + block_size(handle);
+    if (++n % step == 0) {
+      anchors->emplace_back(index_iter->user_key(), range_end - range_start);
+      range_start = range_end;
+    }
+  }
+  Status s = index_iter->status();
+  if (s.ok() && range_end > range_start) {
+    index_iter->SeekToLast();
+    s = index_iter->status();
+    if (s.ok() && index_iter->Valid()) {
+      anchors->emplace_back(index_iter->user_key(), range_end - range_start);
+    }
+  }
+  return s;
+}
+
 bool BlockBasedTable::TEST_FilterBlockInCache() const {
   assert(rep_ != nullptr);
   return TEST_BlockInCache(rep_->filter_handle);
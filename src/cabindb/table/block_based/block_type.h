@@ -23,6 +23,7 @@ enum class BlockType : uint8_t {
   kHashIndexMetadata,
   kMetaIndex,
   kIndex,
+  kLearnedIndex,
   // Note: keep kInvalid the last value when adding new enum values.
   kInvalid
 };
@@ -12,6 +12,7 @@
 #include <assert.h>
 #include <cinttypes>
 
+#include <cstring>
 #include <list>
 #include <string>
 #include <unordered_map>
@@ -19,6 +20,7 @@
 #include "include/cabindb/comparator.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/learned_index.h"
 #include "table/format.h"
 
 namespace CABINDB_NAMESPACE {
@@ -353,6 +355,75 @@ class HashIndexBuilder : public IndexBuilder {
   uint64_t current_restart_index_ = 0;
 };
 
+// LearnedIndexBuilder builds the same binary-searchable index block as
+// ShortenedIndexBuilder plus a metablock holding a LearnedIndexModel of the
+// keys at its restart points, which the reader uses to narrow the binary
+// search over them. The model is only built for the bytewise comparator,
+// since it relies on the byte order of the keys; for any other comparator no
+// metablock is written and the reader falls back to plain binary search.
+class LearnedIndexBuilder : public IndexBuilder {
+ public:
+  explicit LearnedIndexBuilder(
+      const InternalKeyComparator* comparator,
+      int index_block_restart_interval, int format_version,
+      bool use_value_delta_encoding,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode)
+      : IndexBuilder(comparator),
+        primary_index_builder_(comparator, index_block_restart_interval,
+                               format_version, use_value_delta_encoding,
+                               shortening_mode, /* include_first_key */ false),
+        restart_interval_(index_block_restart_interval),
+        use_model_(strcmp(comparator->user_comparator()->Name(),
+                          BytewiseComparator()->Name()) == 0) {}
+
+  virtual void AddIndexEntry(std::string* last_key_in_current_block,
+                             const Slice* first_key_in_next_block,
+                             const BlockHandle& block_handle) override {
+    primary_index_builder_.AddIndexEntry(last_key_in_current_block,
+                                         first_key_in_next_block, block_handle);
+    // last_key_in_current_block now holds the separator that was indexed;
+    // the block builder starts a restart point every restart_interval_
+    // entries, and only those are modelled
+    if (use_model_ && num_entries_++ % restart_interval_ == 0) {
+      model_builder_.Add(ExtractUserKey(*last_key_in_current_block));
+    }
+  }
+
+  virtual void OnKeyAdded(const Slice& key) override {
+    primary_index_builder_.OnKeyAdded(key);
+  }
+
+  virtual Status Finish(
+      IndexBlocks* index_blocks,
+      const BlockHandle& last_partition_block_handle) override {
+    Status s = primary_index_builder_.Finish(index_blocks,
+                                             last_partition_block_handle);
+    model_block_ = model_builder_.Finish();
+    if (!model_block_.empty()) {
+      index_blocks->meta_blocks.insert(
+          {kLearnedIndexBlock.c_str(), model_block_});
+    }
+    return s;
+  }
+
+  virtual size_t IndexSize() const override {
+    return primary_index_builder_.IndexSize() + model_block_.size();
+  }
+
+  virtual bool seperator_is_key_plus_seq() override {
+    return primary_index_builder_.seperator_is_key_plus_seq();
+  }
+
+ private:
+  ShortenedIndexBuilder primary_index_builder_;
+  const uint32_t restart_interval_;
+  const bool use_model_;
+  uint64_t num_entries_ = 0;
+  LearnedIndexModelBuilder model_builder_;
+  // the encoded model, kept alive until the metablock is written
+  std::string model_block_;
+};
+
 /**
  * IndexBuilder for two-level indexing. Internally it creates a new index for
  * each partition and Finish then in order when Finish is called on it
@@ -0,0 +1,202 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#include "table/block_based/learned_index.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include "util/coding.h"
+
+namespace CABINDB_NAMESPACE {
+
+namespace {
+// first key, first entry and slope of one segment
+const size_t kSegmentSize = 8 + 4 + 8;
+}  // namespace
+
+uint64_t LearnedIndexModel::KeyToX(const Slice& prefix, const Slice& user_key) {
+  // keys outside the prefix sort before or after every key of the table
+  const size_t n = std::min(prefix.size(), user_key.size());
+  const int cmp = memcmp(user_key.data(), prefix.data(), n);
+  if (cmp < 0 || (cmp == 0 && user_key.size() < prefix.size())) {
+    return 0;
+  }
+  if (cmp > 0) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+
+  uint64_t x = 0;
+  for (size_t i = prefix.size(); i < prefix.size() + sizeof(x); i++) {
+    x <<= 8;
+    if (i < user_key.size()) {
+      x |= static_cast<uint8_t>(user_key[i]);
+    }
+  }
+  return x;
+}
+
+Status LearnedIndexModel::Create(const Slice& contents,
+                                 std::unique_ptr<LearnedIndexModel>* model) {
+  Slice input = contents;
+  Slice prefix;
+  uint32_t num_segments = 0;
+  std::unique_ptr<LearnedIndexModel> m(new LearnedIndexModel());
+  if (!GetLengthPrefixedSlice(&input, &prefix) ||
+      !GetVarint32(&input, &m->max_error_) ||
+      !GetVarint32(&input, &m->num_entries_) ||
+      !GetVarint32(&input, &num_segments)) {
+    return Status::Corruption("bad learned index header");
+  }
+  if (m->num_entries_ == 0 || num_segments == 0 ||
+      input.size() != num_segments * kSegmentSize) {
+    return Status::Corruption("bad learned index segments");
+  }
+
+  m->prefix_ = prefix.ToString();
+  m->segments_.reserve(num_segments);
+  for (uint32_t i = 0; i < num_segments; i++) {
+    Segment s;
+    s.first_x = DecodeFixed64(input.data());
+    s.first_y = DecodeFixed32(input.data() + 8);
+    uint64_t slope_bits = DecodeFixed64(input.data() + 12);
+    memcpy(&s.slope, &slope_bits, sizeof(s.slope));
+    input.remove_prefix(kSegmentSize);
+    m->segments_.push_back(s);
+  }
+  *model = std::move(m);
+  return Status::OK();
+}
+
+void LearnedIndexModel::Predict(const Slice& user_key, uint32_t* left,
+                                uint32_t* right) const {
+  assert(!segments_.empty());
+  const uint64_t x = KeyToX(prefix_, user_key);
+  auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), x,
+      [](uint64_t v, const Segment& s) { return v < s.first_x; });
+
+  double pos = 0;
+  // first restart point of the segments that start at the x of user_key
+  uint32_t run_start = std::numeric_limits<uint32_t>::max();
+  if (it != segments_.begin()) {
+    // a key between two segments lands at the end of the first one
+    const double upper =
+        it == segments_.end() ? num_entries_ - 1 : it->first_y;
+    --it;
+    pos = it->first_y + it->slope * static_cast<double>(x - it->first_x);
+    pos = std::min(std::max(pos, static_cast<double>(it->first_y)), upper);
+
+    // Keys that only differ after the modelled bytes share one x. The
+    // builder starts a segment at the first key of such a run and another
+    // one whenever the run outgrows the error bound, so the run may span
+    // several segments.
+    if (it->first_x == x) {
+      auto first = it;
+      while (first != segments_.begin() && std::prev(first)->first_x == x) {
+        --first;
+      }
+      run_start = first->first_y;
+    }
+  }
+
+  // one more entry on each side covers rounding and a key that falls
+  // between two entries
+  const uint32_t p = static_cast<uint32_t>(pos);
+  const uint32_t err = max_error_ + 1;
+  *left = p > err ? p - err : 0;
+  if (run_start < p) {
+    *left = run_start > err ? run_start - err : 0;
+  }
+  *right = static_cast<uint32_t>(
+      std::min<uint64_t>(uint64_t{p} + err + 1, num_entries_ - 1));
+}
+
+size_t LearnedIndexModel::ApproximateMemoryUsage() const {
+  return sizeof(*this) + prefix_.capacity() +
+         segments_.capacity() * sizeof(Segment);
+}
+
+std::string LearnedIndexModelBuilder::Finish() {
+  std::string result;
+  if (keys_.empty()) {
+    return result;
+  }
+
+  // keys are sorted, so the first and the last share the common prefix
+  const std::string& first = keys_.front();
+  const std::string& last = keys_.back();
+  size_t prefix_len = 0;
+  while (prefix_len < first.size() && prefix_len < last.size() &&
+         first[prefix_len] == last[prefix_len]) {
+    prefix_len++;
+  }
+  const Slice prefix(first.data(), prefix_len);
+
+  // Each segment starts at a point and keeps the range [lo, hi] of slopes
+  // that keep every later point within max_error_; the segment is closed
+  // when a point empties that range.
+  std::vector<LearnedIndexModel::Segment> segments;
+  const double kNoLimit = std::numeric_limits<double>::infinity();
+  LearnedIndexModel::Segment cur{0, 0, 0};
+  double lo = 0, hi = kNoLimit;
+  // first entry of the run of keys that share the x of the current one
+  uint32_t run_first = 0;
+  uint64_t prev_x = 0;
+  for (uint32_t y = 0; y < keys_.size(); y++) {
+    const uint64_t x = LearnedIndexModel::KeyToX(prefix, keys_[y]);
+    if (y == 0 || x != prev_x) {
+      run_first = y;
+    }
+    prev_x = x;
+    if (y > 0) {
+      if (x == cur.first_x) {
+        if (y - cur.first_y <= max_error_) {
+          continue;
+        }
+      } else {
+        const double dx = static_cast<double>(x - cur.first_x);
+        const double dy = static_cast<double>(y - cur.first_y);
+        const double new_lo = std::max(lo, (dy - max_error_) / dx);
+        const double new_hi = std::min(hi, (dy + max_error_) / dx);
+        if (new_lo <= new_hi) {
+          lo = new_lo;
+          hi = new_hi;
+          continue;
+        }
+      }
+      cur.slope = hi == kNoLimit ? lo : (lo + hi) / 2;
+      segments.push_back(cur);
+      // Do not split a run between two segments: the new one starts at the
+      // first key of the run, which Predict relies on. The closed segment
+      // keeps a slope that fits all of its remaining keys.
+      if (run_first > cur.first_y) {
+        y = run_first;
+      }
+    }
+    cur = {x, y, 0};
+    lo = 0;
+    hi = kNoLimit;
+  }
+  cur.slope = hi == kNoLimit ? lo : (lo + hi) / 2;
+  segments.push_back(cur);
+
+  PutLengthPrefixedSlice(&result, prefix);
+  PutVarint32(&result, max_error_);
+  PutVarint32(&result, static_cast<uint32_t>(keys_.size()));
+  PutVarint32(&result, static_cast<uint32_t>(segments.size()));
+  for (const auto& s : segments) {
+    uint64_t slope_bits;
+    memcpy(&slope_bits, &s.slope, sizeof(slope_bits));
+    PutFixed64(&result, s.first_x);
+    PutFixed32(&result, s.first_y);
+    PutFixed64(&result, slope_bits);
+  }
+  keys_.clear();
+  return result;
+}
+}  // namespace CABINDB_NAMESPACE
@@ -0,0 +1,88 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/cabindb/slice.h"
+#include "include/cabindb/status.h"
+
+namespace CABINDB_NAMESPACE {
+
+// Largest distance, in restart points, between the position the model
+// predicts for a key and the position of that key in the index block.
+const uint32_t kLearnedIndexMaxError = 8;
+
+// LearnedIndexModel is a piecewise linear model that maps a user key to the
+// restart point of a binary search index block whose interval holds it. A key is turned into an integer by reading the eight
+// bytes that follow the prefix shared by all keys of the table as a big
+// endian number, which keeps the order of the bytewise comparator.
+//
+// The model is stored in its own meta block:
+//
+// +-------------------------------+------------------------------------+
+// | prefix: length prefixed slice | max error: varint32                |
+// +-------------------------------+------------------------------------+
+// | number of entries: varint32   | number of segments: varint32       |
+// +-------------------------------+------------------------------------+
+// <= segment 1
+// | first key: 8 bytes | first entry: 4 bytes | slope: 8 bytes         |
+// +--------------------+----------------------+------------------------+
+// | ....                                                               |
+// +--------------------+----------------------+------------------------+
+class LearnedIndexModel {
+ public:
+  // Parses a model written by LearnedIndexModelBuilder.
+  static Status Create(const Slice& contents,
+                       std::unique_ptr<LearnedIndexModel>* model);
+
+  // Sets [*left, *right] to the restart points around user_key. The window is
+  // only a hint, so callers must check that it brackets the key.
+  void Predict(const Slice& user_key, uint32_t* left, uint32_t* right) const;
+
+  uint32_t num_entries() const { return num_entries_; }
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  friend class LearnedIndexModelBuilder;
+
+  struct Segment {
+    uint64_t first_x;
+    uint32_t first_y;
+    double slope;
+  };
+
+  static uint64_t KeyToX(const Slice& prefix, const Slice& user_key);
+
+  std::string prefix_;
+  uint32_t max_error_ = 0;
+  uint32_t num_entries_ = 0;
+  std::vector<Segment> segments_;
+};
+
+// Collects the user keys at the index restart points of one table and fits a
+// LearnedIndexModel to them with a greedy shrinking cone, so that every
+// entry is within max_error of its prediction.
+class LearnedIndexModelBuilder {
+ public:
+  explicit LearnedIndexModelBuilder(uint32_t max_error = kLearnedIndexMaxError)
+      : max_error_(max_error) {}
+
+  // Keys must be added in index order.
+  void Add(const Slice& user_key) { keys_.emplace_back(user_key.ToString()); }
+
+  // Returns the encoded model, or an empty string when no key was added.
+  std::string Finish();
+
+ private:
+  const uint32_t max_error_;
+  std::vector<std::string> keys_;
+};
+}  // namespace CABINDB_NAMESPACE
@@ -0,0 +1,162 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/learned_index.h"
+
+#include <string>
+#include <vector>
+
+#include "test_util/testharness.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace CABINDB_NAMESPACE {
+
+namespace {
+// prefix followed by x as a big endian number and an optional suffix
+std::string MakeKey(const std::string& prefix, uint64_t x,
+                    const std::string& suffix = "") {
+  std::string key = prefix;
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key.push_back(static_cast<char>((x >> shift) & 0xff));
+  }
+  return key + suffix;
+}
+
+std::unique_ptr<LearnedIndexModel> Build(const std::vector<std::string>& keys,
+                                         uint32_t max_error) {
+  LearnedIndexModelBuilder builder(max_error);
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  std::string contents = builder.Finish();
+  std::unique_ptr<LearnedIndexModel> model;
+  EXPECT_OK(LearnedIndexModel::Create(contents, &model));
+  return model;
+}
+
+// every key must be inside the window predicted for it
+void CheckBracketed(const LearnedIndexModel& model,
+                    const std::vector<std::string>& keys) {
+  ASSERT_EQ(keys.size(), model.num_entries());
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    uint32_t left, right;
+    model.Predict(keys[i], &left, &right);
+    ASSERT_LE(left, i) << "key " << i;
+    ASSERT_GE(right, i) << "key " << i;
+    ASSERT_LT(right, keys.size());
+  }
+}
+}  // namespace
+
+class LearnedIndexModelTest : public testing::Test {};
+
+TEST_F(LearnedIndexModelTest, ErrorBound) {
+  Random rnd(301);
+  for (uint32_t max_error : {0u, 1u, 8u, 32u}) {
+    std::vector<std::string> keys;
+    uint64_t x = 0;
+    for (int i = 0; i < 10000; i++) {
+      // mostly dense keys with a few large jumps
+      x += rnd.OneIn(100) ? 1 + rnd.Uniform(1 << 30) : 1 + rnd.Uniform(16);
+      keys.push_back(MakeKey("table-", x));
+    }
+    auto model = Build(keys, max_error);
+    CheckBracketed(*model, keys);
+
+    // without runs of equal keys the window is 2 * (max_error + 1) + 1 wide
+    for (uint32_t i = 0; i < keys.size(); i++) {
+      uint32_t left, right;
+      model->Predict(keys[i], &left, &right);
+      ASSERT_LE(right - left, 2 * (max_error + 1) + 1);
+    }
+  }
+}
+
+TEST_F(LearnedIndexModelTest, SameKeyRuns) {
+  // keys that only differ after the eight modelled bytes map to one x;
+  // runs are shorter and longer than the error bound
+  Random rnd(302);
+  const uint32_t max_error = 4;
+  std::vector<std::string> keys;
+  uint64_t x = 1000;
+  for (int run = 0; run < 300; run++) {
+    x += 1 + rnd.Uniform(3);
+    int len = rnd.OneIn(4) ? 1 + rnd.Uniform(40) : 1 + rnd.Uniform(3);
+    for (int i = 0; i < len; i++) {
+      char suffix[16];
+      snprintf(suffix, sizeof(suffix), "%04d", i);
+      keys.push_back(MakeKey("p", x, suffix));
+    }
+  }
+  auto model = Build(keys, max_error);
+  CheckBracketed(*model, keys);
+}
+
+TEST_F(LearnedIndexModelTest, OutsidePrefix) {
+  std::vector<std::string> keys;
+  for (uint64_t x = 0; x < 100; x++) {
+    keys.push_back(MakeKey("m", x * 7));
+  }
+  auto model = Build(keys, kLearnedIndexMaxError);
+  CheckBracketed(*model, keys);
+
+  // keys sorting before or after the shared prefix land at either end
+  uint32_t left, right;
+  model->Predict("a", &left, &right);
+  ASSERT_EQ(0u, left);
+  model->Predict("z", &left, &right);
+  ASSERT_EQ(keys.size() - 1, right);
+  // a short key that is a prefix of the others
+  model->Predict("m", &left, &right);
+  ASSERT_EQ(0u, left);
+}
+
+TEST_F(LearnedIndexModelTest, Builder) {
+  // no keys, no model
+  LearnedIndexModelBuilder empty;
+  ASSERT_EQ("", empty.Finish());
+
+  // a single key
+  auto model = Build({"only"}, kLearnedIndexMaxError);
+  uint32_t left, right;
+  model->Predict("only", &left, &right);
+  ASSERT_EQ(0u, left);
+  ASSERT_EQ(0u, right);
+  model->Predict("other", &left, &right);
+  ASSERT_EQ(0u, left);
+  ASSERT_EQ(0u, right);
+
+  // linear keys need one segment whatever their number
+  std::vector<std::string> keys;
+  for (uint64_t x = 0; x < 5000; x++) {
+    keys.push_back(MakeKey("lin", x * 3));
+  }
+  LearnedIndexModelBuilder builder;
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  std::string contents = builder.Finish();
+  // prefix, max error, entries, segments and one 20 byte segment
+  ASSERT_LT(contents.size(), 40u);
+  ASSERT_OK(LearnedIndexModel::Create(contents, &model));
+  CheckBracketed(*model, keys);
+
+  // truncated or padded contents are rejected
+  std::unique_ptr<LearnedIndexModel> bad;
+  ASSERT_TRUE(LearnedIndexModel::Create(Slice(contents.data(),
+                                              contents.size() - 1),
+                                        &bad)
+                  .IsCorruption());
+  ASSERT_TRUE(LearnedIndexModel::Create(contents + "x", &bad).IsCorruption());
+  ASSERT_TRUE(LearnedIndexModel::Create("", &bad).IsCorruption());
+}
+
+}  // namespace CABINDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
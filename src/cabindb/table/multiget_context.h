@@ -35,6 +35,8 @@ struct KeyContext {
   PinnableSlice* value;
   std::string* timestamp;
   GetContext* get_context;
+  // set by the lookup when `value` holds a blob index to resolve
+  bool is_blob_index;
 
   KeyContext(ColumnFamilyHandle* col_family, const Slice& user_key,
              PinnableSlice* val, std::string* ts, Status* stat)
@@ -47,7 +49,8 @@ struct KeyContext {
         cb_arg(nullptr),
         value(val),
         timestamp(ts),
-        get_context(nullptr) {}
+        get_context(nullptr),
+        is_blob_index(false) {}
 
   KeyContext() = default;
 };
@@ -9,6 +9,8 @@
 
 #pragma once
 #include <memory>
+#include <string>
+#include <vector>
 #include "db/range_tombstone_fragmenter.h"
 #include "include/cabindb/slice_transform.h"
 #include "table/get_context.h"
@@ -82,6 +84,24 @@ class TableReader {
   virtual uint64_t ApproximateSize(const Slice& start, const Slice& end,
                                    TableReaderCaller caller) = 0;
 
+  // A user key of the table and the approximate number of file bytes
+  // between it and the previous anchor (or the start of the file).
+  struct Anchor {
+    Anchor(const Slice& _user_key, uint64_t _range_size)
+        : user_key(_user_key.ToString()), range_size(_range_size) {}
+    std::string user_key;
+    uint64_t range_size;
+  };
+
+  // Appends to anchors a sample of keys that split the table into ranges of
+  // about the same size, in key order. The last anchor is at or past the
+  // largest key of the table. Used to partition a compaction of files whose
+  // key ranges overlap.
+  virtual Status ApproximateKeyAnchors(const ReadOptions& /*read_options*/,
+                                       std::vector<Anchor>* /*anchors*/) {
+    return Status::NotSupported("ApproximateKeyAnchors() not supported.");
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -274,6 +274,9 @@ DEFINE_bool(mmap_read, true, "Whether use mmap read");
 DEFINE_string(table_factory, "block_based",
               "Table factory to use: `block_based` (default), `plain_table` or "
               "`cuckoo_hash`.");
+DEFINE_string(index_type, "binary_search",
+              "Index type of the block based table: `binary_search` "
+              "(default), `hash_search`, `two_level` or `learned`.");
 DEFINE_string(time_unit, "microsecond",
               "The time unit used for measuring performance. User can specify "
               "`microsecond` (default) or `nanosecond`");
@@ -323,7 +326,24 @@ int main(int argc, char** argv) {
     exit(1);
 #endif  // CABINDB_LITE
   } else if (FLAGS_table_factory == "block_based") {
-    tf.reset(new CABINDB_NAMESPACE::BlockBasedTableFactory());
+    CABINDB_NAMESPACE::BlockBasedTableOptions table_options;
+    if (FLAGS_index_type == "binary_search") {
+      table_options.index_type =
+          CABINDB_NAMESPACE::BlockBasedTableOptions::kBinarySearch;
+    } else if (FLAGS_index_type == "hash_search") {
+      table_options.index_type =
+          CABINDB_NAMESPACE::BlockBasedTableOptions::kHashSearch;
+    } else if (FLAGS_index_type == "two_level") {
+      table_options.index_type =
+          CABINDB_NAMESPACE::BlockBasedTableOptions::kTwoLevelIndexSearch;
+    } else if (FLAGS_index_type == "learned") {
+      table_options.index_type =
+          CABINDB_NAMESPACE::BlockBasedTableOptions::kLearnedIndexSearch;
+    } else {
+      fprintf(stderr, "Invalid index type %s\n", FLAGS_index_type.c_str());
+      return 1;
+    }
+    tf.reset(new CABINDB_NAMESPACE::BlockBasedTableFactory(table_options));
   } else {
     fprintf(stderr, "Invalid table type %s\n", FLAGS_table_factory.c_str());
   }
@@ -2145,6 +2145,73 @@ TEST_P(BlockBasedTableTest, HashIndexTest) {
   IndexTest(table_options);
 }
 
+TEST_P(BlockBasedTableTest, LearnedIndexTest) {
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.index_type = BlockBasedTableOptions::kLearnedIndexSearch;
+  IndexTest(table_options);
+}
+
+// With a larger index restart interval the model only covers restart keys,
+// so the index shrinks while every key stays reachable through Seek().
+TEST_P(BlockBasedTableTest, LearnedIndexRestartInterval) {
+  std::vector<std::string> user_keys;
+  for (int i = 0; i < 2000; ++i) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016x", i * 7);
+    user_keys.push_back(buf);
+  }
+
+  uint64_t index_size[2] = {0, 0};
+  const int restart_intervals[2] = {1, 16};
+  for (int r = 0; r < 2; ++r) {
+    TableConstructor c(BytewiseComparator(),
+                       true /* convert_to_internal_key_ */);
+    for (const auto& k : user_keys) {
+      c.Add(k, "val");
+    }
+
+    std::vector<std::string> ks;
+    stl_wrappers::KVMap kvmap;
+    Options options;
+    options.compression = kNoCompression;
+    BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+    table_options.index_type = BlockBasedTableOptions::kLearnedIndexSearch;
+    table_options.index_block_restart_interval = restart_intervals[r];
+    table_options.block_size = 64;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+    const ImmutableCFOptions ioptions(options);
+    const MutableCFOptions moptions(options);
+    c.Finish(options, ioptions, moptions, table_options,
+             GetPlainInternalComparator(options.comparator), &ks, &kvmap);
+    index_size[r] = c.GetTableReader()->GetTableProperties()->index_size;
+
+    std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+        ReadOptions(), moptions.prefix_extractor.get(), /*arena=*/nullptr,
+        /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+    for (size_t i = 0; i < user_keys.size(); ++i) {
+      iter->Seek(InternalKey(user_keys[i], kMaxSequenceNumber, kTypeValue)
+                     .Encode());
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(user_keys[i], ExtractUserKey(iter->key()).ToString());
+      // a target between two keys lands on the next one
+      iter->Seek(InternalKey(user_keys[i] + "0", kMaxSequenceNumber,
+                             kTypeValue)
+                     .Encode());
+      if (i + 1 < user_keys.size()) {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(user_keys[i + 1], ExtractUserKey(iter->key()).ToString());
+      } else {
+        ASSERT_FALSE(iter->Valid());
+      }
+    }
+    ASSERT_OK(iter->status());
+    iter.reset();
+    c.ResetTableReader();
+  }
+  ASSERT_LT(index_size[1], index_size[0]);
+}
+
 TEST_P(BlockBasedTableTest, PartitionIndexTest) {
   const int max_index_keys = 5;
   const int est_max_index_key_value_size = 32;
@@ -371,6 +371,8 @@ void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, DBOptions& db_options,
 
   // boolean options
   cf_opt->report_bg_io_stats = rnd->Uniform(2);
+  cf_opt->bottom_pri_compaction = rnd->Uniform(2);
+  cf_opt->high_pri_compaction = rnd->Uniform(2);
   cf_opt->disable_auto_compactions = rnd->Uniform(2);
   cf_opt->inplace_update_support = rnd->Uniform(2);
   cf_opt->level_compaction_dynamic_level_bytes = rnd->Uniform(2);
@@ -418,6 +420,7 @@ void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, DBOptions& db_options,
 
   // uint32_t options
   cf_opt->bloom_locality = rnd->Uniform(10000);
+  cf_opt->max_cf_subcompactions = rnd->Uniform(10000);
   cf_opt->max_bytes_for_level_base = rnd->Uniform(10000);
 
   // uint64_t options
@@ -1330,6 +1330,9 @@ DEFINE_bool(use_hash_search, false, "if use kHashSearch "
 DEFINE_bool(use_block_based_filter, false, "if use kBlockBasedFilter "
             "instead of kFullFilter for filter block. "
             "This is valid if only we use BlockTable");
+DEFINE_bool(use_ribbon_filter, false, "Use Ribbon instead of Bloom filter, "
+            "with the FP rate of a Bloom filter of --bloom_bits bits per key. "
+            "This is valid if only we use BlockTable");
 DEFINE_string(merge_operator, "", "The merge operator to use with the database."
               "If a new merge operator is specified, be sure to use fresh"
               " database The possible merge operators are defined in"
@@ -2681,14 +2684,25 @@ class Benchmark {
     }
   }
 
+  const FilterPolicy* NewFilterPolicy() {
+    if (FLAGS_bloom_bits < 0) {
+      return nullptr;
+    }
+    if (FLAGS_use_ribbon_filter) {
+      if (FLAGS_use_block_based_filter) {
+        fprintf(stderr, "Ribbon filter cannot be block based.\n");
+        exit(1);
+      }
+      return NewExperimentalRibbonFilterPolicy(FLAGS_bloom_bits);
+    }
+    return NewBloomFilterPolicy(FLAGS_bloom_bits, FLAGS_use_block_based_filter);
+  }
+
  public:
   Benchmark()
       : cache_(NewCache(FLAGS_cache_size)),
         compressed_cache_(NewCache(FLAGS_compressed_cache_size)),
-        filter_policy_(FLAGS_bloom_bits >= 0
-                           ? NewBloomFilterPolicy(FLAGS_bloom_bits,
-                                                  FLAGS_use_block_based_filter)
-                           : nullptr),
+        filter_policy_(NewFilterPolicy()),
         prefix_extractor_(NewFixedPrefixTransform(FLAGS_prefix_size)),
         num_(FLAGS_num),
         key_size_(FLAGS_key_size),
@@ -4051,8 +4065,7 @@ class Benchmark {
         table_options->block_cache = cache_;
       }
       if (FLAGS_bloom_bits >= 0) {
-        table_options->filter_policy.reset(NewBloomFilterPolicy(
-            FLAGS_bloom_bits, FLAGS_use_block_based_filter));
+        table_options->filter_policy.reset(NewFilterPolicy());
       }
     }
     if (FLAGS_row_cache_size) {
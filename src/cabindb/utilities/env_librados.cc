@@ -3,8 +3,13 @@
 // Copyright (c) Facebook, Inc. and its affiliates. All Rights Reserved.
 #include "include/cabindb/utilities/env_librados.h"
 #include "util/random.h"
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
+#include <list>
+#include <mutex>
 
 namespace CABINDB_NAMESPACE {
 /* GLOBAL DIFINE */
@@ -53,9 +58,7 @@ Status err_to_status(int r)
   case -EIO:
     return Status::IOError(Status::kNone);
   default:
-    // FIXME :(
-    assert(0 == "unrecognized error code");
-    return Status::NotSupported(Status::kNone);
+    return Status::IOError(strerror(-r));
   }
 }
 
@@ -92,17 +95,393 @@ void split(const std::string &fn, std::string *dir, std::string *file) {
   LOG_DEBUG("[OUT]%s | %s\n", dir->c_str(), file->c_str());
 }
 
-// A file abstraction for reading sequentially through a file
-class LibradosSequentialFile : public SequentialFile {
+/**
+ * @brief a file stored as a sequence of RADOS objects
+ * @details
+ *  Byte range [i * stripe_size, (i + 1) * stripe_size) of a file lives in
+ *  object "<fid>.<i>" (i as 16 hex digits), so no object grows past the
+ *  stripe size however large the file gets, and a read that spans several
+ *  stripes goes to their OSDs in parallel. Stripes are only ever written in
+ *  order, so the size of a file follows from its last stripe.
+ *
+ *  A file written before files were striped is the single object "<fid>".
+ *  Such a file is found when its first stripe is missing and is still read,
+ *  appended to, truncated and removed in place.
+ */
+class LibradosStriper {
   librados::IoCtx * _io_ctx;
   std::string _fid;
-  std::string _hint;
-  int _offset;
+  uint64_t _stripe_size;
+  // the first stripe caches the file size here, so Stat() need not probe
+  static constexpr const char* SIZE_XATTR = "cabindb.size";
+  // whether the file is a single unstriped object; -1 until it is known
+  mutable std::atomic<int> _legacy{-1};
+
+  bool Legacy() const {
+    int legacy = _legacy;
+    if (legacy < 0) {
+      uint64_t size;
+      time_t mtime;
+      legacy = _io_ctx->stat(oid(0), &size, &mtime) == -ENOENT &&
+               _io_ctx->stat(_fid, &size, &mtime) == 0;
+      _legacy = legacy;
+    }
+    return legacy;
+  }
+
+  // the object that holds offset, the offset within it and how many of the
+  // len bytes from offset on it holds
+  std::string Locate(uint64_t offset, uint64_t len,
+                     uint64_t* off, uint64_t* n) const {
+    if (Legacy()) {
+      *off = offset;
+      *n = len;
+      return _fid;
+    }
+    *off = offset % _stripe_size;
+    *n = std::min<uint64_t>(len, _stripe_size - *off);
+    return oid(offset / _stripe_size);
+  }
+
+  // whether the file ends where the cached size says: its last stripe is
+  // as long as that, and no stripe follows a full one. Files only grow by
+  // appending, so a stale size fails one of the two checks.
+  bool _CheckSize(uint64_t cached, uint64_t first_size, time_t first_mtime,
+                  uint64_t* size, time_t* mtime) const {
+    uint64_t last = cached ? (cached - 1) / _stripe_size : 0;
+    uint64_t last_size = first_size;
+    time_t last_mtime = first_mtime;
+    if (last > 0 && _io_ctx->stat(oid(last), &last_size, &last_mtime) < 0) {
+      return false;
+    }
+    if (last_size != cached - last * _stripe_size) {
+      return false;
+    }
+    uint64_t next_size;
+    time_t next_mtime;
+    if (last_size == _stripe_size &&
+        _io_ctx->stat(oid(last + 1), &next_size, &next_mtime) != -ENOENT) {
+      return false;
+    }
+    *size = cached;
+    if (mtime) {
+      *mtime = last_mtime;
+    }
+    return true;
+  }
+
 public:
-  LibradosSequentialFile(librados::IoCtx * io_ctx, std::string fid, std::string hint):
-    _io_ctx(io_ctx), _fid(fid), _hint(hint), _offset(0) {}
+  // one in-flight read of [offset, offset + len), one aio_read per stripe
+  struct PendingRead {
+    struct Part {
+      librados::AioCompletion *completion = nullptr;
+      librados::bufferlist bl;
+      size_t len = 0;
+    };
+    uint64_t offset = 0;
+    size_t len = 0;
+    std::list<Part> parts;    // std::list: aio_read keeps a pointer to bl
+  };
+
+  LibradosStriper(librados::IoCtx * io_ctx, const std::string& fid,
+                  uint64_t stripe_size):
+    _io_ctx(io_ctx), _fid(fid), _stripe_size(stripe_size) {}
 
-  ~LibradosSequentialFile() {}
+  std::string oid(uint64_t index) const {
+    char buf[32];
+    snprintf(buf, sizeof(buf), ".%016llx", (unsigned long long)index);
+    return _fid + buf;
+  }
+
+  /**
+   * @brief start reading [offset, offset + len)
+   * @details every aio_read is issued before returning; call FinishRead
+   *  exactly once, even if this fails
+   */
+  int StartRead(uint64_t offset, size_t len, PendingRead* op) const {
+    op->offset = offset;
+    op->len = len;
+    while (len > 0) {
+      uint64_t off, n;
+      std::string part_oid = Locate(offset, len, &off, &n);
+      op->parts.emplace_back();
+      auto& part = op->parts.back();
+      part.len = n;
+      part.completion = librados::Rados::aio_create_completion();
+      int r = _io_ctx->aio_read(part_oid, part.completion, &part.bl, n, off);
+      if (r < 0) {
+        part.completion->release();
+        op->parts.pop_back();
+        return r;
+      }
+      offset += n;
+      len -= n;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief wait for a read started by StartRead
+   * @details copies the data to scratch unless it is nullptr. A missing
+   *  stripe or a short read ends the file.
+   * @return bytes read, or a negative error code
+   */
+  int FinishRead(PendingRead* op, char* scratch) const {
+    int ret = 0;
+    bool eof = false;
+    for (auto& part : op->parts) {
+      part.completion->wait_for_complete();
+      int r = part.completion->get_return_value();
+      part.completion->release();
+      if (r == -ENOENT) {
+        r = 0;
+      }
+      if (ret < 0 || eof) {
+        continue;
+      }
+      if (r < 0) {
+        ret = r;
+        continue;
+      }
+      if (scratch) {
+        part.bl.begin().copy(r, scratch + ret);
+      }
+      ret += r;
+      eof = (size_t)r < part.len;
+    }
+    op->parts.clear();
+    return ret;
+  }
+
+  int Read(uint64_t offset, size_t len, char* scratch) const {
+    PendingRead op;
+    int r = StartRead(offset, len, &op);
+    int ret = FinishRead(&op, scratch);
+    return r < 0 ? r : ret;
+  }
+
+  /**
+   * @brief write bl at offset without waiting
+   * @details a write that crosses a stripe boundary is split; the
+   *  completions of all parts are appended to completions
+   */
+  int AioWrite(uint64_t offset, librados::bufferlist& bl,
+               std::vector<librados::AioCompletion*>* completions) const {
+    uint64_t pos = 0;
+    while (pos < bl.length()) {
+      uint64_t off, n;
+      std::string part_oid = Locate(offset + pos, bl.length() - pos, &off, &n);
+      librados::bufferlist part;
+      part.substr_of(bl, pos, n);
+      librados::AioCompletion *c = librados::Rados::aio_create_completion();
+      int r = _io_ctx->aio_write(part_oid, c, part, n, off);
+      if (r < 0) {
+        c->release();
+        return r;
+      }
+      completions->push_back(c);
+      pos += n;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief record the size of the file in its first stripe without waiting
+   * @details the completion is appended to completions. The size is only a
+   *  hint: Stat() checks it against the last stripe before using it
+   */
+  int AioSetSize(uint64_t size,
+                 std::vector<librados::AioCompletion*>* completions) const {
+    if (Legacy()) {
+      return 0;
+    }
+    librados::bufferlist bl;
+    bl.append(std::to_string(size));
+    librados::ObjectWriteOperation op;
+    op.setxattr(SIZE_XATTR, bl);
+    librados::AioCompletion *c = librados::Rados::aio_create_completion();
+    int r = _io_ctx->aio_operate(oid(0), c, &op);
+    if (r < 0) {
+      c->release();
+      return r;
+    }
+    completions->push_back(c);
+    return 0;
+  }
+
+  /**
+   * @brief get the size and modification time of the file
+   * @details one round trip reads the first stripe's size and the size
+   *  cached with it, and at most two more check the cached size against
+   *  the last stripe. Without a usable cached size this probes for the last
+   *  stripe with an exponential then a binary search, so it costs
+   *  O(log(stripes)) stats
+   */
+  int Stat(uint64_t* size, time_t* mtime) const {
+    uint64_t last_size = 0;
+    time_t last_mtime = 0;
+    if (Legacy()) {
+      int r = _io_ctx->stat(_fid, size, &last_mtime);
+      if (mtime) {
+        *mtime = r < 0 ? 0 : last_mtime;
+      }
+      if (r < 0) {
+        *size = 0;
+      }
+      return r;
+    }
+    librados::ObjectReadOperation op;
+    librados::bufferlist cached;
+    int stat_r = 0, xattr_r = 0;
+    op.stat(&last_size, &last_mtime, &stat_r);
+    op.getxattr(SIZE_XATTR, &cached, &xattr_r);
+    op.set_op_flags2(LIBRADOS_OP_FLAG_FAILOK);
+    int r = _io_ctx->operate(oid(0), &op, nullptr);
+    if (r == 0) {
+      r = stat_r;
+    }
+    if (r < 0) {
+      *size = 0;
+      if (mtime) {
+        *mtime = 0;
+      }
+      return r;
+    }
+    if (xattr_r == 0 &&
+        _CheckSize(std::strtoull(cached.to_str().c_str(), nullptr, 10),
+                   last_size, last_mtime, size, mtime)) {
+      return 0;
+    }
+    // stripe lo exists, stripe hi does not
+    uint64_t lo = 0, hi = 1;
+    uint64_t probe_size;
+    time_t probe_mtime;
+    while (_io_ctx->stat(oid(hi), &probe_size, &probe_mtime) == 0) {
+      lo = hi;
+      last_size = probe_size;
+      last_mtime = probe_mtime;
+      hi *= 2;
+    }
+    while (hi - lo > 1) {
+      uint64_t mid = lo + (hi - lo) / 2;
+      if (_io_ctx->stat(oid(mid), &probe_size, &probe_mtime) == 0) {
+        lo = mid;
+        last_size = probe_size;
+        last_mtime = probe_mtime;
+      } else {
+        hi = mid;
+      }
+    }
+    *size = lo * _stripe_size + last_size;
+    if (mtime) {
+      *mtime = last_mtime;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief shrink the file from old_size to size
+   */
+  int Truncate(uint64_t size, uint64_t old_size) const {
+    if (Legacy()) {
+      return _io_ctx->trunc(_fid, size);
+    }
+    // stripes [keep, end) go away entirely
+    uint64_t keep = (size + _stripe_size - 1) / _stripe_size;
+    uint64_t end = (old_size + _stripe_size - 1) / _stripe_size;
+    for (uint64_t i = keep; i < end; i++) {
+      int r = _io_ctx->remove(oid(i));
+      if (r < 0 && r != -ENOENT) {
+        return r;
+      }
+    }
+    if (size % _stripe_size) {
+      int r = _io_ctx->trunc(oid(size / _stripe_size), size % _stripe_size);
+      if (r < 0) {
+        return r;
+      }
+    }
+    if (size > 0) {
+      librados::bufferlist bl;
+      bl.append(std::to_string(size));
+      return _io_ctx->setxattr(oid(0), SIZE_XATTR, bl);
+    }
+    return 0;
+  }
+
+  int Remove() const {
+    if (Legacy()) {
+      int r = _io_ctx->remove(_fid);
+      return r == -ENOENT ? 0 : r;
+    }
+    uint64_t size;
+    int r = Stat(&size, nullptr);
+    if (r == -ENOENT) {
+      return 0;
+    }
+    if (r < 0) {
+      return r;
+    }
+    // an empty file still has its first stripe
+    return Truncate(0, std::max<uint64_t>(size, 1));
+  }
+
+  size_t GetUniqueId(char* id, size_t max_size) const {
+    // All fid has the same db_id prefix, so we need to ignore db_id prefix
+    size_t s = std::min(max_size, _fid.size());
+    strncpy(id, _fid.c_str() + (_fid.size() - s), s);
+    id[s - 1] = '\0';
+    return s;
+  }
+};
+
+// A file abstraction for reading sequentially through a file
+class LibradosSequentialFile : public SequentialFile {
+  LibradosStriper _striper;
+  std::string _hint;
+  uint64_t _offset;
+
+  // readahead: _buffer holds [_buffer_offset, _buffer_offset + _buffer_len)
+  // and _ahead, when set, reads the window that follows it
+  const size_t _readahead_size;
+  std::unique_ptr<char[]> _buffer;
+  uint64_t _buffer_offset = 0;
+  size_t _buffer_len = 0;
+  std::unique_ptr<LibradosStriper::PendingRead> _ahead;
+  bool _eof = false;
+
+  void _StartReadahead() {
+    if (_readahead_size == 0 || _ahead || _eof) {
+      return;
+    }
+    _ahead.reset(new LibradosStriper::PendingRead);
+    _striper.StartRead(_buffer_offset + _buffer_len, _readahead_size, _ahead.get());
+  }
+
+  // wait for the readahead window and make it the buffer
+  int _FinishReadahead() {
+    uint64_t offset = _ahead->offset;
+    int r = _striper.FinishRead(_ahead.get(), _buffer.get());
+    _ahead.reset();
+    _buffer_offset = offset;
+    _buffer_len = r > 0 ? r : 0;
+    _eof = r >= 0 && (size_t)r < _readahead_size;
+    return r;
+  }
+
+public:
+  LibradosSequentialFile(librados::IoCtx * io_ctx, std::string fid, std::string hint,
+                         uint64_t stripe_size, size_t readahead_size):
+    _striper(io_ctx, fid, stripe_size), _hint(hint), _offset(0),
+    _readahead_size(readahead_size),
+    _buffer(new char[readahead_size]) {}
+
+  ~LibradosSequentialFile() {
+    // the pending aio_reads still refer to _ahead
+    if (_ahead) {
+      _striper.FinishRead(_ahead.get(), nullptr);
+    }
+  }
 
   /**
    * @brief read file
@@ -114,6 +493,9 @@ public:
    *  "scratch[0..n-1]" must be live when "*result" is used.
    *  If an error was encountered, returns a non-OK status.
    *
+   *  Reads are served from a readahead window of readahead_size bytes
+   *  while the aio_read of the next window is already in flight.
+   *
    *  REQUIRES: External synchronization
    *
    * @param n [description]
@@ -123,22 +505,63 @@ public:
    */
   Status Read(size_t n, Slice* result, char* scratch) {
     LOG_DEBUG("[IN]%i\n", (int)n);
-    librados::bufferlist buffer;
+    size_t done = 0;
+    int r = 0;
+    while (done < n) {
+      if (_offset >= _buffer_offset && _offset < _buffer_offset + _buffer_len) {
+        size_t len = std::min<uint64_t>(n - done, _buffer_offset + _buffer_len - _offset);
+        memcpy(scratch + done, _buffer.get() + (_offset - _buffer_offset), len);
+        done += len;
+        _offset += len;
+        continue;
+      }
+      if (_ahead && _ahead->offset == _offset) {
+        r = _FinishReadahead();
+        if (r <= 0) {
+          break;
+        }
+        continue;
+      }
+      if (_offset == _buffer_offset + _buffer_len && _eof) {
+        break;
+      }
+      // a Skip() left the window, or the caller reads more than it holds
+      if (_ahead) {
+        _striper.FinishRead(_ahead.get(), nullptr);
+        _ahead.reset();
+      }
+      _eof = false;
+      if (n - done >= _readahead_size) {
+        size_t want = n - done;
+        r = _striper.Read(_offset, want, scratch + done);
+        if (r < 0) {
+          break;
+        }
+        done += r;
+        _offset += r;
+        _buffer_offset = _offset;
+        _buffer_len = 0;
+        _eof = (size_t)r < want;
+        break;
+      }
+      _buffer_offset = _offset;
+      _buffer_len = 0;
+      _StartReadahead();
+      r = _FinishReadahead();
+      if (r <= 0) {
+        break;
+      }
+    }
     Status s;
-    int r = _io_ctx->read(_fid, buffer, n, _offset);
-    if (r >= 0) {
-      buffer.begin().copy(r, scratch);
-      *result = Slice(scratch, r);
-      _offset += r;
-      s = Status::OK();
-    } else {
+    if (r < 0) {
       s = err_to_status(r);
       if (s == Status::IOError()) {
-        *result = Slice();
         s = Status::OK();
       }
     }
-    LOG_DEBUG("[OUT]%s, %i, %s\n", s.ToString().c_str(), (int)r, buffer.c_str());
+    *result = Slice(scratch, done);
+    _StartReadahead();
+    LOG_DEBUG("[OUT]%s, %i\n", s.ToString().c_str(), (int)done);
     return s;
   }
 
@@ -179,12 +602,12 @@ public:
 
 // A file abstraction for randomly reading the contents of a file.
 class LibradosRandomAccessFile : public RandomAccessFile {
-  librados::IoCtx * _io_ctx;
-  std::string _fid;
+  LibradosStriper _striper;
   std::string _hint;
 public:
-  LibradosRandomAccessFile(librados::IoCtx * io_ctx, std::string fid, std::string hint):
-    _io_ctx(io_ctx), _fid(fid), _hint(hint) {}
+  LibradosRandomAccessFile(librados::IoCtx * io_ctx, std::string fid, std::string hint,
+                           uint64_t stripe_size):
+    _striper(io_ctx, fid, stripe_size), _hint(hint) {}
 
   ~LibradosRandomAccessFile() {}
 
@@ -201,11 +624,9 @@ public:
   Status Read(uint64_t offset, size_t n, Slice* result,
               char* scratch) const {
     LOG_DEBUG("[IN]%i\n", (int)n);
-    librados::bufferlist buffer;
     Status s;
-    int r = _io_ctx->read(_fid, buffer, n, offset);
+    int r = _striper.Read(offset, n, scratch);
     if (r >= 0) {
-      buffer.begin().copy(r, scratch);
       *result = Slice(scratch, r);
       s = Status::OK();
     } else {
@@ -215,10 +636,41 @@ public:
         s = Status::OK();
       }
     }
-    LOG_DEBUG("[OUT]%s, %i, %s\n", s.ToString().c_str(), (int)r, buffer.c_str());
+    LOG_DEBUG("[OUT]%s, %i\n", s.ToString().c_str(), (int)r);
     return s;
   }
 
+  /**
+   * @brief read several ranges at once
+   * @details all the aio_reads are issued before waiting for any of them,
+   *  so a MultiGet pays one round trip instead of one per block
+   *
+   * @param reqs [description]
+   * @param num_reqs [description]
+   * @return [description]
+   */
+  Status MultiRead(ReadRequest* reqs, size_t num_reqs) {
+    std::vector<LibradosStriper::PendingRead> ops(num_reqs);
+    std::vector<int> started(num_reqs);
+    for (size_t i = 0; i < num_reqs; i++) {
+      started[i] = _striper.StartRead(reqs[i].offset, reqs[i].len, &ops[i]);
+    }
+    for (size_t i = 0; i < num_reqs; i++) {
+      int r = _striper.FinishRead(&ops[i], reqs[i].scratch);
+      if (started[i] < 0) {
+        r = started[i];
+      }
+      if (r >= 0) {
+        reqs[i].result = Slice(reqs[i].scratch, r);
+        reqs[i].status = Status::OK();
+      } else {
+        reqs[i].result = Slice();
+        reqs[i].status = err_to_status(r);
+      }
+    }
+    return Status::OK();
+  }
+
   /**
    * @brief [brief description]
    * @details Get unique id for each file and guarantee this id is different for each file
@@ -229,11 +681,7 @@ public:
    * @return [description]
    */
   size_t GetUniqueId(char* id, size_t max_size) const {
-    // All fid has the same db_id prefix, so we need to ignore db_id prefix
-    size_t s = std::min(max_size, _fid.size());
-    strncpy(id, _fid.c_str() + (_fid.size() - s), s);
-    id[s - 1] = '\0';
-    return s;
+    return _striper.GetUniqueId(id, max_size);
   };
 
   //enum AccessPattern { NORMAL, RANDOM, SEQUENTIAL, WILLNEED, DONTNEED };
@@ -259,35 +707,105 @@ public:
 // A file abstraction for sequential writing.  The implementation
 // must provide buffering since callers may append small fragments
 // at a time to the file.
+//
+// Full buffers are written with aio and not waited for; Sync() waits for
+// all of them. Concurrent Sync() calls are group committed: one caller
+// waits for the writes in flight while the others queue behind it, and a
+// caller whose data was covered by that wait returns without another
+// round trip.
 class LibradosWritableFile : public WritableFile {
-  librados::IoCtx * _io_ctx;
-  std::string _fid;
+  LibradosStriper _striper;
   std::string _hint;
   const EnvLibrados * const _env;
 
   std::mutex _mutex;                 // used to protect modification of all following variables
+  std::condition_variable _cond;     // signalled when a group commit ends
   librados::bufferlist _buffer;      // write buffer
   uint64_t _buffer_size;             // write buffer size
   uint64_t _file_size;               // this file size doesn't include buffer size
+  uint64_t _synced_size;             // bytes known to be durable
+  std::vector<librados::AioCompletion*> _inflight;
+  bool _syncing;                     // a group commit leader is waiting
+  int _error;                        // first failed write, sticky
+
+  // writes kept in flight before Append() waits for the oldest ones
+  static const size_t MAX_INFLIGHT = 16;
+
+  static int _Wait(std::vector<librados::AioCompletion*>& completions) {
+    int ret = 0;
+    for (auto c : completions) {
+      c->wait_for_complete();
+      int r = c->get_return_value();
+      c->release();
+      if (r < 0 && ret == 0) {
+        ret = r;
+      }
+    }
+    completions.clear();
+    return ret;
+  }
 
   /**
    * @brief assuming caller holds lock
-   * @details [long description]
+   * @details start writing the buffer to RADOS
    * @return [description]
    */
-  int _SyncLocked() {
-    // 1. sync append data to RADOS
-    int r = _io_ctx->append(_fid, _buffer, _buffer_size);
-    assert(r >= 0);
-
-    // 2. update local variables
-    if (0 == r) {
-      _buffer.clear();
-      _file_size += _buffer_size;
-      _buffer_size = 0;
+  int _FlushLocked() {
+    if (_error < 0 || _buffer_size == 0) {
+      return _error;
+    }
+    int r = _striper.AioWrite(_file_size, _buffer, &_inflight);
+    if (r < 0) {
+      _error = r;
+      return r;
+    }
+    _buffer.clear();
+    _file_size += _buffer_size;
+    _buffer_size = 0;
+
+    if (!_syncing && _inflight.size() > MAX_INFLIGHT) {
+      // nobody will wait for these soon, so bound them here
+      r = _Wait(_inflight);
+      if (r < 0) {
+        _error = r;
+      }
     }
+    return _error;
+  }
 
-    return r;
+  /**
+   * @brief assuming caller holds lock
+   * @details write the buffer and wait until everything written so far is
+   *  durable, as group commit leader or follower
+   * @return [description]
+   */
+  int _SyncLocked(std::unique_lock<std::mutex>& lock) {
+    _FlushLocked();
+    const uint64_t target = _file_size;
+    while (_error == 0 && _synced_size < target) {
+      if (_syncing) {
+        _cond.wait(lock);
+        continue;
+      }
+      _syncing = true;
+      const uint64_t end = _file_size;
+      std::vector<librados::AioCompletion*> batch;
+      batch.swap(_inflight);
+      if (int r = _striper.AioSetSize(end, &batch); r < 0) {
+        _error = r;
+      }
+      lock.unlock();
+      int r = _Wait(batch);
+      lock.lock();
+      _syncing = false;
+      if (r < 0) {
+        _error = r;
+      } else {
+        _synced_size = std::max(_synced_size, end);
+      }
+      _cond.notify_all();
+    }
+    return _error;
   }
 
  public:
@@ -295,19 +813,17 @@ class LibradosWritableFile : public WritableFile {
                        std::string hint, const EnvLibrados* const env,
                        const EnvOptions& options)
       : WritableFile(options),
-        _io_ctx(io_ctx),
-        _fid(fid),
+        _striper(io_ctx, fid, env->_stripe_size),
         _hint(hint),
         _env(env),
         _buffer(),
         _buffer_size(0),
-        _file_size(0) {
-    int ret = _io_ctx->stat(_fid, &_file_size, nullptr);
-
-    // if file not exist
-    if (ret < 0) {
-      _file_size = 0;
-    }
+        _file_size(0),
+        _syncing(false),
+        _error(0) {
+    // if file not exist, the size is 0
+    _striper.Stat(&_file_size, nullptr);
+    _synced_size = _file_size;
   }
 
   ~LibradosWritableFile() {
@@ -319,7 +835,8 @@ class LibradosWritableFile : public WritableFile {
    * @brief append data to file
    * @details
    *  Append will save all written data in buffer util buffer size
-   *  reaches buffer max size. Then, it will write buffer into rados
+   *  reaches buffer max size. Then, it will start writing the buffer
+   *  into rados without waiting for it
    *
    * @param data [description]
    * @return [description]
@@ -330,11 +847,14 @@ class LibradosWritableFile : public WritableFile {
     int r = 0;
 
     std::lock_guard<std::mutex> lock(_mutex);
+    if (_error < 0) {
+      return err_to_status(_error);
+    }
     _buffer.append(data.data(), data.size());
     _buffer_size += data.size();
 
     if (_buffer_size > _env->_write_buffer_size) {
-      r = _SyncLocked();
+      r = _FlushLocked();
     }
 
     LOG_DEBUG("[OUT] %i\n", r);
@@ -363,14 +883,19 @@ class LibradosWritableFile : public WritableFile {
     LOG_DEBUG("[IN]%lld|%lld|%lld\n", (long long)size, (long long)_file_size, (long long)_buffer_size);
     int r = 0;
 
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::unique_lock<std::mutex> lock(_mutex);
     if (_file_size > size) {
-      r = _io_ctx->trunc(_fid, size);
+      // no write may land behind the truncation
+      r = _SyncLocked(lock);
+      if (r == 0) {
+        r = _striper.Truncate(size, _file_size);
+      }
 
       if (r == 0) {
         _buffer.clear();
         _buffer_size = 0;
         _file_size = size;
+        _synced_size = std::min(_synced_size, size);
       }
     } else if (_file_size == size) {
       _buffer.clear();
@@ -403,37 +928,18 @@ class LibradosWritableFile : public WritableFile {
    * @return [description]
    */
   Status Flush() {
-    librados::AioCompletion *write_completion = librados::Rados::aio_create_completion();
-    int r = 0;
-
     std::lock_guard<std::mutex> lock(_mutex);
-    r = _io_ctx->aio_append(_fid, write_completion, _buffer, _buffer_size);
-
-    if (0 == r) {
-      _file_size += _buffer_size;
-      _buffer.clear();
-      _buffer_size = 0;
-    }
-
-    write_completion->release();
-
-    return err_to_status(r);
+    return err_to_status(_FlushLocked());
   }
 
   /**
    * @brief write buffer data to rados
-   * @details initiate an aio write and wait for result
+   * @details initiate an aio write and wait for it and every earlier one
    * @return [description]
    */
   Status Sync() { // sync data
-    int r = 0;
-
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_buffer_size > 0) {
-      r = _SyncLocked();
-    }
-
-    return err_to_status(r);
+    std::unique_lock<std::mutex> lock(_mutex);
+    return err_to_status(_SyncLocked(lock));
   }
 
   /**
@@ -464,9 +970,7 @@ class LibradosWritableFile : public WritableFile {
     LOG_DEBUG("%lld|%lld\n", (long long)_buffer_size, (long long)_file_size);
 
     std::lock_guard<std::mutex> lock(_mutex);
-    int file_size = _file_size + _buffer_size;
-
-    return file_size;
+    return _file_size + _buffer_size;
   }
 
   /**
@@ -479,11 +983,7 @@ class LibradosWritableFile : public WritableFile {
    * @return [description]
    */
   size_t GetUniqueId(char* id, size_t max_size) const {
-    // All fid has the same db_id prefix, so we need to ignore db_id prefix
-    size_t s = std::min(max_size, _fid.size());
-    strncpy(id, _fid.c_str() + (_fid.size() - s), s);
-    id[s - 1] = '\0';
-    return s;
+    return _striper.GetUniqueId(id, max_size);
   }
 
   /**
@@ -552,22 +1052,29 @@ class LibradosFileLock : public FileLock {
   const std::string _obj_name;
   const std::string _lock_name;
   const std::string _cookie;
-  int lock_state;
 public:
   LibradosFileLock(
     librados::IoCtx * io_ctx,
-    const std::string obj_name):
+    const std::string obj_name,
+    const std::string cookie):
     _io_ctx(io_ctx),
     _obj_name(obj_name),
     _lock_name("lock_name"),
-    _cookie("cookie") {
+    _cookie(cookie) {}
 
-    // TODO: the lock will never expire. It may cause problem if the process crash or abnormally exit.
-    while (!_io_ctx->lock_exclusive(
+  /**
+   * @brief take the lock without waiting
+   * @details
+   *  TODO: the lock will never expire. It may cause problem if the process
+   *  crash or abnormally exit; "rados lock break" releases it.
+   * @return 0, or -EBUSY if another client holds it
+   */
+  int Lock() {
+    return _io_ctx->lock_exclusive(
              _obj_name,
              _lock_name,
              _cookie,
-             "description", nullptr, 0));
+             "cabindb", nullptr, 0);
   }
 
   ~LibradosFileLock() {
@@ -597,7 +1104,9 @@ EnvLibrados::EnvLibrados(const std::string& db_name,
                 db_pool,
                 "/wal",
                 db_pool,
-                1 << 20) {}
+                1 << 20,
+                4 << 20,
+                2 << 20) {}
 
 /**
  * @brief EnvLibrados ctor
@@ -611,6 +1120,8 @@ EnvLibrados::EnvLibrados(const std::string& db_name,
  * @param db_pool the pool  for db data
  * @param wal_pool the pool for WAL data
  * @param write_buffer_size WritableFile buffer max size
+ * @param stripe_size       bytes of a file stored in each RADOS object
+ * @param readahead_size    SequentialFile readahead window, 0 disables it
  */
 EnvLibrados::EnvLibrados(const std::string& client_name,
                          const std::string& cluster_name,
@@ -620,7 +1131,9 @@ EnvLibrados::EnvLibrados(const std::string& client_name,
                          const std::string& db_pool,
                          const std::string& wal_dir,
                          const std::string& wal_pool,
-                         const uint64_t write_buffer_size)
+                         const uint64_t write_buffer_size,
+                         const uint64_t stripe_size,
+                         const uint64_t readahead_size)
   : EnvWrapper(Env::Default()),
     _client_name(client_name),
     _cluster_name(cluster_name),
@@ -630,7 +1143,9 @@ EnvLibrados::EnvLibrados(const std::string& client_name,
     _db_pool_name(db_pool),
     _wal_dir(wal_dir),
     _wal_pool_name(wal_pool),
-    _write_buffer_size(write_buffer_size) {
+    _write_buffer_size(write_buffer_size),
+    _stripe_size(stripe_size ? stripe_size : 4 << 20),
+    _readahead_size(readahead_size) {
   int ret = 0;
 
   // 1. create a Rados object and initialize it
@@ -915,7 +1430,8 @@ Status EnvLibrados::NewSequentialFile(
       break;
     }
 
-    result->reset(new LibradosSequentialFile(_GetIoctx(fpath), fid, fpath));
+    result->reset(new LibradosSequentialFile(_GetIoctx(fpath), fid, fpath,
+                                             _stripe_size, _readahead_size));
     s = Status::OK();
   } while (0);
 
@@ -958,7 +1474,8 @@ Status EnvLibrados::NewRandomAccessFile(
       break;
     }
 
-    result->reset(new LibradosRandomAccessFile(_GetIoctx(fpath), fid, fpath));
+    result->reset(new LibradosRandomAccessFile(_GetIoctx(fpath), fid, fpath,
+                                               _stripe_size));
     s = Status::OK();
   } while (0);
 
@@ -1049,6 +1566,11 @@ Status EnvLibrados::ReuseWritableFile(
       break;
     }
 
+    r = _GetFid(dst_fpath, src_fid);
+    if (!r.ok()) {
+      break;
+    }
+
     result->reset(new LibradosWritableFile(_GetIoctx(dst_fpath), src_fid,
                                            dst_fpath, this, options));
   } while (0);
@@ -1172,7 +1694,14 @@ Status EnvLibrados::DeleteFile(const std::string& fname)
   Status s = _GetFid(dir + "/" + file, fid);
 
   if (s.ok() && DIR_ID_VALUE != fid) {
-    s = _DelFid(dir + "/" + file);
+    std::string fpath = dir + "/" + file;
+    // drop the name first: a crash in between leaks objects rather than
+    // leaving a name without its data
+    s = _DelFid(fpath);
+    if (s.ok()) {
+      s = err_to_status(
+        LibradosStriper(_GetIoctx(fpath), fid, _stripe_size).Remove());
+    }
   } else {
     s = Status::NotFound();
   }
@@ -1295,7 +1824,7 @@ Status EnvLibrados::GetFileSize(
       break;
     }
 
-    int ret = _GetIoctx(fpath)->stat(fid, file_size, &mtime);
+    int ret = LibradosStriper(_GetIoctx(fpath), fid, _stripe_size).Stat(file_size, &mtime);
     if (ret < 0) {
       LOG_DEBUG("%i\n", ret);
       if (-ENOENT == ret) {
@@ -1339,15 +1868,17 @@ Status EnvLibrados::GetFileModificationTime(const std::string& fname,
       break;
     }
 
-    int ret = _GetIoctx(fpath)->stat(fid, &file_size, &mtime);
+    int ret = LibradosStriper(_GetIoctx(fpath), fid, _stripe_size).Stat(&file_size, &mtime);
     if (ret < 0) {
-      if (Status::NotFound() == err_to_status(ret)) {
-        *file_mtime = static_cast<uint64_t>(mtime);
+      if (-ENOENT == ret) {
+        // created but never written
+        *file_mtime = 0;
         s = Status::OK();
       } else {
         s = err_to_status(ret);
       }
     } else {
+      *file_mtime = static_cast<uint64_t>(mtime);
       s = Status::OK();
     }
   } while (0);
@@ -1374,8 +1905,16 @@ Status EnvLibrados::RenameFile(
   split(src, &src_dir, &src_file);
   split(target_in, &dst_dir, &dst_file);
 
-  auto s = _RenameFid(src_dir + "/" + src_file,
-                      dst_dir + "/" + dst_file);
+  // the file replaced by the rename, if any, has to go with its objects
+  std::string dst_fpath = dst_dir + "/" + dst_file;
+  std::string dst_fid;
+  bool replaced = _GetFid(dst_fpath, dst_fid).ok() && dst_fid != DIR_ID_VALUE;
+
+  auto s = _RenameFid(src_dir + "/" + src_file, dst_fpath);
+  if (s.ok() && replaced) {
+    s = err_to_status(
+      LibradosStriper(_GetIoctx(dst_fpath), dst_fid, _stripe_size).Remove());
+  }
   LOG_DEBUG("[OUT]%s\n", s.ToString().c_str());
   return s;
 }
@@ -1441,7 +1980,15 @@ Status EnvLibrados::LockFile(
       break;
     }
 
-    *lock = new LibradosFileLock(_GetIoctx(fpath), fpath);
+    // the cookie tells this Env apart from every other client
+    auto l = new LibradosFileLock(_GetIoctx(fpath), fpath, GenerateUniqueId());
+    int r = l->Lock();
+    if (r < 0) {
+      delete l;
+      s = Status::IOError("lock " + fpath, strerror(-r));
+      break;
+    }
+    *lock = l;
   } while (0);
 
   LOG_DEBUG("[OUT]%s\n", s.ToString().c_str());
@@ -15,7 +15,8 @@
 #include "include/cabindb/slice.h"
 #include "include/cabindb/options.h"
 #include "util/random.h"
-src/cabindb/utilities/debug.cc#include <chrono>
+#include <thread>
+#include <chrono>
 #include <ostream>
 #include "include/cabindb/utilities/transaction_db.h"
 
@@ -328,6 +329,235 @@ TEST_F(EnvLibradosTest, Truncate) {
   writable_file.reset();
 }
 
+TEST_F(EnvLibradosTest, Striping) {
+  // 64KB stripes and a 16KB readahead window, so every path below crosses
+  // object boundaries
+  const uint64_t kStripeSize = 64 * 1024;
+  std::unique_ptr<EnvLibrados> env(new EnvLibrados(
+    "client.admin", "ceph", 0, db_name, config, db_pool, "/wal", db_pool,
+    8 * 1024, kStripeSize, 16 * 1024));
+  const size_t kWriteSize = 300 * 1024;
+  Random rnd(301);
+  std::string write_data;
+  for (size_t i = 0; i < kWriteSize; ++i) {
+    write_data.push_back('a' + rnd.Uniform(26));
+  }
+
+  std::unique_ptr<WritableFile> writable_file;
+  ASSERT_OK(env->CreateDir("/dir"));
+  ASSERT_OK(env->NewWritableFile("/dir/s", &writable_file, soptions_));
+  for (size_t i = 0; i < kWriteSize; i += 7 * 1024) {
+    ASSERT_OK(writable_file->Append(Slice(write_data.data() + i,
+                                          std::min<size_t>(7 * 1024, kWriteSize - i))));
+  }
+  ASSERT_OK(writable_file->Sync());
+  writable_file.reset();
+
+  uint64_t file_size;
+  ASSERT_OK(env->GetFileSize("/dir/s", &file_size));
+  ASSERT_EQ(kWriteSize, file_size);
+
+  // sequential reads through the readahead window
+  std::unique_ptr<SequentialFile> seq_file;
+  Slice result;
+  std::unique_ptr<char[]> scratch(new char[kWriteSize]);
+  ASSERT_OK(env->NewSequentialFile("/dir/s", &seq_file, soptions_));
+  std::string read_data;
+  while (true) {
+    ASSERT_OK(seq_file->Read(5000, &result, scratch.get()));
+    if (result.empty()) {
+      break;
+    }
+    read_data.append(result.data(), result.size());
+  }
+  ASSERT_TRUE(write_data == read_data);
+
+  // random and multi reads across stripe boundaries
+  std::unique_ptr<RandomAccessFile> rand_file;
+  ASSERT_OK(env->NewRandomAccessFile("/dir/s", &rand_file, soptions_));
+  ASSERT_OK(rand_file->Read(kStripeSize - 100, 200, &result, scratch.get()));
+  ASSERT_EQ(write_data.substr(kStripeSize - 100, 200), result.ToString());
+  ASSERT_OK(rand_file->Read(kWriteSize - 100, 1000, &result, scratch.get()));
+  ASSERT_EQ(write_data.substr(kWriteSize - 100), result.ToString());
+
+  ReadRequest reqs[3];
+  const uint64_t offsets[3] = {0, 2 * kStripeSize - 10, 4 * kStripeSize + 5};
+  for (int i = 0; i < 3; i++) {
+    reqs[i].offset = offsets[i];
+    reqs[i].len = 1000;
+    reqs[i].scratch = scratch.get() + i * 1000;
+  }
+  ASSERT_OK(rand_file->MultiRead(reqs, 3));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(reqs[i].status);
+    ASSERT_EQ(write_data.substr(offsets[i], 1000), reqs[i].result.ToString());
+  }
+
+  // truncating into the middle of a stripe drops the stripes after it
+  ASSERT_OK(env->NewWritableFile("/dir/s", &writable_file, soptions_));
+  ASSERT_EQ(kWriteSize, writable_file->GetFileSize());
+  ASSERT_OK(writable_file->Truncate(kStripeSize + 10));
+  writable_file.reset();
+  ASSERT_OK(env->GetFileSize("/dir/s", &file_size));
+  ASSERT_EQ(kStripeSize + 10, file_size);
+
+  ASSERT_OK(env->DeleteFile("/dir/s"));
+  ASSERT_EQ(Status::NotFound(), env->FileExists("/dir/s"));
+}
+
+TEST_F(EnvLibradosTest, GroupCommit) {
+  std::unique_ptr<WritableFile> writable_file;
+  ASSERT_OK(env_->CreateDir("/wal"));
+  ASSERT_OK(env_->NewWritableFile("/wal/log", &writable_file, soptions_));
+
+  // writers append and sync concurrently; every sync must cover the data
+  // its thread appended before it
+  const int kThreads = 4;
+  const int kRecords = 200;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      std::string record(100, 'a' + t);
+      for (int i = 0; i < kRecords; i++) {
+        ASSERT_OK(writable_file->Append(record));
+        ASSERT_OK(writable_file->Sync());
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  writable_file.reset();
+
+  uint64_t file_size;
+  ASSERT_OK(env_->GetFileSize("/wal/log", &file_size));
+  ASSERT_EQ(uint64_t{kThreads} * kRecords * 100, file_size);
+}
+
+TEST_F(EnvLibradosTest, LegacyLayout) {
+  Random rnd(301);
+  std::string data;
+  for (size_t i = 0; i < 10000; ++i) {
+    data.push_back('a' + rnd.Uniform(26));
+  }
+
+  std::unique_ptr<WritableFile> writable_file;
+  ASSERT_OK(env_->CreateDir("/dir"));
+  ASSERT_OK(env_->NewWritableFile("/dir/old", &writable_file, soptions_));
+  ASSERT_OK(writable_file->Append(data));
+  ASSERT_OK(writable_file->Sync());
+  writable_file.reset();
+
+  // move the only stripe "<fid>.0000000000000000" of the file to "<fid>",
+  // the single object a file was before files were striped
+  librados::Rados rados;
+  ASSERT_EQ(0, rados.init("admin"));
+  ASSERT_EQ(0, rados.conf_read_file(config));
+  ASSERT_EQ(0, rados.connect());
+  librados::IoCtx ioctx;
+  ASSERT_EQ(0, rados.ioctx_create(db_pool.c_str(), ioctx));
+  const std::string suffix = ".0000000000000000";
+  std::string stripe;
+  for (auto it = ioctx.nobjects_begin(); it != ioctx.nobjects_end(); ++it) {
+    const std::string& oid = it->get_oid();
+    if (oid.size() > suffix.size() &&
+        oid.compare(oid.size() - suffix.size(), suffix.size(), suffix) == 0) {
+      stripe = oid;
+    }
+  }
+  ASSERT_FALSE(stripe.empty());
+  const std::string legacy = stripe.substr(0, stripe.size() - suffix.size());
+  librados::bufferlist bl;
+  ASSERT_EQ((int)data.size(), ioctx.read(stripe, bl, 2 * data.size(), 0));
+  ASSERT_EQ(0, ioctx.write_full(legacy, bl));
+  ASSERT_EQ(0, ioctx.remove(stripe));
+
+  uint64_t file_size;
+  ASSERT_OK(env_->GetFileSize("/dir/old", &file_size));
+  ASSERT_EQ(data.size(), file_size);
+
+  std::unique_ptr<RandomAccessFile> rand_file;
+  Slice result;
+  char scratch[100];
+  ASSERT_OK(env_->NewRandomAccessFile("/dir/old", &rand_file, soptions_));
+  ASSERT_OK(rand_file->Read(5000, 100, &result, scratch));
+  ASSERT_EQ(data.substr(5000, 100), result.ToString());
+  rand_file.reset();
+
+  // the file keeps its layout, and deleting it removes the single object
+  ASSERT_OK(env_->DeleteFile("/dir/old"));
+  uint64_t size;
+  time_t mtime;
+  ASSERT_EQ(-ENOENT, ioctx.stat(legacy, &size, &mtime));
+  ASSERT_EQ(-ENOENT, ioctx.stat(stripe, &size, &mtime));
+  ioctx.close();
+  rados.shutdown();
+}
+
+TEST_F(EnvLibradosTest, CachedSize) {
+  const uint64_t kStripeSize = 64 * 1024;
+  std::unique_ptr<EnvLibrados> env(new EnvLibrados(
+    "client.admin", "ceph", 0, db_name, config, db_pool, "/wal", db_pool,
+    8 * 1024, kStripeSize, 16 * 1024));
+  const size_t kWriteSize = 3 * kStripeSize + kStripeSize / 2;
+
+  std::unique_ptr<WritableFile> writable_file;
+  ASSERT_OK(env->CreateDir("/dir"));
+  ASSERT_OK(env->NewWritableFile("/dir/c", &writable_file, soptions_));
+  ASSERT_OK(writable_file->Append(std::string(kWriteSize, 'c')));
+  ASSERT_OK(writable_file->Sync());
+  writable_file.reset();
+
+  // the first stripe of the only file in the pool records its size
+  librados::Rados rados;
+  ASSERT_EQ(0, rados.init("admin"));
+  ASSERT_EQ(0, rados.conf_read_file(config));
+  ASSERT_EQ(0, rados.connect());
+  librados::IoCtx ioctx;
+  ASSERT_EQ(0, rados.ioctx_create(db_pool.c_str(), ioctx));
+  const std::string suffix = ".0000000000000000";
+  std::string stripe;
+  for (auto it = ioctx.nobjects_begin(); it != ioctx.nobjects_end(); ++it) {
+    const std::string& oid = it->get_oid();
+    if (oid.size() > suffix.size() &&
+        oid.compare(oid.size() - suffix.size(), suffix.size(), suffix) == 0) {
+      stripe = oid;
+    }
+  }
+  ASSERT_FALSE(stripe.empty());
+  librados::bufferlist bl;
+  ASSERT_LT(0, ioctx.getxattr(stripe, "cabindb.size", bl));
+  ASSERT_EQ(std::to_string(kWriteSize), bl.to_str());
+  uint64_t file_size;
+  ASSERT_OK(env->GetFileSize("/dir/c", &file_size));
+  ASSERT_EQ(kWriteSize, file_size);
+
+  // a size that does not match the stripes is not trusted
+  for (uint64_t stale : {uint64_t{0}, kStripeSize, 2 * kStripeSize + 10,
+                         kWriteSize + 10}) {
+    bl.clear();
+    bl.append(std::to_string(stale));
+    ASSERT_EQ(0, ioctx.setxattr(stripe, "cabindb.size", bl));
+    ASSERT_OK(env->GetFileSize("/dir/c", &file_size));
+    ASSERT_EQ(kWriteSize, file_size);
+  }
+  ASSERT_EQ(0, ioctx.rmxattr(stripe, "cabindb.size"));
+  ASSERT_OK(env->GetFileSize("/dir/c", &file_size));
+  ASSERT_EQ(kWriteSize, file_size);
+
+  // truncating records the new size
+  ASSERT_OK(env->NewWritableFile("/dir/c", &writable_file, soptions_));
+  ASSERT_OK(writable_file->Truncate(kStripeSize));
+  writable_file.reset();
+  bl.clear();
+  ASSERT_LT(0, ioctx.getxattr(stripe, "cabindb.size", bl));
+  ASSERT_EQ(std::to_string(kStripeSize), bl.to_str());
+  ASSERT_OK(env->GetFileSize("/dir/c", &file_size));
+  ASSERT_EQ(kStripeSize, file_size);
+  ioctx.close();
+  rados.shutdown();
+}
+
 TEST_F(EnvLibradosTest, DBBasics) {
   std::string kDBPath = "/tmp/DBBasics";
   DB* db;
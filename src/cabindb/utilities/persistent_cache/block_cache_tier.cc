@@ -6,6 +6,8 @@
 
 #include "utilities/persistent_cache/block_cache_tier.h"
 
+#include <algorithm>
+#include <cinttypes>
 #include <regex>
 #include <utility>
 #include <vector>
@@ -47,14 +49,30 @@ Status BlockCacheTier::Open() {
   // Create base/<cache dir> directory
   status = opt_.env->CreateDir(GetCachePath());
   if (!status.ok()) {
-    // directory already exists, clean it up
-    status = CleanupCacheFolder(GetCachePath());
-    assert(status.ok());
+    // directory already exists, keep its blocks if they were cached for the
+    // same identity, clean it up otherwise
+    if (opt_.identity.empty() || !RecoverCacheFolder(GetCachePath()).ok()) {
+      metadata_.Clear();
+      size_ = 0;
+      status = CleanupCacheFolder(GetCachePath());
+      assert(status.ok());
+      if (!status.ok()) {
+        Error(opt_.log, "Error creating directory %s. %s", opt_.path.c_str(),
+              status.ToString().c_str());
+        return status;
+      }
+    }
+  }
+
+  if (!opt_.identity.empty()) {
+    status = WriteMeta();
     if (!status.ok()) {
-      Error(opt_.log, "Error creating directory %s. %s", opt_.path.c_str(),
+      Error(opt_.log, "Error writing %s. %s", GetMetaPath().c_str(),
             status.ToString().c_str());
       return status;
     }
+  } else {
+    opt_.env->DeleteFile(GetMetaPath()).PermitUncheckedError();
   }
 
   // create a new file
@@ -116,6 +134,106 @@ Status BlockCacheTier::CleanupCacheFolder(const std::string& folder) {
   return Status::OK();
 }
 
+Status BlockCacheTier::RecoverCacheFolder(const std::string& folder) {
+  lock_.AssertHeld();
+
+  // META holds the identity and the epoch of the last open
+  std::string meta;
+  Status status = ReadFileToString(opt_.env, GetMetaPath(), &meta);
+  if (!status.ok()) {
+    return status;
+  }
+  const size_t eol = meta.find('\n');
+  if (eol == std::string::npos || meta.substr(0, eol) != opt_.identity) {
+    Info(opt_.log, "Cache %s was not written for %s", opt_.path.c_str(),
+         opt_.identity.c_str());
+    return Status::NotFound("cache identity mismatch");
+  }
+  epoch_ = strtoull(meta.c_str() + eol + 1, nullptr, 10);
+
+  std::vector<std::string> files;
+  status = opt_.env->GetChildren(folder, &files);
+  if (!status.ok()) {
+    return status;
+  }
+  std::vector<uint32_t> ids;
+  for (const auto& file : files) {
+    if (!IsCacheFile(file)) {
+      continue;
+    }
+    char* end = nullptr;
+    const unsigned long id = strtoul(file.c_str(), &end, 10);
+    if (end != file.c_str() + file.find('.')) {
+      opt_.env->DeleteFile(folder + "/" + file).PermitUncheckedError();
+      continue;
+    }
+    ids.push_back(static_cast<uint32_t>(id));
+    writer_cache_id_ = std::max(writer_cache_id_, ids.back() + 1);
+  }
+
+  // Newest files first, so that what no longer fits in the cache is the
+  // oldest data; a key cached twice keeps its newest copy.
+  std::sort(ids.rbegin(), ids.rend());
+  const uint64_t limit = opt_.cache_size * (100 - kEvictPct) / 100;
+  std::vector<std::unique_ptr<RandomAccessCacheFile>> recovered;
+  for (const uint32_t id : ids) {
+    std::unique_ptr<RandomAccessCacheFile> f(
+        new RandomAccessCacheFile(opt_.env, folder, id, opt_.log));
+    uint64_t file_size = 0;
+    std::vector<std::pair<std::string, LBA>> blocks;
+    if (!opt_.env->GetFileSize(f->Path(), &file_size).ok() ||
+        size_ + file_size > limit || !f->Open(opt_.enable_direct_reads) ||
+        !f->Recover(file_size, &blocks) || blocks.empty()) {
+      Info(opt_.log, "Dropping cache file %s", f->Path().c_str());
+      f.reset();
+      opt_.env->DeleteFile(folder + "/" + std::to_string(id) + ".rc")
+          .PermitUncheckedError();
+      continue;
+    }
+
+    for (const auto& block : blocks) {
+      BlockInfo* info = metadata_.Insert(block.first, block.second);
+      if (info) {
+        f->Add(info);
+        stats_.recovered_blocks_++;
+        stats_.recovered_bytes_ += block.second.size_;
+      }
+    }
+    size_ += file_size;
+    recovered.push_back(std::move(f));
+  }
+
+  // oldest first, they are the first to be evicted
+  for (auto it = recovered.rbegin(); it != recovered.rend(); ++it) {
+    bool ok = metadata_.Insert(it->get());
+    assert(ok);
+    (void)ok;
+    it->release();
+  }
+
+  Info(opt_.log,
+       "Recovered %" PRIu64 " blocks (%" PRIu64 " bytes) from %" CABINDB_PRIszt
+       " cache files",
+       stats_.recovered_blocks_, stats_.recovered_bytes_, recovered.size());
+  return Status::OK();
+}
+
+Status BlockCacheTier::WriteMeta() {
+  epoch_++;
+  const std::string meta = opt_.identity + "\n" + std::to_string(epoch_) + "\n";
+  const std::string tmp = GetMetaPath() + ".tmp";
+  Status status = WriteStringToFile(opt_.env, meta, tmp, /*should_sync=*/true);
+  if (status.ok()) {
+    status = opt_.env->RenameFile(tmp, GetMetaPath());
+  }
+  return status;
+}
+
+uint64_t BlockCacheTier::NewId() {
+  // ids handed out by an earlier open may still name cached blocks
+  return (epoch_ << 32) | PersistentCacheTier::NewId();
+}
+
 Status BlockCacheTier::Close() {
   // stop the insert thread
   if (opt_.pipeline_writes && insert_th_.joinable()) {
@@ -165,6 +283,11 @@ PersistentCache::StatsType BlockCacheTier::Stats() {
       stats_.read_miss_latency_.Average());
   Add(&stats, "persistentcache.blockcachetier.write_latency",
       stats_.write_latency_.Average());
+  Add(&stats, "persistentcache.blockcachetier.recovered_blocks",
+      stats_.recovered_blocks_);
+  Add(&stats, "persistentcache.blockcachetier.recovered_bytes",
+      stats_.recovered_bytes_);
+  Add(&stats, "persistentcache.blockcachetier.size", size_.load());
 
   auto out = PersistentCacheTier::Stats();
   out.push_back(stats);
@@ -395,12 +518,25 @@ Status NewPersistentCache(Env* const env, const std::string& path,
                           const std::shared_ptr<Logger>& log,
                           const bool optimized_for_nvm,
                           std::shared_ptr<PersistentCache>* cache) {
+  PersistentCacheTierOptions options;
+  options.optimized_for_nvm = optimized_for_nvm;
+  return NewPersistentCache(env, path, size, log, options, cache);
+}
+
+Status NewPersistentCache(Env* const env, const std::string& path,
+                          const uint64_t size,
+                          const std::shared_ptr<Logger>& log,
+                          const PersistentCacheTierOptions& options,
+                          std::shared_ptr<PersistentCache>* cache) {
   if (!cache) {
     return Status::IOError("invalid argument cache");
   }
 
   auto opt = PersistentCacheConfig(env, path, size, log);
-  if (optimized_for_nvm) {
+  opt.cache_file_size = options.file_size;
+  opt.pipeline_writes = options.pipeline_writes;
+  opt.identity = options.identity;
+  if (options.optimized_for_nvm) {
     // the default settings are optimized for SSD
     // NVM devices are better accessed with 4K direct IO and written with
     // parallelism
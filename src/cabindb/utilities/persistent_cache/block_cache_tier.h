@@ -71,6 +71,8 @@ class BlockCacheTier : public PersistentCacheTier {
 
   PersistentCache::StatsType Stats() override;
 
+  uint64_t NewId() override;
+
   void TEST_Flush() override {
     while (insert_ops_.Size()) {
       /* sleep override */
@@ -111,8 +113,14 @@ class BlockCacheTier : public PersistentCacheTier {
   Status NewCacheFile();
   // Get cache directory path
   std::string GetCachePath() const { return opt_.path + "/cache"; }
+  // Get path of the file that records identity and epoch
+  std::string GetMetaPath() const { return opt_.path + "/META"; }
   // Cleanup folder
   Status CleanupCacheFolder(const std::string& folder);
+  // Load the blocks cached in folder by an earlier open with the same identity
+  Status RecoverCacheFolder(const std::string& folder);
+  // Record identity and the epoch of this open
+  Status WriteMeta();
 
   // Statistics
   struct Statistics {
@@ -126,6 +134,8 @@ class BlockCacheTier : public PersistentCacheTier {
     std::atomic<uint64_t> cache_misses_{0};
     std::atomic<uint64_t> cache_errors_{0};
     std::atomic<uint64_t> insert_dropped_{0};
+    uint64_t recovered_blocks_ = 0;
+    uint64_t recovered_bytes_ = 0;
 
     double CacheHitPct() const {
       const auto lookups = cache_hits_ + cache_misses_;
@@ -148,6 +158,7 @@ class BlockCacheTier : public PersistentCacheTier {
   ThreadedWriter writer_;                       // Writer threads
   BlockCacheTierMetadata metadata_;             // Cache meta data manager
   std::atomic<uint64_t> size_{0};               // Size of the cache
+  uint64_t epoch_ = 0;                          // Opens of this identity
   Statistics stats_;                                 // Statistics
 };
 
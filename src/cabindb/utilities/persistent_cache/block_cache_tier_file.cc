@@ -9,6 +9,8 @@
 #ifndef OS_WIN
 #include <unistd.h>
 #endif
+#include <algorithm>
+#include <cinttypes>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -248,6 +250,83 @@ bool RandomAccessCacheFile::Read(const LBA& lba, Slice* key, Slice* val,
   return ParseRec(lba, key, val, scratch);
 }
 
+bool RandomAccessCacheFile::Recover(
+    const uint64_t file_size,
+    std::vector<std::pair<std::string, LBA>>* blocks) {
+  ReadLock _(&rwlock_);
+
+  if (!freader_) {
+    return false;
+  }
+
+  // records are read through a window of at least kReadSize bytes
+  const size_t kReadSize = 1024 * 1024;
+  std::unique_ptr<char[]> scratch;
+  size_t scratch_size = 0;
+  Slice window;
+  uint64_t window_off = 0;
+  auto fill = [&](const uint64_t off, const size_t size, Slice* data) {
+    if (off < window_off || off + size > window_off + window.size()) {
+      const size_t n = static_cast<size_t>(
+          std::min<uint64_t>(std::max(size, kReadSize), file_size - off));
+      if (n > scratch_size) {
+        scratch.reset(new char[n]);
+        scratch_size = n;
+      }
+      Status s = freader_->Read(IOOptions(), off, n, &window, scratch.get(),
+                                nullptr);
+      if (!s.ok()) {
+        Error(log_, "Error reading from file %s. %s", Path().c_str(),
+              s.ToString().c_str());
+        window = Slice();
+        return false;
+      }
+      window_off = off;
+      if (window.size() < size) {
+        return false;
+      }
+    }
+    *data = Slice(window.data() + (off - window_off), size);
+    return true;
+  };
+
+  uint64_t off = 0;
+  while (off + sizeof(CacheRecordHeader) <= file_size) {
+    Slice data;
+    if (!fill(off, sizeof(CacheRecordHeader), &data)) {
+      break;
+    }
+    CacheRecord rec;
+    memcpy(&rec.hdr_, data.data(), sizeof(rec.hdr_));
+    const uint64_t rec_size = sizeof(rec.hdr_) +
+                              static_cast<uint64_t>(rec.hdr_.key_size_) +
+                              rec.hdr_.val_size_;
+    // the unwritten tail of a file is zero filled
+    if (rec.hdr_.magic_ != CacheRecord::MAGIC || !rec.hdr_.key_size_ ||
+        off + rec_size > file_size) {
+      break;
+    }
+    if (!fill(off, static_cast<size_t>(rec_size), &data)) {
+      break;
+    }
+    rec.key_ = Slice(data.data() + sizeof(rec.hdr_), rec.hdr_.key_size_);
+    rec.val_ = Slice(rec.key_.data() + rec.hdr_.key_size_, rec.hdr_.val_size_);
+    if (rec.ComputeCRC() != rec.hdr_.crc_) {
+      Info(log_, "Torn record in file %s off %" PRIu64, Path().c_str(), off);
+      break;
+    }
+
+    LBA lba;
+    lba.cache_id_ = cache_id_;
+    lba.off_ = static_cast<uint32_t>(off);
+    lba.size_ = static_cast<uint32_t>(rec_size);
+    blocks->emplace_back(rec.key_.ToString(), lba);
+    off += rec_size;
+  }
+
+  return true;
+}
+
 bool RandomAccessCacheFile::ParseRec(const LBA& lba, Slice* key, Slice* val,
                                      char* scratch) {
   Slice data(scratch, lba.size_);
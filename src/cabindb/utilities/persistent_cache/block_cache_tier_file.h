@@ -159,6 +159,10 @@ class RandomAccessCacheFile : public BlockCacheFile {
   bool Open(const bool enable_direct_reads);
   // read data from the disk
   bool Read(const LBA& lba, Slice* key, Slice* block, char* scratch) override;
+  // list the records of a file left by an earlier instance of the cache, up
+  // to the first one that is torn or corrupt
+  bool Recover(const uint64_t file_size,
+               std::vector<std::pair<std::string, LBA>>* blocks);
 
  private:
   std::unique_ptr<RandomAccessFileReader> freader_;
@@ -296,6 +296,62 @@ TEST_F(PersistentCacheTierTest, FactoryTest) {
   }
 }
 
+TEST_F(PersistentCacheTierTest, RecoveryTest) {
+  auto log = std::make_shared<ConsoleLogger>();
+  PersistentCacheTierOptions options;
+  options.file_size = 2 * 1024 * 1024;
+  options.identity = "db-1";
+  const size_t kNumKeys = 2048;
+  auto key = [](size_t i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "k%08" CABINDB_PRIszt, i);
+    return std::string(buf);
+  };
+  auto value = [](size_t i) { return std::string(4096, 'a' + i % 26); };
+
+  std::shared_ptr<PersistentCache> cache;
+  ASSERT_OK(NewPersistentCache(Env::Default(), path_,
+                               /*size=*/64 * 1024 * 1024, log, options,
+                               &cache));
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    const std::string v = value(i);
+    ASSERT_OK(cache->Insert(key(i), v.data(), v.size()));
+  }
+  // closing the cache drains the insert queue and the writer, so every
+  // file that filled up is on the device before it is reopened
+  cache.reset();
+
+  // the files that reached the device come back; the blocks of the last,
+  // partially written file may not
+  ASSERT_OK(NewPersistentCache(Env::Default(), path_,
+                               /*size=*/64 * 1024 * 1024, log, options,
+                               &cache));
+  size_t found = 0;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    std::unique_ptr<char[]> data;
+    size_t size = 0;
+    if (cache->Lookup(key(i), &data, &size).ok()) {
+      ASSERT_EQ(value(i), std::string(data.get(), size));
+      found++;
+    }
+  }
+  ASSERT_GT(found, 0);
+  ASSERT_EQ(static_cast<double>(found),
+            cache->Stats().back()["persistentcache.blockcachetier."
+                                  "recovered_blocks"]);
+  cache.reset();
+
+  // a different identity starts empty
+  options.identity = "db-2";
+  ASSERT_OK(NewPersistentCache(Env::Default(), path_,
+                               /*size=*/64 * 1024 * 1024, log, options,
+                               &cache));
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+  ASSERT_TRUE(cache->Lookup(key(0), &data, &size).IsNotFound());
+  cache.reset();
+}
+
 PersistentCacheDBTest::PersistentCacheDBTest()
     : DBTestBase("/cache_test", /*env_do_fsync=*/true) {
 #ifdef OS_LINUX
@@ -49,6 +49,8 @@ std::string PersistentCacheConfig::ToString() const {
   ret.append(buffer);
   snprintf(buffer, kBufferSize, "    is_compressed: %d\n", is_compressed);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    identity: %s\n", identity.c_str());
+  ret.append(buffer);
 
   return ret;
 }
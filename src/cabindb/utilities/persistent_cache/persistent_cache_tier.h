@@ -217,6 +217,17 @@ struct PersistentCacheConfig {
   // uncompressed mode
   bool is_compressed = true;
 
+  // identity
+  //
+  // Names the data set whose blocks are cached. When set, the cache records
+  // it next to its files and, on open, keeps the blocks found there if they
+  // were cached under the same identity instead of discarding them. Cache
+  // keys must then be stable across restarts, i.e. derived from unique file
+  // ids.
+  //
+  // default: empty, the cache starts empty on every open
+  std::string identity;
+
   PersistentCacheConfig MakePersistentCacheConfig(
       const std::string& path, const uint64_t size,
       const std::shared_ptr<Logger>& log);
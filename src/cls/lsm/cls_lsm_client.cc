@@ -80,32 +80,11 @@ void ClsLsmClient::cls_lsm_init(librados::ObjectWriteOperation& op,
 int ClsLsmClient::cls_lsm_read(librados::IoCtx& io_ctx, const std::string& pool_name,
                 uint64_t key, const std::vector<std::string> *columns, cls_lsm_entry& entry)
 {
-    std::vector<std::string> obj_ids;
-    for (int i = 0; i <= levels; i++) {
-        int key_group = 0;
-        if (i > 0) {
-            key_group = get_key_group(key_low_bound, key_high_bound, key_splits, i, key);
-        }
-        if (key_group == -1) {
-            std::cout << "key " << key << " out of range!" << endl;
-            return 0;
-        }
-
-        if (lsm_bloomfilter_contains(bloomfilter_store[i][key_group], to_string(key))) {
-            std::vector<int> col_groups;
-            if (!columns) {
-                for (uint64_t j = 0; j < column_map[i].size(); j++) {
-                    col_groups.push_back(j);
-                }
-            } else {
-                col_groups = get_col_group(*columns, i, column_map);
-            }
+    ClsLsmClient::cls_lsm_aio_flush();
 
-            for (auto col_group : col_groups) {
-                obj_ids.push_back(construct_object_id(tree_name, i, key_group, col_group));
-            }
-            break;
-        }
+    std::vector<std::string> obj_ids;
+    if (ClsLsmClient::get_object_ids(key, columns, obj_ids) < 0) {
+        return 0;
     }
 
     if (obj_ids.size() == 0) {
@@ -143,14 +122,128 @@ int ClsLsmClient::cls_lsm_read(librados::IoCtx& io_ctx, const std::string& pool_
     return r;
 }
 
+int ClsLsmClient::get_object_ids(uint64_t key, const std::vector<std::string> *columns, std::vector<std::string>& obj_ids)
+{
+    for (int i = 0; i <= levels; i++) {
+        int key_group = 0;
+        if (i > 0) {
+            key_group = get_key_group(key_low_bound, key_high_bound, key_splits, i, key);
+        }
+        if (key_group == -1) {
+            std::cout << "key " << key << " out of range!" << endl;
+            return -ERANGE;
+        }
+
+        if (lsm_bloomfilter_contains(bloomfilter_store[i][key_group], to_string(key))) {
+            std::vector<int> col_groups;
+            if (!columns) {
+                for (uint64_t j = 0; j < column_map[i].size(); j++) {
+                    col_groups.push_back(j);
+                }
+            } else {
+                col_groups = get_col_group(*columns, i, column_map);
+            }
+
+            for (auto col_group : col_groups) {
+                obj_ids.push_back(construct_object_id(tree_name, i, key_group, col_group));
+            }
+            break;
+        }
+    }
+
+    return 0;
+}
+
+int ClsLsmClient::cls_lsm_aio_read(librados::IoCtx& io_ctx, const std::string& pool_name,
+                uint64_t key, const std::vector<std::string> *columns,
+                librados::AioCompletion *c, bufferlist *out, bool *gathered)
+{
+    ClsLsmClient::cls_lsm_aio_flush();
+
+    std::vector<std::string> obj_ids;
+    // like cls_lsm_read, an out of range key reads as a missing one
+    if (ClsLsmClient::get_object_ids(key, columns, obj_ids) < 0 ||
+        obj_ids.size() == 0) {
+        return -ENOENT;
+    }
+
+    bufferlist in;
+    if (obj_ids.size() == 1) {
+        // read from one single object
+        encode(key, in);
+        *gathered = false;
+        return io_ctx.aio_exec(obj_ids[0], c, LSM_CLASS, LSM_READ_KEY, in, out);
+    }
+
+    // gather
+    encode(obj_ids, in);
+    encode(pool_name, in);
+    *gathered = true;
+
+    std::string root = tree_name+"/level-0/keyrange-0/columngroup-0";
+    return io_ctx.aio_exec(root, c, LSM_CLASS, LSM_GATHER, in, out);
+}
+
 void ClsLsmClient::cls_lsm_write(librados::IoCtx& io_ctx, const std::string& root_name, cls_lsm_entry& entry)
 {
-    if (in_mem_data.size() < LSM_LEVEL_0_CAPACITY) {
-        in_mem_data[entry.key] = entry;
+    ClsLsmClient::write_entry(io_ctx, entry, false);
+}
+
+int ClsLsmClient::cls_lsm_aio_write(librados::IoCtx& io_ctx, const std::string& root_name, cls_lsm_entry& entry)
+{
+    return ClsLsmClient::write_entry(io_ctx, entry, true);
+}
+
+int ClsLsmClient::cls_lsm_aio_flush()
+{
+    // each completion is waited for and released by the one caller that
+    // took it off the list
+    std::vector<librados::AioCompletion*> pending;
+    {
+        std::lock_guard l{aio_lock};
+        pending.swap(aio_pending);
+    }
+
+    int ret = 0;
+    for (auto c : pending) {
+        c->wait_for_complete();
+        int r = c->get_return_value();
+        if (r < 0 && ret == 0) {
+            ret = r;
+        }
+        c->release();
+    }
+    return ret;
+}
+
+int ClsLsmClient::cls_lsm_flush(librados::IoCtx& io_ctx)
+{
+    int r = ClsLsmClient::flush_level0(io_ctx, true);
+    int ret = ClsLsmClient::cls_lsm_aio_flush();
+    return r < 0 ? r : ret;
+}
+
+int ClsLsmClient::write_entry(librados::IoCtx& io_ctx, cls_lsm_entry& entry, bool aio)
+{
+    if (in_mem_data.size() >= LSM_LEVEL_0_CAPACITY) {
+        int r = ClsLsmClient::flush_level0(io_ctx, aio);
+        if (r < 0) {
+            return r;
+        }
+    }
+    in_mem_data[entry.key] = entry;
+
+    // register data in the bloomfilter stores
+    lsm_bloomfilter_insert(bloomfilter_store[0][0], to_string(entry.key));
+    return 0;
+}
 
-        // register data in the bloomfilter stores
-        lsm_bloomfilter_insert(bloomfilter_store[0][0], to_string(entry.key));
-    } else if (level_inventory[1] < LSM_LEVEL_OBJECT_CAPACITY) {
+int ClsLsmClient::flush_level0(librados::IoCtx& io_ctx, bool aio)
+{
+    if (in_mem_data.empty()) {
+        return 0;
+    }
+    if (level_inventory[1] < LSM_LEVEL_OBJECT_CAPACITY) {
         bufferlist in, out;
         for (auto ent : in_mem_data) {
             bufferlist bl_entry;
@@ -160,7 +253,20 @@ void ClsLsmClient::cls_lsm_write(librados::IoCtx& io_ctx, const std::string& roo
             in.claim_append(bl_entry);
         }
         std::string oid = tree_name + "/level-1/colgrp-0/member-" + to_string(level_inventory[1]);
-        io_ctx.exec(oid, LSM_CLASS, LSM_WRITE_NODE, in, out);
+        if (aio) {
+            librados::ObjectWriteOperation op;
+            op.exec(LSM_CLASS, LSM_WRITE_NODE, in);
+            librados::AioCompletion *c = librados::Rados::aio_create_completion();
+            int r = io_ctx.aio_operate(oid, c, &op);
+            if (r < 0) {
+                c->release();
+                return r;
+            }
+            std::lock_guard l{aio_lock};
+            aio_pending.push_back(c);
+        } else {
+            io_ctx.exec(oid, LSM_CLASS, LSM_WRITE_NODE, in, out);
+        }
         lsm_bloomfilter_clear(bloomfilter_store[1][level_inventory[1]]);
         lsm_bloomfilter_copy(bloomfilter_store[1][level_inventory[1]], bloomfilter_store[0][0]);
         lsm_bloomfilter_clear(bloomfilter_store[0][0]);
@@ -168,6 +274,12 @@ void ClsLsmClient::cls_lsm_write(librados::IoCtx& io_ctx, const std::string& roo
         in_mem_data.clear();
         level_inventory[1] += 1;
     } else {
+        // the compaction sorts the level-1 nodes, so they have to be written
+        int r = ClsLsmClient::cls_lsm_aio_flush();
+        if (r < 0) {
+            return r;
+        }
+
         std::vector<cls_lsm_entry> ins;
         for (auto ent : in_mem_data) {
             ins.push_back(ent.second);
@@ -177,6 +289,7 @@ void ClsLsmClient::cls_lsm_write(librados::IoCtx& io_ctx, const std::string& roo
         in_mem_data.clear();
         lsm_bloomfilter_clear(bloomfilter_store[0][0]);
     }
+    return 0;
 }
 
 int ClsLsmClient::cls_lsm_compact(librados::IoCtx& io_ctx, std::vector<cls_lsm_entry>& input)
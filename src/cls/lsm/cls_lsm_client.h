@@ -4,6 +4,7 @@
 #include "include/rados/librados.hpp"
 #include "cls/lsm/cls_lsm_types.h"
 #include <iostream>
+#include <mutex>
 #include <string>
 
 class ClsLsmClient {
@@ -12,6 +13,7 @@ class ClsLsmClient {
 
 public:
     ClsLsmClient() {};
+    ~ClsLsmClient() { cls_lsm_aio_flush(); }
 
     void InitClient(std::string pool, std::string tree, uint64_t key_low, uint64_t key_high, int splits, int levels, 
             int num_cols, std::map<int, std::vector<std::vector<std::string>>>& col_map);
@@ -48,6 +50,28 @@ public:
                     const std::vector<std::string> *columns,
                     cls_lsm_entry& entry);
 
+    /**
+    * Asynchronous Read API
+    *
+    * Input:
+    * - io_ctx: the Input/Output context of Ceph
+    * - key: the key whose value is to be read
+    * - columns: the collection of columns to be read
+    * - c: completion signalled once the read finishes
+    * Output:
+    * - out: the encoded entry, or the gather result when the key spans objects
+    * - gathered: set when out holds a gather result
+    * Return: 0 if the read was issued, -ENOENT if no level holds the key
+    *         or the key is out of range
+    */
+    int cls_lsm_aio_read(librados::IoCtx& io_ctx,
+                    const std::string& pool_name,
+                    uint64_t key,
+                    const std::vector<std::string> *columns,
+                    librados::AioCompletion *c,
+                    bufferlist *out,
+                    bool *gathered);
+
     /**
     * Write API
     *
@@ -56,6 +80,32 @@ public:
     * - bl_data_vec: vector of the "rows" to be written
     */
     void cls_lsm_write(librados::IoCtx& io_ctx, const std::string& root_name, cls_lsm_entry& entry);
+
+    /**
+    * Asynchronous Write API
+    *
+    * Like cls_lsm_write, but the level-1 node written once level 0 is full
+    * is sent without waiting for it. Reads and compactions wait for such
+    * writes themselves.
+    *
+    * Return: 0 if the entry was buffered or its write issued
+    */
+    int cls_lsm_aio_write(librados::IoCtx& io_ctx, const std::string& root_name, cls_lsm_entry& entry);
+
+    /**
+    * Waits for every write issued by cls_lsm_aio_write
+    *
+    * Return: 0, or the first error of those writes
+    */
+    int cls_lsm_aio_flush();
+
+    /**
+    * Writes the entries still buffered in level 0, then waits for every
+    * write issued by cls_lsm_aio_write
+    *
+    * Return: 0, or the first error of those writes
+    */
+    int cls_lsm_flush(librados::IoCtx& io_ctx);
     
     /**
     * Compact API
@@ -90,9 +140,17 @@ private:
     std::map<int, int> level_col_grps;
     BloomfilterStore bloomfilter_store;
     std::map<int, std::vector<std::vector<std::string>>> column_map;
+    std::mutex aio_lock;
+    std::vector<librados::AioCompletion*> aio_pending;
    
+    int write_entry(librados::IoCtx& io_ctx, cls_lsm_entry& entry, bool aio);
+
+    int flush_level0(librados::IoCtx& io_ctx, bool aio);
+
     int update_bloomfilter(bufferlist in, int level);
 
+    int get_object_ids(uint64_t key, const std::vector<std::string> *columns, std::vector<std::string>& obj_ids);
+
     void crack(std::vector<std::vector<cls_lsm_entry> >& entry_groups, int groups, std::vector<std::vector<cls_lsm_entry> >& newins);
 
     int get_entry_groups(std::vector<bufferlist>& ins, std::vector<std::vector<cls_lsm_entry> >& entries_groups, std::set<uint64_t>& keys);
@@ -76,31 +76,8 @@ int ClsReadOptimizedClient::cls_read_optimized_read(librados::IoCtx& io_ctx, con
                 uint64_t key, const std::vector<std::string> *columns, cls_lsm_entry& entry)
 {
     std::vector<std::string> obj_ids;
-    for (int i = 1; i <= levels; i++) {
-        int key_group = 0;
-        if (i > 1) {
-            key_group = get_key_group(key_low_bound, key_high_bound, key_splits, i, key);
-        }
-        if (key_group == -1) {
-            std::cout << "key " << key << " out of range!" << endl;
-            return 0;
-        }
-
-        if (lsm_bloomfilter_contains(bloomfilter_store[i][key_group], to_string(key))) {
-            std::vector<int> col_groups;
-            if (!columns) {
-                for (uint64_t j = 0; j < column_map[i].size(); j++) {
-                    col_groups.push_back(j);
-                }
-            } else {
-                col_groups = get_col_group(*columns, i, column_map);
-            }
-
-            for (auto col_group : col_groups) {
-                obj_ids.push_back(construct_object_id(tree_name, i, key_group, col_group));
-            }
-            break;
-        }
+    if (ClsReadOptimizedClient::get_object_ids(key, columns, obj_ids) < 0) {
+        return 0;
     }
 
     if (obj_ids.size() == 0) {
@@ -138,7 +115,67 @@ int ClsReadOptimizedClient::cls_read_optimized_read(librados::IoCtx& io_ctx, con
     return r;
 }
 
-void ClsReadOptimizedClient::cls_read_optimized_write(librados::IoCtx& io_ctx, const std::string& oid, cls_lsm_entry& entry)
+int ClsReadOptimizedClient::get_object_ids(uint64_t key, const std::vector<std::string> *columns, std::vector<std::string>& obj_ids)
+{
+    for (int i = 1; i <= levels; i++) {
+        int key_group = 0;
+        if (i > 1) {
+            key_group = get_key_group(key_low_bound, key_high_bound, key_splits, i, key);
+        }
+        if (key_group == -1) {
+            std::cout << "key " << key << " out of range!" << endl;
+            return -ERANGE;
+        }
+
+        if (lsm_bloomfilter_contains(bloomfilter_store[i][key_group], to_string(key))) {
+            std::vector<int> col_groups;
+            if (!columns) {
+                for (uint64_t j = 0; j < column_map[i].size(); j++) {
+                    col_groups.push_back(j);
+                }
+            } else {
+                col_groups = get_col_group(*columns, i, column_map);
+            }
+
+            for (auto col_group : col_groups) {
+                obj_ids.push_back(construct_object_id(tree_name, i, key_group, col_group));
+            }
+            break;
+        }
+    }
+
+    return 0;
+}
+
+int ClsReadOptimizedClient::cls_read_optimized_aio_read(librados::IoCtx& io_ctx, const std::string& pool_name,
+                uint64_t key, const std::vector<std::string> *columns,
+                librados::AioCompletion *c, bufferlist *out, bool *gathered)
+{
+    std::vector<std::string> obj_ids;
+    // like the synchronous read, an out of range key reads as a missing one
+    if (ClsReadOptimizedClient::get_object_ids(key, columns, obj_ids) < 0 ||
+        obj_ids.size() == 0) {
+        return -ENOENT;
+    }
+
+    bufferlist in;
+    if (obj_ids.size() == 1) {
+        // read from one single object
+        encode(key, in);
+        *gathered = false;
+        return io_ctx.aio_exec(obj_ids[0], c, LSM_CLASS, LSM_READ_KEY, in, out);
+    }
+
+    // gather
+    encode(obj_ids, in);
+    encode(pool_name, in);
+    *gathered = true;
+
+    std::string root = tree_name+"/level-0/keyrange-0/columngroup-0";
+    return io_ctx.aio_exec(root, c, LSM_CLASS, LSM_GATHER, in, out);
+}
+
+void ClsReadOptimizedClient::encode_write(cls_lsm_entry& entry, bufferlist& in)
 {
     std::map<std::string, bufferlist> tgt_child_objects;
     int i = 0;
@@ -161,8 +198,13 @@ void ClsReadOptimizedClient::cls_read_optimized_write(librados::IoCtx& io_ctx, c
         i += 1;
     }
 
-    bufferlist in, out;
     encode(tgt_child_objects, in);
+}
+
+void ClsReadOptimizedClient::cls_read_optimized_write(librados::IoCtx& io_ctx, const std::string& oid, cls_lsm_entry& entry)
+{
+    bufferlist in, out;
+    ClsReadOptimizedClient::encode_write(entry, in);
  
     io_ctx.exec(oid, LSM_CLASS, LSM_COMPACT, in, out);
 
@@ -172,6 +214,26 @@ void ClsReadOptimizedClient::cls_read_optimized_write(librados::IoCtx& io_ctx, c
     }
 }
 
+int ClsReadOptimizedClient::cls_read_optimized_aio_write(librados::IoCtx& io_ctx, const std::string& oid, cls_lsm_entry& entry,
+                librados::AioCompletion *c)
+{
+    bufferlist in;
+    ClsReadOptimizedClient::encode_write(entry, in);
+
+    librados::ObjectWriteOperation op;
+    op.exec(LSM_CLASS, LSM_COMPACT, in);
+    int r = io_ctx.aio_operate(oid, c, &op);
+    if (r < 0) {
+        return r;
+    }
+
+    // register data in the bloomfilter stores
+    for (uint64_t i = 0; i < bloomfilter_store[1].size(); i++) {
+        lsm_bloomfilter_insert(bloomfilter_store[1][i], to_string(entry.key));
+    }
+    return 0;
+}
+
 int ClsReadOptimizedClient::cls_read_optimized_compact(librados::IoCtx& io_ctx, const std::string& oid)
 {
     // get level from object_id
@@ -74,31 +74,8 @@ int ClsWriteOptimizedClient::cls_write_optimized_read(librados::IoCtx& io_ctx, c
                 uint64_t key, const std::vector<std::string> *columns, cls_lsm_entry& entry)
 {
     std::vector<std::string> obj_ids;
-    int key_group = 0;
-    for (int i = 0; i <= levels; i++) {
-        if (i > 0) {
-            key_group = get_key_group(key_low_bound, key_high_bound, key_splits, i, key);
-        }
-        if (key_group == -1) {
-            std::cout << "key " << key << " out of range!" << endl;
-            return 0;
-        }
-
-        if (lsm_bloomfilter_contains(bloomfilter_store[i][key_group], to_string(key))) {
-            std::vector<int> col_groups;
-            if (!columns) {
-                for (uint64_t j = 0; j < column_map[i].size(); j++) {
-                    col_groups.push_back(j);
-                }
-            } else {
-                col_groups = get_col_group(*columns, i, column_map);
-            }
-
-            for (auto col_group : col_groups) {
-                obj_ids.push_back(construct_object_id(tree_name, i, key_group, col_group));
-            }
-            break;
-        }
+    if (ClsWriteOptimizedClient::get_object_ids(key, columns, obj_ids) < 0) {
+        return 0;
     }
 
     if (obj_ids.size() == 0) {
@@ -148,6 +125,66 @@ int ClsWriteOptimizedClient::cls_write_optimized_read(librados::IoCtx& io_ctx, c
     return r;
 }
 
+int ClsWriteOptimizedClient::get_object_ids(uint64_t key, const std::vector<std::string> *columns, std::vector<std::string>& obj_ids)
+{
+    int key_group = 0;
+    for (int i = 0; i <= levels; i++) {
+        if (i > 0) {
+            key_group = get_key_group(key_low_bound, key_high_bound, key_splits, i, key);
+        }
+        if (key_group == -1) {
+            std::cout << "key " << key << " out of range!" << endl;
+            return -ERANGE;
+        }
+
+        if (lsm_bloomfilter_contains(bloomfilter_store[i][key_group], to_string(key))) {
+            std::vector<int> col_groups;
+            if (!columns) {
+                for (uint64_t j = 0; j < column_map[i].size(); j++) {
+                    col_groups.push_back(j);
+                }
+            } else {
+                col_groups = get_col_group(*columns, i, column_map);
+            }
+
+            for (auto col_group : col_groups) {
+                obj_ids.push_back(construct_object_id(tree_name, i, key_group, col_group));
+            }
+            break;
+        }
+    }
+
+    return 0;
+}
+
+int ClsWriteOptimizedClient::cls_write_optimized_aio_read(librados::IoCtx& io_ctx, const std::string& pool_name,
+                uint64_t key, const std::vector<std::string> *columns,
+                librados::AioCompletion *c, bufferlist *out, bool *gathered)
+{
+    std::vector<std::string> obj_ids;
+    // like the synchronous read, an out of range key reads as a missing one
+    if (ClsWriteOptimizedClient::get_object_ids(key, columns, obj_ids) < 0 ||
+        obj_ids.size() == 0) {
+        return -ENOENT;
+    }
+
+    bufferlist in;
+    if (obj_ids.size() == 1) {
+        // read from one single object
+        encode(key, in);
+        *gathered = false;
+        return io_ctx.aio_exec(obj_ids[0], c, LSM_CLASS, LSM_READ_KEY, in, out);
+    }
+
+    // gather
+    encode(obj_ids, in);
+    encode(pool_name, in);
+    *gathered = true;
+
+    std::string root = tree_name+"/level-0/keyrange-0/columngroup-0";
+    return io_ctx.aio_exec(root, c, LSM_CLASS, LSM_GATHER, in, out);
+}
+
 void ClsWriteOptimizedClient::cls_write_optimized_write(librados::IoCtx& io_ctx, const std::string& oid, cls_lsm_entry& entry)
 {
     bufferlist in, out;
@@ -163,6 +200,26 @@ void ClsWriteOptimizedClient::cls_write_optimized_write(librados::IoCtx& io_ctx,
     lsm_bloomfilter_insert(bloomfilter_store[0][0], to_string(entry.key));
 }
 
+int ClsWriteOptimizedClient::cls_write_optimized_aio_write(librados::IoCtx& io_ctx, const std::string& oid, cls_lsm_entry& entry,
+                librados::AioCompletion *c)
+{
+    bufferlist in;
+    encode(entry, in);
+
+    librados::ObjectWriteOperation op;
+    op.create(true);
+
+    op.exec(LSM_CLASS, LSM_WRITE_NODE, in);
+    int r = io_ctx.aio_operate(oid, c, &op);
+    if (r < 0) {
+        return r;
+    }
+
+    // register data in the bloomfilter stores
+    lsm_bloomfilter_insert(bloomfilter_store[0][0], to_string(entry.key));
+    return 0;
+}
+
 int ClsWriteOptimizedClient::cls_write_optimized_compact(librados::IoCtx& io_ctx, const std::string& oid)
 {
     // get level from object_id
@@ -48,6 +48,28 @@ public:
                     const std::vector<std::string> *columns,
                     cls_lsm_entry& entry);
 
+    /**
+    * Asynchronous Read API
+    *
+    * Input:
+    * - io_ctx: the Input/Output context of Ceph
+    * - key: the key whose value is to be read
+    * - columns: the collection of columns to be read
+    * - c: completion signalled once the read finishes
+    * Output:
+    * - out: the encoded entry, or the gather result when the key spans objects
+    * - gathered: set when out holds a gather result
+    * Return: 0 if the read was issued, -ENOENT if no level holds the key
+    *         or the key is out of range
+    */
+    int cls_write_optimized_aio_read(librados::IoCtx& io_ctx,
+                    const std::string& pool_name,
+                    uint64_t key,
+                    const std::vector<std::string> *columns,
+                    librados::AioCompletion *c,
+                    bufferlist *out,
+                    bool *gathered);
+
     /**
     * Write API
     *
@@ -56,6 +78,17 @@ public:
     * - bl_data_vec: vector of the "rows" to be written
     */
     void cls_write_optimized_write(librados::IoCtx& io_ctx, const std::string& oid, cls_lsm_entry& entry);
+
+    /**
+    * Asynchronous Write API
+    *
+    * Input:
+    * - oid: object id of the root node to write the data to
+    * - entry: the "row" to be written
+    * - c: completion signalled once the write is durable
+    */
+    int cls_write_optimized_aio_write(librados::IoCtx& io_ctx, const std::string& oid, cls_lsm_entry& entry,
+                    librados::AioCompletion *c);
     
     /**
     * Compact API
@@ -88,6 +121,8 @@ private:
     std::map<int, std::vector<std::vector<std::string>>> column_map;
 
     int update_bloomfilter(bufferlist in, int level);
+
+    int get_object_ids(uint64_t key, const std::vector<std::string> *columns, std::vector<std::string>& obj_ids);
 };
 
 #endif
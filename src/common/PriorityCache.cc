@@ -12,6 +12,8 @@
  *
  */
 
+#include <algorithm>
+
 #include "PriorityCache.h"
 #include "common/dout.h"
 #include "perfglue/heap_profiler.h"
@@ -397,4 +399,28 @@ namespace PriorityCache
   PriCache::~PriCache()
   {
   }
+
+  void HitRatioBalancer::balance(
+    double ratio,
+    const std::map<std::string, std::shared_ptr<PriCache>>& caches)
+  {
+    double total = 0;
+    for (auto& [name, cache] : caches) {
+      uint64_t hits = cache->get_cache_hits();
+      uint64_t misses = cache->get_cache_misses();
+      auto& l = last[name];
+      // the counters restart if the cache was recreated
+      uint64_t dh = hits >= l.hits ? hits - l.hits : hits;
+      uint64_t dm = misses >= l.misses ? misses - l.misses : misses;
+      if (dh + dm > 0) {
+        l.weight = std::max(min_weight, (double)dh / (dh + dm));
+      }
+      l.hits = hits;
+      l.misses = misses;
+      total += l.weight;
+    }
+    for (auto& [name, cache] : caches) {
+      cache->set_cache_ratio(ratio * last[name].weight / total);
+    }
+  }
 }
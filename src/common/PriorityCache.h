@@ -19,6 +19,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <map>
 #include <unordered_map>
 #include "common/perf_counters.h"
 #include "include/ceph_assert.h"
@@ -100,6 +101,40 @@ namespace PriorityCache {
 
     // Get the name of this cache.
     virtual std::string get_cache_name() const = 0;
+
+    /* Lookups served from and missed by the cache since it was created.
+     * Caches that do not track lookups report 0 for both. */
+    virtual uint64_t get_cache_hits() const {
+      return 0;
+    }
+
+    virtual uint64_t get_cache_misses() const {
+      return 0;
+    }
+  };
+
+  /* Splits one memory ratio between caches by the hit ratio each saw since
+   * the previous split, so a cache whose hits grow with memory gets more of
+   * it regardless of how much traffic it serves.  A cache without lookups
+   * in between keeps its previous weight, and every cache keeps at least
+   * min_weight so it can show that more memory would help. */
+  class HitRatioBalancer {
+    struct last_t {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      double weight = 1.0;
+    };
+    std::map<std::string, last_t> last;
+    double min_weight;
+  public:
+    explicit HitRatioBalancer(double min_weight = 0.05)
+      : min_weight(min_weight) {}
+    void balance(
+      double ratio,
+      const std::map<std::string, std::shared_ptr<PriCache>>& caches);
+    void clear() {
+      last.clear();
+    }
   };
 
   class Manager {
@@ -577,10 +577,21 @@ static ceph::spinlock debug_lock;
     return mem_is_zero(c_str(), _len);
   }
 
+  void buffer::ptr::copy_on_write()
+  {
+    if (_raw && _raw->is_readonly()) {
+      ptr copy(_raw->clone());
+      copy.set_offset(_off);
+      copy.set_length(_len);
+      swap(copy);
+    }
+  }
+
   unsigned buffer::ptr::append(char c)
   {
     ceph_assert(_raw);
     ceph_assert(1 <= unused_tail_length());
+    copy_on_write();
     char* ptr = _raw->get_data() + _off + _len;
     *ptr = c;
     _len++;
@@ -591,6 +602,7 @@ static ceph::spinlock debug_lock;
   {
     ceph_assert(_raw);
     ceph_assert(l <= unused_tail_length());
+    copy_on_write();
     char* c = _raw->get_data() + _off + _len;
     maybe_inline_memcpy(c, p, l, 32);
     _len += l;
@@ -601,6 +613,7 @@ static ceph::spinlock debug_lock;
   {
     ceph_assert(_raw);
     ceph_assert(l <= unused_tail_length());
+    copy_on_write();
     char* c = _raw->get_data() + _off + _len;
     // FIPS zeroization audit 20191115: this memset is not security related.
     memset(c, 0, l);
@@ -613,6 +626,7 @@ static ceph::spinlock debug_lock;
     ceph_assert(_raw);
     ceph_assert(o <= _len);
     ceph_assert(o+l <= _len);
+    copy_on_write();
     char* dest = _raw->get_data() + _off + o;
     if (crc_reset)
         _raw->invalidate_crc();
@@ -621,6 +635,7 @@ static ceph::spinlock debug_lock;
 
   void buffer::ptr::zero(bool crc_reset)
   {
+    copy_on_write();
     if (crc_reset)
         _raw->invalidate_crc();
     // FIPS zeroization audit 20191115: this memset is not security related.
@@ -630,6 +645,7 @@ static ceph::spinlock debug_lock;
   void buffer::ptr::zero(unsigned o, unsigned l, bool crc_reset)
   {
     ceph_assert(o+l <= _len);
+    copy_on_write();
     if (crc_reset)
         _raw->invalidate_crc();
     // FIPS zeroization audit 20191115: this memset is not security related.
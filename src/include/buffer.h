@@ -171,6 +171,8 @@ struct error_code;
   private:
 
     void release();
+    // points this ptr at a copy of a read-only raw before it is written
+    void copy_on_write();
 
     template<bool is_const>
     class iterator_impl {
@@ -35,6 +35,9 @@ inline namespace v15_2_0 {
   protected:
     char *data;
     unsigned len;
+    // set by raws whose memory is shared with its owner, e.g. a value pinned
+    // in a cache; ptr's in-place writers move to a private copy first
+    bool readonly = false;
   public:
     ceph::atomic<unsigned> nref { 0 };
     int mempool;
@@ -89,6 +92,9 @@ public:
     char *get_data() const {
       return data;
     }
+    bool is_readonly() const {
+      return readonly;
+    }
     unsigned get_len() const {
       return len;
     }
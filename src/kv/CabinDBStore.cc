@@ -5,6 +5,7 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <chrono>
 #if __has_include(<filesystem>)
 #include <filesystem>
 #include <iostream>
@@ -15,8 +16,10 @@ namespace fs = std::experimental::filesystem;
 #endif
 #include <errno.h>
 #include <unistd.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/un.h>
 
 #include "cabindb/include/cabindb/db.h"
 #include "cabindb/include/cabindb/table.h"
@@ -25,10 +28,16 @@ namespace fs = std::experimental::filesystem;
 #include "cabindb/include/cabindb/cache.h"
 #include "cabindb/include/cabindb/filter_policy.h"
 #include "cabindb/include/cabindb/utilities/convenience.h"
+#include "cabindb/include/cabindb/utilities/options_util.h"
 #include "cabindb/include/cabindb/merge_operator.h"
+#include "cabindb/include/cabindb/trace_reader_writer.h"
+#include "cabindb/include/cabindb/persistent_cache.h"
 
+#include "common/errno.h"
 #include "common/perf_counters.h"
 #include "common/PriorityCache.h"
+#include "common/safe_io.h"
+#include "include/buffer_raw.h"
 #include "include/common_fwd.h"
 #include "include/scope_guard.h"
 #include "include/str_list.h"
@@ -63,6 +72,27 @@ static const char* sharding_def_file = "sharding/def";
 static const char* sharding_recreate = "sharding/recreate_columns";
 static const char* resharding_column_lock = "reshardingXcommencingXlocked";
 
+// A value left pinned in the block cache by a lookup. The cache handle is
+// released along with the last reference to the buffer, which may outlive
+// the store, so the cache the handle belongs to is kept alive here too.
+// The block is shared with every other reader of the cache, so the raw is
+// read-only: writing through a ptr to it copies the value first.
+class raw_pinned_slice : public ceph::buffer::raw {
+  std::shared_ptr<cabindb::Cache> cache;
+  cabindb::PinnableSlice slice;
+public:
+  raw_pinned_slice(std::shared_ptr<cabindb::Cache> c,
+		   cabindb::PinnableSlice&& s)
+    : raw(const_cast<char*>(s.data()), s.size()),
+      cache(std::move(c)),
+      slice(std::move(s)) {
+    readonly = true;
+  }
+  raw* clone_empty() override {
+    return ceph::buffer::create(len).release();
+  }
+};
+
 static bufferlist to_bufferlist(cabindb::Slice in) {
   bufferlist bl;
   bl.append(bufferptr(in.data(), in.size()));
@@ -216,6 +246,121 @@ cabindb::Logger *create_cabindb_ceph_logger()
   return new CephCabindbLogger(g_ceph_context);
 }
 
+// A compaction job and its result are each sent over the worker socket as
+// a u32 length in host byte order followed by the payload. Both describe
+// files rather than carry their data, so a frame past the cap is garbage.
+static constexpr uint32_t max_compaction_frame = 64 << 20;
+
+static int write_compaction_frame(int fd, const std::string& payload)
+{
+  if (payload.size() > max_compaction_frame) {
+    return -EMSGSIZE;
+  }
+  uint32_t len = payload.size();
+  int r = safe_write(fd, &len, sizeof(len));
+  if (r == 0) {
+    r = safe_write(fd, payload.data(), payload.size());
+  }
+  return r;
+}
+
+static int read_compaction_frame(int fd, std::string *payload)
+{
+  uint32_t len;
+  int r = safe_read_exact(fd, &len, sizeof(len));
+  if (r == 0 && len > max_compaction_frame) {
+    r = -EMSGSIZE;
+  }
+  if (r == 0) {
+    payload->resize(len);
+    r = safe_read_exact(fd, payload->data(), len);
+  }
+  return r;
+}
+
+static int init_compaction_socket_addr(const std::string& socket_path,
+				       struct sockaddr_un *addr)
+{
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr->sun_path)) {
+    return -ENAMETOOLONG;
+  }
+  strcpy(addr->sun_path, socket_path.c_str());
+  return 0;
+}
+
+static int set_socket_timeout(int fd, int opt, std::chrono::seconds timeout)
+{
+  struct timeval tv = {};
+  tv.tv_sec = timeout.count();
+  if (::setsockopt(fd, SOL_SOCKET, opt, &tv, sizeof(tv)) < 0) {
+    return -errno;
+  }
+  return 0;
+}
+
+/// Sends every subcompaction to the worker listening on socket_path, one
+/// connection per job. An empty reply means the worker failed the job.
+/// A worker that does not accept within connect_timeout, or whose reply
+/// takes longer than job_timeout, fails the job too; cabindb then runs the
+/// subcompaction locally. Since the worker runs one job at a time, the
+/// wait for a reply includes the jobs queued ahead of this one.
+class CabinCompactionServiceClient : public cabindb::CompactionService {
+  CephContext *cct;
+  const std::string socket_path;
+  const std::chrono::seconds connect_timeout;
+  const std::chrono::seconds job_timeout;
+public:
+  CabinCompactionServiceClient(CephContext *c, const std::string& path)
+    : cct(c), socket_path(path),
+      connect_timeout(cct->_conf.get_val<std::chrono::seconds>(
+			"cabindb_compaction_service_connect_timeout")),
+      job_timeout(cct->_conf.get_val<std::chrono::seconds>(
+		    "cabindb_compaction_service_timeout")) {}
+
+  const char* Name() const override {
+    return "CabinCompactionServiceClient";
+  }
+
+  cabindb::Status Run(const std::string& input, std::string* output) override {
+    struct sockaddr_un addr;
+    int r = init_compaction_socket_addr(socket_path, &addr);
+    if (r < 0) {
+      return cabindb::Status::InvalidArgument(socket_path, cpp_strerror(r));
+    }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      return cabindb::Status::IOError("socket", cpp_strerror(errno));
+    }
+    auto close_fd = make_scope_guard([fd] { ::close(fd); });
+    // a unix socket connect blocks for the send timeout when the worker's
+    // backlog is full
+    r = set_socket_timeout(fd, SO_SNDTIMEO, connect_timeout);
+    if (r == 0 &&
+	::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+      r = -errno;
+    }
+    if (r == 0) {
+      r = write_compaction_frame(fd, input);
+    }
+    if (r == 0) {
+      r = set_socket_timeout(fd, SO_RCVTIMEO, job_timeout);
+    }
+    if (r == 0) {
+      r = read_compaction_frame(fd, output);
+    }
+    if (r < 0) {
+      dout(5) << __func__ << " " << socket_path << ": " << cpp_strerror(r) << dendl;
+      return cabindb::Status::IOError(socket_path, cpp_strerror(r));
+    }
+    if (output->empty()) {
+      return cabindb::Status::Aborted("compaction worker failed the job");
+    }
+    return cabindb::Status::OK();
+  }
+};
+
 static int string2bool(const string &val, bool &b_val)
 {
   if (strcasecmp(val.c_str(), "false") == 0) {
@@ -336,6 +481,14 @@ int CabinDBStore::tryInterpret(const string &key, const string &val, cabindb::Op
       return -EINVAL;
     //High priority threadpool is used for flusher
     opt.env->SetBackgroundThreads(f, cabindb::Env::Priority::HIGH);
+  } else if (key == "bottom_compaction_threads") {
+    std::string err;
+    int f = strict_iecstrtoll(val.c_str(), &err);
+    if (!err.empty())
+      return -EINVAL;
+    //Bottom priority threadpool is used for last level compactions and
+    //for column families with bottom_pri_compaction
+    opt.env->SetBackgroundThreads(f, cabindb::Env::Priority::BOTTOM);
   } else if (key == "compact_on_mount") {
     int ret = string2bool(val, compact_on_mount);
     if (ret != 0)
@@ -446,6 +599,12 @@ int CabinDBStore::install_cf_mergeop(
       cf_opt->merge_operator.reset(new MergeOperatorLinker(i.second));
     }
   }
+  // reads resolve blob values, but a merge on top of one is not supported
+  if (cf_opt->merge_operator && cf_opt->enable_blob_files) {
+    derr << __func__ << " column family " << key_prefix
+	 << " has a merge operator and cannot use enable_blob_files" << dendl;
+    return -EINVAL;
+  }
   return 0;
 }
 
@@ -479,6 +638,322 @@ std::shared_ptr<cabindb::Cache> CabinDBStore::create_block_cache(
   return cache;
 }
 
+/// Counts the lookups and inserts of the persistent cache tier in the
+/// l_cabindb_pcache_* perf counters once the store's logger exists.
+class CabinDBStore::CabinPersistentCache : public cabindb::PersistentCache {
+  std::shared_ptr<cabindb::PersistentCache> cache;
+  std::atomic<PerfCounters*> logger = {nullptr};
+
+public:
+  explicit CabinPersistentCache(std::shared_ptr<cabindb::PersistentCache> cache)
+    : cache(std::move(cache)) {}
+
+  void set_logger(PerfCounters* l) {
+    logger = l;
+  }
+
+  cabindb::Status Insert(const cabindb::Slice& key, const char* data,
+			 const size_t size) override {
+    if (auto l = logger.load(); l) {
+      l->inc(l_cabindb_pcache_insert);
+      l->inc(l_cabindb_pcache_insert_bytes, size);
+    }
+    return cache->Insert(key, data, size);
+  }
+
+  cabindb::Status Lookup(const cabindb::Slice& key, std::unique_ptr<char[]>* data,
+			 size_t* size) override {
+    utime_t start = ceph_clock_now();
+    cabindb::Status s = cache->Lookup(key, data, size);
+    if (auto l = logger.load(); l) {
+      if (s.ok()) {
+	l->inc(l_cabindb_pcache_hit);
+	l->inc(l_cabindb_pcache_read_bytes, *size);
+      } else {
+	l->inc(l_cabindb_pcache_miss);
+      }
+      l->tinc(l_cabindb_pcache_lookup_latency, ceph_clock_now() - start);
+    }
+    return s;
+  }
+
+  bool IsCompressed() override {
+    return cache->IsCompressed();
+  }
+
+  StatsType Stats() override {
+    return cache->Stats();
+  }
+
+  std::string GetPrintableOptions() const override {
+    return cache->GetPrintableOptions();
+  }
+
+  uint64_t NewId() override {
+    return cache->NewId();
+  }
+};
+
+/// Feeds the read queue depth and subcompaction histograms and the
+/// asynchronous readahead ticker into the l_cabindb_* perf counters once the
+/// store's logger exists.
+class CabinDBStore::CabinStatistics : public cabindb::Statistics {
+  std::shared_ptr<cabindb::Statistics> stats;
+  std::atomic<PerfCounters*> logger = {nullptr};
+
+public:
+  explicit CabinStatistics(std::shared_ptr<cabindb::Statistics> stats)
+    : stats(std::move(stats)) {}
+
+  void set_logger(PerfCounters* l) {
+    logger = l;
+  }
+
+  uint64_t getTickerCount(uint32_t tickerType) const override {
+    return stats->getTickerCount(tickerType);
+  }
+  void histogramData(uint32_t type,
+		     cabindb::HistogramData* const data) const override {
+    stats->histogramData(type, data);
+  }
+  std::string getHistogramString(uint32_t type) const override {
+    return stats->getHistogramString(type);
+  }
+  void recordTick(uint32_t tickerType, uint64_t count) override {
+    if (tickerType == cabindb::ASYNC_READ_BYTES) {
+      if (auto l = logger.load(); l) {
+	l->inc(l_cabindb_async_read_bytes, count);
+      }
+    }
+    stats->recordTick(tickerType, count);
+  }
+  void setTickerCount(uint32_t tickerType, uint64_t count) override {
+    stats->setTickerCount(tickerType, count);
+  }
+  uint64_t getAndResetTickerCount(uint32_t tickerType) override {
+    return stats->getAndResetTickerCount(tickerType);
+  }
+  void recordInHistogram(uint32_t histogramType, uint64_t value) override {
+    if (auto l = logger.load(); l) {
+      switch (histogramType) {
+      case cabindb::READ_QUEUE_DEPTH:
+	l->inc(l_cabindb_read_queue_depth, value);
+	break;
+      case cabindb::NUM_SUBCOMPACTIONS_SCHEDULED:
+	l->inc(l_cabindb_subcompactions, value);
+	break;
+      case cabindb::SUBCOMPACTION_TIME:
+	{
+	  utime_t lat;
+	  lat.set_from_double(static_cast<double>(value) / 1000000);
+	  l->tinc(l_cabindb_subcompaction_latency, lat);
+	}
+	break;
+      }
+    }
+    stats->recordInHistogram(histogramType, value);
+  }
+  cabindb::Status Reset() override {
+    return stats->Reset();
+  }
+  std::string ToString() const override {
+    return stats->ToString();
+  }
+  bool getTickerMap(std::map<std::string, uint64_t>* m) const override {
+    return stats->getTickerMap(m);
+  }
+  bool HistEnabledForType(uint32_t type) const override {
+    return stats->HistEnabledForType(type);
+  }
+};
+
+int CabinDBStore::create_persistent_cache(const cabindb::Options& opt)
+{
+  const auto cache_path = cct->_conf.get_val<std::string>("cabindb_persistent_cache_path");
+  if (cache_path.empty()) {
+    return 0;
+  }
+  cabindb::PersistentCacheTierOptions pcache_opts;
+  pcache_opts.file_size =
+    cct->_conf.get_val<Option::size_t>("cabindb_persistent_cache_file_size");
+  pcache_opts.optimized_for_nvm =
+    cct->_conf.get_val<bool>("cabindb_persistent_cache_optimized_for_nvm");
+  pcache_opts.pipeline_writes =
+    cct->_conf.get_val<bool>("cabindb_persistent_cache_async_admission");
+  if (cct->_conf.get_val<bool>("cabindb_persistent_cache_recover")) {
+    // cached blocks are only valid for the DB they were read from; a new
+    // DB has no identity yet, so its first run starts with an empty cache
+    std::string identity;
+    if (cabindb::ReadFileToString(opt.env, path + "/IDENTITY", &identity).ok()) {
+      while (!identity.empty() && identity.back() == '\n') {
+	identity.pop_back();
+      }
+      pcache_opts.identity = identity;
+    }
+  }
+
+  // the cache device is outside of the DB's env
+  std::shared_ptr<cabindb::PersistentCache> cache;
+  const uint64_t cache_size =
+    cct->_conf.get_val<Option::size_t>("cabindb_persistent_cache_size");
+  cabindb::Status status = cabindb::NewPersistentCache(
+    cabindb::Env::Default(), cache_path, cache_size, opt.info_log,
+    pcache_opts, &cache);
+  if (!status.ok()) {
+    derr << __func__ << " cannot open persistent cache at " << cache_path
+	 << ": " << status.ToString() << dendl;
+    return -EINVAL;
+  }
+  persistent_cache = std::make_shared<CabinPersistentCache>(cache);
+  bbt_opts.persistent_cache = persistent_cache;
+  dout(1) << __func__ << " " << cache_path << " size " << byte_u_t(cache_size)
+	  << (pcache_opts.identity.empty() ? "" : ", recovering blocks of ")
+	  << pcache_opts.identity << dendl;
+  return 0;
+}
+
+int CabinDBStore::create_filter_policy(
+    const std::string& filter_spec,
+    std::shared_ptr<const cabindb::FilterPolicy>* policy) {
+  std::string filter_type = filter_spec;
+  double bits_per_key = cct->_conf.get_val<uint64_t>("cabindb_bloom_bits_per_key");
+  if (auto pos = filter_spec.find(':'); pos != std::string::npos) {
+    filter_type = filter_spec.substr(0, pos);
+    std::string error;
+    bits_per_key = strict_strtod(filter_spec.c_str() + pos + 1, &error);
+    if (!error.empty() || bits_per_key < 0) {
+      derr << __func__ << " invalid bits per key in filter '" << filter_spec
+	   << "'" << dendl;
+      return -EINVAL;
+    }
+  }
+  if (filter_type != "bloom" && filter_type != "ribbon") {
+    derr << __func__ << " unrecognized filter type '" << filter_type << "'" << dendl;
+    return -EINVAL;
+  }
+  if (bits_per_key == 0) {
+    policy->reset();
+  } else if (filter_type == "ribbon") {
+    // same FP rate as a bloom filter with bits_per_key, in about 30% less space
+    policy->reset(cabindb::NewExperimentalRibbonFilterPolicy(bits_per_key));
+  } else {
+    policy->reset(cabindb::NewBloomFilterPolicy(bits_per_key));
+  }
+  dout(10) << __func__ << " " << filter_type << " filter with "
+	   << bits_per_key << " bits per key" << dendl;
+  return 0;
+}
+
+int CabinDBStore::expand_compaction_options(
+    const std::string& compaction_spec,
+    std::unordered_map<std::string, std::string>* column_opts_map) {
+  static const std::map<std::string, std::string> styles = {
+    {"leveled", "kCompactionStyleLevel"},
+    {"universal", "kCompactionStyleUniversal"},
+    {"fifo", "kCompactionStyleFIFO"},
+  };
+  std::string style = compaction_spec;
+  std::string priority = "low";
+  if (auto pos = compaction_spec.find(':'); pos != std::string::npos) {
+    style = compaction_spec.substr(0, pos);
+    priority = compaction_spec.substr(pos + 1);
+  }
+  auto it = styles.find(style);
+  if (it == styles.end()) {
+    derr << __func__ << " unrecognized compaction style '" << style << "'" << dendl;
+    return -EINVAL;
+  }
+  if (priority != "low" && priority != "high" && priority != "bottom") {
+    derr << __func__ << " unrecognized compaction priority '" << priority << "'"
+	 << dendl;
+    return -EINVAL;
+  }
+  // fifo compaction deletes the oldest files once a limit is reached; the
+  // default size limit is far below what a bluestore column can hold, so
+  // the limit has to be chosen explicitly
+  if (style == "fifo") {
+    auto fifo = column_opts_map->find("compaction_options_fifo");
+    if (!column_opts_map->count("ttl") &&
+	(fifo == column_opts_map->end() ||
+	 fifo->second.find("max_table_files_size") == std::string::npos)) {
+      derr << __func__ << " fifo compaction needs a size or age limit:"
+	   << " compaction_options_fifo={max_table_files_size=<bytes>}"
+	   << " or ttl=<seconds>" << dendl;
+      return -EINVAL;
+    }
+  }
+  // options given explicitly for the column win over the shorthand
+  column_opts_map->emplace("compaction_style", it->second);
+  column_opts_map->emplace("high_pri_compaction",
+			   priority == "high" ? "true" : "false");
+  column_opts_map->emplace("bottom_pri_compaction",
+			   priority == "bottom" ? "true" : "false");
+  dout(10) << __func__ << " " << style << " compaction at " << priority
+	   << " priority" << dendl;
+  return 0;
+}
+
+int CabinDBStore::check_fifo_switch(
+    const cabindb::Options& opt,
+    const std::vector<cabindb::ColumnFamilyDescriptor>& cfs) {
+  cabindb::ConfigOptions config_options;
+  config_options.ignore_unknown_options = true;
+  config_options.env = opt.env;
+  cabindb::DBOptions stored_db_opt;
+  std::vector<cabindb::ColumnFamilyDescriptor> stored_cfs;
+  cabindb::Status status = cabindb::LoadLatestOptions(
+    config_options, path, &stored_db_opt, &stored_cfs);
+  if (!status.ok()) {
+    // nothing to compare with
+    dout(10) << __func__ << " no stored options: " << status.ToString() << dendl;
+    return 0;
+  }
+  for (const auto& cf : cfs) {
+    if (cf.options.compaction_style != cabindb::kCompactionStyleFIFO) {
+      continue;
+    }
+    for (const auto& stored : stored_cfs) {
+      if (stored.name == cf.name &&
+	  stored.options.compaction_style != cabindb::kCompactionStyleFIFO) {
+	derr << __func__ << " column family " << cf.name
+	     << " holds data written with "
+	     << (stored.options.compaction_style == cabindb::kCompactionStyleLevel ?
+		 "leveled" : "universal")
+	     << " compaction and cannot be switched to fifo in place;"
+	     << " move its keys to a new column family instead" << dendl;
+	return -EINVAL;
+      }
+    }
+  }
+  return 0;
+}
+
+int CabinDBStore::check_memtable_options(
+    const std::string& column,
+    const cabindb::ColumnFamilyOptions& cf_opt) {
+  const std::string rep = cf_opt.memtable_factory->Name();
+  if ((rep == "HashSkipListRepFactory" || rep == "HashLinkListRepFactory") &&
+      !cf_opt.prefix_extractor) {
+    derr << __func__ << " column family " << column << " uses " << rep
+	 << " but sets no prefix_extractor" << dendl;
+    return -EINVAL;
+  }
+  return 0;
+}
+
+void CabinDBStore::adjust_memtable_writes(
+    cabindb::Options& opt,
+    const std::string& column,
+    const cabindb::ColumnFamilyOptions& cf_opt) {
+  if (opt.allow_concurrent_memtable_write &&
+      !cf_opt.memtable_factory->IsInsertConcurrentlySupported()) {
+    dout(1) << __func__ << " column family " << column << " uses "
+	    << cf_opt.memtable_factory->Name()
+	    << ", turning off allow_concurrent_memtable_write" << dendl;
+    opt.allow_concurrent_memtable_write = false;
+  }
+}
+
 int CabinDBStore::load_cabindb_options(bool create_if_missing, cabindb::Options& opt)
 {
   cabindb::Status status;
@@ -491,9 +966,12 @@ int CabinDBStore::load_cabindb_options(bool create_if_missing, cabindb::Options&
   }
 
   if (cct->_conf->cabindb_perf)  {
-    dbstats = cabindb::CreateDBStatistics();
+    dbstats = std::make_shared<CabinStatistics>(cabindb::CreateDBStatistics());
     opt.statistics = dbstats;
   }
+  async_io = cct->_conf.get_val<bool>("cabindb_async_io");
+  zero_copy_min_size =
+    cct->_conf.get_val<Option::size_t>("cabindb_zero_copy_min_value_size");
 
   opt.create_if_missing = create_if_missing;
   if (kv_options.count("separate_wal_dir")) {
@@ -542,6 +1020,18 @@ int CabinDBStore::load_cabindb_options(bool create_if_missing, cabindb::Options&
 
   opt.env->SetAllowNonOwnerAccess(false);
 
+  if (auto socket_path = cct->_conf.get_val<std::string>("cabindb_compaction_service_socket");
+      !socket_path.empty()) {
+    if (priv) {
+      derr << __func__ << " cabindb_compaction_service_socket is not supported"
+	   << " on BlueFS, compacting locally" << dendl;
+    } else {
+      dout(10) << __func__ << " compaction service at " << socket_path << dendl;
+      opt.compaction_service =
+	std::make_shared<CabinCompactionServiceClient>(cct, socket_path);
+    }
+  }
+
   // caches
   if (!set_cache_flag) {
     cache_size = cct->_conf->cabindb_cache_size;
@@ -554,15 +1044,25 @@ int CabinDBStore::load_cabindb_options(bool create_if_missing, cabindb::Options&
     return -EINVAL;
   }
   bbt_opts.block_size = cct->_conf->cabindb_block_size;
+  if (int r = create_persistent_cache(opt); r < 0) {
+    return r;
+  }
+
+  if (auto limit = cct->_conf.get_val<Option::size_t>("cabindb_write_buffer_limit");
+      limit > 0) {
+    write_buffer_cache = cabindb_cache::WriteBufferCache::get_shared(
+      cct, cct->_conf.get_val<Option::size_t>("cabindb_write_buffer_min"), limit);
+    opt.write_buffer_manager = write_buffer_cache->get_write_buffer_manager();
+    dout(10) << __func__ << " write buffer limit "
+	     << byte_u_t(write_buffer_cache->get_committed_size()) << dendl;
+  }
 
   if (row_cache_size > 0)
     opt.row_cache = cabindb::NewLRUCache(row_cache_size,
 				     cct->_conf->cabindb_cache_shard_bits);
-  uint64_t bloom_bits = cct->_conf.get_val<uint64_t>("cabindb_bloom_bits_per_key");
-  if (bloom_bits > 0) {
-    dout(10) << __func__ << " set bloom filter bits per key to "
-	     << bloom_bits << dendl;
-    bbt_opts.filter_policy.reset(cabindb::NewBloomFilterPolicy(bloom_bits));
+  if (create_filter_policy(cct->_conf.get_val<std::string>("cabindb_filter_type"),
+			   &bbt_opts.filter_policy) < 0) {
+    return -EINVAL;
   }
   using std::placeholders::_1;
   if (cct->_conf.with_val<std::string>("cabindb_index_type",
@@ -577,6 +1077,14 @@ int CabinDBStore::load_cabindb_options(bool create_if_missing, cabindb::Options&
 				    std::bind(std::equal_to<std::string>(), _1,
 					      "two_level")))
     bbt_opts.index_type = cabindb::BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+  if (cct->_conf.with_val<std::string>("cabindb_index_type",
+				    std::bind(std::equal_to<std::string>(), _1,
+					      "learned"))) {
+    bbt_opts.index_type = cabindb::BlockBasedTableOptions::IndexType::kLearnedIndexSearch;
+    // the model only covers index restart keys; a sparse restart interval
+    // keeps the binary index that backs it small
+    bbt_opts.index_block_restart_interval = 16;
+  }
   if (!bbt_opts.no_block_cache) {
     bbt_opts.cache_index_and_filter_blocks =
         cct->_conf.get_val<bool>("cabindb_cache_index_and_filter_blocks");
@@ -598,6 +1106,7 @@ int CabinDBStore::load_cabindb_options(bool create_if_missing, cabindb::Options&
 	   << ", type " << cct->_conf->cabindb_cache_type
 	   << dendl;
 
+  adjust_memtable_writes(opt, cabindb::kDefaultColumnFamilyName, opt);
   opt.merge_operator.reset(new MergeOperatorRouter(*this));
   comparator = opt.comparator;
   return 0;
@@ -627,36 +1136,103 @@ bool CabinDBStore::is_column_family(const std::string& prefix) {
   return cf_handles.count(prefix);
 }
 
-cabindb::ColumnFamilyHandle *CabinDBStore::get_cf_handle(const std::string& prefix, const std::string& key) {
-  auto iter = cf_handles.find(prefix);
-  if (iter == cf_handles.end()) {
-    return nullptr;
+cabindb::ColumnFamilyHandle *CabinDBStore::select_shard(const prefix_shards& shards,
+							const char* key, size_t keylen) {
+  if (shards.handles.size() == 1) {
+    return shards.handles[0];
   } else {
-    if (iter->second.handles.size() == 1) {
-      return iter->second.handles[0];
-    } else {
-      uint32_t hash_l = std::min<uint32_t>(iter->second.hash_l, key.size());
-      uint32_t hash_h = std::min<uint32_t>(iter->second.hash_h, key.size());
-      uint32_t hash = ceph_str_hash_rjenkins(&key[hash_l], hash_h - hash_l);
-      return iter->second.handles[hash % iter->second.handles.size()];
-    }
+    uint32_t hash_l = std::min<uint32_t>(shards.hash_l, keylen);
+    uint32_t hash_h = std::min<uint32_t>(shards.hash_h, keylen);
+    uint32_t hash = ceph_str_hash_rjenkins(&key[hash_l], hash_h - hash_l);
+    return shards.handles[hash % shards.handles.size()];
   }
 }
 
+cabindb::ColumnFamilyHandle *CabinDBStore::get_cf_handle(const std::string& prefix, const std::string& key) {
+  return get_cf_handle(prefix, key.data(), key.size());
+}
+
 cabindb::ColumnFamilyHandle *CabinDBStore::get_cf_handle(const std::string& prefix, const char* key, size_t keylen) {
+  return get_cf_handle(sharding_state.load(std::memory_order_acquire), prefix, key, keylen);
+}
+
+cabindb::ColumnFamilyHandle *CabinDBStore::get_cf_handle(const sharding_state_t* state,
+							 const std::string& prefix,
+							 const char* key, size_t keylen) {
   auto iter = cf_handles.find(prefix);
   if (iter == cf_handles.end()) {
     return nullptr;
+  } else if (auto column = get_resharding_column(state, prefix); column) {
+    // keys of a column being resharded online are written to the new shards
+    return select_shard(column->target, key, keylen);
   } else {
-    if (iter->second.handles.size() == 1) {
-      return iter->second.handles[0];
-    } else {
-      uint32_t hash_l = std::min<uint32_t>(iter->second.hash_l, keylen);
-      uint32_t hash_h = std::min<uint32_t>(iter->second.hash_h, keylen);
-      uint32_t hash = ceph_str_hash_rjenkins(&key[hash_l], hash_h - hash_l);
-      return iter->second.handles[hash % iter->second.handles.size()];
-    }
+    return select_shard(get_shards(state, prefix, iter->second), key, keylen);
+  }
+}
+
+cabindb::ColumnFamilyHandle *CabinDBStore::get_old_cf_handle(const std::string& prefix, const char* key, size_t keylen) {
+  return get_old_cf_handle(sharding_state.load(std::memory_order_acquire), prefix, key, keylen);
+}
+
+cabindb::ColumnFamilyHandle *CabinDBStore::get_old_cf_handle(const sharding_state_t* state,
+							     const std::string& prefix,
+							     const char* key, size_t keylen) {
+  auto column = get_resharding_column(state, prefix);
+  if (!column) {
+    return nullptr;
+  }
+  auto old_cf = select_shard(*column->source, key, keylen);
+  auto new_cf = select_shard(column->target, key, keylen);
+  return old_cf == new_cf ? nullptr : old_cf;
+}
+
+const CabinDBStore::resharding_column* CabinDBStore::get_resharding_column(const std::string& prefix) const {
+  return get_resharding_column(sharding_state.load(std::memory_order_acquire), prefix);
+}
+
+const CabinDBStore::resharding_column* CabinDBStore::get_resharding_column(
+  const sharding_state_t* state, const std::string& prefix) {
+  if (!state || !state->reshard) {
+    return nullptr;
+  }
+  auto column = state->reshard->columns.find(prefix);
+  return column == state->reshard->columns.end() ? nullptr : &column->second;
+}
+
+const CabinDBStore::prefix_shards& CabinDBStore::get_shards(
+  const sharding_state_t* state, const std::string& prefix, const prefix_shards& shards) {
+  if (!state) {
+    return shards;
+  }
+  auto p = state->resharded.find(prefix);
+  return p == state->resharded.end() ? shards : *p->second;
+}
+
+const std::vector<cabindb::ColumnFamilyHandle *>& CabinDBStore::get_cf_handles(
+  const std::string& prefix, const prefix_shards& shards, bool* moving) const {
+  return get_cf_handles(sharding_state.load(std::memory_order_acquire), prefix, shards, moving);
+}
+
+const std::vector<cabindb::ColumnFamilyHandle *>& CabinDBStore::get_cf_handles(
+  const sharding_state_t* state, const std::string& prefix,
+  const prefix_shards& shards, bool* moving) {
+  auto column = get_resharding_column(state, prefix);
+  if (moving) {
+    *moving = column != nullptr;
   }
+  return column ? column->handles : get_shards(state, prefix, shards).handles;
+}
+
+const std::string& CabinDBStore::get_cf_prefix(uint32_t column_family_id) const {
+  // reshard_online() adds the ids of new shards
+  ceph_assert(ceph_mutex_is_locked(reshard_lock));
+  return cf_ids_to_prefix.at(column_family_id);
+}
+
+void CabinDBStore::set_sharding_state(std::unique_ptr<const sharding_state_t> state) {
+  ceph_assert(ceph_mutex_is_wlocked(reshard_lock));
+  sharding_state.store(state.get(), std::memory_order_release);
+  sharding_states.push_back(std::move(state));
 }
 
 /**
@@ -768,30 +1344,48 @@ void CabinDBStore::sharding_def_to_columns(const std::vector<ColumnFamily>& shar
   }
 }
 
+int CabinDBStore::column_family_options(const cabindb::Options& opt,
+					const ColumnFamily& column,
+					cabindb::ColumnFamilyOptions* cf_opt)
+{
+  // copy default CF settings, block cache, merge operators as
+  // the base for new CF
+  *cf_opt = cabindb::ColumnFamilyOptions(opt);
+  // user input options will override the base options
+  std::unordered_map<std::string, std::string> column_opts_map;
+  std::string block_cache_opts;
+  std::string filter_opts;
+  int r = extract_block_cache_options(column.options, &column_opts_map, &block_cache_opts,
+				      &filter_opts);
+  if (r != 0) {
+    derr << __func__ << " failed to parse options; column family=" << column.name <<
+      " options=" << column.options << dendl;
+    return -EINVAL;
+  }
+  cabindb::Status status;
+  status = cabindb::GetColumnFamilyOptionsFromMap(*cf_opt, column_opts_map, cf_opt);
+  if (!status.ok()) {
+    derr << __func__ << " invalid db options; column family="
+	 << column.name << " options=" << column.options << dendl;
+    return -EINVAL;
+  }
+  r = check_memtable_options(column.name, *cf_opt);
+  if (r != 0) {
+    return r;
+  }
+  return install_cf_mergeop(column.name, cf_opt);
+}
+
 int CabinDBStore::create_shards(const cabindb::Options& opt,
 				const std::vector<ColumnFamily>& sharding_def)
 {
   for (auto& p : sharding_def) {
-    // copy default CF settings, block cache, merge operators as
-    // the base for new CF
-    cabindb::ColumnFamilyOptions cf_opt(opt);
-    // user input options will override the base options
-    std::unordered_map<std::string, std::string> column_opts_map;
-    std::string block_cache_opts;
-    int r = extract_block_cache_options(p.options, &column_opts_map, &block_cache_opts);
+    cabindb::ColumnFamilyOptions cf_opt;
+    int r = column_family_options(opt, p, &cf_opt);
     if (r != 0) {
-      derr << __func__ << " failed to parse options; column family=" << p.name <<
-	" options=" << p.options << dendl;
-      return -EINVAL;
+      return r;
     }
     cabindb::Status status;
-    status = cabindb::GetColumnFamilyOptionsFromMap(cf_opt, column_opts_map, &cf_opt);
-    if (!status.ok()) {
-      derr << __func__ << " invalid db options; column family="
-	   << p.name << " options=" << p.options << dendl;
-      return -EINVAL;
-    }
-    install_cf_mergeop(p.name, &cf_opt);
     for (size_t idx = 0; idx < p.shard_cnt; idx++) {
       std::string cf_name;
       if (p.shard_cnt == 1)
@@ -855,7 +1449,8 @@ extern cabindb::Status cabindb::StringToMap(const std::string& opts_str,
 
 int CabinDBStore::extract_block_cache_options(const std::string& opts_str,
 					      std::unordered_map<std::string, std::string>* column_opts_map,
-					      std::string* block_cache_opt)
+					      std::string* block_cache_opt,
+					      std::string* filter_opt)
 {
   dout(5) << __func__ << " opts_str=" << opts_str << dendl;
   cabindb::Status status = cabindb::StringToMap(opts_str, column_opts_map);
@@ -871,6 +1466,19 @@ int CabinDBStore::extract_block_cache_options(const std::string& opts_str,
   } else {
     block_cache_opt->clear();
   }
+  //extract "filter" option, it is a table option too
+  if (auto it = column_opts_map->find("filter"); it != column_opts_map->end()) {
+    *filter_opt = it->second;
+    column_opts_map->erase(it);
+  } else {
+    filter_opt->clear();
+  }
+  //expand "compaction" shorthand into column family options
+  if (auto it = column_opts_map->find("compaction"); it != column_opts_map->end()) {
+    std::string compaction_opt = it->second;
+    column_opts_map->erase(it);
+    return expand_compaction_options(compaction_opt, column_opts_map);
+  }
   return 0;
 }
 
@@ -926,17 +1534,43 @@ int CabinDBStore::verify_sharding(const cabindb::Options& opt,
     }
   };
 
+  auto cf_cache_list = get_str_list(
+    cct->_conf.get_val<std::string>("cabindb_cf_cache_prefixes"));
+  std::set<std::string> cf_cache_prefixes(cf_cache_list.begin(), cf_cache_list.end());
+  // the shared block cache and the ones added for cabindb_cf_cache_prefixes
+  // split the block cache budget evenly; PriorityCache rebalances them later
+  size_t own_caches = 0;
+  for (auto& column : stored_sharding_def) {
+    if (cf_cache_prefixes.count(column.name) &&
+	column.options.find("block_cache") == std::string::npos) {
+      ++own_caches;
+    }
+  }
+  size_t cache_share = cct->_conf->cabindb_cache_size;
+  if (own_caches > 0 && bbt_opts.block_cache) {
+    cache_share = bbt_opts.block_cache->GetCapacity() / (own_caches + 1);
+    bbt_opts.block_cache->SetCapacity(cache_share);
+    dout(10) << __func__ << " block cache split in " << own_caches + 1
+	     << " parts of " << byte_u_t(cache_share) << dendl;
+  }
   for (auto& column : stored_sharding_def) {
     cabindb::ColumnFamilyOptions cf_opt(opt);
     std::unordered_map<std::string, std::string> options_map;
     std::string block_cache_opt;
+    std::string filter_opt;
 
-    int r = extract_block_cache_options(column.options, &options_map, &block_cache_opt);
+    int r = extract_block_cache_options(column.options, &options_map, &block_cache_opt,
+					&filter_opt);
     if (r != 0) {
       derr << __func__ << " failed to parse options; column family=" << column.name <<
 	" options=" << column.options << dendl;
       return -EINVAL;
     }
+    if (block_cache_opt.empty() && cf_cache_prefixes.count(column.name)) {
+      // give the column its own cache so it is balanced on its own hits
+      block_cache_opt = "type=" + cct->_conf->cabindb_cache_type +
+	";size=" + stringify(cache_share);
+    }
     status = cabindb::GetColumnFamilyOptionsFromMap(cf_opt, options_map, &cf_opt);
     if (!status.ok()) {
       derr << __func__ << " invalid db column family options for CF '"
@@ -944,9 +1578,16 @@ int CabinDBStore::verify_sharding(const cabindb::Options& opt,
       derr << __func__ << " error = '" << status.getState() << "'" << dendl;
       return -EINVAL;
     }
-    install_cf_mergeop(column.name, &cf_opt);
+    r = check_memtable_options(column.name, cf_opt);
+    if (r != 0) {
+      return r;
+    }
+    r = install_cf_mergeop(column.name, &cf_opt);
+    if (r != 0) {
+      return r;
+    }
 
-    if (!block_cache_opt.empty()) {
+    if (!block_cache_opt.empty() || !filter_opt.empty()) {
       std::unordered_map<std::string, std::string> cache_options_map;
       status = cabindb::StringToMap(block_cache_opt, &cache_options_map);
       if (!status.ok()) {
@@ -1009,6 +1650,14 @@ int CabinDBStore::verify_sharding(const cabindb::Options& opt,
 	}
       }
       column_bbt_opts.block_cache = block_cache;
+      if (!filter_opt.empty()) {
+	r = create_filter_policy(filter_opt, &column_bbt_opts.filter_policy);
+	if (r != 0) {
+	  derr << __func__ << " invalid filter; column=" << column.name <<
+	    " filter=" << filter_opt << dendl;
+	  return r;
+	}
+      }
       cf_bbt_opts[column.name] = column_bbt_opts;
       cf_opt.table_factory.reset(NewBlockBasedTableFactory(cf_bbt_opts[column.name]));
     }
@@ -1057,6 +1706,15 @@ int CabinDBStore::do_open(ostream &out,
 			  const std::string& sharding_text)
 {
   ceph_assert(!(create_if_missing && open_readonly));
+  // close() stops the background threads; a reopened store restarts them
+  {
+    std::lock_guard l{commit_queue_lock};
+    commit_queue_stop = false;
+  }
+  {
+    std::lock_guard l{compact_queue_lock};
+    compact_queue_stop = false;
+  }
   cabindb::Options opt;
   int r = load_cabindb_options(create_if_missing, opt);
   if (r) {
@@ -1065,6 +1723,16 @@ int CabinDBStore::do_open(ostream &out,
   }
   cabindb::Status status;
   if (create_if_missing) {
+    // a bad definition is reported by apply_sharding() below
+    std::vector<ColumnFamily> sharding_def;
+    if (parse_sharding_def(sharding_text, sharding_def)) {
+      for (auto& column : sharding_def) {
+	cabindb::ColumnFamilyOptions cf_opt;
+	if (column_family_options(opt, column, &cf_opt) == 0) {
+	  adjust_memtable_writes(opt, column.name, cf_opt);
+	}
+      }
+    }
     status = cabindb::DB::Open(opt, path, &db);
     if (!status.ok()) {
       derr << status.ToString() << dendl;
@@ -1087,6 +1755,12 @@ int CabinDBStore::do_open(ostream &out,
     if (r < 0) {
       return r;
     }
+    for (auto& cf : existing_cfs) {
+      adjust_memtable_writes(opt, cf.name, cf.options);
+    }
+    for (auto& cf : missing_cfs) {
+      adjust_memtable_writes(opt, cf.name, cf.options);
+    }
     std::string sharding_recreate_text;
     status = cabindb::ReadFileToString(opt.env,
 				       sharding_recreate,
@@ -1107,6 +1781,10 @@ int CabinDBStore::do_open(ostream &out,
       }
     }
 
+    r = check_fifo_switch(opt, existing_cfs);
+    if (r < 0) {
+      return r;
+    }
     if (existing_cfs.empty()) {
       // no column families
       if (open_readonly) {
@@ -1187,8 +1865,52 @@ int CabinDBStore::do_open(ostream &out,
   plb.add_time_avg(l_cabindb_write_delay_time, "cabindb_write_delay_time", "Cabindb write delay time");
   plb.add_time_avg(l_cabindb_write_pre_and_post_process_time, 
       "cabindb_write_pre_and_post_time", "total time spent on writing a record, excluding write process");
+  plb.add_time_avg(l_cabindb_submit_async_latency, "submit_async_latency",
+      "Time from submit_transaction_async to its commit callback");
+  plb.add_u64(l_cabindb_commit_queue_len, "commit_queue_len", "Length of group commit queue");
+  plb.add_u64_avg(l_cabindb_group_commit_txns, "group_commit_txns",
+      "Transactions committed per WAL sync");
+  plb.add_time_avg(l_cabindb_group_commit_latency, "group_commit_latency",
+      "Time to write and sync one commit group");
+  plb.add_u64_counter(l_cabindb_pcache_hit, "pcache_hit",
+      "Block reads served by the persistent cache");
+  plb.add_u64_counter(l_cabindb_pcache_miss, "pcache_miss",
+      "Block reads missed in the persistent cache");
+  plb.add_u64_counter(l_cabindb_pcache_read_bytes, "pcache_read_bytes",
+      "Bytes read from the persistent cache", NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_u64_counter(l_cabindb_pcache_insert, "pcache_insert",
+      "Blocks admitted to the persistent cache");
+  plb.add_u64_counter(l_cabindb_pcache_insert_bytes, "pcache_insert_bytes",
+      "Bytes admitted to the persistent cache", NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_time_avg(l_cabindb_pcache_lookup_latency, "pcache_lookup_latency",
+      "Persistent cache lookup latency");
+  plb.add_u64_avg(l_cabindb_read_queue_depth, "read_queue_depth",
+      "Table file reads in flight when a read is issued (cabindb_perf only)");
+  plb.add_u64_counter(l_cabindb_async_read_bytes, "async_read_bytes",
+      "Bytes read ahead asynchronously (cabindb_perf only)", NULL, 0,
+      unit_t(UNIT_BYTES));
+  plb.add_u64_avg(l_cabindb_subcompactions, "subcompactions",
+      "Subcompactions a split compaction runs in parallel (cabindb_perf only)");
+  plb.add_time_avg(l_cabindb_subcompaction_latency, "subcompaction_latency",
+      "Time spent by each subcompaction (cabindb_perf only)");
+  plb.add_u64_counter(l_cabindb_zero_copy_gets, "zero_copy_gets",
+      "Values returned by reference to the block cache");
+  plb.add_u64_counter(l_cabindb_zero_copy_bytes, "zero_copy_bytes",
+      "Bytes returned by reference to the block cache", NULL, 0,
+      unit_t(UNIT_BYTES));
+  plb.add_u64_counter(l_cabindb_reshard_keys_moved, "reshard_keys_moved",
+      "Keys moved to their new shard by an online reshard");
+  plb.add_u64_counter(l_cabindb_reshard_bytes_moved, "reshard_bytes_moved",
+      "Bytes moved to their new shard by an online reshard", NULL, 0,
+      unit_t(UNIT_BYTES));
   logger = plb.create_perf_counters();
   cct->get_perfcounters_collection()->add(logger);
+  if (persistent_cache) {
+    persistent_cache->set_logger(logger);
+  }
+  if (dbstats) {
+    static_cast<CabinStatistics*>(dbstats.get())->set_logger(logger);
+  }
 
   if (compact_on_mount) {
     derr << "Compacting cabindb store..." << dendl;
@@ -1219,6 +1941,33 @@ CabinDBStore::~CabinDBStore()
 
 void CabinDBStore::close()
 {
+  // stop moving keys; an unfinished online reshard keeps the sharding
+  // locked until reshard() completes it
+  reshard_thread_lock.lock();
+  if (reshard_thread.is_started()) {
+    dout(1) << __func__ << " waiting for reshard thread to stop" << dendl;
+    reshard_stop = true;
+    reshard_cond.notify_all();
+    reshard_thread_lock.unlock();
+    reshard_thread.join();
+    dout(1) << __func__ << " reshard thread stopped" << dendl;
+  } else {
+    reshard_thread_lock.unlock();
+  }
+
+  // drain and stop the group commit thread
+  commit_queue_lock.lock();
+  if (commit_thread.is_started()) {
+    dout(1) << __func__ << " waiting for commit thread to stop" << dendl;
+    commit_queue_stop = true;
+    commit_queue_cond.notify_all();
+    commit_queue_lock.unlock();
+    commit_thread.join();
+    dout(1) << __func__ << " commit thread stopped" << dendl;
+  } else {
+    commit_queue_lock.unlock();
+  }
+
   // stop compaction thread
   compact_queue_lock.lock();
   if (compact_thread.is_started()) {
@@ -1232,6 +1981,9 @@ void CabinDBStore::close()
     compact_queue_lock.unlock();
   }
 
+  if (persistent_cache) {
+    persistent_cache->set_logger(nullptr);
+  }
   if (logger) {
     cct->get_perfcounters_collection()->remove(logger);
     delete logger;
@@ -1245,6 +1997,18 @@ void CabinDBStore::close()
     }
   }
   cf_handles.clear();
+  sharding_state = nullptr;
+  sharding_states.clear();
+  if (auto rs = online_reshard.exchange(nullptr); rs && !rs->done) {
+    derr << __func__ << " online reshard to '" << rs->sharding
+	 << "' did not finish, complete it with reshard" << dendl;
+  }
+  for (auto& rs : online_reshards) {
+    for (auto cf : rs->created) {
+      db->DestroyColumnFamilyHandle(cf);
+    }
+  }
+  online_reshards.clear();
   if (must_close_default_cf) {
     db->DestroyColumnFamilyHandle(default_cf);
     must_close_default_cf = false;
@@ -1254,6 +2018,88 @@ void CabinDBStore::close()
   db = nullptr;
 }
 
+int CabinDBStore::run_compaction_worker(std::ostream &out,
+					const std::string& socket_path)
+{
+  cabindb::Options opt;
+  int r = load_cabindb_options(false, opt);
+  if (r) {
+    dout(1) << __func__ << " load cabindb options failed" << dendl;
+    out << "load cabindb options failed" << std::endl;
+    return r;
+  }
+  if (opt.compaction_service) {
+    // the worker shares the config of the store it compacts for, and must
+    // not hand the jobs back to itself
+    dout(1) << __func__ << " ignoring cabindb_compaction_service_socket" << dendl;
+    out << "ignoring cabindb_compaction_service_socket, compacting locally" << std::endl;
+    opt.compaction_service.reset();
+  }
+  std::vector<cabindb::ColumnFamilyDescriptor> existing_cfs;
+  std::vector<std::pair<size_t, CabinDBStore::ColumnFamily> > existing_cfs_shard;
+  std::vector<cabindb::ColumnFamilyDescriptor> missing_cfs;
+  std::vector<std::pair<size_t, CabinDBStore::ColumnFamily> > missing_cfs_shard;
+  r = verify_sharding(opt,
+		      existing_cfs, existing_cfs_shard,
+		      missing_cfs, missing_cfs_shard);
+  if (r < 0) {
+    return r;
+  }
+  if (existing_cfs.empty()) {
+    existing_cfs.emplace_back(cabindb::kDefaultColumnFamilyName,
+			      cabindb::ColumnFamilyOptions(opt));
+  }
+
+  struct sockaddr_un addr;
+  r = init_compaction_socket_addr(socket_path, &addr);
+  if (r < 0) {
+    out << "bad socket path " << socket_path << std::endl;
+    return r;
+  }
+  int listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd < 0) {
+    return -errno;
+  }
+  ::unlink(socket_path.c_str());
+  auto close_listen_fd = make_scope_guard([&] {
+    ::close(listen_fd);
+    ::unlink(socket_path.c_str());
+  });
+  if (::bind(listen_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      ::listen(listen_fd, 16) < 0) {
+    r = -errno;
+    out << "cannot listen on " << socket_path << ": " << cpp_strerror(r) << std::endl;
+    return r;
+  }
+
+  // the secondary instance of each job keeps its info log here
+  const std::string secondary_path = path + "/compaction_worker";
+  out << "compacting " << path << " for " << socket_path << std::endl;
+  while (true) {
+    int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR) {
+	continue;
+      }
+      r = -errno;
+      derr << __func__ << " accept failed: " << cpp_strerror(r) << dendl;
+      return r;
+    }
+    std::string input, output;
+    r = read_compaction_frame(fd, &input);
+    if (r == 0) {
+      cabindb::Status status = cabindb::DB::OpenAndCompact(
+	cabindb::DBOptions(opt), path, secondary_path, existing_cfs, input, &output);
+      dout(5) << __func__ << " compaction " << status.ToString() << dendl;
+      r = write_compaction_frame(fd, output);
+    }
+    if (r < 0) {
+      derr << __func__ << " lost a compaction job: " << cpp_strerror(r) << dendl;
+    }
+    ::close(fd);
+  }
+}
+
 int CabinDBStore::repair(std::ostream &out)
 {
   cabindb::Status status;
@@ -1325,6 +2171,64 @@ bool CabinDBStore::get_property(
   return db->GetIntProperty(property, out);
 }
 
+bool CabinDBStore::get_property_all_cfs(
+  const std::string &property,
+  uint64_t *out)
+{
+  uint64_t total = 0;
+  uint64_t v = 0;
+  if (!db->GetIntProperty(default_cf, property, &v)) {
+    return false;
+  }
+  total += v;
+  for (auto& [prefix, shards] : cf_handles) {
+    for (auto cf : get_cf_handles(prefix, shards)) {
+      if (!db->GetIntProperty(cf, property, &v)) {
+	return false;
+      }
+      total += v;
+    }
+  }
+  *out = total;
+  return true;
+}
+
+bool CabinDBStore::get_ticker(
+  uint32_t ticker,
+  uint64_t *out)
+{
+  if (!dbstats) {
+    return false;
+  }
+  *out = dbstats->getTickerCount(ticker);
+  return true;
+}
+
+int CabinDBStore::start_trace(const std::string &path)
+{
+  std::unique_ptr<cabindb::TraceWriter> trace_writer;
+  cabindb::Status status = cabindb::NewFileTraceWriter(
+    db->GetEnv(), cabindb::EnvOptions(), path, &trace_writer);
+  if (status.ok()) {
+    status = db->StartTrace(cabindb::TraceOptions(), std::move(trace_writer));
+  }
+  if (!status.ok()) {
+    derr << __func__ << " " << path << ": " << status.ToString() << dendl;
+    return -EIO;
+  }
+  return 0;
+}
+
+int CabinDBStore::end_trace()
+{
+  cabindb::Status status = db->EndTrace();
+  if (!status.ok()) {
+    derr << __func__ << " " << status.ToString() << dendl;
+    return -EIO;
+  }
+  return 0;
+}
+
 int64_t CabinDBStore::estimate_prefix_size(const string& prefix,
 					   const string& key_prefix)
 {
@@ -1334,7 +2238,7 @@ int64_t CabinDBStore::estimate_prefix_size(const string& prefix,
     cabindb::DB::INCLUDE_FILES;
   auto p_iter = cf_handles.find(prefix);
   if (p_iter != cf_handles.end()) {
-    for (auto cf : p_iter->second.handles) {
+    for (auto cf : get_cf_handles(prefix, p_iter->second)) {
       uint64_t s = 0;
       string start = key_prefix + string(1, '\x00');
       string limit = key_prefix + string("\xff\xff\xff\xff");
@@ -1372,6 +2276,31 @@ void CabinDBStore::get_statistics(Formatter *f)
       }
       f->close_section();
     }
+
+    f->open_array_section("cabindb_blob_files");
+    auto dump_blobs = [this, f](cabindb::ColumnFamilyHandle* cf) {
+      uint64_t files = 0, total = 0, garbage = 0;
+      if (!db->GetIntProperty(cf, cabindb::DB::Properties::kNumBlobFiles, &files) ||
+	  files == 0) {
+	return;
+      }
+      db->GetIntProperty(cf, cabindb::DB::Properties::kTotalBlobFileSize, &total);
+      db->GetIntProperty(cf, cabindb::DB::Properties::kBlobGarbageSize, &garbage);
+      f->open_object_section("column_family");
+      f->dump_string("name", cf->GetName());
+      f->dump_unsigned("num_files", files);
+      f->dump_unsigned("total_size", total);
+      f->dump_unsigned("garbage_size", garbage);
+      f->dump_float("garbage_ratio", total ? (double)garbage / total : 0);
+      f->close_section();
+    };
+    dump_blobs(default_cf);
+    for (auto& [prefix, shards] : cf_handles) {
+      for (auto cf : get_cf_handles(prefix, shards)) {
+	dump_blobs(cf);
+      }
+    }
+    f->close_section();
   }
   if (cct->_conf->cabindb_collect_extended_stats) {
     if (dbstats) {
@@ -1406,9 +2335,66 @@ void CabinDBStore::get_statistics(Formatter *f)
     db->GetProperty("cabindb.estimate-table-readers-mem", &str);
     f->dump_string("cabindb_index_filter_blocks_usage", str);
     f->close_section();
+
+    f->open_array_section("cabindb_block_caches");
+    auto dump_cache = [f](const std::string& name,
+			  std::shared_ptr<PriorityCache::PriCache> cache) {
+      uint64_t hits = cache->get_cache_hits();
+      uint64_t misses = cache->get_cache_misses();
+      f->open_object_section("cache");
+      f->dump_string("name", name);
+      f->dump_unsigned("hits", hits);
+      f->dump_unsigned("misses", misses);
+      f->dump_float("hit_rate", hits + misses ? (double)hits / (hits + misses) : 0);
+      f->close_section();
+    };
+    if (auto cache = get_priority_cache(); cache) {
+      dump_cache("default", cache);
+    }
+    for (auto& [prefix, cache] : get_priority_caches()) {
+      dump_cache(prefix, cache);
+    }
+    f->close_section();
+
+    if (write_buffer_cache) {
+      auto wbm = write_buffer_cache->get_write_buffer_manager();
+      f->open_object_section("cabindb_write_buffer");
+      f->dump_unsigned("usage", wbm->memory_usage());
+      f->dump_unsigned("mutable_usage", wbm->mutable_memtable_memory_usage());
+      f->dump_unsigned("limit", wbm->buffer_size());
+      f->close_section();
+    }
+
+    if (persistent_cache) {
+      f->open_array_section("cabindb_persistent_cache");
+      for (auto& tier : persistent_cache->Stats()) {
+	f->open_object_section("tier");
+	for (auto& [name, value] : tier) {
+	  f->dump_float(name.c_str(), value);
+	}
+	f->close_section();
+      }
+      f->close_section();
+    }
   }
 }
 
+std::map<std::string, std::shared_ptr<PriorityCache::PriCache>>
+CabinDBStore::get_priority_caches() const
+{
+  std::map<std::string, std::shared_ptr<PriorityCache::PriCache>> caches;
+  for (auto& [prefix, opts] : cf_bbt_opts) {
+    if (!opts.block_cache || opts.block_cache == bbt_opts.block_cache) {
+      continue;
+    }
+    auto cache = dynamic_pointer_cast<PriorityCache::PriCache>(opts.block_cache);
+    if (cache) {
+      caches[prefix] = cache;
+    }
+  }
+  return caches;
+}
+
 struct CabinDBStore::CabinWBHandler: public cabindb::WriteBatch::Handler {
   CabinWBHandler(const CabinDBStore& db) : db(db) {}
   const CabinDBStore& db;
@@ -1427,9 +2413,7 @@ struct CabinDBStore::CabinWBHandler: public cabindb::WriteBatch::Handler {
     if (column_family_id == 0) {
       db.split_key(key_in, &prefix, &key);
     } else {
-      auto it = db.cf_ids_to_prefix.find(column_family_id);
-      ceph_assert(it != db.cf_ids_to_prefix.end());
-      prefix = it->second;
+      prefix = db.get_cf_prefix(column_family_id);
       key = key_in.ToString();
     }
     seen << " prefix = " << prefix;
@@ -1474,6 +2458,125 @@ struct CabinDBStore::CabinWBHandler: public cabindb::WriteBatch::Handler {
   bool Continue() override { return num_seen < 50; }
 };
 
+// Copies a batch routed with an older sharding state, sending the keys of
+// the column families where they go now. While a column is resharded
+// online, every put or delete of a key also deletes it from its old shard,
+// right after; that delete is left out and made again if the key still
+// has an old shard.
+struct CabinDBStore::ReshardRouter: public cabindb::WriteBatch::Handler {
+  CabinDBStore& db;
+  const sharding_state_t* from;
+  const sharding_state_t* to;
+  cabindb::WriteBatch* out;
+  // the key of the last operation, and the shard it went to in from
+  uint32_t last_cf = 0;
+  std::string last_prefix;
+  std::string last_key;
+  bool last_range = false;
+
+  ReshardRouter(CabinDBStore& db, const sharding_state_t* from,
+		const sharding_state_t* to, cabindb::WriteBatch* out)
+    : db(db), from(from), to(to), out(out) {}
+
+  void remember(uint32_t column_family_id, const std::string& prefix,
+		const cabindb::Slice& key, bool range = false) {
+    last_cf = column_family_id;
+    last_prefix = prefix;
+    last_key.assign(key.data(), key.size());
+    last_range = range;
+  }
+  // a delete from the old shard that goes with the operation before it
+  bool follows_last(uint32_t column_family_id, const std::string& prefix,
+		    const cabindb::Slice& key) {
+    if (last_range || last_prefix != prefix || last_key != key) {
+      return false;
+    }
+    auto old_cf = db.get_old_cf_handle(from, prefix, key.data(), key.size());
+    return old_cf && old_cf->GetID() == column_family_id &&
+      db.get_cf_handle(from, prefix, key.data(), key.size())->GetID() == last_cf;
+  }
+  void delete_old(const std::string& prefix, const cabindb::Slice& key) {
+    if (auto old_cf = db.get_old_cf_handle(to, prefix, key.data(), key.size()); old_cf) {
+      out->Delete(old_cf, key);
+    }
+  }
+
+  cabindb::Status PutCF(uint32_t column_family_id, const cabindb::Slice& key,
+			const cabindb::Slice& value) override {
+    if (column_family_id == db.default_cf->GetID()) {
+      remember(column_family_id, std::string(), key);
+      return out->Put(db.default_cf, key, value);
+    }
+    auto& prefix = db.get_cf_prefix(column_family_id);
+    remember(column_family_id, prefix, key);
+    out->Put(db.get_cf_handle(to, prefix, key.data(), key.size()), key, value);
+    delete_old(prefix, key);
+    return cabindb::Status::OK();
+  }
+  cabindb::Status DeleteCF(uint32_t column_family_id, const cabindb::Slice& key) override {
+    if (column_family_id == db.default_cf->GetID()) {
+      remember(column_family_id, std::string(), key);
+      return out->Delete(db.default_cf, key);
+    }
+    auto& prefix = db.get_cf_prefix(column_family_id);
+    if (follows_last(column_family_id, prefix, key)) {
+      return cabindb::Status::OK();
+    }
+    remember(column_family_id, prefix, key);
+    out->Delete(db.get_cf_handle(to, prefix, key.data(), key.size()), key);
+    delete_old(prefix, key);
+    return cabindb::Status::OK();
+  }
+  cabindb::Status SingleDeleteCF(uint32_t column_family_id, const cabindb::Slice& key) override {
+    if (column_family_id == db.default_cf->GetID()) {
+      remember(column_family_id, std::string(), key);
+      return out->SingleDelete(db.default_cf, key);
+    }
+    auto& prefix = db.get_cf_prefix(column_family_id);
+    auto cf = db.get_cf_handle(to, prefix, key.data(), key.size());
+    if (cf->GetID() != column_family_id || get_resharding_column(to, prefix)) {
+      // the key may have been put to its new shard by both the move and a
+      // writer, which a single delete does not cover
+      return DeleteCF(column_family_id, key);
+    }
+    remember(column_family_id, prefix, key);
+    return out->SingleDelete(cf, key);
+  }
+  cabindb::Status DeleteRangeCF(uint32_t column_family_id,
+				const cabindb::Slice& begin_key,
+				const cabindb::Slice& end_key) override {
+    if (column_family_id == db.default_cf->GetID()) {
+      remember(column_family_id, std::string(), begin_key, true);
+      return out->DeleteRange(db.default_cf, begin_key, end_key);
+    }
+    // the range was deleted from every shard of the column; once is enough
+    auto& prefix = db.get_cf_prefix(column_family_id);
+    bool again = last_range && last_prefix == prefix && last_key == begin_key;
+    remember(column_family_id, prefix, begin_key, true);
+    if (again) {
+      return cabindb::Status::OK();
+    }
+    for (auto cf : get_cf_handles(to, prefix, db.cf_handles.at(prefix))) {
+      out->DeleteRange(cf, begin_key, end_key);
+    }
+    return cabindb::Status::OK();
+  }
+  // columns with a merge operator are not resharded online
+  cabindb::Status MergeCF(uint32_t column_family_id, const cabindb::Slice& key,
+			  const cabindb::Slice& value) override {
+    if (column_family_id == db.default_cf->GetID()) {
+      remember(column_family_id, std::string(), key);
+      return out->Merge(db.default_cf, key, value);
+    }
+    auto& prefix = db.get_cf_prefix(column_family_id);
+    remember(column_family_id, prefix, key);
+    return out->Merge(db.get_cf_handle(to, prefix, key.data(), key.size()), key, value);
+  }
+  void LogData(const cabindb::Slice& blob) override {
+    out->PutLogData(blob);
+  }
+};
+
 int CabinDBStore::submit_common(cabindb::WriteOptions& woptions, KeyValueDB::Transaction t) 
 {
   // enable cabindb breakdown
@@ -1485,16 +2588,27 @@ int CabinDBStore::submit_common(cabindb::WriteOptions& woptions, KeyValueDB::Tra
 
   CabinDBTransactionImpl * _t =
     static_cast<CabinDBTransactionImpl *>(t.get());
+  // an online reshard does not move keys while they are written
+  std::shared_lock reshard_l{reshard_lock};
+  cabindb::WriteBatch* bat = &_t->bat;
+  cabindb::WriteBatch rerouted;
+  if (auto state = sharding_state.load(std::memory_order_acquire);
+      state != _t->sharding) {
+    ReshardRouter router(*this, _t->sharding, state, &rerouted);
+    cabindb::Status s = _t->bat.Iterate(&router);
+    ceph_assert(s.ok());
+    bat = &rerouted;
+  }
   woptions.disableWAL = disableWAL;
   lgeneric_subdout(cct, cabindb, 30) << __func__;
   CabinWBHandler bat_txc(*this);
-  _t->bat.Iterate(&bat_txc);
+  bat->Iterate(&bat_txc);
   *_dout << " Cabindb transaction: " << bat_txc.seen.str() << dendl;
 
-  cabindb::Status s = db->Write(woptions, &_t->bat);
+  cabindb::Status s = db->Write(woptions, bat);
   if (!s.ok()) {
     CabinWBHandler cabin_txc(*this);
-    _t->bat.Iterate(&cabin_txc);
+    bat->Iterate(&cabin_txc);
     derr << __func__ << " error: " << s.ToString() << " code = " << s.code()
          << " Cabindb transaction: " << cabin_txc.seen.str() << dendl;
   }
@@ -1547,12 +2661,86 @@ int CabinDBStore::submit_transaction_sync(KeyValueDB::Transaction t)
   utime_t lat = ceph_clock_now() - start;
   logger->tinc(l_cabindb_submit_sync_latency, lat);
 
-  return result;
+  return result;
+}
+
+int CabinDBStore::submit_transaction_async(KeyValueDB::Transaction t,
+					   std::function<void(int)> on_commit)
+{
+  if (disableWAL) {
+    derr << __func__ << " refused: the WAL is disabled" << dendl;
+    return -EOPNOTSUPP;
+  }
+  std::lock_guard l(commit_queue_lock);
+  commit_queue.push_back({t, std::move(on_commit), ceph_clock_now()});
+  logger->set(l_cabindb_commit_queue_len, commit_queue.size());
+  commit_queue_cond.notify_all();
+  if (!commit_thread.is_started()) {
+    commit_thread.create("cstore_commit");
+  }
+  return 0;
+}
+
+void CabinDBStore::commit_thread_entry()
+{
+  std::unique_lock l{commit_queue_lock};
+  dout(10) << __func__ << " enter" << dendl;
+  while (true) {
+    if (commit_queue.empty()) {
+      if (commit_queue_stop) {
+	break;
+      }
+      dout(20) << __func__ << " waiting" << dendl;
+      commit_queue_cond.wait(l);
+      continue;
+    }
+    std::deque<pending_commit> group;
+    uint64_t max_txns = cct->_conf.get_val<uint64_t>("cabindb_group_commit_max_txns");
+    if (max_txns == 0 || commit_queue.size() <= max_txns) {
+      group.swap(commit_queue);
+    } else {
+      auto end = commit_queue.begin() + max_txns;
+      group.insert(group.end(), std::make_move_iterator(commit_queue.begin()),
+		   std::make_move_iterator(end));
+      commit_queue.erase(commit_queue.begin(), end);
+    }
+    logger->set(l_cabindb_commit_queue_len, commit_queue.size());
+    l.unlock();
+
+    // write the whole group unsynced, then make it durable with a single
+    // WAL sync; the group is acknowledged only after that sync
+    utime_t start = ceph_clock_now();
+    cabindb::WriteOptions woptions;
+    woptions.sync = false;
+    std::vector<int> rs(group.size());
+    for (size_t i = 0; i < group.size(); ++i) {
+      rs[i] = submit_common(woptions, group[i].t);
+    }
+    cabindb::Status s = db->SyncWAL();
+    if (!s.ok()) {
+      derr << __func__ << " SyncWAL error: " << s.ToString() << dendl;
+      for (auto& r : rs) {
+	r = -1;
+      }
+    }
+    utime_t now = ceph_clock_now();
+    logger->tinc(l_cabindb_group_commit_latency, now - start);
+    logger->inc(l_cabindb_group_commit_txns, group.size());
+    dout(20) << __func__ << " committed " << group.size() << " txns" << dendl;
+
+    for (size_t i = 0; i < group.size(); ++i) {
+      logger->tinc(l_cabindb_submit_async_latency, now - group[i].queued);
+      group[i].on_commit(rs[i]);
+    }
+    l.lock();
+  }
+  dout(10) << __func__ << " exit" << dendl;
 }
 
 CabinDBStore::CabinDBTransactionImpl::CabinDBTransactionImpl(CabinDBStore *_db)
 {
   db = _db;
+  sharding = db->sharding_state.load(std::memory_order_acquire);
 }
 
 void CabinDBStore::CabinDBTransactionImpl::put_bat(
@@ -1581,9 +2769,12 @@ void CabinDBStore::CabinDBTransactionImpl::set(
   const string &k,
   const bufferlist &to_set_bl)
 {
-  auto cf = db->get_cf_handle(prefix, k);
+  auto cf = db->get_cf_handle(sharding, prefix, k.data(), k.size());
   if (cf) {
     put_bat(bat, cf, k, to_set_bl);
+    if (auto old_cf = db->get_old_cf_handle(sharding, prefix, k.data(), k.size()); old_cf) {
+      bat.Delete(old_cf, cabindb::Slice(k));
+    }
   } else {
     string key = combine_strings(prefix, k);
     put_bat(bat, db->default_cf, key, to_set_bl);
@@ -1595,10 +2786,13 @@ void CabinDBStore::CabinDBTransactionImpl::set(
   const char *k, size_t keylen,
   const bufferlist &to_set_bl)
 {
-  auto cf = db->get_cf_handle(prefix, k, keylen);
+  auto cf = db->get_cf_handle(sharding, prefix, k, keylen);
   if (cf) {
     string key(k, keylen);  // fixme?
     put_bat(bat, cf, key, to_set_bl);
+    if (auto old_cf = db->get_old_cf_handle(sharding, prefix, k, keylen); old_cf) {
+      bat.Delete(old_cf, cabindb::Slice(key));
+    }
   } else {
     string key;
     combine_strings(prefix, k, keylen, &key);
@@ -1609,9 +2803,12 @@ void CabinDBStore::CabinDBTransactionImpl::set(
 void CabinDBStore::CabinDBTransactionImpl::rmkey(const string &prefix,
 					         const string &k)
 {
-  auto cf = db->get_cf_handle(prefix, k);
+  auto cf = db->get_cf_handle(sharding, prefix, k.data(), k.size());
   if (cf) {
     bat.Delete(cf, cabindb::Slice(k));
+    if (auto old_cf = db->get_old_cf_handle(sharding, prefix, k.data(), k.size()); old_cf) {
+      bat.Delete(old_cf, cabindb::Slice(k));
+    }
   } else {
     bat.Delete(db->default_cf, combine_strings(prefix, k));
   }
@@ -1621,9 +2818,12 @@ void CabinDBStore::CabinDBTransactionImpl::rmkey(const string &prefix,
 					         const char *k,
 						 size_t keylen)
 {
-  auto cf = db->get_cf_handle(prefix, k, keylen);
+  auto cf = db->get_cf_handle(sharding, prefix, k, keylen);
   if (cf) {
     bat.Delete(cf, cabindb::Slice(k, keylen));
+    if (auto old_cf = db->get_old_cf_handle(sharding, prefix, k, keylen); old_cf) {
+      bat.Delete(old_cf, cabindb::Slice(k, keylen));
+    }
   } else {
     string key;
     combine_strings(prefix, k, keylen, &key);
@@ -1634,9 +2834,18 @@ void CabinDBStore::CabinDBTransactionImpl::rmkey(const string &prefix,
 void CabinDBStore::CabinDBTransactionImpl::rm_single_key(const string &prefix,
 					                 const string &k)
 {
-  auto cf = db->get_cf_handle(prefix, k);
+  auto cf = db->get_cf_handle(sharding, prefix, k.data(), k.size());
   if (cf) {
-    bat.SingleDelete(cf, k);
+    if (get_resharding_column(sharding, prefix)) {
+      // the key may have been put to its new shard by both the move and a
+      // writer, which a single delete does not cover
+      bat.Delete(cf, k);
+      if (auto old_cf = db->get_old_cf_handle(sharding, prefix, k.data(), k.size()); old_cf) {
+	bat.Delete(old_cf, k);
+      }
+    } else {
+      bat.SingleDelete(cf, k);
+    }
   } else {
     bat.SingleDelete(db->default_cf, combine_strings(prefix, k));
   }
@@ -1664,7 +2873,7 @@ void CabinDBStore::CabinDBTransactionImpl::rmkeys_by_prefix(const string &prefix
     }
   } else {
     ceph_assert(p_iter->second.handles.size() >= 1);
-    for (auto cf : p_iter->second.handles) {
+    for (auto cf : get_cf_handles(sharding, prefix, p_iter->second)) {
       uint64_t cnt = db->delete_range_threshold;
       bat.SetSavePoint();
       auto it = db->new_shard_iterator(cf);
@@ -1706,7 +2915,7 @@ void CabinDBStore::CabinDBTransactionImpl::rm_range_keys(const string &prefix,
     }
   } else {
     ceph_assert(p_iter->second.handles.size() >= 1);
-    for (auto cf : p_iter->second.handles) {
+    for (auto cf : get_cf_handles(sharding, prefix, p_iter->second)) {
       uint64_t cnt = db->delete_range_threshold;
       bat.SetSavePoint();
       cabindb::Iterator* it = db->new_shard_iterator(cf);
@@ -1732,7 +2941,7 @@ void CabinDBStore::CabinDBTransactionImpl::merge(
   const string &k,
   const bufferlist &to_set_bl)
 {
-  auto cf = db->get_cf_handle(prefix, k);
+  auto cf = db->get_cf_handle(sharding, prefix, k.data(), k.size());
   if (cf) {
     // bufferlist::c_str() is non-constant, so we can't call c_str()
     if (to_set_bl.is_contiguous() && to_set_bl.length() > 0) {
@@ -1767,40 +2976,128 @@ void CabinDBStore::CabinDBTransactionImpl::merge(
   }
 }
 
+void CabinDBStore::multi_get(
+    const string &prefix,
+    const std::vector<string> &keys,
+    std::vector<cabindb::PinnableSlice> *values,
+    std::vector<cabindb::Status> *statuses)
+{
+  size_t n = keys.size();
+  std::vector<cabindb::ColumnFamilyHandle*> cfs(n);
+  std::vector<cabindb::Slice> slices(n);
+  // keys outside a column family carry the prefix; reserve so the
+  // slices pointing into combined stay valid
+  std::vector<string> combined;
+  bool sharded = cf_handles.count(prefix) > 0;
+  if (!sharded) {
+    combined.reserve(n);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (sharded) {
+      cfs[i] = get_cf_handle(prefix, keys[i]);
+      slices[i] = cabindb::Slice(keys[i]);
+    } else {
+      combined.push_back(combine_strings(prefix, keys[i]));
+      cfs[i] = default_cf;
+      slices[i] = cabindb::Slice(combined.back());
+    }
+  }
+  // A key of a column being resharded online only ever moves from its
+  // old shard to its new one, so it is looked up in the old shard first.
+  std::vector<size_t> moving;
+  std::vector<cabindb::ColumnFamilyHandle*> old_cfs;
+  std::vector<cabindb::Slice> old_slices;
+  if (sharded && get_resharding_column(prefix)) {
+    for (size_t i = 0; i < n; ++i) {
+      if (auto old_cf = get_old_cf_handle(prefix, keys[i].data(), keys[i].size()); old_cf) {
+	moving.push_back(i);
+	old_cfs.push_back(old_cf);
+	old_slices.push_back(slices[i]);
+      }
+    }
+  }
+  std::vector<cabindb::PinnableSlice> old_values(moving.size());
+  std::vector<cabindb::Status> old_statuses(moving.size());
+  if (!moving.empty()) {
+    db->MultiGet(cabindb::ReadOptions(), moving.size(), old_cfs.data(),
+		 old_slices.data(), old_values.data(), old_statuses.data());
+  }
+  values->resize(n);
+  statuses->resize(n);
+  db->MultiGet(cabindb::ReadOptions(), n, cfs.data(), slices.data(),
+	       values->data(), statuses->data());
+  for (size_t j = 0; j < moving.size(); ++j) {
+    if (!old_statuses[j].IsNotFound()) {
+      (*values)[moving[j]] = std::move(old_values[j]);
+      (*statuses)[moving[j]] = old_statuses[j];
+    }
+  }
+}
+
+void CabinDBStore::append_value(const string& prefix,
+				cabindb::PinnableSlice&& value,
+				bufferlist *out)
+{
+  // a value copied out of a memtable is not pinned, and a small one would
+  // hold on to a whole block
+  if (zero_copy_min_size == 0 || !value.IsPinned() ||
+      value.size() < zero_copy_min_size) {
+    out->append(value.data(), value.size());
+    return;
+  }
+  auto it = cf_bbt_opts.find(prefix);
+  auto cache = it != cf_bbt_opts.end() ? it->second.block_cache :
+    bbt_opts.block_cache;
+  logger->inc(l_cabindb_zero_copy_gets);
+  logger->inc(l_cabindb_zero_copy_bytes, value.size());
+  out->append(bufferptr(ceph::unique_leakable_ptr<ceph::buffer::raw>(
+    new raw_pinned_slice(std::move(cache), std::move(value)))));
+}
+
 int CabinDBStore::get(
     const string &prefix,
     const std::set<string> &keys,
     std::map<string, bufferlist> *out)
 {
-  cabindb::PinnableSlice value;
   utime_t start = ceph_clock_now();
-  if (cf_handles.count(prefix) > 0) {
-    for (auto& key : keys) {
-      auto cf_handle = get_cf_handle(prefix, key);
-      auto status = db->Get(cabindb::ReadOptions(),
-			    cf_handle,
-			    cabindb::Slice(key),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+  std::vector<string> ks(keys.begin(), keys.end());
+  std::vector<cabindb::PinnableSlice> values;
+  std::vector<cabindb::Status> statuses;
+  multi_get(prefix, ks, &values, &statuses);
+  for (size_t i = 0; i < ks.size(); ++i) {
+    if (statuses[i].ok()) {
+      append_value(prefix, std::move(values[i]), &(*out)[ks[i]]);
+    } else if (statuses[i].IsIOError()) {
+      ceph_abort_msg(statuses[i].getState());
     }
-  } else {
-    for (auto& key : keys) {
-      string k = combine_strings(prefix, key);
-      auto status = db->Get(cabindb::ReadOptions(),
-			    default_cf,
-			    cabindb::Slice(k),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+  }
+  utime_t lat = ceph_clock_now() - start;
+  logger->inc(l_cabindb_gets);
+  logger->tinc(l_cabindb_get_latency, lat);
+  return 0;
+}
+
+int CabinDBStore::get_many(
+    const string &prefix,
+    const std::vector<string> &keys,
+    std::vector<bufferlist> *out,
+    std::vector<int> *rs)
+{
+  utime_t start = ceph_clock_now();
+  std::vector<cabindb::PinnableSlice> values;
+  std::vector<cabindb::Status> statuses;
+  multi_get(prefix, keys, &values, &statuses);
+  out->clear();
+  out->resize(keys.size());
+  rs->resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (statuses[i].ok()) {
+      append_value(prefix, std::move(values[i]), &(*out)[i]);
+      (*rs)[i] = 0;
+    } else if (statuses[i].IsNotFound()) {
+      (*rs)[i] = -ENOENT;
+    } else {
+      ceph_abort_msg(statuses[i].getState());
     }
   }
   utime_t lat = ceph_clock_now() - start;
@@ -1821,10 +3118,20 @@ int CabinDBStore::get(
   cabindb::Status s;
   auto cf = get_cf_handle(prefix, key);
   if (cf) {
-    s = db->Get(cabindb::ReadOptions(),
-		cf,
-		cabindb::Slice(key),
-		&value);
+    // a key being resharded online may still be in its old shard
+    auto old_cf = get_old_cf_handle(prefix, key.data(), key.size());
+    if (old_cf) {
+      s = db->Get(cabindb::ReadOptions(),
+		  old_cf,
+		  cabindb::Slice(key),
+		  &value);
+    }
+    if (!old_cf || s.IsNotFound()) {
+      s = db->Get(cabindb::ReadOptions(),
+		  cf,
+		  cabindb::Slice(key),
+		  &value);
+    }
   } else {
     string k = combine_strings(prefix, key);
     s = db->Get(cabindb::ReadOptions(),
@@ -1833,7 +3140,7 @@ int CabinDBStore::get(
 		&value);
   }
   if (s.ok()) {
-    out->append(value.data(), value.size());
+    append_value(prefix, std::move(value), out);
   } else if (s.IsNotFound()) {
     r = -ENOENT;
   } else {
@@ -1858,10 +3165,20 @@ int CabinDBStore::get(
   cabindb::Status s;
   auto cf = get_cf_handle(prefix, key, keylen);
   if (cf) {
-    s = db->Get(cabindb::ReadOptions(),
-		cf,
-		cabindb::Slice(key, keylen),
-		&value);
+    // a key being resharded online may still be in its old shard
+    auto old_cf = get_old_cf_handle(prefix, key, keylen);
+    if (old_cf) {
+      s = db->Get(cabindb::ReadOptions(),
+		  old_cf,
+		  cabindb::Slice(key, keylen),
+		  &value);
+    }
+    if (!old_cf || s.IsNotFound()) {
+      s = db->Get(cabindb::ReadOptions(),
+		  cf,
+		  cabindb::Slice(key, keylen),
+		  &value);
+    }
   } else {
     string k;
     combine_strings(prefix, key, keylen, &k);
@@ -1871,7 +3188,7 @@ int CabinDBStore::get(
 		&value);
   }
   if (s.ok()) {
-    out->append(value.data(), value.size());
+    append_value(prefix, std::move(value), out);
   } else if (s.IsNotFound()) {
     r = -ENOENT;
   } else {
@@ -1908,8 +3225,8 @@ void CabinDBStore::compact()
   logger->inc(l_cabindb_compact);
   cabindb::CompactRangeOptions options;
   db->CompactRange(options, default_cf, nullptr, nullptr);
-  for (auto cf : cf_handles) {
-    for (auto shard_cf : cf.second.handles) {
+  for (auto& [prefix, shards] : cf_handles) {
+    for (auto shard_cf : get_cf_handles(prefix, shards)) {
       db->CompactRange(
 	      options,
 	      shard_cf,
@@ -2011,7 +3328,7 @@ void CabinDBStore::compact_range(const string& start, const string& end)
 			    const std::string& end) {
     cabindb::Slice cstart(start);
     cabindb::Slice cend(end);
-    for (const auto& shard_it : column_it->second.handles) {
+    for (const auto& shard_it : get_cf_handles(column_it->first, column_it->second)) {
       db->CompactRange(options, shard_it, &cstart, &cend);
     }
   };
@@ -2712,12 +4029,13 @@ private:
 public:
   explicit ShardMergeIteratorImpl(const CabinDBStore* db,
 				  const std::string& prefix,
-				  const std::vector<cabindb::ColumnFamilyHandle*>& shards)
+				  const std::vector<cabindb::ColumnFamilyHandle*>& shards,
+				  const cabindb::ReadOptions& opt)
     : db(db), keyless(db->comparator), prefix(prefix)
   {
     iters.reserve(shards.size());
     for (auto& s : shards) {
-      iters.push_back(db->db->NewIterator(cabindb::ReadOptions(), s));
+      iters.push_back(db->db->NewIterator(opt, s));
     }
   }
   ~ShardMergeIteratorImpl() {
@@ -2892,30 +4210,176 @@ KeyValueDB::Iterator CabinDBStore::get_iterator(const std::string& prefix, Itera
 {
   auto cf_it = cf_handles.find(prefix);
   if (cf_it != cf_handles.end()) {
-    if (cf_it->second.handles.size() == 1) {
-      return std::make_shared<CFIteratorImpl>(
-        prefix,
-        db->NewIterator(cabindb::ReadOptions(), cf_it->second.handles[0]));
+    bool moving;
+    auto& handles = get_cf_handles(prefix, cf_it->second, &moving);
+    if (!moving) {
+      return new_cf_iterator(prefix, handles, iterator_read_options());
+    }
+    // a key moves to its new shard in one write, so the shards read at one
+    // snapshot hold it once
+    auto snapshot = get_db_snapshot();
+    cabindb::ReadOptions opt = iterator_read_options();
+    opt.snapshot = snapshot.get();
+    return std::make_shared<RangeIteratorImpl>(
+      new_cf_iterator(prefix, handles, opt), std::string(), std::string(), snapshot);
+  } else {
+    return KeyValueDB::get_iterator(prefix, opts);
+  }
+}
+
+std::shared_ptr<const cabindb::Snapshot> CabinDBStore::get_db_snapshot()
+{
+  cabindb::DB* d = db;
+  return std::shared_ptr<const cabindb::Snapshot>(
+    db->GetSnapshot(),
+    [d](const cabindb::Snapshot* s) { d->ReleaseSnapshot(s); });
+}
+
+KeyValueDB::Iterator CabinDBStore::new_cf_iterator(
+  const std::string& prefix,
+  const std::vector<cabindb::ColumnFamilyHandle*>& handles,
+  const cabindb::ReadOptions& opt)
+{
+  if (handles.size() == 1) {
+    return std::make_shared<CFIteratorImpl>(
+      prefix,
+      db->NewIterator(opt, handles[0]));
+  } else {
+    return std::make_shared<ShardMergeIteratorImpl>(
+      this,
+      prefix,
+      handles,
+      opt);
+  }
+}
+
+std::vector<KeyValueDB::Iterator> CabinDBStore::get_parallel_iterators(
+  const std::string& prefix,
+  size_t n,
+  const std::string& from,
+  const std::string& to,
+  IteratorOpts opts)
+{
+  // all ranges read one snapshot; it goes away with the last iterator
+  auto snapshot = get_db_snapshot();
+  cabindb::ReadOptions opt = iterator_read_options();
+  opt.snapshot = snapshot.get();
+  if (opts & ITERATOR_NOCACHE)
+    opt.fill_cache = false;
+
+  std::vector<std::string> bounds;
+  if (n > 1) {
+    get_split_keys(prefix, n, from, to, &bounds);
+  }
+  bounds.push_back(to);
+
+  auto cf_it = cf_handles.find(prefix);
+  std::vector<Iterator> iters;
+  iters.reserve(bounds.size());
+  std::string lower = from;
+  for (auto& upper : bounds) {
+    Iterator it;
+    if (cf_it != cf_handles.end()) {
+      it = new_cf_iterator(prefix, get_cf_handles(prefix, cf_it->second), opt);
     } else {
-      return std::make_shared<ShardMergeIteratorImpl>(
-        this,
+      it = std::make_shared<PrefixIteratorImpl>(
         prefix,
-        cf_it->second.handles);
+        std::make_shared<CabinDBWholeSpaceIteratorImpl>(
+	  db->NewIterator(opt, default_cf)));
     }
+    iters.push_back(std::make_shared<RangeIteratorImpl>(
+      std::move(it), lower, upper, snapshot));
+    lower = upper;
+  }
+  dout(10) << __func__ << " prefix " << prefix << " split into "
+	   << iters.size() << " of " << n << dendl;
+  return iters;
+}
+
+void CabinDBStore::get_split_keys(
+  const std::string& prefix,
+  size_t n,
+  const std::string& from,
+  const std::string& to,
+  std::vector<std::string>* keys)
+{
+  std::vector<cabindb::ColumnFamilyHandle*> handles;
+  // in the default column family the keys of prefix follow prefix + '\0'
+  std::string key_prefix;
+  auto cf_it = cf_handles.find(prefix);
+  if (cf_it != cf_handles.end()) {
+    handles = get_cf_handles(prefix, cf_it->second);
   } else {
-    return KeyValueDB::get_iterator(prefix, opts);
+    handles.push_back(default_cf);
+    key_prefix = combine_strings(prefix, std::string());
+  }
+
+  // The largest key of every table file that ends inside the range,
+  // weighted by the size of the file. Memtables are not counted, and
+  // neither are files that end outside the range, so the split is only
+  // as even as the tables are.
+  std::vector<std::pair<std::string, uint64_t>> ends;
+  uint64_t total = 0;
+  for (auto cf : handles) {
+    cabindb::ColumnFamilyMetaData meta;
+    db->GetColumnFamilyMetaData(cf, &meta);
+    for (auto& level : meta.levels) {
+      for (auto& file : level.files) {
+	if (file.largestkey.compare(0, key_prefix.size(), key_prefix) != 0) {
+	  continue;
+	}
+	std::string end = file.largestkey.substr(key_prefix.size());
+	if (end <= from || (!to.empty() && end >= to)) {
+	  continue;
+	}
+	total += file.size;
+	ends.emplace_back(std::move(end), file.size);
+      }
+    }
+  }
+  if (total == 0) {
+    return;
+  }
+  std::sort(ends.begin(), ends.end());
+
+  // cut wherever the running size crosses the next 1/n of the total
+  uint64_t sum = 0;
+  size_t next = 1;
+  for (auto& [end, size] : ends) {
+    sum += size;
+    if (sum * n < total * next) {
+      continue;
+    }
+    if (keys->empty() || keys->back() < end) {
+      keys->push_back(end);
+    }
+    while (next < n && sum * n >= total * next) {
+      ++next;
+    }
+    if (next == n) {
+      break;
+    }
   }
 }
 
+cabindb::ReadOptions CabinDBStore::iterator_read_options() const
+{
+  cabindb::ReadOptions opt;
+  opt.async_io = async_io;
+  // KeyValueDB iterators cross prefix_extractor prefixes freely
+  opt.total_order_seek = true;
+  return opt;
+}
+
 cabindb::Iterator* CabinDBStore::new_shard_iterator(cabindb::ColumnFamilyHandle* cf)
 {
-  return db->NewIterator(cabindb::ReadOptions(), cf);
+  return db->NewIterator(iterator_read_options(), cf);
 }
 
 CabinDBStore::WholeSpaceIterator CabinDBStore::get_wholespace_iterator(IteratorOpts opts)
 {
   if (cf_handles.size() == 0) {
-    cabindb::ReadOptions opt = cabindb::ReadOptions();
+    cabindb::ReadOptions opt = iterator_read_options();
     if (opts & ITERATOR_NOCACHE)
       opt.fill_cache=false;
     return std::make_shared<CabinDBWholeSpaceIteratorImpl>(
@@ -2928,7 +4392,7 @@ CabinDBStore::WholeSpaceIterator CabinDBStore::get_wholespace_iterator(IteratorO
 CabinDBStore::WholeSpaceIterator CabinDBStore::get_default_cf_iterator()
 {
   return std::make_shared<CabinDBWholeSpaceIteratorImpl>(
-    db->NewIterator(cabindb::ReadOptions(), default_cf));
+    db->NewIterator(iterator_read_options(), default_cf));
 }
 
 int CabinDBStore::prepare_for_reshard(const std::string& new_sharding,
@@ -2995,6 +4459,32 @@ int CabinDBStore::prepare_for_reshard(const std::string& new_sharding,
   //2. apply merge operator to (main + columns) opts
   //3. prepare std::vector<cabindb::ColumnFamilyDescriptor> cfs_to_open
 
+  // columns named in the new sharding take their options the same way
+  // create_shards() does, shorthands included; the rest keep the defaults
+  auto reshard_cf_options = [&](const std::string& base_name,
+				cabindb::ColumnFamilyOptions* cf_opt) {
+    for (const auto& nsd : new_sharding_def) {
+      if (nsd.name == base_name) {
+	return column_family_options(opt, nsd, cf_opt);
+      }
+    }
+    *cf_opt = cabindb::ColumnFamilyOptions(opt);
+    if (base_name != cabindb::kDefaultColumnFamilyName)
+      return install_cf_mergeop(base_name, cf_opt);
+    return 0;
+  };
+
+  // the memtable reps of the new columns decide if the db may fill
+  // memtables concurrently; reject bad reps before anything is created
+  for (const auto& nsd : new_sharding_def) {
+    cabindb::ColumnFamilyOptions cf_opt;
+    r = column_family_options(opt, nsd, &cf_opt);
+    if (r != 0) {
+      return r;
+    }
+    adjust_memtable_writes(opt, nsd.name, cf_opt);
+  }
+
   std::vector<cabindb::ColumnFamilyDescriptor> cfs_to_open;
   for (const auto& full_name : existing_columns) {
     //split col_name to <prefix>-<number>
@@ -3005,24 +4495,17 @@ int CabinDBStore::prepare_for_reshard(const std::string& new_sharding,
     else
       base_name = full_name.substr(0,pos);
 
-    cabindb::ColumnFamilyOptions cf_opt(opt);
-    // search if we have options for this column
-    std::string options;
-    for (const auto& nsd : new_sharding_def) {
-      if (nsd.name == base_name) {
-	options = nsd.options;
-	break;
-      }
-    }
-    status = cabindb::GetColumnFamilyOptionsFromString(cf_opt, options, &cf_opt);
-    if (!status.ok()) {
-      derr << __func__ << " failure parsing column options: " << options << dendl;
-      return -EINVAL;
+    cabindb::ColumnFamilyOptions cf_opt;
+    r = reshard_cf_options(base_name, &cf_opt);
+    if (r != 0) {
+      return r;
     }
-    if (base_name != cabindb::kDefaultColumnFamilyName)
-      install_cf_mergeop(base_name, &cf_opt);
     cfs_to_open.emplace_back(full_name, cf_opt);
   }
+  r = check_fifo_switch(opt, cfs_to_open);
+  if (r < 0) {
+    return r;
+  }
 
   //4. open db, acquire existing column handles
   std::vector<cabindb::ColumnFamilyHandle*> handles;
@@ -3065,21 +4548,11 @@ int CabinDBStore::prepare_for_reshard(const std::string& new_sharding,
     else
       base_name = full_name.substr(0,pos);
 
-    cabindb::ColumnFamilyOptions cf_opt(opt);
-    // search if we have options for this column
-    std::string options;
-    for (const auto& nsd : new_sharding_def) {
-      if (nsd.name == base_name) {
-	options = nsd.options;
-	break;
-      }
-    }
-    status = cabindb::GetColumnFamilyOptionsFromString(cf_opt, options, &cf_opt);
-    if (!status.ok()) {
-      derr << __func__ << " failure parsing column options: " << options << dendl;
-      return -EINVAL;
+    cabindb::ColumnFamilyOptions cf_opt;
+    r = reshard_cf_options(base_name, &cf_opt);
+    if (r != 0) {
+      return r;
     }
-    install_cf_mergeop(base_name, &cf_opt);
     cabindb::ColumnFamilyHandle *cf;
     status = db->CreateColumnFamily(cf_opt, full_name, &cf);
     if (!status.ok()) {
@@ -3168,7 +4641,7 @@ int CabinDBStore::reshard_cleanup(const CabinDBStore::columns_t& current_columns
 
     // verify that column is empty
     std::unique_ptr<cabindb::Iterator> it{
-      db->NewIterator(cabindb::ReadOptions(), handle.get())};
+      db->NewIterator(iterator_read_options(), handle.get())};
     ceph_assert(it);
     it->SeekToFirst();
     ceph_assert(!it->Valid());
@@ -3209,7 +4682,7 @@ int CabinDBStore::reshard(const std::string& new_sharding, const CabinDBStore::r
   {
     dout(5) << " column=" << (void*)handle << " prefix=" << fixed_prefix << dendl;
     std::unique_ptr<cabindb::Iterator> it{
-      db->NewIterator(cabindb::ReadOptions(), handle)};
+      db->NewIterator(iterator_read_options(), handle)};
     ceph_assert(it);
 
     cabindb::WriteBatch bat;
@@ -3223,7 +4696,7 @@ int CabinDBStore::reshard(const std::string& new_sharding, const CabinDBStore::r
 	      bytes_per_iterator = 0;
 	      keys_per_iterator = 0;
 	      std::string raw_key_str = raw_key.ToString();
-	      it.reset(db->NewIterator(cabindb::ReadOptions(), handle));
+	      it.reset(db->NewIterator(iterator_read_options(), handle));
 	      ceph_assert(it);
 	      it->Seek(raw_key_str);
 	      ceph_assert(it->Valid());
@@ -3331,6 +4804,348 @@ int CabinDBStore::reshard(const std::string& new_sharding, const CabinDBStore::r
   return r;
 }
 
+int CabinDBStore::reshard_online(const std::string& new_sharding,
+				 const CabinDBStore::resharding_ctrl* ctrl)
+{
+  // held until the reshard thread is started, so that only one of two
+  // concurrent callers gets past the check below
+  std::lock_guard l{reshard_thread_lock};
+  if (auto rs = online_reshard.load(std::memory_order_acquire); rs && !rs->done) {
+    derr << __func__ << " a reshard was already started" << dendl;
+    return -EBUSY;
+  }
+  if (reshard_thread.is_started()) {
+    // the last reshard finished
+    reshard_thread.join();
+  }
+  std::vector<ColumnFamily> new_sharding_def;
+  char const* error_position;
+  std::string error_msg;
+  if (!parse_sharding_def(new_sharding, new_sharding_def, &error_position, &error_msg)) {
+    dout(1) << __func__ << " bad sharding: " << dendl;
+    dout(1) << __func__ << new_sharding << dendl;
+    dout(1) << __func__ << std::string(error_position - &new_sharding[0], ' ') << "^" << error_msg << dendl;
+    return -EINVAL;
+  }
+  std::string stored_sharding_text;
+  get_sharding(stored_sharding_text);
+  std::vector<ColumnFamily> stored_sharding_def;
+  parse_sharding_def(stored_sharding_text, stored_sharding_def);
+  if (stored_sharding_def.size() != new_sharding_def.size()) {
+    derr << __func__ << " adding or removing column families needs an offline reshard" << dendl;
+    return -EOPNOTSUPP;
+  }
+
+  auto rs = std::make_unique<online_reshard_t>();
+  rs->sharding = new_sharding;
+  // undone unless the reshard starts
+  auto drop_created = make_scope_guard([&] {
+    if (!rs) {
+      return;
+    }
+    for (auto cf : rs->created) {
+      db->DropColumnFamily(cf);
+      db->DestroyColumnFamilyHandle(cf);
+    }
+  });
+  cabindb::Options opt(db->GetDBOptions(), db->GetOptions(default_cf));
+  for (const auto& column : new_sharding_def) {
+    auto stored = std::find_if(stored_sharding_def.begin(), stored_sharding_def.end(),
+			       [&](const ColumnFamily& c) { return c.name == column.name; });
+    if (stored == stored_sharding_def.end()) {
+      derr << __func__ << " adding or removing column families needs an offline reshard" << dendl;
+      return -EOPNOTSUPP;
+    }
+    if (stored->shard_cnt == column.shard_cnt &&
+	stored->hash_l == column.hash_l &&
+	stored->hash_h == column.hash_h) {
+      continue;
+    }
+    // a merge could not see an operand left in the old shard
+    for (auto& p : merge_ops) {
+      if (p.first == column.name) {
+	derr << __func__ << " column " << column.name
+	     << " has a merge operator and needs an offline reshard" << dendl;
+	return -EOPNOTSUPP;
+      }
+    }
+    cabindb::ColumnFamilyOptions cf_opt;
+    int r = column_family_options(opt, column, &cf_opt);
+    if (r != 0) {
+      return r;
+    }
+    // no reshard changes the sharding state until this one starts
+    auto& source = get_shards(sharding_state.load(std::memory_order_acquire),
+			      column.name, cf_handles.at(column.name));
+    auto& moving = rs->columns[column.name];
+    moving.source = &source;
+    moving.target.hash_l = column.hash_l;
+    moving.target.hash_h = column.hash_h;
+    moving.handles = source.handles;
+    for (size_t idx = 0; idx < column.shard_cnt; idx++) {
+      std::string cf_name = column.shard_cnt == 1 ?
+	column.name : column.name + "-" + to_string(idx);
+      // shards named alike in both shardings are kept
+      auto cf_it = std::find_if(source.handles.begin(), source.handles.end(),
+				[&](cabindb::ColumnFamilyHandle* h) { return h->GetName() == cf_name; });
+      cabindb::ColumnFamilyHandle *cf;
+      if (cf_it != source.handles.end()) {
+	cf = *cf_it;
+      } else {
+	cabindb::Status status = db->CreateColumnFamily(cf_opt, cf_name, &cf);
+	if (!status.ok()) {
+	  derr << __func__ << " Failed to create cabindb column family: "
+	       << cf_name << dendl;
+	  return -EINVAL;
+	}
+	rs->created.push_back(cf);
+	moving.handles.push_back(cf);
+      }
+      moving.target.handles.push_back(cf);
+    }
+    dout(5) << __func__ << " column " << *stored << " to " << column << dendl;
+  }
+
+  if (rs->columns.empty()) {
+    // nothing moves; new column options are used from the next open
+    env->CreateDir(sharding_def_dir);
+    if (auto status = cabindb::WriteStringToFile(env, new_sharding,
+						 sharding_def_file, true);
+	!status.ok()) {
+      derr << __func__ << " cannot write to " << sharding_def_file << dendl;
+      return -EIO;
+    }
+    return 0;
+  }
+
+  // a db that stops before all keys are moved is left for reshard()
+  std::string locked_sharding_text = stored_sharding_text;
+  if (locked_sharding_text.size() != 0)
+    locked_sharding_text += " ";
+  locked_sharding_text += resharding_column_lock;
+  env->CreateDir(sharding_def_dir);
+  if (auto status = cabindb::WriteStringToFile(env, locked_sharding_text,
+					       sharding_def_file, true);
+      !status.ok()) {
+    derr << __func__ << " cannot write to " << sharding_def_file << dendl;
+    return -EIO;
+  }
+
+  {
+    std::unique_lock wl{reshard_lock};
+    for (auto& [prefix, column] : rs->columns) {
+      for (auto cf : column.handles) {
+	cf_ids_to_prefix.emplace(cf->GetID(), prefix);
+      }
+    }
+    auto state = std::make_unique<sharding_state_t>();
+    if (auto current = sharding_state.load(std::memory_order_acquire); current) {
+      state->resharded = current->resharded;
+    }
+    state->reshard = rs.get();
+    set_sharding_state(std::move(state));
+    online_reshard.store(rs.get(), std::memory_order_release);
+    online_reshards.push_back(std::move(rs));
+  }
+  reshard_ctrl = ctrl ? *ctrl : resharding_ctrl();
+  reshard_stop = false;
+  reshard_thread.create("cstore_reshard");
+  return 0;
+}
+
+bool CabinDBStore::reshard_online_done() const
+{
+  auto rs = online_reshard.load(std::memory_order_acquire);
+  return rs && rs->done.load(std::memory_order_acquire);
+}
+
+int CabinDBStore::reshard_online_wait()
+{
+  reshard_thread_lock.lock();
+  bool started = reshard_thread.is_started();
+  reshard_thread_lock.unlock();
+  if (started) {
+    reshard_thread.join();
+  }
+  auto rs = online_reshard.load(std::memory_order_acquire);
+  if (!rs) {
+    // nothing had to move
+    return 0;
+  }
+  return rs->error;
+}
+
+void CabinDBStore::reshard_thread_entry()
+{
+  auto rs = online_reshard.load(std::memory_order_acquire);
+  dout(1) << __func__ << " moving keys to " << rs->sharding << dendl;
+  for (auto& [prefix, column] : rs->columns) {
+    for (auto cf : column.source->handles) {
+      int r = reshard_move_shard(column, cf);
+      if (r < 0) {
+	dout(1) << __func__ << " stopped in " << cf->GetName()
+		<< ": " << cpp_strerror(r) << dendl;
+	rs->error = r;
+	return;
+      }
+    }
+  }
+  int r = reshard_online_finish(rs);
+  if (r < 0) {
+    derr << __func__ << " failed to finish: " << cpp_strerror(r) << dendl;
+    rs->error = r;
+    return;
+  }
+  dout(1) << __func__ << " sharding is " << rs->sharding << dendl;
+}
+
+int CabinDBStore::reshard_move_shard(const resharding_column& column,
+				     cabindb::ColumnFamilyHandle* cf)
+{
+  dout(5) << __func__ << " " << cf->GetName() << dendl;
+  cabindb::WriteOptions woptions;
+  woptions.disableWAL = disableWAL;
+  std::string next;
+  bool first = true;
+  while (true) {
+    // the keys of the next range that move, found without the lock
+    std::vector<std::string> keys;
+    size_t keys_seen = 0;
+    size_t bytes_seen = 0;
+    bool end;
+    {
+      std::unique_ptr<cabindb::Iterator> it{
+	db->NewIterator(iterator_read_options(), cf)};
+      if (first) {
+	it->SeekToFirst();
+      } else {
+	it->Seek(next);
+      }
+      for (; it->Valid() &&
+	     keys_seen < reshard_ctrl.keys_per_iterator &&
+	     keys.size() < reshard_ctrl.keys_per_batch &&
+	     bytes_seen < reshard_ctrl.bytes_per_batch;
+	   it->Next()) {
+	keys_seen++;
+	cabindb::Slice key = it->key();
+	if (select_shard(column.target, key.data(), key.size()) == cf) {
+	  continue;
+	}
+	keys.push_back(key.ToString());
+	bytes_seen += key.size() + it->value().size();
+      }
+      if (!it->status().ok()) {
+	derr << __func__ << " iterator error: " << it->status().ToString() << dendl;
+	return -EIO;
+      }
+      end = !it->Valid();
+      if (!end) {
+	next = it->key().ToString();
+      }
+    }
+    size_t keys_moved = 0;
+    size_t bytes_moved = 0;
+    if (!keys.empty()) {
+      // writers wait while the range is read again and moved, or the move
+      // would overwrite a value written since it was found
+      std::unique_lock l{reshard_lock};
+      std::vector<cabindb::Slice> slices(keys.begin(), keys.end());
+      std::vector<cabindb::PinnableSlice> values(keys.size());
+      std::vector<cabindb::Status> statuses(keys.size());
+      db->MultiGet(cabindb::ReadOptions(), cf, keys.size(), slices.data(),
+		   values.data(), statuses.data(), true);
+      cabindb::WriteBatch bat;
+      for (size_t i = 0; i < keys.size(); ++i) {
+	if (statuses[i].IsNotFound()) {
+	  // written or removed in the meantime, which moved it
+	  continue;
+	}
+	if (!statuses[i].ok()) {
+	  derr << __func__ << " read error: " << statuses[i].ToString() << dendl;
+	  return -EIO;
+	}
+	bat.Delete(cf, slices[i]);
+	bat.Put(select_shard(column.target, keys[i].data(), keys[i].size()),
+		slices[i], values[i]);
+	keys_moved++;
+	bytes_moved += slices[i].size() + values[i].size();
+      }
+      if (bat.Count() > 0) {
+	cabindb::Status s = db->Write(woptions, &bat);
+	if (!s.ok()) {
+	  derr << __func__ << " write error: " << s.ToString() << dendl;
+	  return -EIO;
+	}
+      }
+    }
+    first = false;
+    logger->inc(l_cabindb_reshard_keys_moved, keys_moved);
+    logger->inc(l_cabindb_reshard_bytes_moved, bytes_moved);
+    if (end) {
+      return 0;
+    }
+    std::unique_lock l{reshard_thread_lock};
+    if (reshard_ctrl.bytes_per_sec && bytes_moved) {
+      reshard_cond.wait_for(
+	l, ceph::make_timespan((double)bytes_moved / reshard_ctrl.bytes_per_sec),
+	[this] { return reshard_stop; });
+    }
+    if (reshard_stop) {
+      return -ECANCELED;
+    }
+  }
+}
+
+int CabinDBStore::reshard_online_finish(online_reshard_t* rs)
+{
+  // No batch is written while the sharding changes. One routed before is
+  // routed again when it is submitted, and does not reach the old shards.
+  std::unique_lock wl{reshard_lock};
+  // shards that are not part of the new sharding must be empty by now
+  std::vector<cabindb::ColumnFamilyHandle*> to_drop;
+  for (auto& [prefix, column] : rs->columns) {
+    for (auto cf : column.source->handles) {
+      if (std::find(column.target.handles.begin(), column.target.handles.end(), cf) !=
+	  column.target.handles.end()) {
+	continue;
+      }
+      std::unique_ptr<cabindb::Iterator> it{
+	db->NewIterator(iterator_read_options(), cf)};
+      it->SeekToFirst();
+      if (it->Valid()) {
+	derr << __func__ << " " << cf->GetName() << " is not empty" << dendl;
+	return -EIO;
+      }
+      to_drop.push_back(cf);
+    }
+  }
+  // from now on keys are read and written in their new shards only
+  auto current = sharding_state.load(std::memory_order_acquire);
+  ceph_assert(current && current->reshard == rs);
+  auto state = std::make_unique<sharding_state_t>();
+  state->resharded = current->resharded;
+  for (auto& [prefix, column] : rs->columns) {
+    state->resharded[prefix] = &column.target;
+  }
+  set_sharding_state(std::move(state));
+  for (auto cf : to_drop) {
+    dout(5) << __func__ << " dropping " << cf->GetName() << dendl;
+    if (cabindb::Status status = db->DropColumnFamily(cf); !status.ok()) {
+      derr << __func__ << " Failed to drop column: " << cf->GetName() << dendl;
+      return -EINVAL;
+    }
+  }
+  env->CreateDir(sharding_def_dir);
+  if (auto status = cabindb::WriteStringToFile(env, rs->sharding,
+					       sharding_def_file, true);
+      !status.ok()) {
+    derr << __func__ << " cannot write to " << sharding_def_file << dendl;
+    return -EIO;
+  }
+  rs->done.store(true, std::memory_order_release);
+  return 0;
+}
+
 bool CabinDBStore::get_sharding(std::string& sharding) {
   cabindb::Status status;
   std::string stored_sharding_text;
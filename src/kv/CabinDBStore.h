@@ -6,6 +6,8 @@
 #include "include/types.h"
 #include "include/buffer_fwd.h"
 #include "KeyValueDB.h"
+#include <atomic>
+#include <deque>
 #include <set>
 #include <map>
 #include <string>
@@ -18,6 +20,7 @@
 #include "cabindb/include/cabindb/table.h"
 #include "cabindb/include/cabindb/db.h"
 #include "kv/cabindb_cache/BinnedLRUCache.h"
+#include "kv/cabindb_cache/WriteBufferCache.h"
 #include <errno.h>
 #include "common/errno.h"
 #include "common/dout.h"
@@ -43,6 +46,24 @@ enum {
   l_cabindb_write_memtable_time,
   l_cabindb_write_delay_time,
   l_cabindb_write_pre_and_post_process_time,
+  l_cabindb_submit_async_latency,
+  l_cabindb_commit_queue_len,
+  l_cabindb_group_commit_txns,
+  l_cabindb_group_commit_latency,
+  l_cabindb_pcache_hit,
+  l_cabindb_pcache_miss,
+  l_cabindb_pcache_read_bytes,
+  l_cabindb_pcache_insert,
+  l_cabindb_pcache_insert_bytes,
+  l_cabindb_pcache_lookup_latency,
+  l_cabindb_read_queue_depth,
+  l_cabindb_async_read_bytes,
+  l_cabindb_subcompactions,
+  l_cabindb_subcompaction_latency,
+  l_cabindb_zero_copy_gets,
+  l_cabindb_zero_copy_bytes,
+  l_cabindb_reshard_keys_moved,
+  l_cabindb_reshard_bytes_moved,
   l_cabindb_last,
 };
 
@@ -80,11 +101,22 @@ class CabinDBStore : public KeyValueDB {
   std::shared_ptr<cabindb::Statistics> dbstats;
   cabindb::BlockBasedTableOptions bbt_opts;
   std::string options_str;
+  class CabinPersistentCache;
+  std::shared_ptr<CabinPersistentCache> persistent_cache;
+  class CabinStatistics;
+  /// read ahead of iterators asynchronously (cabindb_async_io)
+  bool async_io = false;
+  /// smallest pinned value get() references instead of copying, 0 for none
+  /// (cabindb_zero_copy_min_value_size)
+  uint64_t zero_copy_min_size = 0;
+  /// memtable budget shared by every CabinDBStore of the process
+  std::shared_ptr<cabindb_cache::WriteBufferCache> write_buffer_cache;
 
   uint64_t cache_size = 0;
   bool set_cache_flag = false;
   friend class ShardMergeIteratorImpl;
   friend class WholeMergeIteratorImpl;
+  struct ReshardRouter;
   /*
    *  See CabinDB's definition of a column family(CF) and how to use it.
    *  The interfaces of KeyValueDB is extended, when a column family is created.
@@ -116,14 +148,83 @@ private:
   std::unordered_map<std::string, prefix_shards> cf_handles;
   std::unordered_map<uint32_t, std::string> cf_ids_to_prefix;
   std::unordered_map<std::string, cabindb::BlockBasedTableOptions> cf_bbt_opts;
-  
+
+  /// a column family whose keys move to a new sharding while the db is open
+  struct resharding_column {
+    const prefix_shards* source; //< the old sharding
+    prefix_shards target;        //< the new sharding
+    std::vector<cabindb::ColumnFamilyHandle *> handles; //< shards of both
+  };
+  struct online_reshard_t {
+    std::string sharding;        //< the new sharding definition
+    std::map<std::string, resharding_column> columns;
+    std::vector<cabindb::ColumnFamilyHandle *> created; //< new shards only
+    std::atomic<bool> done = false; //< every key is in its new shard
+    int error = 0;               //< why the reshard thread stopped early
+  };
+  /// every reshard_online() since open; kept until close()
+  std::vector<std::unique_ptr<online_reshard_t>> online_reshards;
+  /// the last of online_reshards
+  std::atomic<online_reshard_t*> online_reshard = nullptr;
+
+  /// Where online reshards have put the keys of the column families.
+  /// A state is never changed; a new one replaces it, with reshard_lock
+  /// held exclusively, and the old one is kept until close() for the
+  /// readers and transactions still routing with it.
+  struct sharding_state_t {
+    /// the reshard moving keys, if any
+    const online_reshard_t* reshard = nullptr;
+    /// columns that finished online reshards, to their new sharding
+    std::map<std::string, const prefix_shards*> resharded;
+  };
+  std::vector<std::unique_ptr<const sharding_state_t>> sharding_states;
+  /// nullptr as long as cf_handles is all there is
+  std::atomic<const sharding_state_t*> sharding_state = nullptr;
+  void set_sharding_state(std::unique_ptr<const sharding_state_t> state);
+
   void add_column_family(const std::string& cf_name, uint32_t hash_l, uint32_t hash_h,
 			 size_t shard_idx, cabindb::ColumnFamilyHandle *handle);
   bool is_column_family(const std::string& prefix);
+  static cabindb::ColumnFamilyHandle *select_shard(const prefix_shards& shards,
+						   const char* key, size_t keylen);
   cabindb::ColumnFamilyHandle *get_cf_handle(const std::string& prefix, const std::string& key);
   cabindb::ColumnFamilyHandle *get_cf_handle(const std::string& prefix, const char* key, size_t keylen);
+  /// the shard of the old sharding that may still hold key while its
+  /// column is resharded online, or nullptr if get_cf_handle() is the only
+  /// place to look
+  cabindb::ColumnFamilyHandle *get_old_cf_handle(const std::string& prefix, const char* key, size_t keylen);
+  const resharding_column* get_resharding_column(const std::string& prefix) const;
+  /// every shard that may hold keys of prefix; moving is set if keys can be
+  /// in more than one of them
+  const std::vector<cabindb::ColumnFamilyHandle *>& get_cf_handles(
+    const std::string& prefix, const prefix_shards& shards, bool* moving = nullptr) const;
+  /// the same as the above, as of state
+  static const prefix_shards& get_shards(const sharding_state_t* state,
+					 const std::string& prefix,
+					 const prefix_shards& shards);
+  static const resharding_column* get_resharding_column(const sharding_state_t* state,
+							const std::string& prefix);
+  cabindb::ColumnFamilyHandle *get_cf_handle(const sharding_state_t* state,
+					     const std::string& prefix,
+					     const char* key, size_t keylen);
+  cabindb::ColumnFamilyHandle *get_old_cf_handle(const sharding_state_t* state,
+						 const std::string& prefix,
+						 const char* key, size_t keylen);
+  static const std::vector<cabindb::ColumnFamilyHandle *>& get_cf_handles(
+    const sharding_state_t* state, const std::string& prefix,
+    const prefix_shards& shards, bool* moving = nullptr);
+  /// the column family prefix of a column family id; reshard_lock must be held
+  const std::string& get_cf_prefix(uint32_t column_family_id) const;
 
   int submit_common(cabindb::WriteOptions& woptions, KeyValueDB::Transaction t);
+  /// look all keys up with one batched MultiGet
+  void multi_get(const std::string& prefix,
+		 const std::vector<std::string>& keys,
+		 std::vector<cabindb::PinnableSlice>* values,
+		 std::vector<cabindb::Status>* statuses);
+  /// append a looked up value to out, by reference if it is pinned and large
+  void append_value(const std::string& prefix, cabindb::PinnableSlice&& value,
+		    ceph::bufferlist* out);
   int install_cf_mergeop(const std::string &cf_name, cabindb::ColumnFamilyOptions *cf_opt);
   int create_db_dir();
   int do_open(std::ostream &out, bool create_if_missing, bool open_readonly,
@@ -141,6 +242,10 @@ public:
 private:
   static void sharding_def_to_columns(const std::vector<ColumnFamily>& sharding_def,
 				      std::vector<std::string>& columns);
+  /// column family options of a new column from the sharding definition
+  int column_family_options(const cabindb::Options& opt,
+			    const ColumnFamily& column,
+			    cabindb::ColumnFamilyOptions* cf_opt);
   int create_shards(const cabindb::Options& opt,
 		    const vector<ColumnFamily>& sharding_def);
   int apply_sharding(const cabindb::Options& opt,
@@ -151,9 +256,35 @@ private:
 		      std::vector<cabindb::ColumnFamilyDescriptor>& missing_cfs,
 		      std::vector<std::pair<size_t, CabinDBStore::ColumnFamily> >& missing_cfs_shard);
   std::shared_ptr<cabindb::Cache> create_block_cache(const std::string& cache_type, size_t cache_size, double cache_prio_high = 0.0);
+  /// secondary block cache on cabindb_persistent_cache_path, if set
+  int create_persistent_cache(const cabindb::Options& opt);
+  /// filter_spec is <type>[:<bits per key>], type is bloom or ribbon;
+  /// bits default to cabindb_bloom_bits_per_key, 0 bits means no filter
+  int create_filter_policy(const std::string& filter_spec,
+			   std::shared_ptr<const cabindb::FilterPolicy>* policy);
+  /// compaction_spec is <style>[:<priority>], style is leveled, universal
+  /// or fifo, priority is low (default), high or bottom; fifo needs a size
+  /// or age limit in the column's options
+  int expand_compaction_options(const std::string& compaction_spec,
+				std::unordered_map<std::string, std::string>* column_opts_map);
+  /// a column family already written by leveled or universal compaction
+  /// keeps files below level 0, which fifo compaction cannot open
+  int check_fifo_switch(const cabindb::Options& opt,
+			const std::vector<cabindb::ColumnFamilyDescriptor>& cfs);
+  /// also moves the column's "filter" option, if any, to filter_opt and
+  /// expands its "compaction" option into cabindb column family options
   int extract_block_cache_options(const std::string& opts_str,
 				  std::unordered_map<std::string, std::string>* column_opts_map,
-				  std::string* block_cache_opt);
+				  std::string* block_cache_opt,
+				  std::string* filter_opt);
+  /// a hash indexed memtable needs the column's prefix_extractor, without
+  /// one cabindb silently falls back to a skiplist
+  int check_memtable_options(const std::string& column,
+			     const cabindb::ColumnFamilyOptions& cf_opt);
+  /// turns allow_concurrent_memtable_write off if the column's memtable
+  /// rep does not take concurrent inserts
+  void adjust_memtable_writes(cabindb::Options& opt, const std::string& column,
+			      const cabindb::ColumnFamilyOptions& cf_opt);
   // manage async compactions
   ceph::mutex compact_queue_lock =
     ceph::make_mutex("CabinDBStore::compact_thread_lock");
@@ -173,6 +304,30 @@ private:
 
   void compact_thread_entry();
 
+  // group commit of transactions queued by submit_transaction_async
+  struct pending_commit {
+    KeyValueDB::Transaction t;
+    std::function<void(int)> on_commit;
+    utime_t queued;
+  };
+  ceph::mutex commit_queue_lock =
+    ceph::make_mutex("CabinDBStore::commit_queue_lock");
+  ceph::condition_variable commit_queue_cond;
+  std::deque<pending_commit> commit_queue;
+  bool commit_queue_stop;
+  class CommitThread : public Thread {
+    CabinDBStore *db;
+  public:
+    explicit CommitThread(CabinDBStore *d) : db(d) {}
+    void *entry() override {
+      db->commit_thread_entry();
+      return NULL;
+    }
+    friend class CabinDBStore;
+  } commit_thread;
+
+  void commit_thread_entry();
+
   void compact_range(const std::string& start, const std::string& end);
   void compact_range_async(const std::string& start, const std::string& end);
   int tryInterpret(const std::string& key, const std::string& val,
@@ -226,9 +381,12 @@ public:
     dbstats(NULL),
     compact_queue_stop(false),
     compact_thread(this),
+    commit_queue_stop(false),
+    commit_thread(this),
     compact_on_mount(false),
     disableWAL(false),
-    delete_range_threshold(cct->_conf.get_val<uint64_t>("cabindb_delete_range_threshold"))
+    delete_range_threshold(cct->_conf.get_val<uint64_t>("cabindb_delete_range_threshold")),
+    reshard_thread(this)
   {}
 
   ~CabinDBStore() override;
@@ -249,6 +407,11 @@ public:
   void close() override;
 
   int repair(std::ostream &out) override;
+  /// Serves the compactions sent by cabindb_compaction_service_socket of the
+  /// process that has this db open, one job at a time, until accept fails.
+  /// Each job opens its own secondary instance of the db, so it sees the
+  /// files of the latest MANIFEST, and closes it when the job is done.
+  int run_compaction_worker(std::ostream &out, const std::string& socket_path);
   void split_stats(const std::string &s, char delim, std::vector<std::string> &elems);
   void get_statistics(ceph::Formatter *f) override;
 
@@ -261,6 +424,21 @@ public:
     const std::string &property,
     uint64_t *out) final;
 
+  /// sum an integer property over the default and every sharded column family
+  bool get_property_all_cfs(
+    const std::string &property,
+    uint64_t *out);
+
+  /// read a cabindb statistics ticker; only available with cabindb_perf
+  bool get_ticker(
+    uint32_t ticker,
+    uint64_t *out);
+
+  /// record every get/write/iterator op in cabindb's native trace format,
+  /// replayable with cabindb's trace_replay tooling
+  int start_trace(const std::string &path);
+  int end_trace();
+
   int64_t estimate_prefix_size(const std::string& prefix,
 			       const std::string& key_prefix) override;
   struct CabinWBHandler;
@@ -268,6 +446,8 @@ public:
   public:
     cabindb::WriteBatch bat;
     CabinDBStore *db;
+    /// the sharding bat was routed for
+    const sharding_state_t *sharding;
 
     explicit CabinDBTransactionImpl(CabinDBStore *_db);
   private:
@@ -315,6 +495,9 @@ public:
 
   int submit_transaction(KeyValueDB::Transaction t) override;
   int submit_transaction_sync(KeyValueDB::Transaction t) override;
+  /// -EOPNOTSUPP with disableWAL: no WAL sync would make t durable
+  int submit_transaction_async(KeyValueDB::Transaction t,
+			       std::function<void(int)> on_commit) override;
   int get(
     const std::string &prefix,
     const std::set<std::string> &key,
@@ -330,6 +513,11 @@ public:
     const char *key,
     size_t keylen,
     ceph::bufferlist *out) override;
+  int get_many(
+    const std::string &prefix,
+    const std::vector<std::string> &keys,
+    std::vector<ceph::bufferlist> *out,
+    std::vector<int> *rs) override;
 
 
   class CabinDBWholeSpaceIteratorImpl :
@@ -362,7 +550,28 @@ public:
   };
 
   Iterator get_iterator(const std::string& prefix, IteratorOpts opts = 0) override;
+  std::vector<Iterator> get_parallel_iterators(
+    const std::string& prefix,
+    size_t n,
+    const std::string& from = std::string(),
+    const std::string& to = std::string(),
+    IteratorOpts opts = 0) override;
 private:
+  /// read options of iterators
+  cabindb::ReadOptions iterator_read_options() const;
+  /// a snapshot that is released with the last reference to it
+  std::shared_ptr<const cabindb::Snapshot> get_db_snapshot();
+  /// iterator over prefix, which is stored in handles
+  Iterator new_cf_iterator(const std::string& prefix,
+			   const std::vector<cabindb::ColumnFamilyHandle*>& handles,
+			   const cabindb::ReadOptions& opt);
+  /// up to n - 1 keys that cut [from, to) of prefix into pieces of about
+  /// the same size on disk
+  void get_split_keys(const std::string& prefix,
+		      size_t n,
+		      const std::string& from,
+		      const std::string& to,
+		      std::vector<std::string>* keys);
   /// this iterator spans single cf
   cabindb::Iterator* new_shard_iterator(cabindb::ColumnFamilyHandle* cf);
 public:
@@ -494,6 +703,14 @@ err:
     return nullptr;
   }
 
+  std::map<std::string, std::shared_ptr<PriorityCache::PriCache>>
+      get_priority_caches() const override;
+
+  virtual std::shared_ptr<PriorityCache::PriCache>
+      get_write_buffer_cache() const override {
+    return write_buffer_cache;
+  }
+
   WholeSpaceIterator get_wholespace_iterator(IteratorOpts opts = 0) override;
 private:
   WholeSpaceIterator get_default_cf_iterator();
@@ -514,10 +731,48 @@ public:
     bool   unittest_fail_after_first_batch = false;
     bool   unittest_fail_after_processing_column = false;
     bool   unittest_fail_after_successful_processing = false;
+    uint64_t bytes_per_sec =  0;          /// online only: rate of moving, 0 for no limit
   };
   int reshard(const std::string& new_sharding, const resharding_ctrl* ctrl = nullptr);
+  /// Starts moving keys to new_sharding in the background while the db
+  /// stays open. Only the shard count and hash range of existing column
+  /// families may change, and not for those with a merge operator. The
+  /// sharding is locked as by reshard() until the move is done, so a db
+  /// closed before that must be finished with reshard(new_sharding).
+  /// -EBUSY while another one moves keys or failed to.
+  int reshard_online(const std::string& new_sharding, const resharding_ctrl* ctrl = nullptr);
+  /// true once the last reshard_online() has moved every key
+  bool reshard_online_done() const;
+  /// waits for the reshard thread; 0 if the new sharding is in place or
+  /// nothing had to move. Not to be called along with close().
+  int reshard_online_wait();
   bool get_sharding(std::string& sharding);
 
+private:
+  // online resharding
+  mutable ceph::shared_mutex reshard_lock =
+    ceph::make_shared_mutex("CabinDBStore::reshard_lock"); //< held shared by writers
+  ceph::mutex reshard_thread_lock =
+    ceph::make_mutex("CabinDBStore::reshard_thread_lock");
+  ceph::condition_variable reshard_cond;
+  bool reshard_stop = false;
+  resharding_ctrl reshard_ctrl;
+  class ReshardThread : public Thread {
+    CabinDBStore *db;
+  public:
+    explicit ReshardThread(CabinDBStore *d) : db(d) {}
+    void *entry() override {
+      db->reshard_thread_entry();
+      return NULL;
+    }
+    friend class CabinDBStore;
+  } reshard_thread;
+
+  void reshard_thread_entry();
+  int reshard_move_shard(const resharding_column& column,
+			 cabindb::ColumnFamilyHandle* cf);
+  int reshard_online_finish(online_reshard_t* rs);
+
 };
 
 #endif
@@ -4,6 +4,7 @@
 #define KEY_VALUE_DB_H
 
 #include "include/buffer.h"
+#include <functional>
 #include <ostream>
 #include <set>
 #include <map>
@@ -161,6 +162,15 @@ public:
   virtual int submit_transaction_sync(Transaction t) {
     return submit_transaction(t);
   }
+  /// Queue t and return; on_commit gets the result once t is durable.
+  /// Transactions queued here commit in submission order, and backends
+  /// may group them into one WAL sync.  A negative return means t was
+  /// not queued and on_commit is not called.
+  virtual int submit_transaction_async(Transaction t,
+				       std::function<void(int)> on_commit) {
+    on_commit(submit_transaction_sync(t));
+    return 0;
+  }
 
   /// Retrieve Keys
   virtual int get(
@@ -188,6 +198,21 @@ public:
 		  ceph::buffer::list *value) {
     return get(prefix, std::string(key, keylen), value);
   }
+  /// Retrieve keys in one batch. out and rs are resized to keys.size();
+  /// (*rs)[i] is 0 or -ENOENT and (*out)[i] holds the value of keys[i].
+  virtual int get_many(
+    const std::string &prefix,               ///< [in] Prefix/CF for keys
+    const std::vector<std::string> &keys,    ///< [in] Keys to retrieve
+    std::vector<ceph::buffer::list> *out,    ///< [out] Values, by key index
+    std::vector<int> *rs) {                  ///< [out] Per key result
+    out->clear();
+    out->resize(keys.size());
+    rs->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      (*rs)[i] = get(prefix, keys[i], &(*out)[i]);
+    }
+    return 0;
+  }
 
   // This superclass is used both by kv iterators *and* by the ObjectMap
   // omap iterator.  The class hierarchies are unfortunately tied together
@@ -262,7 +287,7 @@ public:
   };
   typedef std::shared_ptr< WholeSpaceIteratorImpl > WholeSpaceIterator;
 
-private:
+protected:
   // This class filters a WholeSpaceIterator by a prefix.
   // Performs as a dummy wrapper over WholeSpaceIterator
   // if prefix is empty
@@ -321,6 +346,70 @@ private:
       return generic_iter->status();
     }
   };
+
+  // This class limits an Iterator to the keys in [from, to); an empty
+  // bound is open. pin is kept alive as long as the iterator, e.g. the
+  // snapshot it reads from.
+  class RangeIteratorImpl : public IteratorImpl {
+    std::shared_ptr<const void> pin;
+    Iterator iter;
+    const std::string from;
+    const std::string to;
+  public:
+    RangeIteratorImpl(Iterator iter,
+		      const std::string &from,
+		      const std::string &to,
+		      std::shared_ptr<const void> pin = nullptr) :
+      pin(std::move(pin)), iter(std::move(iter)), from(from), to(to) { }
+    ~RangeIteratorImpl() override { }
+
+    int seek_to_first() override {
+      return from.empty() ? iter->seek_to_first() : iter->lower_bound(from);
+    }
+    int seek_to_last() override {
+      if (to.empty())
+	return iter->seek_to_last();
+      int r = iter->lower_bound(to);
+      if (r < 0)
+	return r;
+      return iter->valid() ? iter->prev() : iter->seek_to_last();
+    }
+    int upper_bound(const std::string &after) override {
+      return after < from ? iter->lower_bound(from) : iter->upper_bound(after);
+    }
+    int lower_bound(const std::string &k) override {
+      return iter->lower_bound(k < from ? from : k);
+    }
+    bool valid() override {
+      if (!iter->valid())
+	return false;
+      if (from.empty() && to.empty())
+	return true;
+      std::string k = iter->key();
+      return k >= from && (to.empty() || k < to);
+    }
+    int next() override {
+      return iter->next();
+    }
+    int prev() override {
+      return iter->prev();
+    }
+    std::string key() override {
+      return iter->key();
+    }
+    std::pair<std::string, std::string> raw_key() override {
+      return iter->raw_key();
+    }
+    ceph::buffer::list value() override {
+      return iter->value();
+    }
+    ceph::buffer::ptr value_as_ptr() override {
+      return iter->value_as_ptr();
+    }
+    int status() override {
+      return iter->status();
+    }
+  };
 public:
   typedef uint32_t IteratorOpts;
   static const uint32_t ITERATOR_NOCACHE = 1;
@@ -330,6 +419,19 @@ public:
       prefix,
       get_wholespace_iterator(opts));
   }
+  /// Up to n iterators over consecutive, disjoint ranges that together
+  /// cover the keys of prefix in [from, to); an empty bound is open.
+  /// All of them read the same point in time, so each can be walked by
+  /// its own thread. Stores that cannot split a range return one iterator.
+  virtual std::vector<Iterator> get_parallel_iterators(
+    const std::string &prefix,
+    size_t n,
+    const std::string &from = std::string(),
+    const std::string &to = std::string(),
+    IteratorOpts opts = 0) {
+    return {std::make_shared<RangeIteratorImpl>(
+      get_iterator(prefix, opts), from, to)};
+  }
 
   virtual uint64_t get_estimated_size(std::map<std::string,uint64_t> &extra) = 0;
   virtual int get_statfs(struct store_statfs_t *buf) {
@@ -360,6 +462,18 @@ public:
     return nullptr;
   }
 
+  /// caches owned by a single column family, by prefix; the shared
+  /// cache returned by get_priority_cache() is not included
+  virtual std::map<std::string, std::shared_ptr<PriorityCache::PriCache>>
+      get_priority_caches() const {
+    return {};
+  }
+
+  /// memtable memory, if the store charges it to a PriorityCache
+  virtual std::shared_ptr<PriorityCache::PriCache> get_write_buffer_cache() const {
+    return nullptr;
+  }
+
 
 
   virtual ~KeyValueDB() {}
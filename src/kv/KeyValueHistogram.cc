@@ -50,6 +50,25 @@ void KeyValueHistogram::update_hist_entry(map<string, map<int, struct key_dist>
       key_hist[prefix][key_slab].val_map[value_slab].max_len);
 }
 
+void KeyValueHistogram::merge(const KeyValueHistogram& other)
+{
+  for (auto& [slab, count] : other.value_hist) {
+    value_hist[slab] += count;
+  }
+  for (auto& [prefix, slabs] : other.key_hist) {
+    for (auto& [key_slab, kd] : slabs) {
+      auto& mine = key_hist[prefix][key_slab];
+      mine.count += kd.count;
+      mine.max_len = std::max(mine.max_len, kd.max_len);
+      for (auto& [value_slab, vd] : kd.val_map) {
+        auto& v = mine.val_map[value_slab];
+        v.count += vd.count;
+        v.max_len = std::max(v.max_len, vd.max_len);
+      }
+    }
+  }
+}
+
 void KeyValueHistogram::dump(Formatter* f)
 {
   f->open_object_section("rocksdb_value_distribution");
@@ -32,6 +32,8 @@ struct KeyValueHistogram {
   std::string get_value_slab_to_range(int slab);
   void update_hist_entry(std::map<std::string, std::map<int, struct key_dist> >& key_hist,
     const std::string& prefix, size_t key_size, size_t value_size);
+  /// add the counts of other, e.g. of another part of the same scan
+  void merge(const KeyValueHistogram& other);
   void dump(ceph::Formatter* f);
 };
 
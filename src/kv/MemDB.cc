@@ -17,6 +17,8 @@ namespace fs = std::filesystem;
 #include <experimental/filesystem>
 namespace fs = std::experimental::filesystem;
 #endif
+#include <algorithm>
+#include <thread>
 #include <errno.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -70,10 +72,18 @@ static string make_key(const string &prefix, const string &value)
   return out;
 }
 
-void MemDB::_encode(mdb_iter_t iter, bufferlist &bl)
+MemDB::MemDB(CephContext *c, const std::string &path, void *p) :
+  m_current(nullptr), m_epoch(0), m_next_txn(1),
+  m_total_bytes(0), m_allocated_bytes(0),
+  m_cct(c), logger(NULL), m_priv(p), m_db_path(path)
 {
-  encode(iter->first, bl);
-  encode(iter->second, bl);
+  m_num_shards = std::max<uint64_t>(
+    1, m_cct->_conf.get_val<uint64_t>("memdb_shards"));
+  m_shard_locks.reset(new std::mutex[m_num_shards]);
+  Version *v = new Version;
+  v->roots.resize(m_num_shards);
+  intrusive_ptr_add_ref(v);
+  m_current = v;
 }
 
 std::string MemDB::_get_data_fn()
@@ -84,7 +94,6 @@ std::string MemDB::_get_data_fn()
 
 void MemDB::_save()
 {
-  std::lock_guard<std::mutex> l(m_lock);
   dout(10) << __func__ << " Saving MemDB to file: "<< _get_data_fn().c_str() << dendl;
   int mode = 0644;
   int fd = TEMP_FAILURE_RETRY(::open(_get_data_fn().c_str(),
@@ -96,11 +105,12 @@ void MemDB::_save()
     return;
   }
   bufferlist bl;
-  mdb_iter_t iter = m_map.begin();
-  while (iter != m_map.end()) {
-    dout(10) << __func__ << " Key:"<< iter->first << dendl;
-    _encode(iter, bl);
-    ++iter;
+  MDBWholeSpaceIteratorImpl iter(_get_version());
+  for (iter.seek_to_first(); iter.valid(); iter.next()) {
+    const Node *n = iter.m_cursors[iter.m_cur].cur();
+    dout(10) << __func__ << " Key:"<< n->key << dendl;
+    encode(n->key, bl);
+    encode(n->value, bl);
   }
   bl.write_fd(fd);
 
@@ -109,7 +119,6 @@ void MemDB::_save()
 
 int MemDB::_load()
 {
-  std::lock_guard<std::mutex> l(m_lock);
   dout(10) << __func__ << " Reading MemDB from file: "<< _get_data_fn().c_str() << dendl;
   /*
    * Open file and read it in single shot.
@@ -132,6 +141,11 @@ int MemDB::_load()
     return -err;
   }
 
+  /*
+   * Nobody can see the DB yet, so the whole file is one transaction.
+   */
+  uint64_t txn = m_next_txn++;
+  std::map<unsigned, NodeRef> roots;
   ssize_t file_size = st.st_size;
   ssize_t bytes_done = 0;
   while (bytes_done < file_size) {
@@ -142,10 +156,24 @@ int MemDB::_load()
     bytes_done += ceph::decode_file(fd, datap);
 
     dout(10) << __func__ << " Key:"<< key << dendl;
-    m_map[key] = datap;
+    string prefix, k;
+    split_key(key, &prefix, &k);
+    NodeRef x(new Node);
+    x->key = std::move(key);
+    x->value = datap;
+    x->prio = std::hash<string>()(x->key);
+    x->txn = txn;
+    bufferptr old;
+    bool found = false;
+    NodeRef &root = roots[_shard_of(prefix)];
+    root = _insert(root, x, txn, &old, &found);
+    if (found) {
+      m_total_bytes -= old.length();
+    }
     m_total_bytes += datap.length();
   }
   VOID_TEMP_FAILURE_RETRY(::close(fd));
+  _retire(_publish(roots));
   return 0;
 }
 
@@ -212,6 +240,7 @@ int MemDB::create_and_open(ostream &out, bool create_if_missing, const std::stri
 MemDB::~MemDB()
 {
   close();
+  intrusive_ptr_release(m_current.load());
   dout(10) << __func__ << " Destroying MemDB instance: "<< dendl;
 }
 
@@ -232,19 +261,45 @@ int MemDB::submit_transaction(KeyValueDB::Transaction t)
   MDBTransactionImpl* mt =  static_cast<MDBTransactionImpl*>(t.get());
 
   dtrace << __func__ << " " << mt->get_ops().size() << dendl;
+
+  /*
+   * Lock every shard the transaction writes in shard order, apply the ops
+   * to private copies of their roots and publish all of them at once, so
+   * that readers see either none or all of the transaction.
+   */
+  std::map<unsigned, NodeRef> roots;
+  for (auto& op : mt->get_ops()) {
+    roots[_shard_of(op.second.first.first)];
+  }
+  std::vector<std::unique_lock<std::mutex>> shard_locks;
+  for (auto& i : roots) {
+    shard_locks.emplace_back(m_shard_locks[i.first]);
+  }
+  if (!roots.empty()) {
+    std::lock_guard<std::mutex> l(m_publish_lock);
+    Version *cur = m_current.load();
+    for (auto& i : roots) {
+      i.second = cur->roots[i.first];
+    }
+  }
+
+  uint64_t txn = m_next_txn++;
   for(auto& op : mt->get_ops()) {
+    NodeRef &root = roots[_shard_of(op.second.first.first)];
     if(op.first == MDBTransactionImpl::WRITE) {
-      ms_op_t set_op = op.second;
-      _setkey(set_op);
+      _setkey(root, txn, op.second);
     } else if (op.first == MDBTransactionImpl::MERGE) {
-      ms_op_t merge_op = op.second;
-      _merge(merge_op);
+      _merge(root, txn, op.second);
     } else {
-      ms_op_t rm_op = op.second;
       ceph_assert(op.first == MDBTransactionImpl::DELETE);
-      _rmkey(rm_op);
+      _rmkey(root, txn, op.second);
     }
   }
+  if (!roots.empty()) {
+    Version *old = _publish(roots);
+    shard_locks.clear();
+    _retire(old);
+  }
 
   utime_t lat = ceph_clock_now() - start;
   logger->inc(l_memdb_txns);
@@ -314,44 +369,39 @@ void MemDB::MDBTransactionImpl::merge(
   return;
 }
 
-int MemDB::_setkey(ms_op_t &op)
+int MemDB::_setkey(NodeRef &root, uint64_t txn, const ms_op_t &op)
 {
-  std::lock_guard<std::mutex> l(m_lock);
-  std::string key = make_key(op.first.first, op.first.second);
   bufferlist bl = op.second;
+  NodeRef x(new Node);
+  x->key = make_key(op.first.first, op.first.second);
+  x->value = bufferptr((char *) bl.c_str(), bl.length());
+  x->prio = std::hash<string>()(x->key);
+  x->txn = txn;
 
   m_total_bytes += bl.length();
 
-  bufferlist bl_old;
-  if (_get(op.first.first, op.first.second, &bl_old)) {
-    /*
-     * delete and free existing key.
-     */
-    ceph_assert(m_total_bytes >= bl_old.length());
-    m_total_bytes -= bl_old.length();
-    m_map.erase(key);
+  bufferptr old;
+  bool found = false;
+  root = _insert(root, x, txn, &old, &found);
+  if (found) {
+    ceph_assert(m_total_bytes >= old.length());
+    m_total_bytes -= old.length();
   }
-
-  m_map[key] = bufferptr((char *) bl.c_str(), bl.length());
-  iterator_seq_no++;
   return 0;
 }
 
-int MemDB::_rmkey(ms_op_t &op)
+int MemDB::_rmkey(NodeRef &root, uint64_t txn, const ms_op_t &op)
 {
-  std::lock_guard<std::mutex> l(m_lock);
   std::string key = make_key(op.first.first, op.first.second);
 
-  bufferlist bl_old;
-  if (_get(op.first.first, op.first.second, &bl_old)) {
-    ceph_assert(m_total_bytes >= bl_old.length());
-    m_total_bytes -= bl_old.length();
+  bufferptr old;
+  bool found = false;
+  root = _erase(root, key, txn, &old, &found);
+  if (found) {
+    ceph_assert(m_total_bytes >= old.length());
+    m_total_bytes -= old.length();
   }
-  iterator_seq_no++;
-  /*
-   * Erase will call the destructor for bufferptr.
-   */
-  return m_map.erase(key);
+  return found ? 1 : 0;
 }
 
 std::shared_ptr<KeyValueDB::MergeOperator> MemDB::_find_merge_op(const std::string &prefix)
@@ -367,11 +417,9 @@ std::shared_ptr<KeyValueDB::MergeOperator> MemDB::_find_merge_op(const std::stri
 }
 
 
-int MemDB::_merge(ms_op_t &op)
+int MemDB::_merge(NodeRef &root, uint64_t txn, const ms_op_t &op)
 {
-  std::lock_guard<std::mutex> l(m_lock);
   std::string prefix = op.first.first;
-  std::string key = make_key(op.first.first, op.first.second);
   bufferlist bl = op.second;
   int64_t bytes_adjusted = bl.length();
 
@@ -381,67 +429,230 @@ int MemDB::_merge(ms_op_t &op)
   std::shared_ptr<MergeOperator> mop = _find_merge_op(prefix);
   ceph_assert(mop);
 
+  NodeRef x(new Node);
+  x->key = make_key(op.first.first, op.first.second);
+  x->prio = std::hash<string>()(x->key);
+  x->txn = txn;
+
   /*
    * call the merge operator with value and non value
    */
-  bufferlist bl_old;
-  if (_get(op.first.first, op.first.second, &bl_old) == false) {
-    std::string new_val;
+  std::string new_val;
+  const Node *n = _find(root.get(), x->key);
+  if (n == nullptr) {
     /*
      * Merge non existent.
      */
     mop->merge_nonexistent(bl.c_str(), bl.length(), &new_val);
-    m_map[key] = bufferptr(new_val.c_str(), new_val.length());
   } else {
     /*
      * Merge existing.
      */
-    std::string new_val;
-    mop->merge(bl_old.c_str(), bl_old.length(), bl.c_str(), bl.length(), &new_val);
-    m_map[key] = bufferptr(new_val.c_str(), new_val.length());
-    bytes_adjusted -= bl_old.length();
-    bl_old.clear();
+    mop->merge(n->value.c_str(), n->value.length(), bl.c_str(), bl.length(),
+               &new_val);
+    bytes_adjusted -= n->value.length();
   }
+  x->value = bufferptr(new_val.c_str(), new_val.length());
+
+  bufferptr old;
+  bool found = false;
+  root = _insert(root, x, txn, &old, &found);
 
   ceph_assert((int64_t)m_total_bytes + bytes_adjusted >= 0);
   m_total_bytes += bytes_adjusted;
-  iterator_seq_no++;
   return 0;
 }
 
+unsigned MemDB::_shard_of(const string &prefix) const
+{
+  return std::hash<string>()(prefix) % m_num_shards;
+}
+
+namespace {
+// reader slot of this thread, handed out round robin
+unsigned reader_slot(unsigned slots)
+{
+  static std::atomic<unsigned> next_slot = {0};
+  static thread_local unsigned slot = next_slot++;
+  return slot % slots;
+}
+}
+
 /*
- * Caller take btree lock.
+ * Pins the current version. The slot counter covers the window between
+ * loading m_current and taking the reference, see _synchronize().
  */
-bool MemDB::_get(const string &prefix, const string &k, bufferlist *out)
+MemDB::VersionRef MemDB::_get_version()
 {
-  string key = make_key(prefix, k);
+  auto& slot = m_readers[reader_slot(READER_SLOTS)];
+  unsigned e = m_epoch.load() & 1;
+  slot.active[e]++;
+  VersionRef v(m_current.load());
+  slot.active[e]--;
+  return v;
+}
 
-  mdb_iter_t iter = m_map.find(key);
-  if (iter == m_map.end()) {
-    return false;
+/*
+ * Makes roots the current roots of their shards and returns the version
+ * they replace, which the caller passes to _retire().
+ */
+MemDB::Version *MemDB::_publish(const std::map<unsigned, NodeRef> &roots)
+{
+  Version *v = new Version;
+  intrusive_ptr_add_ref(v);
+  Version *old;
+  {
+    std::lock_guard<std::mutex> l(m_publish_lock);
+    old = m_current.load();
+    v->roots = old->roots;
+    for (auto& i : roots) {
+      v->roots[i.first] = i.second;
+    }
+    m_current = v;
   }
+  return old;
+}
 
-  out->push_back((m_map[key].clone()));
-  return true;
+void MemDB::_retire(Version *old)
+{
+  _synchronize();
+  intrusive_ptr_release(old);
 }
 
-bool MemDB::_get_locked(const string &prefix, const string &k, bufferlist *out)
+/*
+ * Waits until no reader can still be about to take a reference on a
+ * version that was replaced before the call. Readers that load m_current
+ * after the flip count against the other parity, so each wait is bounded;
+ * flipping twice also covers readers that loaded the epoch before the
+ * previous flip.
+ */
+void MemDB::_synchronize()
+{
+  std::lock_guard<std::mutex> l(m_sync_lock);
+  for (int round = 0; round < 2; round++) {
+    unsigned e = m_epoch++ & 1;
+    for (auto& slot : m_readers) {
+      while (slot.active[e].load() != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+}
+
+const MemDB::Node *MemDB::_find(const Node *n, const string &key)
 {
-  std::lock_guard<std::mutex> l(m_lock);
-  return _get(prefix, k, out);
+  while (n) {
+    int c = key.compare(n->key);
+    if (c == 0) {
+      return n;
+    }
+    n = c < 0 ? n->left.get() : n->right.get();
+  }
+  return nullptr;
 }
 
+/*
+ * Returns a node the writer of txn may change: n itself if txn already
+ * copied it, a fresh copy otherwise.
+ */
+MemDB::NodeRef MemDB::_own(const NodeRef &n, uint64_t txn)
+{
+  if (n->txn == txn) {
+    return n;
+  }
+  NodeRef c(new Node(*n));
+  c->txn = txn;
+  return c;
+}
+
+MemDB::NodeRef MemDB::_insert(const NodeRef &n, const NodeRef &x, uint64_t txn,
+                              bufferptr *old, bool *found)
+{
+  if (!n) {
+    return x;
+  }
+  int c = x->key.compare(n->key);
+  NodeRef r = _own(n, txn);
+  if (c == 0) {
+    *found = true;
+    *old = r->value;
+    r->value = x->value;
+  } else if (c < 0) {
+    r->left = _insert(r->left, x, txn, old, found);
+    if (r->left->prio > r->prio) {
+      NodeRef l = r->left;
+      r->left = l->right;
+      l->right = r;
+      return l;
+    }
+  } else {
+    r->right = _insert(r->right, x, txn, old, found);
+    if (r->right->prio > r->prio) {
+      NodeRef rr = r->right;
+      r->right = rr->left;
+      rr->left = r;
+      return rr;
+    }
+  }
+  return r;
+}
+
+MemDB::NodeRef MemDB::_erase(const NodeRef &n, const string &key, uint64_t txn,
+                             bufferptr *old, bool *found)
+{
+  if (!n) {
+    return n;
+  }
+  int c = key.compare(n->key);
+  if (c == 0) {
+    *found = true;
+    *old = n->value;
+    return _join(n->left, n->right, txn);
+  }
+  const NodeRef &child = c < 0 ? n->left : n->right;
+  NodeRef nc = _erase(child, key, txn, old, found);
+  if (nc == child) {
+    // key not found, or changed in place under a node we already own
+    return n;
+  }
+  NodeRef r = _own(n, txn);
+  (c < 0 ? r->left : r->right) = nc;
+  return r;
+}
+
+/*
+ * Joins two treaps where every key of a sorts before every key of b.
+ */
+MemDB::NodeRef MemDB::_join(const NodeRef &a, const NodeRef &b, uint64_t txn)
+{
+  if (!a) {
+    return b;
+  }
+  if (!b) {
+    return a;
+  }
+  if (a->prio > b->prio) {
+    NodeRef r = _own(a, txn);
+    r->right = _join(r->right, b, txn);
+    return r;
+  }
+  NodeRef r = _own(b, txn);
+  r->left = _join(a, r->left, txn);
+  return r;
+}
 
 int MemDB::get(const string &prefix, const std::string& key,
                  bufferlist *out)
 {
   utime_t start = ceph_clock_now();
-  int ret;
+  int ret = -ENOENT;
 
-  if (_get_locked(prefix, key, out)) {
+  VersionRef v = _get_version();
+  const Node *n = _find(v->roots[_shard_of(prefix)].get(),
+                        make_key(prefix, key));
+  if (n) {
+    out->push_back(n->value.clone());
     ret = 0;
-  } else {
-    ret = -ENOENT;
   }
 
   utime_t lat = ceph_clock_now() - start;
@@ -456,10 +667,15 @@ int MemDB::get(const string &prefix, const std::set<string> &keys,
 {
   utime_t start = ceph_clock_now();
 
+  VersionRef v = _get_version();
+  const Node *root = v->roots[_shard_of(prefix)].get();
   for (const auto& i : keys) {
-    bufferlist bl;
-    if (_get_locked(prefix, i, &bl))
+    const Node *n = _find(root, make_key(prefix, i));
+    if (n) {
+      bufferlist bl;
+      bl.push_back(n->value.clone());
       out->insert(make_pair(i, bl));
+    }
   }
 
   utime_t lat = ceph_clock_now() - start;
@@ -469,124 +685,214 @@ int MemDB::get(const string &prefix, const std::set<string> &keys,
   return 0;
 }
 
-void MemDB::MDBWholeSpaceIteratorImpl::fill_current()
+void MemDB::MDBWholeSpaceIteratorImpl::cursor_t::first()
 {
-  bufferlist bl;
-  bl.push_back(m_iter->second.clone());
-  m_key_value = std::make_pair(m_iter->first, bl);
+  path.clear();
+  for (const Node *n = root; n; n = n->left.get()) {
+    path.push_back(n);
+  }
 }
 
-bool MemDB::MDBWholeSpaceIteratorImpl::valid()
+void MemDB::MDBWholeSpaceIteratorImpl::cursor_t::last()
 {
-  if (m_key_value.first.empty()) {
-    return false;
+  path.clear();
+  for (const Node *n = root; n; n = n->right.get()) {
+    path.push_back(n);
   }
-  return true;
 }
 
-bool MemDB::MDBWholeSpaceIteratorImpl::iterator_validate() {
+void MemDB::MDBWholeSpaceIteratorImpl::cursor_t::lower_bound(const string &k)
+{
+  path.clear();
+  size_t depth = 0;
+  for (const Node *n = root; n; ) {
+    path.push_back(n);
+    if (n->key >= k) {
+      depth = path.size();
+      n = n->left.get();
+    } else {
+      n = n->right.get();
+    }
+  }
+  path.resize(depth);
+}
 
-  if (this_seq_no != *global_seq_no) {
-    auto key = m_key_value.first;
-    ceph_assert(!key.empty());
+void MemDB::MDBWholeSpaceIteratorImpl::cursor_t::upper_bound(const string &k)
+{
+  path.clear();
+  size_t depth = 0;
+  for (const Node *n = root; n; ) {
+    path.push_back(n);
+    if (n->key > k) {
+      depth = path.size();
+      n = n->left.get();
+    } else {
+      n = n->right.get();
+    }
+  }
+  path.resize(depth);
+}
 
-    bool restart_iter = false;
-    if (!m_using_btree) {
-      /*
-       * Map is modified and marker key does not exists, 
-       * restart the iterator from next key.
-       */
-      if (m_map_p->find(key) == m_map_p->end()) {
-        restart_iter = true;
-      }
+void MemDB::MDBWholeSpaceIteratorImpl::cursor_t::before(const string &k)
+{
+  path.clear();
+  size_t depth = 0;
+  for (const Node *n = root; n; ) {
+    path.push_back(n);
+    if (n->key < k) {
+      depth = path.size();
+      n = n->right.get();
     } else {
-      restart_iter = true;
+      n = n->left.get();
     }
+  }
+  path.resize(depth);
+}
 
-    if (restart_iter) {
-      m_iter = m_map_p->lower_bound(key);
-      if (m_iter == m_map_p->end()) {
-        return false;
-      }
+void MemDB::MDBWholeSpaceIteratorImpl::cursor_t::next()
+{
+  const Node *n = path.back();
+  if (n->right) {
+    for (n = n->right.get(); n; n = n->left.get()) {
+      path.push_back(n);
     }
+    return;
+  }
+  // climb until we come up from a left child
+  do {
+    n = path.back();
+    path.pop_back();
+  } while (!path.empty() && path.back()->right.get() == n);
+}
 
-    /*
-     * This iter is valid now.
-     */
-    this_seq_no = *global_seq_no;
+void MemDB::MDBWholeSpaceIteratorImpl::cursor_t::prev()
+{
+  const Node *n = path.back();
+  if (n->left) {
+    for (n = n->left.get(); n; n = n->right.get()) {
+      path.push_back(n);
+    }
+    return;
+  }
+  do {
+    n = path.back();
+    path.pop_back();
+  } while (!path.empty() && path.back()->left.get() == n);
+}
+
+MemDB::MDBWholeSpaceIteratorImpl::MDBWholeSpaceIteratorImpl(
+  VersionRef version, int shard)
+  : m_version(std::move(version))
+{
+  if (shard >= 0) {
+    m_cursors.push_back(cursor_t{m_version->roots[shard].get(), {}});
+  } else {
+    for (auto& root : m_version->roots) {
+      if (root) {
+        m_cursors.push_back(cursor_t{root.get(), {}});
+      }
+    }
   }
+}
 
-  return true;
+/*
+ * Makes the smallest (forward) or largest (backward) positioned cursor
+ * the current one.
+ */
+void MemDB::MDBWholeSpaceIteratorImpl::pick()
+{
+  m_cur = -1;
+  for (size_t i = 0; i < m_cursors.size(); i++) {
+    const Node *n = m_cursors[i].cur();
+    if (!n) {
+      continue;
+    }
+    if (m_cur < 0) {
+      m_cur = i;
+      continue;
+    }
+    int c = n->key.compare(m_cursors[m_cur].cur()->key);
+    if (m_forward ? c < 0 : c > 0) {
+      m_cur = i;
+    }
+  }
 }
 
-void
-MemDB::MDBWholeSpaceIteratorImpl::free_last()
+bool MemDB::MDBWholeSpaceIteratorImpl::valid()
 {
-  m_key_value.first.clear();
-  m_key_value.second.clear();
+  return m_cur >= 0;
 }
 
 string MemDB::MDBWholeSpaceIteratorImpl::key()
 {
-  dtrace << __func__ << " " << m_key_value.first << dendl;
+  const string &k = m_cursors[m_cur].cur()->key;
+  dtrace << __func__ << " " << k << dendl;
   string prefix, key;
-  split_key(m_key_value.first, &prefix, &key);
+  split_key(k, &prefix, &key);
   return key;
 }
 
 std::pair<string,string> MemDB::MDBWholeSpaceIteratorImpl::raw_key()
 {
   string prefix, key;
-  split_key(m_key_value.first, &prefix, &key);
+  split_key(m_cursors[m_cur].cur()->key, &prefix, &key);
   return { prefix, key };
 }
 
 bool MemDB::MDBWholeSpaceIteratorImpl::raw_key_is_prefixed(
     const string &prefix)
 {
-  string p, k;
-  split_key(m_key_value.first, &p, &k);
-  return (p == prefix);
+  const string &k = m_cursors[m_cur].cur()->key;
+  return k.size() > prefix.size() && k[prefix.size()] == KEY_DELIM &&
+    k.compare(0, prefix.size(), prefix) == 0;
 }
 
 bufferlist MemDB::MDBWholeSpaceIteratorImpl::value()
 {
-  dtrace << __func__ << " " << m_key_value << dendl;
-  return m_key_value.second;
+  const Node *n = m_cursors[m_cur].cur();
+  dtrace << __func__ << " " << n->key << dendl;
+  bufferlist bl;
+  bl.push_back(n->value.clone());
+  return bl;
 }
 
 int MemDB::MDBWholeSpaceIteratorImpl::next()
 {
-  std::lock_guard<std::mutex> l(*m_map_lock_p);
-  if (!iterator_validate()) {
-    free_last();
+  if (m_cur < 0) {
     return -1;
   }
-  free_last();
-  ++m_iter;
-  if (m_iter != m_map_p->end()) {
-    fill_current();
-    return 0;
-  } else {
-    return -1;
+  if (!m_forward) {
+    // the other cursors sit before the current key, move them past it
+    const string k = m_cursors[m_cur].cur()->key;
+    for (size_t i = 0; i < m_cursors.size(); i++) {
+      if ((int)i != m_cur) {
+        m_cursors[i].upper_bound(k);
+      }
+    }
+    m_forward = true;
   }
+  m_cursors[m_cur].next();
+  pick();
+  return m_cur >= 0 ? 0 : -1;
 }
 
 int MemDB::MDBWholeSpaceIteratorImpl:: prev()
 {
-  std::lock_guard<std::mutex> l(*m_map_lock_p);
-  if (!iterator_validate()) {
-    free_last();
+  if (m_cur < 0) {
     return -1;
   }
-  free_last();
-  if (m_iter != m_map_p->begin()) {
-    --m_iter;
-    fill_current();
-    return 0;
-  } else {
-    return -1;
+  if (m_forward) {
+    const string k = m_cursors[m_cur].cur()->key;
+    for (size_t i = 0; i < m_cursors.size(); i++) {
+      if ((int)i != m_cur) {
+        m_cursors[i].before(k);
+      }
+    }
+    m_forward = false;
   }
+  m_cursors[m_cur].prev();
+  pick();
+  return m_cur >= 0 ? 0 : -1;
 }
 
 /*
@@ -594,68 +900,57 @@ int MemDB::MDBWholeSpaceIteratorImpl:: prev()
  */
 int MemDB::MDBWholeSpaceIteratorImpl::seek_to_first(const std::string &k)
 {
-  std::lock_guard<std::mutex> l(*m_map_lock_p);
-  free_last();
-  if (k.empty()) {
-    m_iter = m_map_p->begin();
-  } else {
-    m_iter = m_map_p->lower_bound(k);
-  }
-  
-  if (m_iter == m_map_p->end()) {
-    return -1;
+  for (auto& c : m_cursors) {
+    if (k.empty()) {
+      c.first();
+    } else {
+      c.lower_bound(k);
+    }
   }
-  fill_current();
-  return 0;
+  m_forward = true;
+  pick();
+  return m_cur >= 0 ? 0 : -1;
 }
 
 int MemDB::MDBWholeSpaceIteratorImpl::seek_to_last(const std::string &k)
 {
-  std::lock_guard<std::mutex> l(*m_map_lock_p);
-  free_last();
-  if (k.empty()) {
-    m_iter = m_map_p->end();
-    --m_iter;
-  } else {
-    m_iter = m_map_p->lower_bound(k);
-  }
-
-  if (m_iter == m_map_p->end()) {
-    return -1;
+  for (auto& c : m_cursors) {
+    if (k.empty()) {
+      c.last();
+    } else {
+      c.lower_bound(k);
+    }
   }
-  fill_current();
-  return 0;
+  m_forward = !k.empty();
+  pick();
+  return m_cur >= 0 ? 0 : -1;
 }
 
 MemDB::MDBWholeSpaceIteratorImpl::~MDBWholeSpaceIteratorImpl()
 {
-  free_last();
 }
 
 int MemDB::MDBWholeSpaceIteratorImpl::upper_bound(const std::string &prefix,
     const std::string &after) {
 
-  std::lock_guard<std::mutex> l(*m_map_lock_p);
-
   dtrace << "upper_bound " << prefix.c_str() << after.c_str() << dendl;
   string k = make_key(prefix, after);
-  m_iter = m_map_p->upper_bound(k);
-  if (m_iter != m_map_p->end()) {
-    fill_current();
-    return 0;
+  for (auto& c : m_cursors) {
+    c.upper_bound(k);
   }
-  return -1;
+  m_forward = true;
+  pick();
+  return m_cur >= 0 ? 0 : -1;
 }
 
 int MemDB::MDBWholeSpaceIteratorImpl::lower_bound(const std::string &prefix,
     const std::string &to) {
-  std::lock_guard<std::mutex> l(*m_map_lock_p);
   dtrace << "lower_bound " << prefix.c_str() << to.c_str() << dendl;
   string k = make_key(prefix, to);
-  m_iter = m_map_p->lower_bound(k);
-  if (m_iter != m_map_p->end()) {
-    fill_current();
-    return 0;
+  for (auto& c : m_cursors) {
+    c.lower_bound(k);
   }
-  return -1;
+  m_forward = true;
+  pick();
+  return m_cur >= 0 ? 0 : -1;
 }
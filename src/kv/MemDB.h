@@ -9,15 +9,19 @@
 #define CEPH_OS_BLUESTORE_MEMDB_H
 
 #include "include/buffer.h"
+#include <atomic>
 #include <ostream>
 #include <set>
 #include <map>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include <boost/scoped_ptr.hpp>
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+#include <boost/smart_ptr/intrusive_ref_counter.hpp>
 #include "include/common_fwd.h"
 #include "include/encoding.h"
-#include "include/btree_map.h"
 #include "KeyValueDB.h"
 #include "osd/osd_types.h"
 
@@ -36,15 +40,51 @@ enum {
 class MemDB : public KeyValueDB
 {
   typedef std::pair<std::pair<std::string, std::string>, ceph::bufferlist> ms_op_t;
-  std::mutex m_lock;
-  uint64_t m_total_bytes;
-  uint64_t m_allocated_bytes;
 
-  typedef std::map<std::string, ceph::bufferptr> mdb_map_t;
-  typedef mdb_map_t::iterator mdb_iter_t;
-  bool m_using_btree;
+  /*
+   * Every shard is a persistent (copy on write) treap. A writer copies the
+   * path to each key it changes; nodes it has already copied carry its txn
+   * id and are changed in place. Published nodes are never modified.
+   */
+  struct Node : public boost::intrusive_ref_counter<Node> {
+    std::string key;
+    ceph::bufferptr value;
+    uint64_t prio = 0;
+    uint64_t txn = 0;
+    boost::intrusive_ptr<Node> left, right;
+  };
+  typedef boost::intrusive_ptr<Node> NodeRef;
+
+  /*
+   * The roots of all shards as of one committed transaction. Readers and
+   * iterators pin a Version and walk it without locks.
+   */
+  struct Version : public boost::intrusive_ref_counter<Version> {
+    std::vector<NodeRef> roots;
+  };
+  typedef boost::intrusive_ptr<Version> VersionRef;
+
+  /*
+   * Readers announce themselves in one of two per-slot counters between
+   * loading m_current and taking a reference on it, so that a writer can
+   * wait for them before dropping the version it replaced.
+   */
+  static constexpr unsigned READER_SLOTS = 64;
+  struct alignas(64) reader_slot_t {
+    std::atomic<uint64_t> active[2] = {{0}, {0}};
+  };
+
+  std::atomic<Version*> m_current;
+  reader_slot_t m_readers[READER_SLOTS];
+  std::atomic<uint64_t> m_epoch;
+  std::mutex m_sync_lock;             ///< serializes _synchronize()
+  std::mutex m_publish_lock;          ///< serializes swapping m_current
+  std::unique_ptr<std::mutex[]> m_shard_locks;  ///< one writer per shard
+  unsigned m_num_shards;
+  std::atomic<uint64_t> m_next_txn;
 
-  mdb_map_t m_map;
+  std::atomic<uint64_t> m_total_bytes;
+  uint64_t m_allocated_bytes;
 
   CephContext *m_cct;
   PerfCounters *logger;
@@ -55,21 +95,26 @@ class MemDB : public KeyValueDB
   int transaction_rollback(KeyValueDB::Transaction t);
   int _open(std::ostream &out);
   void close() override;
-  bool _get(const std::string &prefix, const std::string &k, ceph::bufferlist *out);
-  bool _get_locked(const std::string &prefix, const std::string &k, ceph::bufferlist *out);
   std::string _get_data_fn();
-  void _encode(mdb_iter_t iter, ceph::bufferlist &bl);
   void _save();
   int _load();
-  uint64_t iterator_seq_no;
+
+  unsigned _shard_of(const std::string &prefix) const;
+  VersionRef _get_version();
+  Version *_publish(const std::map<unsigned, NodeRef> &roots);
+  void _retire(Version *old);
+  void _synchronize();
+
+  static const Node *_find(const Node *n, const std::string &key);
+  static NodeRef _own(const NodeRef &n, uint64_t txn);
+  static NodeRef _insert(const NodeRef &n, const NodeRef &x, uint64_t txn,
+                         ceph::bufferptr *old, bool *found);
+  static NodeRef _erase(const NodeRef &n, const std::string &key, uint64_t txn,
+                        ceph::bufferptr *old, bool *found);
+  static NodeRef _join(const NodeRef &a, const NodeRef &b, uint64_t txn);
 
 public:
-  MemDB(CephContext *c, const std::string &path, void *p) :
-    m_total_bytes(0), m_allocated_bytes(0), m_using_btree(false),
-    m_cct(c), logger(NULL), m_priv(p), m_db_path(path), iterator_seq_no(1)
-  {
-    //Nothing as of now
-  }
+  MemDB(CephContext *c, const std::string &path, void *p);
 
   ~MemDB() override;
   int set_merge_operator(const std::string& prefix,
@@ -119,12 +164,12 @@ public:
 private:
 
   /*
-   * Transaction states.
+   * Transaction states. Applied to the root of the op's shard, which the
+   * caller holds the lock of.
    */
-  int _merge(const std::string &k, ceph::bufferptr &bl);
-  int _merge(ms_op_t &op);
-  int _setkey(ms_op_t &op);
-  int _rmkey(ms_op_t &op);
+  int _merge(NodeRef &root, uint64_t txn, const ms_op_t &op);
+  int _setkey(NodeRef &root, uint64_t txn, const ms_op_t &op);
+  int _rmkey(NodeRef &root, uint64_t txn, const ms_op_t &op);
 
 public:
 
@@ -151,30 +196,37 @@ public:
 
   using KeyValueDB::get;
 
+  /*
+   * Walks a pinned Version. With several shards the iterator merges them
+   * by key; an iterator over one prefix only looks at that prefix's shard.
+   */
   class MDBWholeSpaceIteratorImpl : public KeyValueDB::WholeSpaceIteratorImpl {
-
-      mdb_iter_t m_iter;
-      std::pair<std::string, ceph::bufferlist> m_key_value;
-      mdb_map_t *m_map_p;
-      std::mutex *m_map_lock_p;
-      uint64_t *global_seq_no;
-      uint64_t this_seq_no;
-      bool m_using_btree;
+      friend class MemDB;
+
+      /// path from the shard root to the current node, empty at the end
+      struct cursor_t {
+        const Node *root;
+        std::vector<const Node*> path;
+
+        const Node *cur() const { return path.empty() ? nullptr : path.back(); }
+        void first();
+        void last();
+        void lower_bound(const std::string &k);   ///< first >= k
+        void upper_bound(const std::string &k);   ///< first > k
+        void before(const std::string &k);        ///< last < k
+        void next();
+        void prev();
+      };
+
+      VersionRef m_version;
+      std::vector<cursor_t> m_cursors;
+      int m_cur = -1;       ///< cursor holding the current key
+      bool m_forward = true;
+
+      void pick();
 
   public:
-    MDBWholeSpaceIteratorImpl(mdb_map_t *btree_p, std::mutex *btree_lock_p,
-                              uint64_t *iterator_seq_no, bool using_btree) {
-      m_map_p = btree_p;
-      m_map_lock_p = btree_lock_p;
-      std::lock_guard<std::mutex> l(*m_map_lock_p);
-      global_seq_no = iterator_seq_no;
-      this_seq_no = *iterator_seq_no;
-      m_using_btree = using_btree;
-    }
-
-    void fill_current();
-    void free_last();
-
+    MDBWholeSpaceIteratorImpl(VersionRef version, int shard = -1);
 
     int seek_to_first(const std::string &k) override;
     int seek_to_last(const std::string &k) override;
@@ -185,7 +237,6 @@ public:
     int upper_bound(const std::string &prefix, const std::string &after) override;
     int lower_bound(const std::string &prefix, const std::string &to) override;
     bool valid() override;
-    bool iterator_validate();
 
     int next() override;
     int prev() override;
@@ -199,12 +250,10 @@ public:
   };
 
   uint64_t get_estimated_size(std::map<std::string,uint64_t> &extra) override {
-      std::lock_guard<std::mutex> l(m_lock);
       return m_allocated_bytes;
   };
 
   int get_statfs(struct store_statfs_t *buf) override {
-    std::lock_guard<std::mutex> l(m_lock);
     buf->reset();
     buf->total = m_total_bytes;
     buf->allocated = m_allocated_bytes;
@@ -214,7 +263,17 @@ public:
 
   WholeSpaceIterator get_wholespace_iterator(IteratorOpts opts = 0) override {
     return std::shared_ptr<KeyValueDB::WholeSpaceIteratorImpl>(
-      new MDBWholeSpaceIteratorImpl(&m_map, &m_lock, &iterator_seq_no, m_using_btree));
+      new MDBWholeSpaceIteratorImpl(_get_version()));
+  }
+
+  Iterator get_iterator(const std::string &prefix, IteratorOpts opts = 0) override {
+    if (prefix.empty()) {
+      return KeyValueDB::get_iterator(prefix, opts);
+    }
+    return std::make_shared<PrefixIteratorImpl>(
+      prefix,
+      std::make_shared<MDBWholeSpaceIteratorImpl>(_get_version(),
+                                                  _shard_of(prefix)));
   }
 };
 
@@ -1767,40 +1767,82 @@ void RocksDBStore::RocksDBTransactionImpl::merge(
   }
 }
 
+void RocksDBStore::multi_get(
+    const string &prefix,
+    const std::vector<string> &keys,
+    std::vector<rocksdb::PinnableSlice> *values,
+    std::vector<rocksdb::Status> *statuses)
+{
+  size_t n = keys.size();
+  std::vector<rocksdb::ColumnFamilyHandle*> cfs(n);
+  std::vector<rocksdb::Slice> slices(n);
+  // keys outside a column family carry the prefix; reserve so the
+  // slices pointing into combined stay valid
+  std::vector<string> combined;
+  bool sharded = cf_handles.count(prefix) > 0;
+  if (!sharded) {
+    combined.reserve(n);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (sharded) {
+      cfs[i] = get_cf_handle(prefix, keys[i]);
+      slices[i] = rocksdb::Slice(keys[i]);
+    } else {
+      combined.push_back(combine_strings(prefix, keys[i]));
+      cfs[i] = default_cf;
+      slices[i] = rocksdb::Slice(combined.back());
+    }
+  }
+  values->resize(n);
+  statuses->resize(n);
+  db->MultiGet(rocksdb::ReadOptions(), n, cfs.data(), slices.data(),
+	       values->data(), statuses->data());
+}
+
 int RocksDBStore::get(
     const string &prefix,
     const std::set<string> &keys,
     std::map<string, bufferlist> *out)
 {
-  rocksdb::PinnableSlice value;
   utime_t start = ceph_clock_now();
-  if (cf_handles.count(prefix) > 0) {
-    for (auto& key : keys) {
-      auto cf_handle = get_cf_handle(prefix, key);
-      auto status = db->Get(rocksdb::ReadOptions(),
-			    cf_handle,
-			    rocksdb::Slice(key),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+  std::vector<string> ks(keys.begin(), keys.end());
+  std::vector<rocksdb::PinnableSlice> values;
+  std::vector<rocksdb::Status> statuses;
+  multi_get(prefix, ks, &values, &statuses);
+  for (size_t i = 0; i < ks.size(); ++i) {
+    if (statuses[i].ok()) {
+      (*out)[ks[i]].append(values[i].data(), values[i].size());
+    } else if (statuses[i].IsIOError()) {
+      ceph_abort_msg(statuses[i].getState());
     }
-  } else {
-    for (auto& key : keys) {
-      string k = combine_strings(prefix, key);
-      auto status = db->Get(rocksdb::ReadOptions(),
-			    default_cf,
-			    rocksdb::Slice(k),
-			    &value);
-      if (status.ok()) {
-	(*out)[key].append(value.data(), value.size());
-      } else if (status.IsIOError()) {
-	ceph_abort_msg(status.getState());
-      }
-      value.Reset();
+  }
+  utime_t lat = ceph_clock_now() - start;
+  logger->inc(l_rocksdb_gets);
+  logger->tinc(l_rocksdb_get_latency, lat);
+  return 0;
+}
+
+int RocksDBStore::get_many(
+    const string &prefix,
+    const std::vector<string> &keys,
+    std::vector<bufferlist> *out,
+    std::vector<int> *rs)
+{
+  utime_t start = ceph_clock_now();
+  std::vector<rocksdb::PinnableSlice> values;
+  std::vector<rocksdb::Status> statuses;
+  multi_get(prefix, keys, &values, &statuses);
+  out->clear();
+  out->resize(keys.size());
+  rs->resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (statuses[i].ok()) {
+      (*out)[i].append(values[i].data(), values[i].size());
+      (*rs)[i] = 0;
+    } else if (statuses[i].IsNotFound()) {
+      (*rs)[i] = -ENOENT;
+    } else {
+      ceph_abort_msg(statuses[i].getState());
     }
   }
   utime_t lat = ceph_clock_now() - start;
@@ -2712,12 +2754,13 @@ private:
 public:
   explicit ShardMergeIteratorImpl(const RocksDBStore* db,
 				  const std::string& prefix,
-				  const std::vector<rocksdb::ColumnFamilyHandle*>& shards)
+				  const std::vector<rocksdb::ColumnFamilyHandle*>& shards,
+				  const rocksdb::ReadOptions& opt)
     : db(db), keyless(db->comparator), prefix(prefix)
   {
     iters.reserve(shards.size());
     for (auto& s : shards) {
-      iters.push_back(db->db->NewIterator(rocksdb::ReadOptions(), s));
+      iters.push_back(db->db->NewIterator(opt, s));
     }
   }
   ~ShardMergeIteratorImpl() {
@@ -2892,21 +2935,143 @@ KeyValueDB::Iterator RocksDBStore::get_iterator(const std::string& prefix, Itera
 {
   auto cf_it = cf_handles.find(prefix);
   if (cf_it != cf_handles.end()) {
-    if (cf_it->second.handles.size() == 1) {
-      return std::make_shared<CFIteratorImpl>(
-        prefix,
-        db->NewIterator(rocksdb::ReadOptions(), cf_it->second.handles[0]));
+    return new_cf_iterator(prefix, cf_it->second.handles, rocksdb::ReadOptions());
+  } else {
+    return KeyValueDB::get_iterator(prefix, opts);
+  }
+}
+
+KeyValueDB::Iterator RocksDBStore::new_cf_iterator(
+  const std::string& prefix,
+  const std::vector<rocksdb::ColumnFamilyHandle*>& handles,
+  const rocksdb::ReadOptions& opt)
+{
+  if (handles.size() == 1) {
+    return std::make_shared<CFIteratorImpl>(
+      prefix,
+      db->NewIterator(opt, handles[0]));
+  } else {
+    return std::make_shared<ShardMergeIteratorImpl>(
+      this,
+      prefix,
+      handles,
+      opt);
+  }
+}
+
+std::vector<KeyValueDB::Iterator> RocksDBStore::get_parallel_iterators(
+  const std::string& prefix,
+  size_t n,
+  const std::string& from,
+  const std::string& to,
+  IteratorOpts opts)
+{
+  // all ranges read one snapshot; it goes away with the last iterator
+  rocksdb::DB* d = db;
+  std::shared_ptr<const rocksdb::Snapshot> snapshot(
+    db->GetSnapshot(),
+    [d](const rocksdb::Snapshot* s) { d->ReleaseSnapshot(s); });
+  rocksdb::ReadOptions opt;
+  opt.snapshot = snapshot.get();
+  if (opts & ITERATOR_NOCACHE)
+    opt.fill_cache = false;
+
+  std::vector<std::string> bounds;
+  if (n > 1) {
+    get_split_keys(prefix, n, from, to, &bounds);
+  }
+  bounds.push_back(to);
+
+  auto cf_it = cf_handles.find(prefix);
+  std::vector<Iterator> iters;
+  iters.reserve(bounds.size());
+  std::string lower = from;
+  for (auto& upper : bounds) {
+    Iterator it;
+    if (cf_it != cf_handles.end()) {
+      it = new_cf_iterator(prefix, cf_it->second.handles, opt);
     } else {
-      return std::make_shared<ShardMergeIteratorImpl>(
-        this,
+      it = std::make_shared<PrefixIteratorImpl>(
         prefix,
-        cf_it->second.handles);
+        std::make_shared<RocksDBWholeSpaceIteratorImpl>(
+	  db->NewIterator(opt, default_cf)));
     }
+    iters.push_back(std::make_shared<RangeIteratorImpl>(
+      std::move(it), lower, upper, snapshot));
+    lower = upper;
+  }
+  dout(10) << __func__ << " prefix " << prefix << " split into "
+	   << iters.size() << " of " << n << dendl;
+  return iters;
+}
+
+void RocksDBStore::get_split_keys(
+  const std::string& prefix,
+  size_t n,
+  const std::string& from,
+  const std::string& to,
+  std::vector<std::string>* keys)
+{
+  std::vector<rocksdb::ColumnFamilyHandle*> handles;
+  // in the default column family the keys of prefix follow prefix + '\0'
+  std::string key_prefix;
+  auto cf_it = cf_handles.find(prefix);
+  if (cf_it != cf_handles.end()) {
+    handles = cf_it->second.handles;
   } else {
-    return KeyValueDB::get_iterator(prefix, opts);
+    handles.push_back(default_cf);
+    key_prefix = combine_strings(prefix, std::string());
+  }
+
+  // The largest key of every table file that ends inside the range,
+  // weighted by the size of the file. Memtables are not counted, and
+  // neither are files that end outside the range, so the split is only
+  // as even as the tables are.
+  std::vector<std::pair<std::string, uint64_t>> ends;
+  uint64_t total = 0;
+  for (auto cf : handles) {
+    rocksdb::ColumnFamilyMetaData meta;
+    db->GetColumnFamilyMetaData(cf, &meta);
+    for (auto& level : meta.levels) {
+      for (auto& file : level.files) {
+	if (file.largestkey.compare(0, key_prefix.size(), key_prefix) != 0) {
+	  continue;
+	}
+	std::string end = file.largestkey.substr(key_prefix.size());
+	if (end <= from || (!to.empty() && end >= to)) {
+	  continue;
+	}
+	total += file.size;
+	ends.emplace_back(std::move(end), file.size);
+      }
+    }
+  }
+  if (total == 0) {
+    return;
+  }
+  std::sort(ends.begin(), ends.end());
+
+  // cut wherever the running size crosses the next 1/n of the total
+  uint64_t sum = 0;
+  size_t next = 1;
+  for (auto& [end, size] : ends) {
+    sum += size;
+    if (sum * n < total * next) {
+      continue;
+    }
+    if (keys->empty() || keys->back() < end) {
+      keys->push_back(end);
+    }
+    while (next < n && sum * n >= total * next) {
+      ++next;
+    }
+    if (next == n) {
+      break;
+    }
   }
 }
 
+
 rocksdb::Iterator* RocksDBStore::new_shard_iterator(rocksdb::ColumnFamilyHandle* cf)
 {
   return db->NewIterator(rocksdb::ReadOptions(), cf);
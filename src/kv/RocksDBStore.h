@@ -124,6 +124,11 @@ private:
   rocksdb::ColumnFamilyHandle *get_cf_handle(const std::string& prefix, const char* key, size_t keylen);
 
   int submit_common(rocksdb::WriteOptions& woptions, KeyValueDB::Transaction t);
+  /// look all keys up with one batched MultiGet
+  void multi_get(const std::string& prefix,
+		 const std::vector<std::string>& keys,
+		 std::vector<rocksdb::PinnableSlice>* values,
+		 std::vector<rocksdb::Status>* statuses);
   int install_cf_mergeop(const std::string &cf_name, rocksdb::ColumnFamilyOptions *cf_opt);
   int create_db_dir();
   int do_open(std::ostream &out, bool create_if_missing, bool open_readonly,
@@ -330,6 +335,11 @@ public:
     const char *key,
     size_t keylen,
     ceph::bufferlist *out) override;
+  int get_many(
+    const std::string &prefix,
+    const std::vector<std::string> &keys,
+    std::vector<ceph::bufferlist> *out,
+    std::vector<int> *rs) override;
 
 
   class RocksDBWholeSpaceIteratorImpl :
@@ -362,7 +372,24 @@ public:
   };
 
   Iterator get_iterator(const std::string& prefix, IteratorOpts opts = 0) override;
+  std::vector<Iterator> get_parallel_iterators(
+    const std::string& prefix,
+    size_t n,
+    const std::string& from = std::string(),
+    const std::string& to = std::string(),
+    IteratorOpts opts = 0) override;
 private:
+  /// iterator over prefix, which is stored in handles
+  Iterator new_cf_iterator(const std::string& prefix,
+			   const std::vector<rocksdb::ColumnFamilyHandle*>& handles,
+			   const rocksdb::ReadOptions& opt);
+  /// up to n - 1 keys that cut [from, to) of prefix into pieces of about
+  /// the same size on disk
+  void get_split_keys(const std::string& prefix,
+		      size_t n,
+		      const std::string& from,
+		      const std::string& to,
+		      std::vector<std::string>* keys);
   /// this iterator spans single cf
   rocksdb::Iterator* new_shard_iterator(rocksdb::ColumnFamilyHandle* cf);
 public:
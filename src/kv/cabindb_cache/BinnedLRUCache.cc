@@ -110,7 +110,9 @@ BinnedLRUCacheShard::BinnedLRUCacheShard(CephContext *c, size_t capacity, bool s
       high_pri_pool_ratio_(high_pri_pool_ratio),
       high_pri_pool_capacity_(0),
       usage_(0),
-      lru_usage_(0) {
+      lru_usage_(0),
+      hits_(0),
+      misses_(0) {
   // Make empty circular linked list
   lru_.next = &lru_;
   lru_.prev = &lru_;
@@ -188,6 +190,11 @@ size_t BinnedLRUCacheShard::GetHighPriPoolUsage() const {
   return high_pri_pool_usage_;
 }
 
+void BinnedLRUCacheShard::GetLookupCounts(uint64_t* hits, uint64_t* misses) const {
+  *hits = hits_.load(std::memory_order_relaxed);
+  *misses = misses_.load(std::memory_order_relaxed);
+}
+
 void BinnedLRUCacheShard::LRU_Remove(BinnedLRUHandle* e) {
   ceph_assert(e->next != nullptr);
   ceph_assert(e->prev != nullptr);
@@ -284,6 +291,9 @@ cabindb::Cache::Handle* BinnedLRUCacheShard::Lookup(const cabindb::Slice& key, u
     }
     e->refs++;
     e->SetHit();
+    hits_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    misses_.fetch_add(1, std::memory_order_relaxed);
   }
   return reinterpret_cast<cabindb::Cache::Handle*>(e);
 }
@@ -552,6 +562,28 @@ size_t BinnedLRUCache::GetHighPriPoolUsage() const {
 
 // PriCache
 
+uint64_t BinnedLRUCache::get_cache_hits() const
+{
+  uint64_t total = 0;
+  for (int s = 0; s < num_shards_; s++) {
+    uint64_t hits, misses;
+    shards_[s].GetLookupCounts(&hits, &misses);
+    total += hits;
+  }
+  return total;
+}
+
+uint64_t BinnedLRUCache::get_cache_misses() const
+{
+  uint64_t total = 0;
+  for (int s = 0; s < num_shards_; s++) {
+    uint64_t hits, misses;
+    shards_[s].GetLookupCounts(&hits, &misses);
+    total += misses;
+  }
+  return total;
+}
+
 int64_t BinnedLRUCache::request_cache_bytes(PriorityCache::Priority pri, uint64_t total_cache) const
 {
   int64_t assigned = get_cache_bytes(pri);
@@ -10,6 +10,7 @@
 #ifndef CABINDB_BINNED_LRU_CACHE
 #define CABINDB_BINNED_LRU_CACHE
 
+#include <atomic>
 #include <string>
 #include <mutex>
 
@@ -224,6 +225,9 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Retrieves high pri pool usage
   size_t GetHighPriPoolUsage() const;
 
+  // Retrieves the number of lookups that found / missed an entry
+  void GetLookupCounts(uint64_t* hits, uint64_t* misses) const;
+
  private:
   CephContext *cct;
   void LRU_Remove(BinnedLRUHandle* e);
@@ -286,6 +290,10 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Memory size for entries residing only in the LRU list
   size_t lru_usage_;
 
+  // Lookups that found / missed an entry; read without mutex_
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
@@ -324,6 +332,8 @@ class BinnedLRUCache : public ShardedCache {
   virtual std::string get_cache_name() const {
     return "CabinDB Binned LRU Cache";
   }
+  virtual uint64_t get_cache_hits() const;
+  virtual uint64_t get_cache_misses() const;
 
  private:
   CephContext *cct;
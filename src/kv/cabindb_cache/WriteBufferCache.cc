@@ -0,0 +1,83 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "WriteBufferCache.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "common/dout.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_cabindb
+#undef dout_prefix
+#define dout_prefix *_dout << "cabindb: "
+
+namespace cabindb_cache {
+
+WriteBufferCache::WriteBufferCache(CephContext *c, size_t _min_size,
+				   size_t _max_size)
+  : cct(c),
+    min_size(std::max<size_t>(_min_size, 1)),
+    max_size(std::max(min_size, _max_size)),
+    // until a PriorityCache::Manager commits a size the memtables may use
+    // the whole budget
+    manager(std::make_shared<cabindb::WriteBufferManager>(max_size))
+{
+}
+
+std::shared_ptr<WriteBufferCache> WriteBufferCache::get_shared(
+  CephContext *c, size_t min_size, size_t max_size)
+{
+  static std::mutex lock;
+  static std::weak_ptr<WriteBufferCache> shared;
+  std::lock_guard l(lock);
+  auto cache = shared.lock();
+  if (!cache) {
+    cache = std::make_shared<WriteBufferCache>(c, min_size, max_size);
+    shared = cache;
+  }
+  return cache;
+}
+
+int64_t WriteBufferCache::request_cache_bytes(
+  PriorityCache::Priority pri, uint64_t total_cache) const
+{
+  int64_t assigned = get_cache_bytes(pri);
+  int64_t used = std::max(manager->memory_usage(), min_size);
+  int64_t request = 0;
+
+  switch (pri) {
+  // memtables in use can only shrink by flushing, so they must be kept
+  case PriorityCache::Priority::PRI0:
+    request = used;
+    break;
+  // room for the active memtables to fill before they are switched
+  case PriorityCache::Priority::PRI1:
+    request = static_cast<int64_t>(max_size) - used;
+    break;
+  default:
+    break;
+  }
+  request = (request > assigned) ? request - assigned : 0;
+  ldout(cct, 10) << __func__ << " Priority: " << static_cast<uint32_t>(pri)
+                 << " Request: " << request << dendl;
+  return request;
+}
+
+int64_t WriteBufferCache::commit_cache_size(uint64_t total_bytes)
+{
+  size_t old_bytes = manager->buffer_size();
+  int64_t new_bytes = PriorityCache::get_chunk(
+      get_cache_bytes(), total_bytes);
+  new_bytes = std::clamp<int64_t>(new_bytes, min_size, max_size);
+  ldout(cct, 10) << __func__ << " old: " << old_bytes
+                 << " new: " << new_bytes
+                 << " usage: " << manager->memory_usage()
+                 << " mutable: " << manager->mutable_memtable_memory_usage()
+                 << dendl;
+  manager->SetBufferSize(new_bytes);
+  return new_bytes;
+}
+
+}  // namespace cabindb_cache
@@ -0,0 +1,83 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#ifndef CABINDB_WRITE_BUFFER_CACHE
+#define CABINDB_WRITE_BUFFER_CACHE
+
+#include <memory>
+#include <string>
+
+#include "cabindb/include/cabindb/write_buffer_manager.h"
+#include "include/common_fwd.h"
+#include "common/PriorityCache.h"
+
+namespace cabindb_cache {
+
+// Presents the memtables of every CabinDB instance of the process as one
+// PriorityCache consumer.  The memory already held by the memtables is
+// requested at PRI0 since it can only be given back by flushing; room to
+// grow up to max_size is requested at PRI1.  Each commit moves the limit of
+// the shared WriteBufferManager, which never stalls writers: when the
+// budget shrinks below the current usage the memtables are just flushed.
+// Its share of the budget is the ratio the owner of the manager sets
+// (bluestore_cache_kv_memtable_ratio); left at 0 the other consumers take
+// everything but the memtables already in use.
+class WriteBufferCache : public PriorityCache::PriCache {
+ public:
+  WriteBufferCache(CephContext *c, size_t min_size, size_t max_size);
+
+  // Returns the cache of the process, creating it on first use.  The sizes
+  // only matter to the call that creates it.
+  static std::shared_ptr<WriteBufferCache> get_shared(
+      CephContext *c, size_t min_size, size_t max_size);
+
+  std::shared_ptr<cabindb::WriteBufferManager> get_write_buffer_manager() const {
+    return manager;
+  }
+
+  // PriorityCache
+  int64_t request_cache_bytes(
+      PriorityCache::Priority pri, uint64_t total_cache) const override;
+  int64_t get_cache_bytes(PriorityCache::Priority pri) const override {
+    return cache_bytes[pri];
+  }
+  int64_t get_cache_bytes() const override {
+    int64_t total = 0;
+    for (int i = 0; i < PriorityCache::Priority::LAST + 1; i++) {
+      PriorityCache::Priority pri = static_cast<PriorityCache::Priority>(i);
+      total += get_cache_bytes(pri);
+    }
+    return total;
+  }
+  void set_cache_bytes(PriorityCache::Priority pri, int64_t bytes) override {
+    cache_bytes[pri] = bytes;
+  }
+  void add_cache_bytes(PriorityCache::Priority pri, int64_t bytes) override {
+    cache_bytes[pri] += bytes;
+  }
+  int64_t commit_cache_size(uint64_t total_cache) override;
+  int64_t get_committed_size() const override {
+    return manager->buffer_size();
+  }
+  double get_cache_ratio() const override {
+    return cache_ratio;
+  }
+  void set_cache_ratio(double ratio) override {
+    cache_ratio = ratio;
+  }
+  std::string get_cache_name() const override {
+    return "CabinDB Write Buffer Cache";
+  }
+
+ private:
+  CephContext *cct;
+  const size_t min_size;
+  const size_t max_size;
+  std::shared_ptr<cabindb::WriteBufferManager> manager;
+  int64_t cache_bytes[PriorityCache::Priority::LAST+1] = {0};
+  double cache_ratio = 0;
+};
+
+}  // namespace cabindb_cache
+
+#endif // CABINDB_WRITE_BUFFER_CACHE
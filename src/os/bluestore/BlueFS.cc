@@ -299,6 +299,19 @@ void BlueFS::_init_logger()
 	    "How many times bluefs read found page with all 0s");
   b.add_u64(l_bluefs_read_zeros_errors, "read_zeros_errors",
 	    "How many times bluefs read found transient page with all 0s");
+  b.add_u64(l_bluefs_spillover_bytes, "spillover_bytes",
+	    "Bytes of DB files kept on slow device", "spil",
+	    PerfCountersBuilder::PRIO_USEFUL, unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluefs_promoted_files, "promoted_files",
+		    "Hot files moved from slow device to DB device");
+  b.add_u64_counter(l_bluefs_promoted_bytes, "promoted_bytes",
+		    "Bytes of hot files moved from slow device to DB device",
+		    NULL, PerfCountersBuilder::PRIO_USEFUL, unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluefs_demoted_files, "demoted_files",
+		    "Cold files moved from DB device to slow device");
+  b.add_u64_counter(l_bluefs_demoted_bytes, "demoted_bytes",
+		    "Bytes of cold files moved from DB device to slow device",
+		    NULL, PerfCountersBuilder::PRIO_USEFUL, unit_t(UNIT_BYTES));
 
   logger = b.create_perf_counters();
   cct->get_perfcounters_collection()->add(logger);
@@ -328,6 +341,7 @@ void BlueFS::_update_logger_stats()
     logger->set(l_bluefs_slow_total_bytes, _get_total(BDEV_SLOW));
     logger->set(l_bluefs_slow_used_bytes, _get_used(BDEV_SLOW));
   }
+  logger->set(l_bluefs_spillover_bytes, vselector->get_spillover());
 }
 
 int BlueFS::add_block_device(unsigned id, const string& path, bool trim,
@@ -815,6 +829,10 @@ int BlueFS::mount()
            << std::hex << log_writer->pos << std::dec
            << dendl;
 
+  if (cct->_conf->bluefs_tiering_interval > 0 &&
+      bdev[BDEV_DB] && bdev[BDEV_SLOW]) {
+    tiering_thread.init();
+  }
   return 0;
 
  out:
@@ -843,6 +861,9 @@ void BlueFS::umount(bool avoid_compact)
 {
   dout(1) << __func__ << dendl;
 
+  if (tiering_thread.is_started()) {
+    tiering_thread.shutdown();
+  }
   sync_metadata(avoid_compact);
 
   _close_writer(log_writer);
@@ -1547,6 +1568,11 @@ int BlueFS::device_migrate_to_existing(
   vector<byte> buf;
   bool buffered = cct->_conf->bluefs_buffered_io;
 
+  // both move extents behind each other's back
+  if (tiering_thread.is_started()) {
+    tiering_thread.shutdown();
+  }
+
   dout(10) << __func__ << " devs_source " << devs_source
 	   << " dev_target " << dev_target << dendl;
   assert(dev_target < (int)MAX_BDEV);
@@ -1690,6 +1716,11 @@ int BlueFS::device_migrate_to_new(
   vector<byte> buf;
   bool buffered = cct->_conf->bluefs_buffered_io;
 
+  // both move extents behind each other's back
+  if (tiering_thread.is_started()) {
+    tiering_thread.shutdown();
+  }
+
   dout(10) << __func__ << " devs_source " << devs_source
 	   << " dev_target " << dev_target << dendl;
   assert(dev_target == (int)BDEV_NEWDB || dev_target == (int)BDEV_NEWWAL);
@@ -1884,12 +1915,14 @@ int64_t BlueFS::_read_random(
   }
   logger->inc(l_bluefs_read_random_count, 1);
   logger->inc(l_bluefs_read_random_bytes, len);
+  ++h->file->num_reads;
 
   std::shared_lock s_lock(h->lock);
   buf->bl.reassign_to_mempool(mempool::mempool_bluefs_file_reader);
   while (len > 0) {
     if (off < buf->bl_off || off >= buf->get_buf_end()) {
       s_lock.unlock();
+      std::shared_lock e_lock(h->file->extents_lock);
       uint64_t x_off = 0;
       auto p = h->file->fnode.seek(off, &x_off);
       ceph_assert(p != h->file->fnode.extents.end());
@@ -1908,6 +1941,7 @@ int64_t BlueFS::_read_random(
 			cct->_conf->bluefs_buffered_io);
       }
       ceph_assert(r == 0);
+      e_lock.unlock();
       off += l;
       len -= l;
       ret += l;
@@ -1979,6 +2013,7 @@ int64_t BlueFS::_read(
   }
   logger->inc(l_bluefs_read_count, 1);
   logger->inc(l_bluefs_read_bytes, len);
+  ++h->file->num_reads;
   if (prefetch) {
     logger->inc(l_bluefs_read_prefetch_count, 1);
     logger->inc(l_bluefs_read_prefetch_bytes, len);
@@ -1999,6 +2034,7 @@ int64_t BlueFS::_read(
         // if precondition hasn't changed during locking upgrade.
         buf->bl.clear();
         buf->bl_off = off & super.block_mask();
+        std::shared_lock e_lock(h->file->extents_lock);
         uint64_t x_off = 0;
         auto p = h->file->fnode.seek(buf->bl_off, &x_off);
 	if (p == h->file->fnode.extents.end()) {
@@ -3024,7 +3060,8 @@ const char* BlueFS::get_device_name(unsigned id)
 }
 
 int BlueFS::_allocate_without_fallback(uint8_t id, uint64_t len,
-		      PExtentVector* extents)
+		      PExtentVector* extents,
+		      bool quiet)
 {
   dout(10) << __func__ << " len 0x" << std::hex << len << std::dec
            << " from " << (int)id << dendl;
@@ -3039,6 +3076,12 @@ int BlueFS::_allocate_without_fallback(uint8_t id, uint64_t len,
     if (alloc_len > 0) {
       alloc[id]->release(*extents);
     }
+    if (quiet) {
+      dout(10) << __func__ << " unable to allocate 0x" << std::hex << need
+	       << " on bdev " << (int)id << std::dec << dendl;
+      extents->clear();
+      return -ENOSPC;
+    }
     derr << __func__ << " unable to allocate 0x" << std::hex << need
 	 << " on bdev " << (int)id
          << ", allocator name " << alloc[id]->get_name()
@@ -3122,6 +3165,232 @@ int BlueFS::_allocate(uint8_t id, uint64_t len,
   return 0;
 }
 
+void *BlueFS::TieringThread::entry()
+{
+  std::unique_lock l{lock};
+  while (!stop) {
+    auto wait = ceph::make_timespan(
+      fs->cct->_conf->bluefs_tiering_interval);
+    cond.wait_for(l, wait);
+    if (stop) {
+      break;
+    }
+    l.unlock();
+    fs->_tiering_pass();
+    l.lock();
+  }
+  return NULL;
+}
+
+void BlueFS::_tiering_pass()
+{
+  const uint64_t hot_reads = cct->_conf->bluefs_tiering_hot_reads;
+  const uint64_t max_bytes = cct->_conf->bluefs_tiering_max_bytes;
+
+  // (file, allocated bytes) of read-only files by placement
+  std::vector<std::pair<FileRef, uint64_t>> to_promote, to_demote;
+  uint64_t db_total, db_free;
+  {
+    std::lock_guard l(lock);
+    void* wal_hint = vselector->get_hint_by_dir("db.wal");
+    for (auto& [ino, f] : file_map) {
+      f->heat = f->heat / 2 + f->num_reads.exchange(0);
+      if (ino == 1 || f->num_writers > 0 || f->fnode.size == 0 ||
+	  f->vselector_hint == wal_hint) {
+	continue;
+      }
+      bool on_slow = false, on_db = true;
+      for (auto& e : f->fnode.extents) {
+	on_slow |= e.bdev == BDEV_SLOW;
+	on_db &= e.bdev == BDEV_DB;
+      }
+      if (f->heat >= hot_reads) {
+	if (on_slow) {
+	  to_promote.emplace_back(f, f->fnode.get_allocated());
+	}
+      } else if (on_db) {
+	to_demote.emplace_back(f, f->fnode.get_allocated());
+      }
+    }
+    db_total = _get_total(BDEV_DB);
+    db_free = db_total - std::min(db_total, _get_used(BDEV_DB));
+  }
+  if (to_promote.empty() && to_demote.empty()) {
+    return;
+  }
+
+  // make room for the hot files too, not only for the free ratio
+  uint64_t db_reserve = db_total * cct->_conf->bluefs_tiering_db_free_ratio;
+  uint64_t want = 0;
+  for (auto& [f, allocated] : to_promote) {
+    want += allocated;
+  }
+  want = db_reserve + std::min(want, max_bytes / 2);
+
+  dout(10) << __func__ << " " << to_promote.size() << " hot files on slow, "
+	   << to_demote.size() << " cold files on db, db free 0x"
+	   << std::hex << db_free << " want 0x" << want << std::dec << dendl;
+
+  uint64_t moved = 0;
+  std::sort(to_demote.begin(), to_demote.end(),
+	    [](auto& a, auto& b) { return a.first->heat < b.first->heat; });
+  for (auto& [f, allocated] : to_demote) {
+    if (db_free >= want || moved >= max_bytes) {
+      break;
+    }
+    int64_t r = _migrate_file(f, BDEV_SLOW);
+    if (r == -ENOSPC) {
+      break;
+    } else if (r < 0) {
+      continue;
+    }
+    db_free += r;
+    moved += r;
+    logger->inc(l_bluefs_demoted_files);
+    logger->inc(l_bluefs_demoted_bytes, r);
+  }
+
+  std::sort(to_promote.begin(), to_promote.end(),
+	    [](auto& a, auto& b) { return a.first->heat > b.first->heat; });
+  for (auto& [f, allocated] : to_promote) {
+    if (moved >= max_bytes) {
+      break;
+    }
+    if (db_free < db_reserve + allocated) {
+      continue;
+    }
+    int64_t r = _migrate_file(f, BDEV_DB);
+    if (r == -ENOSPC) {
+      break;
+    } else if (r < 0) {
+      continue;
+    }
+    db_free -= std::min(db_free, allocated);
+    moved += r;
+    logger->inc(l_bluefs_promoted_files);
+    logger->inc(l_bluefs_promoted_bytes, r);
+  }
+}
+
+int64_t BlueFS::_migrate_file(FileRef f, unsigned dev)
+{
+  // the copy goes through a buffer of at most this many bytes
+  static constexpr uint64_t max_chunk = 1 << 20;
+  bool buffered = cct->_conf->bluefs_buffered_io;
+  mempool::bluefs::vector<bluefs_extent_t> old_extents;
+  uint64_t size;
+  uint64_t generation;
+  PExtentVector extents;
+  {
+    std::lock_guard l(lock);
+    if (f->deleted || f->num_writers > 0) {
+      return -ENOENT;
+    }
+    dout(10) << __func__ << " " << f->fnode << " to " << dev << dendl;
+    old_extents = f->fnode.extents;
+    size = f->fnode.size;
+    generation = f->generation;
+    // a full device is expected here and retried on the next pass
+    if (!alloc[dev] ||
+	alloc[dev]->get_free() < round_up_to(size, alloc_size[dev])) {
+      return -ENOSPC;
+    }
+    int r = _allocate_without_fallback(dev, size, &extents, true);
+    if (r < 0) {
+      return r;
+    }
+  }
+  auto release_new = [&]() {
+    uint64_t len = 0;
+    for (auto& i : extents) {
+      len += i.length;
+    }
+    alloc[dev]->release(extents);
+    if (is_shared_alloc(dev)) {
+      shared_alloc->bluefs_used -= len;
+    }
+  };
+
+  // The file is immutable as long as it has no writer, so it can be
+  // copied without the lock. A file removed or reopened for write
+  // meanwhile may have had its extents reused; that is caught below and
+  // the copy dropped. The data is streamed a chunk at a time, never more
+  // than both the current source and target extent hold.
+  auto src = old_extents.begin();
+  auto dst = extents.begin();
+  uint64_t src_off = 0, dst_off = 0, copied = 0;
+  uint64_t new_len = 0;
+  for (auto& i : extents) {
+    new_len += i.length;
+  }
+  ceph::buffer::ptr bp = ceph::buffer::create_page_aligned(
+    std::min(max_chunk, new_len));
+  while (copied < size &&
+	 src != old_extents.end() && dst != extents.end()) {
+    uint64_t len = std::min({max_chunk,
+			     src->length - src_off,
+			     dst->length - dst_off});
+    int r = bdev[src->bdev]->read_random(src->offset + src_off, len,
+					 bp.c_str(), buffered);
+    if (r != 0) {
+      derr << __func__ << " failed to read 0x" << std::hex
+	   << src->offset + src_off << "~" << len << std::dec
+	   << " from " << (int)src->bdev << dendl;
+      release_new();
+      return -EIO;
+    }
+    bufferlist cur;
+    cur.append(bp, 0, len);
+    r = bdev[dev]->write(dst->offset + dst_off, cur, buffered);
+    ceph_assert(r == 0);
+    copied += len;
+    if ((src_off += len) == src->length) {
+      ++src;
+      src_off = 0;
+    }
+    if ((dst_off += len) == dst->length) {
+      ++dst;
+      dst_off = 0;
+    }
+  }
+  ceph_assert(copied >= size);
+  bdev[dev]->flush();
+
+  std::unique_lock l(lock);
+  bool same = !f->deleted && f->num_writers == 0 &&
+    f->generation == generation && f->fnode.size == size &&
+    std::equal(old_extents.begin(), old_extents.end(),
+	       f->fnode.extents.begin(), f->fnode.extents.end(),
+	       [](auto& a, auto& b) {
+		 return a.bdev == b.bdev && a.offset == b.offset &&
+		   a.length == b.length;
+	       });
+  if (!same) {
+    dout(10) << __func__ << " ino " << f->fnode.ino
+	     << " changed while copying, dropped" << dendl;
+    release_new();
+    return -EAGAIN;
+  }
+
+  bluefs_fnode_t moved;
+  for (auto& i : extents) {
+    moved.append_extent(bluefs_extent_t(dev, i.offset, i.length));
+  }
+  {
+    std::unique_lock e_lock(f->extents_lock);
+    vselector->sub_usage(f->vselector_hint, f->fnode);
+    f->fnode.swap_extents(moved);
+    vselector->add_usage(f->vselector_hint, f->fnode);
+  }
+  // old extents go back to the allocator once the new ones are logged
+  for (auto& e : moved.extents) {
+    pending_release[e.bdev].insert(e.offset, e.length);
+  }
+  log_t.op_file_update(f->fnode);
+  _flush_and_sync_log(l);
+  return moved.get_allocated();
+}
+
 int BlueFS::_preallocate(FileRef f, uint64_t off, uint64_t len)
 {
   dout(10) << __func__ << " file " << f->fnode << " 0x"
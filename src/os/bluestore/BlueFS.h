@@ -11,6 +11,7 @@
 #include "blk/BlockDevice.h"
 
 #include "common/RefCountedObj.h"
+#include "common/Thread.h"
 #include "common/ceph_context.h"
 #include "global/global_context.h"
 #include "include/common_fwd.h"
@@ -52,6 +53,11 @@ enum {
   l_bluefs_read_prefetch_bytes,
   l_bluefs_read_zeros_candidate,
   l_bluefs_read_zeros_errors,
+  l_bluefs_spillover_bytes,
+  l_bluefs_promoted_files,
+  l_bluefs_promoted_bytes,
+  l_bluefs_demoted_files,
+  l_bluefs_demoted_bytes,
 
   l_bluefs_last,
 };
@@ -72,6 +78,11 @@ public:
   virtual uint8_t select_prefer_bdev(void* hint) = 0;
   virtual void get_paths(const std::string& base, paths& res) const = 0;
   virtual void dump(std::ostream& sout) = 0;
+
+  // bytes of files meant for the DB volume which are kept on the slow one
+  virtual uint64_t get_spillover() const {
+    return 0;
+  }
 };
 
 struct bluefs_shared_alloc_context_t {
@@ -118,9 +129,18 @@ public:
 
     std::atomic_int num_readers, num_writers;
     std::atomic_int num_reading;
+    std::atomic<uint64_t> num_reads;  ///< reads since the last tiering pass
+    std::atomic<uint64_t> generation; ///< bumped by every writer opened
+    uint64_t heat = 0;                ///< decayed num_reads, tiering thread only
 
     void* vselector_hint = nullptr;
 
+    // held shared while reading through fnode.extents, exclusive while
+    // the tiering thread moves the file to other extents
+    ceph::shared_mutex extents_lock {
+     ceph::make_shared_mutex(std::string(), false, false, false)
+    };
+
   private:
     FRIEND_MAKE_REF(File);
     File()
@@ -132,6 +152,8 @@ public:
 	num_readers(0),
 	num_writers(0),
 	num_reading(0),
+	num_reads(0),
+	generation(0),
         vselector_hint(nullptr)
       {}
     ~File() override {
@@ -192,6 +214,7 @@ public:
        buffer_appender(buffer.get_page_aligned_appender(
                          g_conf()->bluefs_alloc_size / CEPH_PAGE_SIZE)) {
       ++file->num_writers;
+      ++file->generation;
       iocv.fill(nullptr);
       dirty_devs.fill(false);
       if (file->fnode.ino == 1) {
@@ -356,6 +379,30 @@ private:
 
   class SocketHook;
   SocketHook* asok_hook = nullptr;
+
+  // moves files between BDEV_DB and BDEV_SLOW by how often they are read
+  struct TieringThread : public Thread {
+    BlueFS *fs;
+    ceph::condition_variable cond;
+    ceph::mutex lock = ceph::make_mutex("BlueFS::TieringThread::lock");
+    bool stop = false;
+
+    explicit TieringThread(BlueFS *fs) : fs(fs) {}
+    void *entry() override;
+    void init() {
+      ceph_assert(stop == false);
+      create("bluefs_tiering");
+    }
+    void shutdown() {
+      lock.lock();
+      stop = true;
+      cond.notify_all();
+      lock.unlock();
+      join();
+      stop = false;
+    }
+  } tiering_thread{this};
+
   // used to trigger zeros into read (debug / verify)
   std::atomic<uint64_t> inject_read_zeros{0};
 
@@ -382,7 +429,11 @@ private:
   int _allocate(uint8_t bdev, uint64_t len,
 		bluefs_fnode_t* node);
   int _allocate_without_fallback(uint8_t id, uint64_t len,
-				 PExtentVector* extents);
+				 PExtentVector* extents,
+				 bool quiet = false);
+
+  void _tiering_pass();
+  int64_t _migrate_file(FileRef f, unsigned dev);
 
   int _flush_range(FileWriter *h, uint64_t offset, uint64_t length);
   int _flush(FileWriter *h, bool force, std::unique_lock<ceph::mutex>& l);
@@ -541,6 +592,11 @@ public:
 
   void compact_log();
 
+  /// move files between DB and slow devices now, as the tiering thread does
+  void tiering_pass() {
+    _tiering_pass();
+  }
+
   /// sync any uncommitted state to disk
   void sync_metadata(bool avoid_compact);
   /// test and compact log, if necessary
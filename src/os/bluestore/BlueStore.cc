@@ -39,6 +39,7 @@
 #include "FreelistManager.h"
 #include "BlueFS.h"
 #include "BlueRocksEnv.h"
+#include "BlueCabinEnv.h"
 #include "auth/Crypto.h"
 #include "common/EventTrace.h"
 #include "perfglue/heap_profiler.h"
@@ -847,6 +848,74 @@ private:
   }
 };
 
+/// options string of the kv backend, with its annex appended
+string kv_backend_options(CephContext *cct, const string& kv_backend)
+{
+  bool cabin = kv_backend == "cabindb";
+  string options = cabin ? cct->_conf->bluestore_cabindb_options :
+    cct->_conf->bluestore_rocksdb_options;
+  const string& options_annex = cabin ?
+    cct->_conf->bluestore_cabindb_options_annex :
+    cct->_conf->bluestore_rocksdb_options_annex;
+  if (!options_annex.empty()) {
+    if (!options.empty() &&
+      *options.rbegin() != ',') {
+      options += ',';
+    }
+    options += options_annex;
+  }
+  return options;
+}
+
+/// bluefs backed Env of the kv backend.  rocksdb and cabindb have
+/// separate Env hierarchies, so only the one of the backend is set.
+class BlueFSKVEnv {
+  rocksdb::Env *rocks_env = nullptr;
+  cabindb::Env *cabin_env = nullptr;
+
+public:
+  BlueFSKVEnv(BlueFS *bluefs, const string& kv_backend, bool mirror) {
+    if (kv_backend == "cabindb") {
+      cabin_env = new BlueCabinEnv(bluefs);
+      if (mirror) {
+	cabin_env = new cabindb::EnvMirror(cabindb::Env::Default(), cabin_env,
+					   false, true);
+      }
+    } else {
+      rocks_env = new BlueRocksEnv(bluefs);
+      if (mirror) {
+	rocks_env = new rocksdb::EnvMirror(rocksdb::Env::Default(), rocks_env,
+					   false, true);
+      }
+    }
+  }
+
+  void create_dir(const string& dir) {
+    if (cabin_env) {
+      cabin_env->CreateDir(dir);
+    } else {
+      rocks_env->CreateDir(dir);
+    }
+  }
+  bool dir_missing(const string& dir) {
+    std::vector<std::string> res;
+    return cabin_env ? cabin_env->GetChildren(dir, &res).IsNotFound() :
+      rocks_env->GetChildren(dir, &res).IsNotFound();
+  }
+  /// the opaque env argument of KeyValueDB::create
+  void *get() {
+    return cabin_env ? static_cast<void*>(cabin_env) :
+      static_cast<void*>(rocks_env);
+  }
+  /// only needed when no KeyValueDB took ownership of the env
+  void destroy() {
+    delete rocks_env;
+    rocks_env = nullptr;
+    delete cabin_env;
+    cabin_env = nullptr;
+  }
+};
+
 } // anonymous namespace
 
 // Garbage Collector
@@ -4121,6 +4190,9 @@ void *BlueStore::MempoolThread::entry()
 
   binned_kv_cache = store->db->get_priority_cache();
   binned_kv_onode_cache = store->db->get_priority_cache(PREFIX_OBJ);
+  binned_kv_cf_caches = store->db->get_priority_caches();
+  binned_kv_cf_caches.erase(PREFIX_OBJ);
+  kv_write_buffer_cache = store->db->get_write_buffer_cache();
   if (store->cache_autotune && binned_kv_cache != nullptr) {
     pcm = std::make_shared<PriorityCache::Manager>(
         store->cct, min, max, target, true, "bluestore-pricache");
@@ -4130,6 +4202,12 @@ void *BlueStore::MempoolThread::entry()
     if (binned_kv_onode_cache != nullptr) {
       pcm->insert("kv_onode", binned_kv_onode_cache, true);
     }
+    for (auto& [prefix, cache] : binned_kv_cf_caches) {
+      pcm->insert("kv_" + prefix, cache, true);
+    }
+    if (kv_write_buffer_cache != nullptr) {
+      pcm->insert("kv_memtable", kv_write_buffer_cache, true);
+    }
   }
 
   utime_t next_balance = ceph_clock_now();
@@ -4203,17 +4281,30 @@ void *BlueStore::MempoolThread::entry()
   store->_record_allocation_stats();
   stop = false;
   pcm = nullptr;
+  binned_kv_cf_caches.clear();
+  kv_balancer.clear();
+  kv_write_buffer_cache = nullptr;
   return NULL;
 }
 
 void BlueStore::MempoolThread::_adjust_cache_settings()
 {
-  if (binned_kv_cache != nullptr) {
+  if (binned_kv_cache != nullptr && binned_kv_cf_caches.empty()) {
     binned_kv_cache->set_cache_ratio(store->cache_kv_ratio);
+  } else if (binned_kv_cache != nullptr) {
+    std::map<std::string, std::shared_ptr<PriorityCache::PriCache>> kv_caches;
+    kv_caches["kv"] = binned_kv_cache;
+    for (auto& [prefix, cache] : binned_kv_cf_caches) {
+      kv_caches["kv_" + prefix] = cache;
+    }
+    kv_balancer.balance(store->cache_kv_ratio, kv_caches);
   }
   if (binned_kv_onode_cache != nullptr) {
     binned_kv_onode_cache->set_cache_ratio(store->cache_kv_onode_ratio);
   }
+  if (kv_write_buffer_cache != nullptr) {
+    kv_write_buffer_cache->set_cache_ratio(store->cache_kv_memtable_ratio);
+  }
   meta_cache->set_cache_ratio(store->cache_meta_ratio);
   data_cache->set_cache_ratio(store->cache_data_ratio);
 }
@@ -4257,6 +4348,21 @@ void BlueStore::MempoolThread::_resize_shards(bool interval_stats)
                   << " meta_used: " << meta_used
                   << " data_alloc: " << data_alloc
                   << " data_used: " << data_used << dendl;
+    for (auto& [prefix, cache] : binned_kv_cf_caches) {
+      uint64_t hits = cache->get_cache_hits();
+      uint64_t misses = cache->get_cache_misses();
+      dout(5) << __func__ << " kv_" << prefix
+	      << " alloc: " << cache->get_committed_size()
+	      << " ratio: " << cache->get_cache_ratio()
+	      << " hit_rate: "
+	      << (hits + misses ? (double)hits / (hits + misses) : 0.0)
+	      << dendl;
+    }
+    if (kv_write_buffer_cache != nullptr) {
+      dout(5) << __func__ << " kv_memtable"
+	      << " alloc: " << kv_write_buffer_cache->get_committed_size()
+	      << dendl;
+    }
   } else {
     dout(20) << __func__  << " cache_size: " << cache_size
                    << " kv_alloc: " << kv_alloc
@@ -4805,6 +4911,20 @@ int BlueStore::_set_cache_sizes()
     return -EINVAL;
   }
 
+  // the memtables only compete for the cache when the autotuner balances
+  // them against it
+  cache_kv_memtable_ratio = 0;
+  if (cache_autotune &&
+      cct->_conf.get_val<Option::size_t>("cabindb_write_buffer_limit") > 0) {
+    cache_kv_memtable_ratio =
+      cct->_conf.get_val<double>("bluestore_cache_kv_memtable_ratio");
+    if (cache_kv_memtable_ratio < 0 || cache_kv_memtable_ratio > 1.0) {
+      derr << __func__ << " bluestore_cache_kv_memtable_ratio ("
+	   << cache_kv_memtable_ratio << ") must be in range [0,1.0]" << dendl;
+      return -EINVAL;
+    }
+  }
+
   if (cache_meta_ratio + cache_kv_ratio > 1.0) {
     derr << __func__ << " bluestore_cache_meta_ratio (" << cache_meta_ratio
          << ") + bluestore_cache_kv_ratio (" << cache_kv_ratio
@@ -4816,7 +4936,8 @@ int BlueStore::_set_cache_sizes()
   cache_data_ratio = (double)1.0 - 
                      (double)cache_meta_ratio - 
                      (double)cache_kv_ratio - 
-                     (double)cache_kv_onode_ratio;
+                     (double)cache_kv_onode_ratio -
+                     (double)cache_kv_memtable_ratio;
   if (cache_data_ratio < 0) {
     // deal with floating point imprecision
     cache_data_ratio = 0;
@@ -4825,6 +4946,7 @@ int BlueStore::_set_cache_sizes()
   dout(1) << __func__ << " cache_size " << cache_size
           << " meta " << cache_meta_ratio
 	  << " kv " << cache_kv_ratio
+	  << " kv_memtable " << cache_kv_memtable_ratio
 	  << " data " << cache_data_ratio
 	  << dendl;
   return 0;
@@ -5759,7 +5881,8 @@ free_bluefs:
   return r;
 }
 
-int BlueStore::_open_bluefs(bool create, bool read_only)
+int BlueStore::_open_bluefs(bool create, bool read_only,
+			    const std::string& kv_backend)
 {
   int r = _minimal_open_bluefs(create);
   if (r < 0) {
@@ -5768,24 +5891,35 @@ int BlueStore::_open_bluefs(bool create, bool read_only)
   BlueFSVolumeSelector* vselector = nullptr;
   if (bluefs_layout.shared_bdev == BlueFS::BDEV_SLOW) {
 
-    string options = cct->_conf->bluestore_rocksdb_options;
-    string options_annex = cct->_conf->bluestore_rocksdb_options_annex;
-    if (!options_annex.empty()) {
-      if (!options.empty() &&
-        *options.rbegin() != ',') {
-        options += ',';
+    string options = kv_backend_options(cct, kv_backend);
+
+    // only the level sizing is needed to place files on WAL/DB/slow
+    uint64_t max_bytes_for_level_base;
+    double max_bytes_for_level_multiplier;
+    if (kv_backend == "cabindb") {
+      cabindb::Options cabin_opts;
+      r = CabinDBStore::ParseOptionsFromStringStatic(
+	cct,
+	options,
+	cabin_opts,
+	nullptr);
+      if (r < 0) {
+	return r;
       }
-      options += options_annex;
-    }
-
-    rocksdb::Options rocks_opts;
-    r = RocksDBStore::ParseOptionsFromStringStatic(
-      cct,
-      options,
-      rocks_opts,
-      nullptr);
-    if (r < 0) {
-      return r;
+      max_bytes_for_level_base = cabin_opts.max_bytes_for_level_base;
+      max_bytes_for_level_multiplier = cabin_opts.max_bytes_for_level_multiplier;
+    } else {
+      rocksdb::Options rocks_opts;
+      r = RocksDBStore::ParseOptionsFromStringStatic(
+	cct,
+	options,
+	rocks_opts,
+	nullptr);
+      if (r < 0) {
+	return r;
+      }
+      max_bytes_for_level_base = rocks_opts.max_bytes_for_level_base;
+      max_bytes_for_level_multiplier = rocks_opts.max_bytes_for_level_multiplier;
     }
     if (cct->_conf->bluestore_volume_selection_policy == "fit_to_fast") {
       vselector = new FitToFastVolumeSelector(
@@ -5800,8 +5934,8 @@ int BlueStore::_open_bluefs(bool create, bool read_only)
           bluefs->get_block_device_size(BlueFS::BDEV_DB) * 95 / 100,
           bluefs->get_block_device_size(BlueFS::BDEV_SLOW) * 95 / 100,
           1024 * 1024 * 1024, //FIXME: set expected l0 size here
-          rocks_opts.max_bytes_for_level_base,
-          rocks_opts.max_bytes_for_level_multiplier,
+          max_bytes_for_level_base,
+          max_bytes_for_level_multiplier,
           reserved_factor,
           cct->_conf->bluestore_volume_selection_reserved,
           cct->_conf->bluestore_volume_selection_policy == "use_some_extra");
@@ -6004,22 +6138,20 @@ int BlueStore::_prepare_db_environment(bool create, bool read_only,
   map<string,string> kv_options;
   // force separate wal dir for all new deployments.
   kv_options["separate_wal_dir"] = 1;
-  rocksdb::Env *env = NULL;
+  std::optional<BlueFSKVEnv> env;
   if (do_bluefs) {
     dout(10) << __func__ << " initializing bluefs" << dendl;
-    if (kv_backend != "rocksdb") {
-      derr << " backend must be rocksdb to use bluefs" << dendl;
+    if (kv_backend != "rocksdb" && kv_backend != "cabindb") {
+      derr << " backend must be rocksdb or cabindb to use bluefs" << dendl;
       return -EINVAL;
     }
 
-    r = _open_bluefs(create, read_only);
+    r = _open_bluefs(create, read_only, kv_backend);
     if (r < 0) {
       return r;
     }
 
     if (cct->_conf->bluestore_bluefs_env_mirror) {
-      rocksdb::Env* a = new BlueRocksEnv(bluefs);
-      rocksdb::Env* b = rocksdb::Env::Default();
       if (create) {
         string cmd = "rm -rf " + path + "/db " +
           path + "/db.slow " +
@@ -6027,9 +6159,9 @@ int BlueStore::_prepare_db_environment(bool create, bool read_only,
         int r = system(cmd.c_str());
         (void)r;
       }
-      env = new rocksdb::EnvMirror(b, a, false, true);
+      env.emplace(bluefs, kv_backend, true);
     } else {
-      env = new BlueRocksEnv(bluefs);
+      env.emplace(bluefs, kv_backend, false);
 
       // simplify the dir names, too, as "seen" by rocksdb
       fn = "db";
@@ -6056,15 +6188,13 @@ int BlueStore::_prepare_db_environment(bool create, bool read_only,
 
     if (create) {
       for (auto& p : paths) {
-        env->CreateDir(p.first);
+	env->create_dir(p.first);
       }
       // Selectors don't provide wal path so far hence create explicitly
-      env->CreateDir(fn + ".wal");
+      env->create_dir(fn + ".wal");
     } else {
-      std::vector<std::string> res;
       // check for dir presence
-      auto r = env->GetChildren(fn+".wal", &res);
-      if (r.IsNotFound()) {
+      if (env->dir_missing(fn + ".wal")) {
 	kv_options.erase("separate_wal_dir");
       }
     }
@@ -6105,7 +6235,7 @@ int BlueStore::_prepare_db_environment(bool create, bool read_only,
 			  kv_backend,
 			  fn,
 			  kv_options,
-			  static_cast<void*>(env));
+			  env ? env->get() : nullptr);
   if (!db) {
     derr << __func__ << " error creating db" << dendl;
     if (bluefs) {
@@ -6113,8 +6243,9 @@ int BlueStore::_prepare_db_environment(bool create, bool read_only,
     }
     // delete env manually here since we can't depend on db to do this
     // under this case
-    delete env;
-    env = NULL;
+    if (env) {
+      env->destroy();
+    }
     return -EIO;
   }
 
@@ -6129,7 +6260,6 @@ int BlueStore::_open_db(bool create, bool to_repair_db, bool read_only)
   int r;
   ceph_assert(!(create && read_only));
   string options;
-  string options_annex;
   stringstream err;
   string kv_dir_fn;
   string kv_backend;
@@ -6140,19 +6270,15 @@ int BlueStore::_open_db(bool create, bool to_repair_db, bool read_only)
     return -EIO;
   }
   if (kv_backend == "rocksdb") {
-    options = cct->_conf->bluestore_rocksdb_options;
-    options_annex = cct->_conf->bluestore_rocksdb_options_annex;
-    if (!options_annex.empty()) {
-      if (!options.empty() &&
-        *options.rbegin() != ',') {
-        options += ',';
-      }
-      options += options_annex;
-    }
-
+    options = kv_backend_options(cct, kv_backend);
     if (cct->_conf.get_val<bool>("bluestore_rocksdb_cf")) {
       sharding_def = cct->_conf.get_val<std::string>("bluestore_rocksdb_cfs");
     }
+  } else if (kv_backend == "cabindb") {
+    options = kv_backend_options(cct, kv_backend);
+    if (cct->_conf.get_val<bool>("bluestore_cabindb_cf")) {
+      sharding_def = cct->_conf.get_val<std::string>("bluestore_cabindb_cfs");
+    }
   }
 
   db->init(options);
@@ -10871,14 +10997,23 @@ int BlueStore::omap_get_values(
     const string& prefix = o->get_omap_prefix();
     o->get_omap_key(string(), &final_key);
     size_t base_key_len = final_key.size();
+    // look every key up in one batch so the kv store can use MultiGet
+    vector<string> final_keys;
+    final_keys.reserve(keys.size());
     for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p) {
       final_key.resize(base_key_len); // keep prefix
       final_key += *p;
-      bufferlist val;
-      if (db->get(prefix, final_key, &val) >= 0) {
-	dout(30) << __func__ << "  got " << pretty_binary_string(final_key)
+      final_keys.push_back(final_key);
+    }
+    vector<bufferlist> vals;
+    vector<int> rs;
+    db->get_many(prefix, final_keys, &vals, &rs);
+    size_t i = 0;
+    for (set<string>::const_iterator p = keys.begin(); p != keys.end(); ++p, ++i) {
+      if (rs[i] >= 0) {
+	dout(30) << __func__ << "  got " << pretty_binary_string(final_keys[i])
 		 << " -> " << *p << dendl;
-	out->insert(make_pair(*p, val));
+	out->insert(make_pair(*p, std::move(vals[i])));
       }
     }
   }
@@ -2163,6 +2163,7 @@ private:
   double cache_meta_ratio = 0;   ///< cache ratio dedicated to metadata
   double cache_kv_ratio = 0;     ///< cache ratio dedicated to kv (e.g., rocksdb)
   double cache_kv_onode_ratio = 0; ///< cache ratio dedicated to kv onodes (e.g., rocksdb onode CF)
+  double cache_kv_memtable_ratio = 0; ///< cache ratio dedicated to kv memtables
   double cache_data_ratio = 0;   ///< cache ratio dedicated to object data
   bool cache_autotune = false;   ///< cache autotune setting
   double cache_autotune_interval = 0; ///< time to wait between cache rebalancing
@@ -2191,6 +2192,12 @@ private:
     bool stop = false;
     std::shared_ptr<PriorityCache::PriCache> binned_kv_cache = nullptr;
     std::shared_ptr<PriorityCache::PriCache> binned_kv_onode_cache = nullptr;
+    /// column family caches other than kv_onode, by prefix
+    std::map<std::string, std::shared_ptr<PriorityCache::PriCache>> binned_kv_cf_caches;
+    /// memtables of the kv store, if it charges them to the cache budget
+    std::shared_ptr<PriorityCache::PriCache> kv_write_buffer_cache = nullptr;
+    /// splits the kv ratio between the shared and the column family caches
+    PriorityCache::HitRatioBalancer kv_balancer;
     std::shared_ptr<PriorityCache::Manager> pcm = nullptr;
 
     struct MempoolCache : public PriorityCache::PriCache {
@@ -2360,7 +2367,7 @@ private:
 
   int _minimal_open_bluefs(bool create);
   void _minimal_close_bluefs();
-  int _open_bluefs(bool create, bool read_only);
+  int _open_bluefs(bool create, bool read_only, const std::string& kv_backend);
   void _close_bluefs(bool cold_close);
 
   int _is_bluefs(bool create, bool* ret);
@@ -3712,6 +3719,12 @@ class RocksDBBlueFSVolumeSelector : public BlueFSVolumeSelector
 
       return values[x][y];
     }
+    const T& at(size_t x, size_t y) const {
+      ceph_assert(x < MaxX);
+      ceph_assert(y < MaxY);
+
+      return values[x][y];
+    }
     size_t get_max_x() const {
       return MaxX;
     }
@@ -3888,6 +3901,10 @@ public:
     BlueFSVolumeSelector::paths& res) const override;
 
   void dump(std::ostream& sout) override;
+
+  uint64_t get_spillover() const override {
+    return per_level_per_dev_usage.at(BlueFS::BDEV_SLOW, LEVEL_DB - LEVEL_FIRST);
+  }
 };
 
 #endif
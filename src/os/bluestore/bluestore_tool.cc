@@ -61,8 +61,8 @@ void validate_path(CephContext *cct, const string& path, bool bluefs)
     cerr << "failed to load kv_backend: " << cpp_strerror(r) << std::endl;
     exit(EXIT_FAILURE);
   }
-  if (kv_backend != "rocksdb") {
-    cerr << "expect kv_backend to be rocksdb, but is " << kv_backend
+  if (kv_backend != "rocksdb" && kv_backend != "cabindb") {
+    cerr << "expect kv_backend to be rocksdb or cabindb, but is " << kv_backend
          << std::endl;
     exit(EXIT_FAILURE);
   }
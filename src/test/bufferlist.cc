@@ -638,6 +638,37 @@ TEST(BufferPtr, zero) {
   EXPECT_EQ('\0', ptr[0]);
 }
 
+TEST(BufferPtr, readonly) {
+  struct raw_readonly : public buffer::raw {
+    raw_readonly(char *c, unsigned l) : raw(c, l) {
+      readonly = true;
+    }
+    raw* clone_empty() override {
+      return buffer::create(len).release();
+    }
+  };
+  char str[] = "XXXX";
+  bufferptr ptr(ceph::unique_leakable_ptr<buffer::raw>(
+    new raw_readonly(str, strlen(str))));
+  bufferptr shared(ptr, 1, 2);
+  // writers get a copy, other ptrs keep seeing the owner's memory
+  ptr.copy_in(0, 1, "A");
+  EXPECT_EQ('A', ptr[0]);
+  EXPECT_EQ('X', str[0]);
+  EXPECT_FALSE(ptr.raw_c_str() == str);
+  shared.zero(0, 1);
+  EXPECT_EQ('\0', shared[0]);
+  EXPECT_EQ('X', str[1]);
+  EXPECT_EQ(1u, shared.offset());
+  EXPECT_EQ(2u, shared.length());
+  bufferlist bl;
+  bl.append(bufferptr(ceph::unique_leakable_ptr<buffer::raw>(
+    new raw_readonly(str, strlen(str)))));
+  bl.zero();
+  EXPECT_TRUE(bl.is_zero());
+  EXPECT_EQ(std::string("XXXX"), str);
+}
+
 TEST(BufferPtr, ostream) {
   {
     bufferptr ptr;
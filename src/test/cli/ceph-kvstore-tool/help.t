@@ -1,5 +1,5 @@
   $ ceph-kvstore-tool --help
-  Usage: ceph-kvstore-tool <leveldb|rocksdb|bluestore-kv> <store path> command [args...]
+  Usage: ceph-kvstore-tool <leveldb|rocksdb|cabindb|bluestore-kv> <store path> command [args...]
   
   Commands:
     list [prefix]
@@ -19,5 +19,8 @@
     compact-range <prefix> <start> <end>
     destructive-repair  (use only as last resort! may corrupt healthy data)
     stats
-    histogram [prefix]
+    histogram [prefix] [threads]
+    compaction-worker <socket>  (cabindb only; store stays open elsewhere)
+    reshard <sharding> [--online]  (cabindb only; --online moves keys
+                                    with the store open)
   
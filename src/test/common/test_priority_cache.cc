@@ -0,0 +1,113 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "gtest/gtest.h"
+#include "common/PriorityCache.h"
+
+namespace {
+
+struct FakeCache : public PriorityCache::PriCache {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  double ratio = 0;
+
+  int64_t request_cache_bytes(PriorityCache::Priority pri,
+			      uint64_t total_cache) const override {
+    return 0;
+  }
+  int64_t get_cache_bytes(PriorityCache::Priority pri) const override {
+    return 0;
+  }
+  int64_t get_cache_bytes() const override {
+    return 0;
+  }
+  void set_cache_bytes(PriorityCache::Priority pri, int64_t bytes) override {}
+  void add_cache_bytes(PriorityCache::Priority pri, int64_t bytes) override {}
+  int64_t commit_cache_size(uint64_t total_cache) override {
+    return 0;
+  }
+  int64_t get_committed_size() const override {
+    return 0;
+  }
+  double get_cache_ratio() const override {
+    return ratio;
+  }
+  void set_cache_ratio(double r) override {
+    ratio = r;
+  }
+  std::string get_cache_name() const override {
+    return "fake";
+  }
+  uint64_t get_cache_hits() const override {
+    return hits;
+  }
+  uint64_t get_cache_misses() const override {
+    return misses;
+  }
+};
+
+} // anonymous namespace
+
+TEST(HitRatioBalancer, equal_without_lookups)
+{
+  auto a = std::make_shared<FakeCache>();
+  auto b = std::make_shared<FakeCache>();
+  PriorityCache::HitRatioBalancer balancer;
+  balancer.balance(0.4, {{"a", a}, {"b", b}});
+  ASSERT_DOUBLE_EQ(0.2, a->ratio);
+  ASSERT_DOUBLE_EQ(0.2, b->ratio);
+}
+
+TEST(HitRatioBalancer, by_ratio_not_volume)
+{
+  auto a = std::make_shared<FakeCache>();
+  auto b = std::make_shared<FakeCache>();
+  PriorityCache::HitRatioBalancer balancer;
+
+  // a serves 100 times the lookups of b at a lower hit ratio
+  a->hits = 3000;
+  a->misses = 7000;
+  b->hits = 90;
+  b->misses = 10;
+  balancer.balance(0.6, {{"a", a}, {"b", b}});
+  ASSERT_DOUBLE_EQ(0.6 * 0.3 / 1.2, a->ratio);
+  ASSERT_DOUBLE_EQ(0.6 * 0.9 / 1.2, b->ratio);
+
+  // only the lookups since the last split count
+  a->hits += 900;
+  a->misses += 100;
+  b->hits += 30;
+  b->misses += 70;
+  balancer.balance(0.6, {{"a", a}, {"b", b}});
+  ASSERT_DOUBLE_EQ(0.6 * 0.9 / 1.2, a->ratio);
+  ASSERT_DOUBLE_EQ(0.6 * 0.3 / 1.2, b->ratio);
+}
+
+TEST(HitRatioBalancer, idle_keeps_weight_and_floor)
+{
+  auto a = std::make_shared<FakeCache>();
+  auto b = std::make_shared<FakeCache>();
+  PriorityCache::HitRatioBalancer balancer(0.1);
+
+  // b only misses, it keeps the floor weight
+  a->hits = 50;
+  a->misses = 50;
+  b->misses = 100;
+  balancer.balance(1.0, {{"a", a}, {"b", b}});
+  ASSERT_DOUBLE_EQ(0.5 / 0.6, a->ratio);
+  ASSERT_DOUBLE_EQ(0.1 / 0.6, b->ratio);
+
+  // a sees no lookups, so only b's weight changes
+  b->hits = 100;
+  b->misses = 200;
+  balancer.balance(1.0, {{"a", a}, {"b", b}});
+  ASSERT_DOUBLE_EQ(0.5, a->ratio);
+  ASSERT_DOUBLE_EQ(0.5, b->ratio);
+
+  // a recreated cache restarts its counters
+  a->hits = 1;
+  a->misses = 3;
+  balancer.balance(1.0, {{"a", a}, {"b", b}});
+  ASSERT_DOUBLE_EQ(0.25 / 0.75, a->ratio);
+  ASSERT_DOUBLE_EQ(0.5 / 0.75, b->ratio);
+}
@@ -6697,6 +6697,20 @@ TEST_P(StoreTestSpecificAUSize, TooManyBlobsTest) {
   doMany4KWritesTest(store.get(), 1, 1000, max_object, 4*1024, 0);
 }
 
+TEST_P(StoreTestSpecificAUSize, CabinDBBackendTest) {
+  if (string(GetParam()) != "bluestore")
+    return;
+  // the kv store runs on bluefs through BlueCabinEnv
+  SetVal(g_conf(), "bluestore_kvbackend", "cabindb");
+  StartDeferred(0x10000);
+  const unsigned max_object = 4*1024*1024;
+  doMany4KWritesTest(store.get(), 1, 1000, max_object, 4*1024, 0);
+
+  store->umount();
+  ASSERT_EQ(0, store->fsck(false));
+  ASSERT_EQ(0, store->mount());
+}
+
 #if defined(WITH_BLUESTORE)
 void get_mempool_stats(uint64_t* total_bytes, uint64_t* total_items)
 {
@@ -18,6 +18,8 @@
 #include <gtest/gtest.h>
 
 #include "os/bluestore/BlueFS.h"
+#include "os/bluestore/BlueCabinEnv.h"
+#include "kv/KeyValueDB.h"
 
 std::unique_ptr<char[]> gen_buffer(uint64_t size)
 {
@@ -760,6 +762,246 @@ TEST(BlueFS, test_replay_growth) {
   fs.umount();
 }
 
+TEST(BlueFS, test_tiering) {
+  uint64_t size = 1048576 * 128;
+  TempBdev bdev_db{size};
+  TempBdev bdev_slow{size};
+
+  // no tiering thread, the passes are run by hand below
+  ConfSaver conf(g_ceph_context->_conf);
+  conf.SetVal("bluefs_tiering_interval", "0");
+  conf.SetVal("bluefs_tiering_hot_reads", "4");
+  conf.ApplyChanges();
+
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev_db.path, false, 1048576));
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_SLOW, bdev_slow.path, false, 0));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_SLOW, true, false }));
+  ASSERT_EQ(0, fs.mount());
+
+  // db.slow files are placed on the slow device
+  uint64_t len = 4 * 1048576;
+  auto data = gen_buffer(len);
+  {
+    BlueFS::FileWriter *h;
+    ASSERT_EQ(0, fs.mkdir("db.slow"));
+    ASSERT_EQ(0, fs.open_for_write("db.slow", "file", &h, false));
+    h->append(data.get(), len);
+    fs.fsync(h);
+    fs.close_writer(h);
+  }
+  uint64_t slow_used = fs.get_used(BlueFS::BDEV_SLOW);
+  ASSERT_GE(slow_used, len);
+
+  // too few reads leave it where it is
+  BlueFS::FileReader *h;
+  ASSERT_EQ(0, fs.open_for_read("db.slow", "file", &h));
+  auto out = std::make_unique<char[]>(len);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ((int)len, fs.read_random(h, 0, len, out.get()));
+  }
+  fs.tiering_pass();
+  ASSERT_EQ(slow_used, fs.get_used(BlueFS::BDEV_SLOW));
+
+  // the heat of the last pass halves, four more reads make it hot
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ((int)len, fs.read_random(h, 0, len, out.get()));
+  }
+  fs.tiering_pass();
+  ASSERT_LE(fs.get_used(BlueFS::BDEV_SLOW) + len, slow_used);
+  delete h;
+  fs.umount();
+
+  // the new extents are logged and hold the same data
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.open_for_read("db.slow", "file", &h));
+  bufferlist bl;
+  ASSERT_EQ((int)len, fs.read(h, 0, len, &bl, NULL));
+  ASSERT_EQ(0, memcmp(data.get(), bl.c_str(), len));
+  delete h;
+  fs.umount();
+}
+
+TEST(BlueFS, test_tiering_demote) {
+  uint64_t size = 1048576 * 128;
+  TempBdev bdev_db{size};
+  TempBdev bdev_slow{size};
+
+  // the db device wants most of itself free, so cold files must leave it
+  ConfSaver conf(g_ceph_context->_conf);
+  conf.SetVal("bluefs_tiering_interval", "0");
+  conf.SetVal("bluefs_tiering_hot_reads", "4");
+  conf.SetVal("bluefs_tiering_db_free_ratio", "0.9");
+  conf.ApplyChanges();
+
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev_db.path, false, 1048576));
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_SLOW, bdev_slow.path, false, 0));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_SLOW, true, false }));
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.mkdir("db"));
+
+  // the cold file spans many copy chunks and ends mid block
+  uint64_t cold_len = 16 * 1048576 + 12345;
+  uint64_t hot_len = 4 * 1048576;
+  auto cold = gen_buffer(cold_len);
+  auto hot = gen_buffer(hot_len);
+  for (auto& [name, data, len] : {std::tuple{"cold", cold.get(), cold_len},
+				  std::tuple{"hot", hot.get(), hot_len}}) {
+    BlueFS::FileWriter *h;
+    ASSERT_EQ(0, fs.open_for_write("db", name, &h, false));
+    h->append(data, len);
+    fs.fsync(h);
+    fs.close_writer(h);
+  }
+  uint64_t db_used = fs.get_used(BlueFS::BDEV_DB);
+  uint64_t slow_used = fs.get_used(BlueFS::BDEV_SLOW);
+  ASSERT_GE(db_used, cold_len + hot_len);
+
+  BlueFS::FileReader *h;
+  ASSERT_EQ(0, fs.open_for_read("db", "hot", &h));
+  auto out = std::make_unique<char[]>(hot_len);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ((int)hot_len, fs.read_random(h, 0, hot_len, out.get()));
+  }
+  delete h;
+
+  // only the cold file moves to the slow device
+  fs.tiering_pass();
+  ASSERT_LE(fs.get_used(BlueFS::BDEV_DB) + cold_len, db_used);
+  ASSERT_GE(fs.get_used(BlueFS::BDEV_DB), hot_len);
+  ASSERT_GE(fs.get_used(BlueFS::BDEV_SLOW), slow_used + cold_len);
+  fs.umount();
+
+  // the new extents are logged and hold the same data
+  ASSERT_EQ(0, fs.mount());
+  for (auto& [name, data, len] : {std::tuple{"cold", cold.get(), cold_len},
+				  std::tuple{"hot", hot.get(), hot_len}}) {
+    ASSERT_EQ(0, fs.open_for_read("db", name, &h));
+    bufferlist bl;
+    ASSERT_EQ((int)len, fs.read(h, 0, len, &bl, NULL));
+    ASSERT_EQ(0, memcmp(data, bl.c_str(), len));
+    delete h;
+  }
+  fs.umount();
+}
+
+TEST(BlueFS, test_cabindb_on_bluefs) {
+  uint64_t size = 1048576 * 128;
+  TempBdev bdev{size};
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev.path, false, 1048576));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_DB, false, false }));
+  ASSERT_EQ(0, fs.mount());
+
+  auto key = [](int i) { return "key" + stringify(i); };
+  auto value = [](int i) { return std::string(1000, 'a' + i % 26); };
+  const int keys = 2000;
+  {
+    // the store takes ownership of the env
+    std::unique_ptr<KeyValueDB> db(KeyValueDB::create(
+      g_ceph_context, "cabindb", "db", {}, new BlueCabinEnv(&fs)));
+    ASSERT_TRUE(db);
+    db->init("compression=kNoCompression,write_buffer_size=262144");
+    ostringstream err;
+    ASSERT_EQ(0, db->create_and_open(err, true)) << err.str();
+    for (int i = 0; i < keys; i += 100) {
+      KeyValueDB::Transaction t = db->get_transaction();
+      for (int j = i; j < i + 100; j++) {
+	bufferlist bl;
+	bl.append(value(j));
+	t->set("P", key(j), bl);
+      }
+      ASSERT_EQ(0, db->submit_transaction_sync(t));
+    }
+    // the memtables are flushed and compacted to table files on bluefs
+    db->compact();
+  }
+  std::vector<std::string> ls;
+  ASSERT_EQ(0, fs.readdir("db", &ls));
+  ASSERT_TRUE(std::any_of(ls.begin(), ls.end(), [](const std::string& f) {
+    return f.size() > 4 && f.compare(f.size() - 4, 4, ".sst") == 0;
+  }));
+  fs.umount();
+
+  // everything is read back through BlueCabinEnv after a remount
+  ASSERT_EQ(0, fs.mount());
+  {
+    std::unique_ptr<KeyValueDB> db(KeyValueDB::create(
+      g_ceph_context, "cabindb", "db", {}, new BlueCabinEnv(&fs)));
+    db->init("compression=kNoCompression");
+    ostringstream err;
+    ASSERT_EQ(0, db->open(err)) << err.str();
+    for (int i = 0; i < keys; i++) {
+      bufferlist bl;
+      ASSERT_EQ(0, db->get("P", key(i), &bl));
+      ASSERT_EQ(value(i), bl.to_str());
+    }
+    KeyValueDB::Iterator it = db->get_iterator("P");
+    int n = 0;
+    for (it->seek_to_first(); it->valid(); it->next()) {
+      n++;
+    }
+    ASSERT_EQ(keys, n);
+  }
+  fs.umount();
+}
+
+TEST(BlueFS, test_cabindb_unique_id) {
+  uint64_t size = 1048576 * 128;
+  TempBdev bdev{size};
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev.path, false, 1048576));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_DB, false, false }));
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.mkdir("db"));
+
+  BlueCabinEnv env(&fs);
+  auto create = [&env](const std::string& name) {
+    std::unique_ptr<cabindb::WritableFile> f;
+    ASSERT_TRUE(env.NewWritableFile(name, &f, cabindb::EnvOptions()).ok());
+    ASSERT_TRUE(f->Append(std::string(4096, 'x')).ok());
+    ASSERT_TRUE(f->Sync().ok());
+  };
+  auto unique_id = [&env](const std::string& name) {
+    std::unique_ptr<cabindb::RandomAccessFile> f;
+    EXPECT_TRUE(env.NewRandomAccessFile(name, &f, cabindb::EnvOptions()).ok());
+    char id[64];
+    return std::string(id, f->GetUniqueId(id, sizeof(id)));
+  };
+
+  create("db/000012.sst");
+  create("db/CURRENT");
+  const std::string id12 = unique_id("db/000012.sst");
+  ASSERT_FALSE(id12.empty());
+  // unnumbered files leave the id to the cache
+  ASSERT_TRUE(unique_id("db/CURRENT").empty());
+
+  // the id survives a remount and a compaction of the bluefs log
+  fs.compact_log();
+  fs.umount();
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(id12, unique_id("db/000012.sst"));
+
+  // once the log is compacted the ino of a deleted file may be handed out
+  // again; a new table file must still get an id of its own
+  ASSERT_TRUE(env.DeleteFile("db/000012.sst").ok());
+  fs.compact_log();
+  fs.umount();
+  ASSERT_EQ(0, fs.mount());
+  create("db/000013.sst");
+  const std::string id13 = unique_id("db/000013.sst");
+  ASSERT_FALSE(id13.empty());
+  ASSERT_NE(id12, id13);
+  // and neither id is a prefix of the other
+  ASSERT_NE(0u, id13.compare(0, id12.size(), id12));
+  fs.umount();
+}
+
 int main(int argc, char **argv) {
   vector<const char*> args;
   argv_to_vec(argc, (const char **)argv, args);
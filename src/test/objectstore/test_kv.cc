@@ -15,10 +15,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <iostream>
+#include <numeric>
 #include <time.h>
 #include <sys/mount.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include "kv/KeyValueDB.h"
 #include "kv/RocksDBStore.h"
+#include "kv/CabinDBStore.h"
+#include "cabindb/include/cabindb/utilities/options_util.h"
 #include "include/Context.h"
 #include "common/ceph_argparse.h"
 #include "global/global_init.h"
@@ -259,6 +264,102 @@ TEST_P(KVTest, Merge) {
   fini();
 }
 
+TEST_P(KVTest, GetMany) {
+  shared_ptr<KeyValueDB::MergeOperator> p(new AppendMOP);
+  bool merge = db->set_merge_operator("A", p) == 0;
+  // rocksdb and cabindb spread both prefixes over several column families
+  bool sharded = string(GetParam()) == "rocksdb" ||
+    string(GetParam()) == "cabindb";
+  ASSERT_EQ(0, db->create_and_open(cout, true, sharded ? "P(3) A(2)" : ""));
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (int i = 0; i < 100; i += 2) {
+      bufferlist v;
+      v.append("p" + stringify(i));
+      t->set("P", "key" + stringify(i), v);
+      if (merge) {
+	bufferlist m;
+	m.append(stringify(i));
+	t->merge("A", "key" + stringify(i), m);
+      }
+    }
+    ASSERT_EQ(0, db->submit_transaction_sync(t));
+  }
+  if (merge) {
+    // a second operand so lookups have to apply the operator
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (int i = 0; i < 100; i += 4) {
+      bufferlist m;
+      m.append("+");
+      t->merge("A", "key" + stringify(i), m);
+    }
+    ASSERT_EQ(0, db->submit_transaction_sync(t));
+  }
+
+  // every even key exists, every odd one is missing
+  std::vector<std::string> keys;
+  for (int i = 0; i < 100; i++) {
+    keys.push_back("key" + stringify(i));
+  }
+  {
+    std::vector<bufferlist> out;
+    std::vector<int> rs;
+    ASSERT_EQ(0, db->get_many("P", keys, &out, &rs));
+    ASSERT_EQ(keys.size(), out.size());
+    ASSERT_EQ(keys.size(), rs.size());
+    for (int i = 0; i < 100; i++) {
+      if (i % 2) {
+	ASSERT_EQ(-ENOENT, rs[i]);
+	ASSERT_EQ(0u, out[i].length());
+      } else {
+	ASSERT_EQ(0, rs[i]);
+	ASSERT_EQ("p" + stringify(i), tostr(out[i]));
+      }
+    }
+  }
+  {
+    std::set<std::string> ks(keys.begin(), keys.end());
+    std::map<std::string, bufferlist> out;
+    ASSERT_EQ(0, db->get("P", ks, &out));
+    ASSERT_EQ(50u, out.size());
+    for (auto& [k, v] : out) {
+      ASSERT_EQ("p" + k.substr(3), tostr(v));
+    }
+  }
+  if (merge) {
+    std::vector<bufferlist> out;
+    std::vector<int> rs;
+    ASSERT_EQ(0, db->get_many("A", keys, &out, &rs));
+    std::set<std::string> ks(keys.begin(), keys.end());
+    std::map<std::string, bufferlist> m;
+    ASSERT_EQ(0, db->get("A", ks, &m));
+    ASSERT_EQ(50u, m.size());
+    for (int i = 0; i < 100; i++) {
+      if (i % 2) {
+	ASSERT_EQ(-ENOENT, rs[i]);
+	ASSERT_EQ(0u, m.count(keys[i]));
+	continue;
+      }
+      string expect = "?" + stringify(i) + (i % 4 ? "" : "+");
+      ASSERT_EQ(0, rs[i]);
+      ASSERT_EQ(expect, tostr(out[i]));
+      ASSERT_EQ(expect, tostr(m[keys[i]]));
+    }
+  }
+  {
+    // an empty batch and a prefix without any keys
+    std::vector<bufferlist> out;
+    std::vector<int> rs;
+    ASSERT_EQ(0, db->get_many("P", {}, &out, &rs));
+    ASSERT_TRUE(out.empty());
+    ASSERT_EQ(0, db->get_many("Q", keys, &out, &rs));
+    for (int i = 0; i < 100; i++) {
+      ASSERT_EQ(-ENOENT, rs[i]);
+    }
+  }
+  fini();
+}
+
 TEST_P(KVTest, RMRange) {
   ASSERT_EQ(0, db->create_and_open(cout));
   bufferlist value;
@@ -312,6 +413,147 @@ TEST_P(KVTest, RMRange) {
   fini();
 }
 
+TEST_P(KVTest, IteratorSnapshot) {
+  ASSERT_EQ(0, db->create_and_open(cout));
+  bufferlist value;
+  value.append("value");
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (auto& prefix : {"A", "B", "C", "D"}) {
+      t->set(prefix, "key1", value);
+      t->set(prefix, "key3", value);
+    }
+    db->submit_transaction_sync(t);
+  }
+
+  KeyValueDB::WholeSpaceIterator it = db->get_wholespace_iterator();
+  KeyValueDB::Iterator pit = db->get_iterator("C");
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (auto& prefix : {"A", "B", "C", "D"}) {
+      t->set(prefix, "key2", value);
+      t->rmkey(prefix, "key3");
+    }
+    db->submit_transaction_sync(t);
+  }
+
+  // both iterators still see the first transaction only
+  std::vector<std::pair<std::string, std::string>> expected;
+  for (auto& prefix : {"A", "B", "C", "D"}) {
+    expected.emplace_back(prefix, "key1");
+    expected.emplace_back(prefix, "key3");
+  }
+  size_t i = 0;
+  for (it->seek_to_first(); it->valid(); it->next(), i++) {
+    ASSERT_LT(i, expected.size());
+    ASSERT_EQ(expected[i], it->raw_key());
+  }
+  ASSERT_EQ(expected.size(), i);
+  for (it->seek_to_last(); it->valid(); it->prev()) {
+    ASSERT_EQ(expected[--i], it->raw_key());
+  }
+  ASSERT_EQ(0u, i);
+
+  pit->seek_to_first();
+  ASSERT_TRUE(pit->valid());
+  ASSERT_EQ("key1", pit->key());
+  pit->next();
+  ASSERT_TRUE(pit->valid());
+  ASSERT_EQ("key3", pit->key());
+  pit->next();
+  ASSERT_FALSE(pit->valid());
+
+  // a new iterator sees the second one
+  pit = db->get_iterator("C");
+  pit->seek_to_first();
+  ASSERT_EQ("key1", pit->key());
+  pit->next();
+  ASSERT_EQ("key2", pit->key());
+  pit->next();
+  ASSERT_FALSE(pit->valid());
+  fini();
+}
+
+TEST_P(KVTest, ParallelIterators) {
+  // stores that split by table file need "A" to span several of them
+  bool splits = string(GetParam()) == "rocksdb" ||
+    string(GetParam()) == "cabindb";
+  if (splits) {
+    ASSERT_EQ(0, db->init("compression=kNoCompression,"
+			  "target_file_size_base=65536"));
+  }
+  ASSERT_EQ(0, db->create_and_open(cout));
+  bufferlist value;
+  value.append("value");
+  bufferlist big_value;
+  big_value.append(std::string(1024, 'v'));
+  std::vector<std::string> keys;
+  for (unsigned i = 0; i < 1000; ++i) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%04u", i);
+    keys.push_back(key);
+  }
+  {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (auto& key : keys) {
+      t->set("A", key, big_value);
+      t->set("B", key, big_value);
+    }
+    db->submit_transaction_sync(t);
+  }
+  db->compact();
+
+  auto check = [&](const std::string& from, const std::string& to,
+		   bool split) {
+    auto iters = db->get_parallel_iterators("A", 4, from, to);
+    if (split) {
+      ASSERT_GT(iters.size(), 1u);
+    } else {
+      ASSERT_GE(iters.size(), 1u);
+    }
+    ASSERT_LE(iters.size(), 4u);
+
+    // written after the iterators, so none of them may see it
+    KeyValueDB::Transaction t = db->get_transaction();
+    t->set("A", "key0500a", value);
+    t->rmkey("A", "key0600");
+    db->submit_transaction_sync(t);
+
+    std::vector<std::string> expected;
+    for (auto& key : keys) {
+      if (key >= from && (to.empty() || key < to)) {
+        expected.push_back(key);
+      }
+    }
+    std::vector<std::string> seen;
+    for (auto& it : iters) {
+      for (it->seek_to_first(); it->valid(); it->next()) {
+        seen.push_back(it->key());
+      }
+    }
+    ASSERT_EQ(expected, seen);
+
+    // each range ends where the next one starts, walking backwards too
+    seen.clear();
+    for (auto i = iters.rbegin(); i != iters.rend(); ++i) {
+      for ((*i)->seek_to_last(); (*i)->valid(); (*i)->prev()) {
+        seen.push_back((*i)->key());
+      }
+    }
+    std::reverse(seen.begin(), seen.end());
+    ASSERT_EQ(expected, seen);
+
+    t = db->get_transaction();
+    t->rmkey("A", "key0500a");
+    t->set("A", "key0600", value);
+    db->submit_transaction_sync(t);
+  };
+  check("", "", splits);
+  check("key0100", "key0900", splits);
+  check("key0950", "", false);
+  fini();
+}
+
 TEST_P(KVTest, ShardingRMRange) {
   if(string(GetParam()) != "rocksdb")
     return;
@@ -985,7 +1227,41 @@ TEST_P(RocksDBShardingTest, wholespace_lookup_limits) {
   } while (!end(X));
 }
 
-
+TEST_P(RocksDBShardingTest, parallel_iterators) {
+  // small tables, so that every shard ends up with several of them
+  db->close();
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_rocksdb_options +
+			",target_file_size_base=65536"));
+  ASSERT_EQ(0, db->open(cout));
+  bufferlist value;
+  value.append(std::string(1024, 'v'));
+  std::vector<std::string> keys;
+  for (unsigned i = 0; i < 1000; ++i) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%04u", i);
+    keys.push_back(key);
+  }
+  KeyValueDB::Transaction t = db->get_transaction();
+  for (auto& key : keys) {
+    t->set("Betelgeuse", key, value);
+    t->set("D", key, value);
+  }
+  ASSERT_EQ(0, db->submit_transaction_sync(t));
+  db->compact();
+
+  for (auto& prefix : {"Betelgeuse", "D"}) {
+    auto iters = db->get_parallel_iterators(prefix, 4);
+    ASSERT_GT(iters.size(), 1u);
+    ASSERT_LE(iters.size(), 4u);
+    std::vector<std::string> seen;
+    for (auto& it : iters) {
+      for (it->seek_to_first(); it->valid(); it->next()) {
+	seen.push_back(it->key());
+      }
+    }
+    ASSERT_EQ(keys, seen);
+  }
+}
 
 class RocksDBResharding : public ::testing::Test {
 public:
@@ -1272,11 +1548,822 @@ TEST_F(RocksDBResharding, change_reshard) {
   }
 }
 
+TEST(CabinDBStore, cf_caches_split_budget) {
+  int r = ::mkdir("kv_test_temp_dir", 0777);
+  ASSERT_TRUE(r == 0 || errno == EEXIST);
+  g_ceph_context->_conf.set_val("cabindb_cf_cache_prefixes", "A B");
+  g_ceph_context->_conf.apply_changes(nullptr);
+  boost::scoped_ptr<KeyValueDB> db(
+    KeyValueDB::create(g_ceph_context, "cabindb", "kv_test_temp_dir"));
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_cabindb_options));
+  ASSERT_EQ(0, db->create_and_open(cout, true, "A B(2) C"));
+  // column caches are set up when existing column families are opened
+  db->close();
+  ASSERT_EQ(0, db->open(cout));
+
+  // the shared cache and those of A and B each get a third
+  auto capacity = [](std::shared_ptr<PriorityCache::PriCache> c) {
+    return dynamic_pointer_cast<cabindb::Cache>(c)->GetCapacity();
+  };
+  size_t total = g_conf()->cabindb_cache_size;
+  auto caches = db->get_priority_caches();
+  ASSERT_EQ(2u, caches.size());
+  ASSERT_EQ(1u, caches.count("A"));
+  ASSERT_EQ(1u, caches.count("B"));
+  ASSERT_EQ(total / 3, capacity(db->get_priority_cache()));
+  ASSERT_EQ(total / 3, capacity(caches["A"]));
+  ASSERT_EQ(total / 3, capacity(caches["B"]));
+
+  // lookups are counted by the cache of their column only
+  KeyValueDB::Transaction t = db->get_transaction();
+  for (int i = 0; i < 100; i++) {
+    bufferlist v;
+    v.append(std::string(100, 'a'));
+    t->set("A", "key" + stringify(i), v);
+  }
+  ASSERT_EQ(0, db->submit_transaction_sync(t));
+  db->compact();
+  uint64_t b_lookups = caches["B"]->get_cache_hits() +
+    caches["B"]->get_cache_misses();
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < 100; i++) {
+      bufferlist v;
+      ASSERT_EQ(0, db->get("A", "key" + stringify(i), &v));
+    }
+  }
+  ASSERT_GT(caches["A"]->get_cache_hits(), 0u);
+  ASSERT_GT(caches["A"]->get_cache_misses(), 0u);
+  ASSERT_EQ(b_lookups, caches["B"]->get_cache_hits() +
+	    caches["B"]->get_cache_misses());
+  caches.clear();
+  db.reset();
+
+  g_ceph_context->_conf.set_val("cabindb_cf_cache_prefixes", "");
+  g_ceph_context->_conf.apply_changes(nullptr);
+  ASSERT_EQ(0, ::system("rm -r kv_test_temp_dir"));
+}
+
+TEST(CabinDBStore, async_commit) {
+  int r = ::mkdir("kv_test_temp_dir", 0777);
+  ASSERT_TRUE(r == 0 || errno == EEXIST);
+  // small groups, so the queue is committed over several WAL syncs
+  g_ceph_context->_conf.set_val("cabindb_group_commit_max_txns", "8");
+  g_ceph_context->_conf.apply_changes(nullptr);
+  boost::scoped_ptr<KeyValueDB> db(
+    KeyValueDB::create(g_ceph_context, "cabindb", "kv_test_temp_dir"));
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_cabindb_options));
+  ASSERT_EQ(0, db->create_and_open(cout));
+
+  const int n = 200;
+  std::mutex lock;
+  std::vector<int> order;
+  std::vector<int> rs;
+  auto submit = [&](int i) {
+    KeyValueDB::Transaction t = db->get_transaction();
+    bufferlist v;
+    v.append(stringify(i));
+    t->set("A", "key" + stringify(i), v);
+    // every transaction overwrites "last"; the final value is the last one
+    t->set("A", "last", v);
+    return db->submit_transaction_async(t, [&, i](int r) {
+      std::lock_guard l{lock};
+      order.push_back(i);
+      rs.push_back(r);
+    });
+  };
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(0, submit(i));
+  }
+  // close drains the queue: every callback ran before it returns
+  db->close();
+  ASSERT_EQ((size_t)n, order.size());
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i, order[i]);
+    ASSERT_EQ(0, rs[i]);
+  }
+
+  // a reopened store commits async transactions again
+  ASSERT_EQ(0, db->open(cout));
+  for (int i = 0; i < n; i++) {
+    bufferlist v;
+    ASSERT_EQ(0, db->get("A", "key" + stringify(i), &v));
+    ASSERT_EQ(stringify(i), v.to_str());
+  }
+  bufferlist last;
+  ASSERT_EQ(0, db->get("A", "last", &last));
+  ASSERT_EQ(stringify(n - 1), last.to_str());
+  ASSERT_EQ(0, submit(n));
+  db->close();
+  ASSERT_EQ((size_t)n + 1, order.size());
+  ASSERT_EQ(n, order.back());
+  ASSERT_EQ(0, rs.back());
+  db.reset();
+
+  // without a WAL nothing could make the transaction durable
+  db.reset(KeyValueDB::create(g_ceph_context, "cabindb", "kv_test_temp_dir"));
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_cabindb_options +
+			std::string(",disableWAL=true")));
+  ASSERT_EQ(0, db->open(cout));
+  ASSERT_EQ(-EOPNOTSUPP, submit(n + 1));
+  ASSERT_EQ((size_t)n + 1, order.size());
+  db.reset();
+
+  g_ceph_context->_conf.set_val("cabindb_group_commit_max_txns", "128");
+  g_ceph_context->_conf.apply_changes(nullptr);
+  ASSERT_EQ(0, ::system("rm -r kv_test_temp_dir"));
+}
+
+TEST(CabinDBStore, write_buffer_cache_balance) {
+  // a consumer that takes all the memory it is offered
+  struct GreedyCache : public PriorityCache::PriCache {
+    int64_t bytes[PriorityCache::Priority::LAST+1] = {0};
+    double ratio = 0;
+    int64_t request_cache_bytes(PriorityCache::Priority pri,
+				uint64_t total_cache) const override {
+      return total_cache;
+    }
+    int64_t get_cache_bytes(PriorityCache::Priority pri) const override {
+      return bytes[pri];
+    }
+    int64_t get_cache_bytes() const override {
+      return std::accumulate(std::begin(bytes), std::end(bytes), int64_t(0));
+    }
+    void set_cache_bytes(PriorityCache::Priority pri, int64_t b) override {
+      bytes[pri] = b;
+    }
+    void add_cache_bytes(PriorityCache::Priority pri, int64_t b) override {
+      bytes[pri] += b;
+    }
+    int64_t commit_cache_size(uint64_t total_cache) override {
+      return get_cache_bytes();
+    }
+    int64_t get_committed_size() const override {
+      return get_cache_bytes();
+    }
+    double get_cache_ratio() const override {
+      return ratio;
+    }
+    void set_cache_ratio(double r) override {
+      ratio = r;
+    }
+    std::string get_cache_name() const override {
+      return "greedy";
+    }
+  };
+
+  const uint64_t mem = 4ull << 30;
+  const size_t used = 128 << 20;
+  auto memtables = std::make_shared<cabindb_cache::WriteBufferCache>(
+    g_ceph_context, 16 << 20, 1 << 30);
+  auto wbm = memtables->get_write_buffer_manager();
+  auto greedy = std::make_shared<GreedyCache>();
+  PriorityCache::Manager pcm(g_ceph_context, mem, mem, mem, true,
+			     "test-write-buffer-cache");
+  pcm.insert("kv_memtable", memtables, false);
+  pcm.insert("data", greedy, false);
+  wbm->ReserveMem(used);
+
+  // without a ratio the memtables lose everything but the minimum, so
+  // they would be flushed on every write
+  double memtable_ratio =
+    g_conf().get_val<double>("bluestore_cache_kv_memtable_ratio");
+  ASSERT_GT(memtable_ratio, 0);
+  greedy->set_cache_ratio(1.0 - memtable_ratio);
+  pcm.balance();
+  ASSERT_LT(wbm->buffer_size(), used);
+  ASSERT_TRUE(wbm->ShouldFlush());
+
+  // with the configured ratio the limit stays above the memtables in use,
+  // balance after balance
+  memtables->set_cache_ratio(memtable_ratio);
+  for (int i = 0; i < 3; i++) {
+    pcm.balance();
+    ASSERT_GE(memtables->get_cache_bytes(PriorityCache::Priority::PRI0),
+	      static_cast<int64_t>(used));
+    ASSERT_GT(wbm->buffer_size(), used);
+    ASSERT_EQ(memtables->get_committed_size(),
+	      static_cast<int64_t>(wbm->buffer_size()));
+    ASSERT_FALSE(wbm->ShouldFlush());
+  }
+  wbm->FreeMem(used);
+}
+
+TEST(CabinDBStore, compaction_service_timeout) {
+  int r = ::mkdir("kv_test_temp_dir", 0777);
+  ASSERT_TRUE(r == 0 || errno == EEXIST);
+  // a worker that never takes its jobs off the listen queue
+  const std::string socket_path = "kv_test_temp_dir.sock";
+  int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_LE(0, listen_fd);
+  struct sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, socket_path.c_str());
+  ::unlink(socket_path.c_str());
+  ASSERT_EQ(0, ::bind(listen_fd, reinterpret_cast<struct sockaddr*>(&addr),
+		      sizeof(addr)));
+  ASSERT_EQ(0, ::listen(listen_fd, 1));
+  g_ceph_context->_conf.set_val("cabindb_compaction_service_socket", socket_path);
+  g_ceph_context->_conf.set_val("cabindb_compaction_service_connect_timeout", "1");
+  g_ceph_context->_conf.set_val("cabindb_compaction_service_timeout", "1");
+  g_ceph_context->_conf.apply_changes(nullptr);
+
+  boost::scoped_ptr<KeyValueDB> db(
+    KeyValueDB::create(g_ceph_context, "cabindb", "kv_test_temp_dir"));
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_cabindb_options));
+  ASSERT_EQ(0, db->create_and_open(cout));
+  for (int round = 0; round < 3; round++) {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (int i = 0; i < 100; i++) {
+      bufferlist v;
+      v.append("value" + stringify(round));
+      t->set("P", "key" + stringify(i), v);
+    }
+    ASSERT_EQ(0, db->submit_transaction_sync(t));
+    // past the first round the new table overlaps the compacted one, so the
+    // compaction is sent to the worker, times out and runs here instead
+    db->compact();
+  }
+  for (int i = 0; i < 100; i++) {
+    bufferlist v;
+    ASSERT_EQ(0, db->get("P", "key" + stringify(i), &v));
+    ASSERT_EQ("value2", v.to_str());
+  }
+  db.reset();
+
+  ::close(listen_fd);
+  ::unlink(socket_path.c_str());
+  g_ceph_context->_conf.set_val("cabindb_compaction_service_socket", "");
+  g_ceph_context->_conf.rm_val("cabindb_compaction_service_connect_timeout");
+  g_ceph_context->_conf.rm_val("cabindb_compaction_service_timeout");
+  g_ceph_context->_conf.apply_changes(nullptr);
+  ASSERT_EQ(0, ::system("rm -r kv_test_temp_dir"));
+}
+
+TEST(CabinDBStore, blob_column_family) {
+  int r = ::mkdir("kv_test_temp_dir", 0777);
+  ASSERT_TRUE(r == 0 || errno == EEXIST);
+  boost::scoped_ptr<KeyValueDB> db(
+    KeyValueDB::create(g_ceph_context, "cabindb", "kv_test_temp_dir"));
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_cabindb_options));
+  ASSERT_EQ(0, db->create_and_open(
+	      cout, true, "A=enable_blob_files=true;min_blob_size=0 B"));
+
+  auto value_of = [](int i) {
+    return "value" + stringify(i) + std::string(100, 'v');
+  };
+  KeyValueDB::Transaction t = db->get_transaction();
+  for (int i = 0; i < 10; i++) {
+    bufferlist v;
+    v.append(value_of(i));
+    t->set("A", "key" + stringify(i), v);
+  }
+  ASSERT_EQ(0, db->submit_transaction_sync(t));
+  // flushing moves the values to blob files
+  db->compact();
+
+  {
+    // iterate both ways over values read back from the blob files
+    auto it = db->get_iterator("A");
+    int i = 0;
+    for (it->seek_to_first(); it->valid(); it->next(), i++) {
+      ASSERT_EQ(0, it->status());
+      ASSERT_EQ("key" + stringify(i), it->key());
+      ASSERT_EQ(value_of(i), it->value().to_str());
+    }
+    ASSERT_EQ(0, it->status());
+    ASSERT_EQ(10, i);
+    for (it->seek_to_last(); it->valid(); it->prev()) {
+      --i;
+      ASSERT_EQ("key" + stringify(i), it->key());
+      ASSERT_EQ(value_of(i), it->value().to_str());
+    }
+    ASSERT_EQ(0, i);
+    ASSERT_EQ(0, it->lower_bound("key5"));
+    ASSERT_TRUE(it->valid());
+    ASSERT_EQ(value_of(5), it->value().to_str());
+  }
+  {
+    // batched reads go through MultiGet
+    std::set<std::string> keys{"key1", "key4", "key7", "missing"};
+    std::map<std::string, bufferlist> out;
+    ASSERT_EQ(0, db->get("A", keys, &out));
+    ASSERT_EQ(3u, out.size());
+    ASSERT_EQ(value_of(1), tostr(out["key1"]));
+    ASSERT_EQ(value_of(4), tostr(out["key4"]));
+    ASSERT_EQ(value_of(7), tostr(out["key7"]));
+
+    std::vector<bufferlist> values;
+    std::vector<int> rs;
+    ASSERT_EQ(0, db->get_many("A", {"key2", "missing"}, &values, &rs));
+    ASSERT_EQ(0, rs[0]);
+    ASSERT_EQ(value_of(2), tostr(values[0]));
+    ASSERT_EQ(-ENOENT, rs[1]);
+
+    bufferlist v;
+    ASSERT_EQ(0, db->get("A", "key9", &v));
+    ASSERT_EQ(value_of(9), tostr(v));
+  }
+  db.reset();
+  ASSERT_EQ(0, ::system("rm -r kv_test_temp_dir"));
+
+  // merges on top of a blob value are not supported
+  r = ::mkdir("kv_test_temp_dir", 0777);
+  ASSERT_TRUE(r == 0 || errno == EEXIST);
+  db.reset(KeyValueDB::create(g_ceph_context, "cabindb", "kv_test_temp_dir"));
+  ASSERT_EQ(0, db->set_merge_operator("A", std::make_shared<AppendMOP>()));
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_cabindb_options));
+  ASSERT_EQ(-EINVAL, db->create_and_open(
+	      cout, true, "A=enable_blob_files=true;min_blob_size=0"));
+  db.reset();
+  ASSERT_EQ(0, ::system("rm -r kv_test_temp_dir"));
+}
+
+TEST(CabinDBStore, zero_copy_outlives_store) {
+  int r = ::mkdir("kv_test_temp_dir", 0777);
+  ASSERT_TRUE(r == 0 || errno == EEXIST);
+  g_ceph_context->_conf.set_val("cabindb_zero_copy_min_value_size", "1024");
+  g_ceph_context->_conf.apply_changes(nullptr);
+  boost::scoped_ptr<KeyValueDB> db(
+    KeyValueDB::create(g_ceph_context, "cabindb", "kv_test_temp_dir"));
+  ASSERT_EQ(0, db->init(g_conf()->bluestore_cabindb_options));
+  ASSERT_EQ(0, db->create_and_open(cout));
+
+  const std::string a(4096, 'a');
+  bufferlist value, small_value;
+  value.append(a);
+  small_value.append(a.substr(0, 16));
+  KeyValueDB::Transaction t = db->get_transaction();
+  t->set("A", "key", value);
+  t->set("A", "small", small_value);
+  db->submit_transaction_sync(t);
+  // a value read out of a memtable is always copied
+  db->compact();
+
+  bufferlist out, small;
+  ASSERT_EQ(0, db->get("A", "key", &out));
+  ASSERT_EQ(0, db->get("A", "small", &small));
+  PerfCounters *logger = db->get_perf_counters();
+  ASSERT_EQ(1u, logger->get(l_cabindb_zero_copy_gets));
+  ASSERT_EQ(4096u, logger->get(l_cabindb_zero_copy_bytes));
+
+  // writing to a buffer reaches neither the cached block nor other readers
+  bufferlist other;
+  ASSERT_EQ(0, db->get("A", "key", &other));
+  ASSERT_EQ(2u, logger->get(l_cabindb_zero_copy_gets));
+  other.zero();
+  auto p = other.begin(1);
+  p.copy_in(1, "b");
+  ASSERT_EQ(std::string(1, '\0') + "b" + std::string(4094, '\0'), other.to_str());
+  bufferlist again;
+  ASSERT_EQ(0, db->get("A", "key", &again));
+  ASSERT_EQ(a, again.to_str());
+  ASSERT_EQ(a, out.to_str());
+
+  // neither a newer value, the table holding the old one going away nor
+  // the store itself going away may touch the buffer
+  value.clear();
+  value.append(std::string(4096, 'b'));
+  t = db->get_transaction();
+  t->set("A", "key", value);
+  db->submit_transaction_sync(t);
+  db->compact();
+  db->close();
+  db.reset();
+  ASSERT_EQ(a, out.to_str());
+  ASSERT_EQ(a.substr(0, 16), small.to_str());
+  out.clear();
+
+  g_ceph_context->_conf.set_val("cabindb_zero_copy_min_value_size", "0");
+  g_ceph_context->_conf.apply_changes(nullptr);
+  ASSERT_EQ(0, ::system("rm -r kv_test_temp_dir"));
+}
+
+class CabinDBResharding : public ::testing::Test {
+public:
+  boost::scoped_ptr<CabinDBStore> db;
+
+  CabinDBResharding() : db(0) {}
+
+  void rm_r(string path) {
+    string cmd = string("rm -r ") + path;
+    if (verbose)
+      cout << "==> " << cmd << std::endl;
+    int r = ::system(cmd.c_str());
+    if (r) {
+      cerr << "failed with exit code " << r
+	   << ", continuing anyway" << std::endl;
+    }
+  }
+
+  void SetUp() override {
+    verbose = getenv("VERBOSE") && strcmp(getenv("VERBOSE"), "1") == 0;
+
+    int r = ::mkdir("kv_test_temp_dir", 0777);
+    if (r < 0 && errno != EEXIST) {
+      r = -errno;
+      cerr << __func__ << ": unable to create kv_test_temp_dir: "
+	   << cpp_strerror(r) << std::endl;
+      return;
+    }
+
+    KeyValueDB* db_kv = KeyValueDB::create(g_ceph_context, "cabindb",
+					 "kv_test_temp_dir");
+    CabinDBStore* db_cabin = dynamic_cast<CabinDBStore*>(db_kv);
+    ceph_assert(db_cabin);
+    db.reset(db_cabin);
+    ASSERT_EQ(0, db->init(g_conf()->bluestore_cabindb_options));
+  }
+  void TearDown() override {
+    db.reset(nullptr);
+    rm_r("kv_test_temp_dir");
+  }
+
+  bool verbose;
+  std::vector<std::string> prefixes = {"Ad", "Betelgeuse", "C", "D", "Evade"};
+  std::vector<std::string> randoms = {"0", "1", "2", "3", "4", "5",
+				      "found", "brain", "fully", "pen", "worth", "race",
+				      "stand", "nodded", "whenever", "surrounded", "industrial", "skin",
+				      "this", "direction", "family", "beginning", "whenever", "held",
+				      "metal", "year", "like", "valuable", "softly", "whistle",
+				      "perfectly", "broken", "idea", "also", "coffee", "branch",
+				      "tongue", "immediately", "bent", "partly", "burn", "include",
+				      "certain", "burst", "final", "smoke", "positive", "perfectly"
+  };
+  int R = randoms.size();
+  std::map<std::string, std::string> data;
+
+  void generate_data() {
+    data.clear();
+    for (size_t p = 0; p < prefixes.size(); p++) {
+      size_t elem_count = 1 << (( p * 3 ) + 3);
+      for (size_t i = 0; i < elem_count; i++) {
+	std::string key;
+	for (int x = 0; x < 5; x++) {
+	  key = key + randoms[rand() % R];
+	}
+	std::string value;
+	for (int x = 0; x < 3; x++) {
+	  value = value + randoms[rand() % R];
+	}
+	data[CabinDBStore::combine_strings(prefixes[p], key)] = value;
+      }
+    }
+  }
+
+  void data_to_db() {
+    KeyValueDB::Transaction t = db->get_transaction();
+    size_t i = 0;
+    for (auto& d: data) {
+      bufferlist v1;
+      v1.append(d.second);
+      string prefix;
+      string key;
+      CabinDBStore::split_key(d.first, &prefix, &key);
+      t->set(prefix, key, v1);
+      i++;
+      if ((i % 1000) == 0) {
+	ASSERT_EQ(db->submit_transaction_sync(t), 0);
+	t = db->get_transaction();
+      }
+    }
+    ASSERT_EQ(db->submit_transaction_sync(t), 0);
+  }
+
+  void check_db() {
+    KeyValueDB::WholeSpaceIterator it = db->get_wholespace_iterator();
+    auto dit = data.begin();
+    int r = it->seek_to_first();
+    ASSERT_EQ(r, 0);
+    ASSERT_EQ(it->valid(), (dit != data.end()));
+
+    while (dit != data.end()) {
+      ASSERT_EQ(it->valid(), true);
+      string prefix;
+      string key;
+      CabinDBStore::split_key(dit->first, &prefix, &key);
+      auto raw_key = it->raw_key();
+      ASSERT_EQ(raw_key.first, prefix);
+      ASSERT_EQ(raw_key.second, key);
+      ASSERT_EQ(it->value().to_str(), dit->second);
+      ASSERT_EQ(it->next(), 0);
+      ++dit;
+    }
+    ASSERT_EQ(it->valid(), false);
+  }
+
+  // give n random keys new values
+  void update_data(size_t n) {
+    KeyValueDB::Transaction t = db->get_transaction();
+    for (size_t i = 0; i < n; i++) {
+      auto dit = std::next(data.begin(), rand() % data.size());
+      dit->second = randoms[rand() % R] + randoms[rand() % R];
+      bufferlist v1;
+      v1.append(dit->second);
+      string prefix;
+      string key;
+      CabinDBStore::split_key(dit->first, &prefix, &key);
+      t->set(prefix, key, v1);
+    }
+    ASSERT_EQ(db->submit_transaction_sync(t), 0);
+  }
+
+  void check_gets(size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      auto dit = std::next(data.begin(), rand() % data.size());
+      string prefix;
+      string key;
+      CabinDBStore::split_key(dit->first, &prefix, &key);
+      bufferlist v1;
+      ASSERT_EQ(db->get(prefix, key, &v1), 0);
+      ASSERT_EQ(v1.to_str(), dit->second);
+    }
+  }
+};
+
+TEST_F(CabinDBResharding, reject_hash_memtable_without_prefix_extractor) {
+  ASSERT_EQ(0, db->create_and_open(cout, true, ""));
+  generate_data();
+  data_to_db();
+  db->close();
+  ASSERT_EQ(db->reshard("Evade(4)=memtable=prefix_hash:1000"), -EINVAL);
+  // refused before any column was created, a valid sharding still goes through
+  ASSERT_EQ(db->reshard("Evade(4)"), 0);
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+}
+
+TEST_F(CabinDBResharding, hash_memtable_turns_off_concurrent_writes) {
+  ASSERT_EQ(0, db->create_and_open(cout, true, ""));
+  generate_data();
+  data_to_db();
+  db->close();
+  // the hash memtable cannot take concurrent inserts, so creating its
+  // columns fails unless the reshard downgrades the db options; the
+  // block_cache shorthand must be understood on the way
+  const std::string sharding =
+    "Evade(4)=memtable=prefix_hash:1000;prefix_extractor=capped:4;"
+    "block_cache={type=binned_lru}";
+  ASSERT_EQ(db->reshard(sharding), 0);
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  // and the reopened db still takes writes into it
+  data_to_db();
+  check_db();
+  db->close();
+}
+
+TEST_F(CabinDBResharding, compaction_option_parsing) {
+  ASSERT_EQ(0, db->create_and_open(cout, true, ""));
+  generate_data();
+  data_to_db();
+  db->close();
+  // unknown styles and priorities, and fifo without a limit, are refused
+  ASSERT_EQ(db->reshard("Evade(4)=compaction=sideways"), -EINVAL);
+  ASSERT_EQ(db->reshard("Evade(4)=compaction=leveled:urgent"), -EINVAL);
+  ASSERT_EQ(db->reshard("Evade(4)=compaction=fifo"), -EINVAL);
+  ASSERT_EQ(db->reshard("Evade(4)=compaction=fifo;"
+			"compaction_options_fifo={allow_compaction=true}"), -EINVAL);
+
+  const std::string sharding =
+    "Ad=compaction=universal:high Betelgeuse=compaction=leveled:bottom "
+    "C=compaction=fifo;compaction_options_fifo={max_table_files_size=1073741824} "
+    "Evade(4)=compaction=fifo;ttl=100000";
+  ASSERT_EQ(db->reshard(sharding), 0);
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+
+  cabindb::ConfigOptions config_options;
+  config_options.ignore_unknown_options = true;
+  cabindb::DBOptions db_opt;
+  std::vector<cabindb::ColumnFamilyDescriptor> cfs;
+  ASSERT_TRUE(cabindb::LoadLatestOptions(config_options, "kv_test_temp_dir",
+					 &db_opt, &cfs).ok());
+  std::map<std::string, cabindb::ColumnFamilyOptions> cf_opts;
+  for (const auto& cf : cfs) {
+    cf_opts[cf.name] = cf.options;
+  }
+  ASSERT_EQ(cabindb::kCompactionStyleUniversal, cf_opts["Ad"].compaction_style);
+  ASSERT_TRUE(cf_opts["Ad"].high_pri_compaction);
+  ASSERT_FALSE(cf_opts["Ad"].bottom_pri_compaction);
+  ASSERT_EQ(cabindb::kCompactionStyleLevel, cf_opts["Betelgeuse"].compaction_style);
+  ASSERT_FALSE(cf_opts["Betelgeuse"].high_pri_compaction);
+  ASSERT_TRUE(cf_opts["Betelgeuse"].bottom_pri_compaction);
+  ASSERT_EQ(cabindb::kCompactionStyleFIFO, cf_opts["C"].compaction_style);
+  ASSERT_EQ(1073741824u,
+	    cf_opts["C"].compaction_options_fifo.max_table_files_size);
+  ASSERT_EQ(cabindb::kCompactionStyleFIFO, cf_opts["Evade-0"].compaction_style);
+  ASSERT_EQ(100000u, cf_opts["Evade-3"].ttl);
+
+  // Betelgeuse already holds leveled output
+  ASSERT_EQ(db->reshard(
+	      "Ad=compaction=universal:high Betelgeuse=compaction=fifo;ttl=100000 "
+	      "C=compaction=fifo;compaction_options_fifo={max_table_files_size=1073741824} "
+	      "Evade(4)=compaction=fifo;ttl=100000"), -EINVAL);
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+}
+
+TEST_F(CabinDBResharding, online_with_traffic) {
+  ASSERT_EQ(0, db->create_and_open(cout, true, "Ad(1) Evade(2)"));
+  generate_data();
+  data_to_db();
+  CabinDBStore::resharding_ctrl ctrl;
+  ctrl.keys_per_batch = 100;
+  ctrl.bytes_per_sec = 1 << 20;
+  ASSERT_EQ(db->reshard_online("Ad(1) Evade(5)", &ctrl), 0);
+  // only one online reshard at a time
+  ASSERT_EQ(db->reshard_online("Ad(1) Evade(3)"), -EBUSY);
+  do {
+    update_data(100);
+    check_gets(100);
+    check_db();
+  } while (!db->reshard_online_done());
+  ASSERT_EQ(db->reshard_online_wait(), 0);
+  std::string sharding;
+  ASSERT_TRUE(db->get_sharding(sharding));
+  ASSERT_EQ(sharding, "Ad(1) Evade(5)");
+  update_data(100);
+  check_gets(100);
+  check_db();
+  db->close();
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+}
+
+TEST_F(CabinDBResharding, online_closed_midway) {
+  ASSERT_EQ(0, db->create_and_open(cout, true, "Ad(1) Evade(2)"));
+  generate_data();
+  data_to_db();
+  CabinDBStore::resharding_ctrl ctrl;
+  ctrl.keys_per_batch = 10;
+  ctrl.bytes_per_sec = 1000;
+  ASSERT_EQ(db->reshard_online("Ad(1) Evade(5)", &ctrl), 0);
+  update_data(100);
+  check_gets(100);
+  ASSERT_FALSE(db->reshard_online_done());
+  db->close();
+  // the sharding stays locked until an offline reshard finishes the move
+  ASSERT_NE(db->open(cout), 0);
+  ASSERT_EQ(db->reshard("Ad(1) Evade(5)"), 0);
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+}
+
+TEST_F(CabinDBResharding, online_drops_old_shards) {
+  ASSERT_EQ(0, db->create_and_open(cout, true, "Ad(1) Evade(4)"));
+  generate_data();
+  data_to_db();
+  ASSERT_EQ(db->reshard_online("Ad(1) Evade(2)"), 0);
+  ASSERT_EQ(db->reshard_online_wait(), 0);
+  ASSERT_TRUE(db->reshard_online_done());
+  // Evade-2 and Evade-3 are dropped; compactions, sizes and properties
+  // only go to the shards that are left
+  update_data(100);
+  db->compact();
+  db->compact_prefix("Evade");
+  uint64_t sst_size = 0;
+  ASSERT_TRUE(db->get_property_all_cfs("cabindb.total-sst-files-size", &sst_size));
+  ASSERT_GT(sst_size, 0u);
+  ASSERT_GT(db->estimate_prefix_size("Evade", ""), 0);
+  check_db();
+  db->close();
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+}
+
+// Puts and removes of random keys of prefix, and what data will be once
+// they are submitted.
+static KeyValueDB::Transaction make_updates(
+  KeyValueDB* db, const std::map<std::string, std::string>& data,
+  const std::string& prefix, size_t n, std::map<std::string, std::string>* after)
+{
+  *after = data;
+  auto first = after->lower_bound(CabinDBStore::combine_strings(prefix, ""));
+  auto last = after->lower_bound(CabinDBStore::combine_strings(prefix + '\x01', ""));
+  size_t count = std::distance(first, last);
+  KeyValueDB::Transaction t = db->get_transaction();
+  for (size_t i = 0; i < n; i++) {
+    auto dit = std::next(first, rand() % count);
+    string p, key;
+    CabinDBStore::split_key(dit->first, &p, &key);
+    if (i % 3 == 0) {
+      t->rmkey(p, key);
+      dit->second.clear();
+    } else {
+      dit->second = "updated" + std::to_string(i);
+      bufferlist v;
+      v.append(dit->second);
+      t->set(p, key, v);
+    }
+  }
+  for (auto it = after->begin(); it != after->end();) {
+    it = it->second.empty() ? after->erase(it) : std::next(it);
+  }
+  return t;
+}
+
+TEST_F(CabinDBResharding, online_transaction_across_finish) {
+  ASSERT_EQ(0, db->create_and_open(cout, true, "Ad(1) Evade(4)"));
+  generate_data();
+  data_to_db();
+  // routed before the reshard starts, to shards that are dropped
+  std::map<std::string, std::string> after_before;
+  auto before = make_updates(db.get(), data, "Evade", 200, &after_before);
+
+  CabinDBStore::resharding_ctrl ctrl;
+  ctrl.keys_per_batch = 100;
+  ctrl.bytes_per_sec = 1 << 18;
+  ASSERT_EQ(db->reshard_online("Ad(1) Evade(2)", &ctrl), 0);
+  // routed while keys move, so every put and remove also deletes the key
+  // from the shard it is moving out of
+  std::map<std::string, std::string> after_during;
+  auto during = make_updates(db.get(), after_before, "Evade", 200, &after_during);
+  during->rm_range_keys("Evade", "f", "g");
+  ASSERT_FALSE(db->reshard_online_done());
+  ASSERT_EQ(db->reshard_online_wait(), 0);
+  ASSERT_TRUE(db->reshard_online_done());
+
+  // the old shards are gone; both are routed again
+  ASSERT_EQ(db->submit_transaction_sync(before), 0);
+  ASSERT_EQ(db->submit_transaction_sync(during), 0);
+  data = after_during;
+  for (auto it = data.lower_bound(CabinDBStore::combine_strings("Evade", "f"));
+       it != data.lower_bound(CabinDBStore::combine_strings("Evade", "g"));) {
+    it = data.erase(it);
+  }
+  check_db();
+  check_gets(100);
+  db->close();
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+}
+
+TEST_F(CabinDBResharding, online_twice) {
+  ASSERT_EQ(0, db->create_and_open(cout, true, "Ad(1) Evade(4)"));
+  generate_data();
+  data_to_db();
+  std::map<std::string, std::string> after_first;
+  auto first = make_updates(db.get(), data, "Evade", 200, &after_first);
+  ASSERT_EQ(db->reshard_online("Ad(1) Evade(2)"), 0);
+  ASSERT_EQ(db->reshard_online_wait(), 0);
+  // a finished reshard does not keep the next one from starting; it brings
+  // back shards the first one dropped
+  CabinDBStore::resharding_ctrl ctrl;
+  ctrl.keys_per_batch = 100;
+  ctrl.bytes_per_sec = 1 << 18;
+  ASSERT_EQ(db->reshard_online("Ad(1) Evade(6)", &ctrl), 0);
+  ASSERT_EQ(db->reshard_online("Ad(1) Evade(3)"), -EBUSY);
+  // routed two shardings ago
+  ASSERT_EQ(db->submit_transaction_sync(first), 0);
+  data = after_first;
+  std::map<std::string, std::string> after_second;
+  auto second = make_updates(db.get(), data, "Evade", 200, &after_second);
+  check_gets(100);
+  ASSERT_EQ(db->reshard_online_wait(), 0);
+  ASSERT_EQ(db->submit_transaction_sync(second), 0);
+  data = after_second;
+  std::string sharding;
+  ASSERT_TRUE(db->get_sharding(sharding));
+  ASSERT_EQ(sharding, "Ad(1) Evade(6)");
+  update_data(100);
+  check_gets(100);
+  check_db();
+  db->close();
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+}
+
+TEST_F(CabinDBResharding, online_default_batches_with_traffic) {
+  ASSERT_EQ(0, db->create_and_open(cout, true, "Ad(1) Evade(2)"));
+  generate_data();
+  data_to_db();
+  // the keys of a whole batch are found without the lock; values written
+  // before the batch is moved must not be overwritten by it
+  ASSERT_EQ(db->reshard_online("Ad(1) Evade(7)"), 0);
+  do {
+    update_data(20);
+    check_gets(20);
+  } while (!db->reshard_online_done());
+  ASSERT_EQ(db->reshard_online_wait(), 0);
+  check_db();
+  db->close();
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+}
 
 INSTANTIATE_TEST_SUITE_P(
   KeyValueDB,
   KVTest,
-  ::testing::Values("leveldb", "rocksdb", "memdb"));
+  ::testing::Values("leveldb", "rocksdb", "memdb", "cabindb"));
 
 INSTANTIATE_TEST_SUITE_P(
   KeyValueDB,
@@ -14,6 +14,7 @@
 #include <set>
 #include <string>
 #include <fstream>
+#include <thread>
 
 #include "common/ceph_argparse.h"
 #include "common/config.h"
@@ -25,6 +26,7 @@
 #include "global/global_init.h"
 
 #include "kvstore_tool.h"
+#include "kv/CabinDBStore.h"
 
 void usage(const char *pname)
 {
@@ -48,7 +50,10 @@ void usage(const char *pname)
     << "  compact-range <prefix> <start> <end>\n"
     << "  destructive-repair  (use only as last resort! may corrupt healthy data)\n"
     << "  stats\n"
-    << "  histogram [prefix]\n"
+    << "  histogram [prefix] [threads]\n"
+    << "  compaction-worker <socket>  (cabindb only; store stays open elsewhere)\n"
+    << "  reshard <sharding> [--online]  (cabindb only; --online moves keys\n"
+    << "                                  with the store open)\n"
     << std::endl;
 }
 
@@ -99,6 +104,47 @@ int main(int argc, const char *argv[])
     return 1;
   }
 
+  if (cmd == "compaction-worker") {
+    // the store is opened by the process it compacts for, not by StoreTool
+    if (type != "cabindb" || argc < 5) {
+      usage(argv[0]);
+      return 1;
+    }
+    CabinDBStore store(g_ceph_context, path, {}, nullptr);
+    int ret = store.run_compaction_worker(std::cerr, argv[4]);
+    std::cerr << "compaction-worker stopped: " << cpp_strerror(ret) << std::endl;
+    return 1;
+  }
+
+  if (cmd == "reshard") {
+    if (type != "cabindb" || argc < 5) {
+      usage(argv[0]);
+      return 1;
+    }
+    string new_sharding(argv[4]);
+    bool online = argc > 5 && string(argv[5]) == "--online";
+    CabinDBStore store(g_ceph_context, path, {}, nullptr);
+    int ret;
+    if (online) {
+      ret = store.create_and_open(std::cerr);
+      if (ret == 0) {
+	ret = store.reshard_online(new_sharding);
+      }
+      if (ret == 0) {
+	ret = store.reshard_online_wait();
+      }
+      store.close();
+    } else {
+      ret = store.reshard(new_sharding);
+    }
+    if (ret < 0) {
+      std::cerr << "error resharding: " << cpp_strerror(ret) << std::endl;
+      return 1;
+    }
+    std::cout << "reshard success" << std::endl;
+    return 0;
+  }
+
   bool to_repair = (cmd == "destructive-repair");
   bool need_stats = (cmd == "stats");
   StoreTool st(type, path, to_repair, need_stats);
@@ -353,7 +399,17 @@ int main(int argc, const char *argv[])
     string prefix;
     if (argc > 4)
       prefix = url_unescape(argv[4]);
-    st.build_size_histogram(prefix);
+    size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (argc > 5) {
+      string err;
+      int n = strict_strtol(argv[5], 10, &err);
+      if (!err.empty() || n < 1) {
+        std::cerr << "invalid threads: " << argv[5] << std::endl;
+        return 1;
+      }
+      threads = n;
+    }
+    st.build_size_histogram(prefix, threads);
   } else {
     std::cerr << "Unrecognized command: " << cmd << std::endl;
     return 1;
@@ -4,6 +4,8 @@
 #include "kvstore_tool.h"
 
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "common/errno.h"
 #include "common/url_escape.h"
@@ -236,39 +238,67 @@ int StoreTool::print_stats() const
 }
 
 //Itrerates through the db and collects the stats
-int StoreTool::build_size_histogram(const string& prefix0) const
+int StoreTool::build_size_histogram(const string& prefix0, size_t threads) const
 {
   ostringstream ostr;
   Formatter* f = Formatter::create("json-pretty", "json-pretty", "json-pretty");
 
   const size_t MAX_PREFIX = 256;
-  uint64_t num[MAX_PREFIX] = {0};
+  struct part_stats_t {
+    uint64_t num[MAX_PREFIX] = {0};
+    size_t max_key_size = 0, max_value_size = 0;
+    uint64_t total_key_size = 0, total_value_size = 0;
+    KeyValueHistogram hist;
+  };
+
+  auto start = coarse_mono_clock::now();
+
+  // the parts are disjoint, so each is walked by its own thread and the
+  // counts are added up afterwards
+  auto iters = db->get_parallel_iterators(prefix0, std::max<size_t>(threads, 1),
+                                          string(), string(),
+                                          KeyValueDB::ITERATOR_NOCACHE);
+  std::vector<part_stats_t> parts(iters.size());
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < iters.size(); ++i) {
+    workers.emplace_back([iter = iters[i], &part = parts[i]] {
+      iter->seek_to_first();
+      while (iter->valid()) {
+	pair<string, string> key(iter->raw_key());
+	size_t key_size = key.first.size() + key.second.size();
+	size_t value_size = iter->value().length();
+	part.hist.value_hist[part.hist.get_value_slab(value_size)]++;
+	part.max_key_size = std::max(part.max_key_size, key_size);
+	part.max_value_size = std::max(part.max_value_size, value_size);
+	part.total_key_size += key_size;
+	part.total_value_size += value_size;
+
+	unsigned prefix = key.first[0];
+	ceph_assert(prefix < MAX_PREFIX);
+	part.num[prefix]++;
+	part.hist.update_hist_entry(part.hist.key_hist, key.first, key_size,
+				    value_size);
+	iter->next();
+      }
+    });
+  }
+  for (auto& t : workers) {
+    t.join();
+  }
 
+  uint64_t num[MAX_PREFIX] = {0};
   size_t max_key_size = 0, max_value_size = 0;
   uint64_t total_key_size = 0, total_value_size = 0;
-  size_t key_size = 0, value_size = 0;
   KeyValueHistogram hist;
-
-  auto start = coarse_mono_clock::now();
-
-  auto iter = db->get_iterator(prefix0, KeyValueDB::ITERATOR_NOCACHE);
-  iter->seek_to_first();
-  while (iter->valid()) {
-    pair<string, string> key(iter->raw_key());
-    key_size = key.first.size() + key.second.size();
-    value_size = iter->value().length();
-    hist.value_hist[hist.get_value_slab(value_size)]++;
-    max_key_size = std::max(max_key_size, key_size);
-    max_value_size = std::max(max_value_size, value_size);
-    total_key_size += key_size;
-    total_value_size += value_size;
-
-
-    unsigned prefix = key.first[0];
-    ceph_assert(prefix < MAX_PREFIX);
-    num[prefix]++;
-    hist.update_hist_entry(hist.key_hist, key.first, key_size, value_size);
-    iter->next();
+  for (auto& part : parts) {
+    for (size_t i = 0; i < MAX_PREFIX; ++i) {
+      num[i] += part.num[i];
+    }
+    max_key_size = std::max(max_key_size, part.max_key_size);
+    max_value_size = std::max(max_value_size, part.max_value_size);
+    total_key_size += part.total_key_size;
+    total_value_size += part.total_value_size;
+    hist.merge(part.hist);
   }
 
   ceph::timespan duration = coarse_mono_clock::now() - start;
@@ -77,5 +77,5 @@ public:
   int destructive_repair();
 
   int print_stats() const;
-  int build_size_histogram(const string& prefix) const;
+  int build_size_histogram(const string& prefix, size_t threads = 1) const;
 };
@@ -2,6 +2,9 @@
 #include "cabin_db.h"
 #include "global/global_init.h"
 
+#include <algorithm>
+#include <sstream>
+
 using namespace std;
 
 namespace ycsbc {
@@ -11,6 +14,10 @@ namespace ycsbc {
          map<string,string> defaults = {
             { "debug_rocksdb", "2" }
         };
+        // the write/read amplification report needs cabindb's tickers
+        if (utils::StrToBool(props.GetProperty("dbstatistics", "false"))) {
+            defaults["cabindb_perf"] = "true";
+        }
         vector<const char*> args;
         args.push_back("cabindb");
         args.push_back("/tmp/test-cabindb");
@@ -24,12 +31,18 @@ namespace ycsbc {
         std::cout << "Finished initializing, dbpath=" << path << std::endl;
 
         const bool createdb = utils::StrToBool(props.GetProperty("createdb","false"));
-        const int num_cf = stoi(props.GetProperty("columnfamilyshards", "0"));
-        std::string cfs = "";
-        for (int i=0; i < num_cf; i++) {
-            cfs += "cf" + std::to_string(i+1) + "(1) ";
-            vec_cf.push_back("cf"+std::to_string(i+1));
+        if (ParseLayout(props) < 0) {
+            exit(1);
         }
+        std::string cfs = ShardingDef(props);
+        std::vector<CabinDBStore::ColumnFamily> sharding_def;
+        std::string error_msg;
+        if (!CabinDBStore::parse_sharding_def(cfs, sharding_def, nullptr, &error_msg)) {
+            cerr << "invalid sharding definition '" << cfs << "': " << error_msg << std::endl;
+            exit(1);
+        }
+        std::cout << "layout=" << props.GetProperty("cabindblayout", "hybrid")
+                  << " column groups=" << groups.size() << " sharding='" << cfs << "'" << std::endl;
 
         std::map<std::string,std::string> options = {};
 		void *p = NULL;
@@ -40,84 +53,431 @@ namespace ycsbc {
             exit(1);
         }
         db.reset(db_ptr);
+
+        // native cabindb trace of the KV ops, next to the ycsb-level -tracefile
+        kv_trace = !props.GetProperty("kvtracefile", "").empty();
+        if (kv_trace && db->start_trace(props["kvtracefile"]) < 0) {
+            kv_trace = false;
+        }
+
+        async_depth = stoul(props.GetProperty("asyncdepth", "64"));
+        async_inflight = 0;
+        async_error = CabinDB::kOK;
+    }
+
+    static const std::string row_prefix = "row-wise";
+
+    int CabinDB::ParseLayout(utils::Properties &props)
+    {
+        std::string name = props.GetProperty("cabindblayout", "hybrid");
+        if (name == "row") {
+            layout = LAYOUT_ROW;
+        } else if (name == "column") {
+            layout = LAYOUT_COLUMN;
+        } else if (name == "hybrid") {
+            layout = LAYOUT_HYBRID;
+        } else {
+            cerr << "unknown cabindblayout " << name << ", expected row, column or hybrid" << endl;
+            return -EINVAL;
+        }
+
+        // "field0,field1 field2": comma separated fields share a column group
+        std::istringstream spec(props.GetProperty("columngroups", ""));
+        std::string group;
+        while (spec >> group) {
+            std::istringstream gs(group);
+            std::string field;
+            groups.emplace_back();
+            while (getline(gs, field, ',')) {
+                if (field_group.count(field)) {
+                    cerr << "field " << field << " is in more than one column group" << endl;
+                    return -EINVAL;
+                }
+                field_group[field] = groups.size() - 1;
+                groups.back().push_back(field);
+            }
+        }
+
+        // every field not grouped above is a group of its own
+        const int field_count = stoi(props.GetProperty(CoreWorkload::FIELD_COUNT_PROPERTY,
+                                                       CoreWorkload::FIELD_COUNT_DEFAULT));
+        for (int i = 0; i < field_count; i++) {
+            std::string field = "field" + std::to_string(i);
+            if (!field_group.count(field)) {
+                field_group[field] = groups.size();
+                groups.push_back({field});
+            }
+        }
+        for (size_t g = 0; g < groups.size(); g++) {
+            vec_cf.push_back("cf" + std::to_string(g + 1));
+        }
+        return 0;
+    }
+
+    std::string CabinDB::ShardingDef(utils::Properties &props)
+    {
+        std::string cfs = props.GetProperty("shardingdef", "");
+        if (!cfs.empty()) {
+            return cfs;
+        }
+
+        // columnfamilyshards > 0 gives the row store and every column group
+        // a column family of that many shards; 0 keeps them all in default
+        const int shards = stoi(props.GetProperty("columnfamilyshards", "0"));
+        if (shards <= 0) {
+            return cfs;
+        }
+        // cfoptions, e.g. a hash memtable for read-mostly runs, applies to
+        // every generated column family
+        std::string column = "(" + std::to_string(shards) + ")";
+        const std::string cfoptions = props.GetProperty("cfoptions", "");
+        if (!cfoptions.empty()) {
+            column += "=" + cfoptions;
+        }
+        if (StoresRows()) {
+            cfs += row_prefix + column + " ";
+        }
+        if (StoresColumns()) {
+            for (auto &cf : vec_cf) {
+                cfs += cf + column + " ";
+            }
+        }
+        return cfs;
+    }
+
+    bool CabinDB::UseRows(const std::vector<std::string> *fields) const
+    {
+        return layout == LAYOUT_ROW || (layout == LAYOUT_HYBRID && !fields);
+    }
+
+    std::vector<size_t> CabinDB::NeededGroups(const std::vector<std::string> *fields) const
+    {
+        std::vector<size_t> needed;
+        if (!fields) {
+            for (size_t g = 0; g < groups.size(); g++) {
+                needed.push_back(g);
+            }
+            return needed;
+        }
+        for (auto &field : *fields) {
+            auto it = field_group.find(field);
+            if (it != field_group.end() &&
+                std::find(needed.begin(), needed.end(), it->second) == needed.end()) {
+                needed.push_back(it->second);
+            }
+        }
+        return needed;
+    }
+
+    /// append the pairs of values named in fields (all if NULL) to result
+    static void Project(std::vector<DB::KVPair> &values, const std::vector<std::string> *fields,
+                        std::vector<DB::KVPair> &result)
+    {
+        for (auto &value : values) {
+            if (!fields || std::find(fields->begin(), fields->end(), value.first) != fields->end()) {
+                result.push_back(std::move(value));
+            }
+        }
+    }
+
+    /// overwrite the fields of record that appear in values, append the rest
+    static void Merge(std::vector<DB::KVPair> &record, const std::vector<DB::KVPair> &values)
+    {
+        for (auto &value : values) {
+            auto it = std::find_if(record.begin(), record.end(),
+                                   [&value](const DB::KVPair &p) { return p.first == value.first; });
+            if (it != record.end()) {
+                it->second = value.second;
+            } else {
+                record.push_back(value);
+            }
+        }
+    }
+
+    bool CabinDB::GetIOStats(IOStats &stats)
+    {
+        uint64_t wal = 0, flush = 0, compact_write = 0, compact_read = 0, block_read = 0;
+        if (!db->get_ticker(cabindb::WAL_FILE_BYTES, &wal) ||
+            !db->get_ticker(cabindb::FLUSH_WRITE_BYTES, &flush) ||
+            !db->get_ticker(cabindb::COMPACT_WRITE_BYTES, &compact_write) ||
+            !db->get_ticker(cabindb::COMPACT_READ_BYTES, &compact_read) ||
+            !db->get_ticker(cabindb::BLOCK_CACHE_BYTES_WRITE, &block_read)) {
+            return false;
+        }
+        stats.bytes_written = wal + flush + compact_write;
+        // every block a user read fetched from disk was inserted into the block cache
+        stats.bytes_read = compact_read + block_read;
+
+        uint64_t sst = 0, live = 0;
+        db->get_property_all_cfs("cabindb.total-sst-files-size", &sst);
+        db->get_property_all_cfs("cabindb.estimate-live-data-size", &live);
+        stats.space_used = sst;
+        stats.live_bytes = live;
+        return true;
     }
 
     int CabinDB::Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
                       std::vector<KVPair> &result) 
     {
-        bufferlist bl_res;
-        db->get("row-wise", key, &bl_res);
-        decode(result, bl_res);
+        if (UseRows(fields)) {
+            bufferlist bl_res;
+            if (db->get(row_prefix, key, &bl_res) < 0) {
+                return CabinDB::kErrorNoData;
+            }
+            std::vector<KVPair> row;
+            decode(row, bl_res);
+            Project(row, fields, result);
+            return CabinDB::kOK;
+        }
+
+        // projected read: only the column families holding the requested fields
+        for (auto g : NeededGroups(fields)) {
+            bufferlist bl_res;
+            if (db->get(vec_cf[g], key, &bl_res) < 0) {
+                return CabinDB::kErrorNoData;
+            }
+            std::vector<KVPair> cols;
+            decode(cols, bl_res);
+            Project(cols, fields, result);
+        }
         return CabinDB::kOK;
     }
 
     int CabinDB::Scan(const std::string &table, const std::string &key, const std::string &max_key, int len,
                         const std::vector<std::string> *fields, std::vector<std::vector<KVPair>> &result) 
     {
-        std::map<string, bufferlist> bl_res;
-        long lowk = atol(key.c_str());
-        long highk = atol(max_key.c_str());
-        std::set<std::string> keys;
-        for (int i = 0; i < len && lowk+i <= highk; i++) {
-            keys.insert(std::to_string(lowk+i));
+        if (UseRows(fields)) {
+            KeyValueDB::Iterator it = db->get_iterator(row_prefix);
+            for (it->lower_bound(key); it->valid() && (int)result.size() < len; it->next()) {
+                if (!max_key.empty() && it->key() > max_key) {
+                    break;
+                }
+                std::vector<KVPair> row;
+                bufferlist bl_val = it->value();
+                decode(row, bl_val);
+                result.emplace_back();
+                Project(row, fields, result.back());
+            }
+            return CabinDB::kOK;
         }
-        db->get("test", keys, &bl_res);
 
-        for (auto blr : bl_res) {
-            std::vector<KVPair> kvpairs;
-            decode(kvpairs, blr.second);
-            result.push_back(kvpairs);
+        // one iterator per needed column group; every insert writes all
+        // groups, so they advance in step and are only re-aligned on gaps
+        std::vector<KeyValueDB::Iterator> its;
+        for (auto g : NeededGroups(fields)) {
+            its.push_back(db->get_iterator(vec_cf[g]));
+            its.back()->lower_bound(key);
+        }
+        while (!its.empty() && its[0]->valid() && (int)result.size() < len) {
+            std::string k = its[0]->key();
+            if (!max_key.empty() && k > max_key) {
+                break;
+            }
+            std::vector<KVPair> row;
+            for (auto &it : its) {
+                if (it->valid() && it->key() < k) {
+                    it->lower_bound(k);
+                }
+                if (it->valid() && it->key() == k) {
+                    std::vector<KVPair> cols;
+                    bufferlist bl_val = it->value();
+                    decode(cols, bl_val);
+                    Project(cols, fields, row);
+                    it->next();
+                }
+            }
+            result.push_back(std::move(row));
         }
         return CabinDB::kOK;
     }
 
+    void CabinDB::AppendInsert(KeyValueDB::Transaction tx, const std::string &key, std::vector<KVPair> &values)
+    {
+        if (StoresRows()) {
+            bufferlist bl_val;
+            encode(values, bl_val);
+            tx->set(row_prefix, key, bl_val);
+        }
+
+        if (StoresColumns()) {
+            std::vector<std::vector<KVPair>> cols(groups.size());
+            for (auto &value : values) {
+                auto it = field_group.find(value.first);
+                if (it != field_group.end()) {
+                    cols[it->second].push_back(value);
+                }
+            }
+            for (size_t g = 0; g < cols.size(); g++) {
+                if (cols[g].empty()) {
+                    continue;
+                }
+                bufferlist bl_val_cf;
+                encode(cols[g], bl_val_cf);
+                tx->set(vec_cf[g], key, bl_val_cf);
+            }
+        }
+    }
+
     int CabinDB::Insert(const std::string &table, const std::string &key, std::vector<KVPair> &values)
     {
-        bufferlist bl_val;
-        encode(values, bl_val);
+        KeyValueDB::Transaction tx = db->get_transaction();
+        AppendInsert(tx, key, values);
+        std::lock_guard l{KeyLock(key)};
+        return db->submit_transaction_sync(tx);
+    }
 
+    int CabinDB::BatchInsert(const std::string &table, const std::vector<std::string> &keys,
+                             std::vector<std::vector<KVPair>> &values)
+    {
         KeyValueDB::Transaction tx = db->get_transaction();
-        tx->set("row-wise", key, bl_val);
-        int ret = db->submit_transaction_sync(tx);
+        for (size_t i = 0; i < keys.size(); i++) {
+            AppendInsert(tx, keys[i], values[i]);
+        }
+        return db->submit_transaction_sync(tx);
+    }
+
+    int CabinDB::BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                           const std::vector<std::string> *fields,
+                           std::vector<std::vector<KVPair>> &results)
+    {
+        std::vector<std::string> prefixes;
+        if (UseRows(fields)) {
+            prefixes.push_back(row_prefix);
+        } else {
+            for (auto g : NeededGroups(fields)) {
+                prefixes.push_back(vec_cf[g]);
+            }
+        }
 
-        int cf_size = values.size();
-        for (long i=0; i < cf_size; i++) {
-            KVPair val = values[i];
-            bufferlist bl_val_cf;
-            encode(val, bl_val_cf);
+        int ret = CabinDB::kOK;
+        results.resize(keys.size());
+        // a row missing from any column family is not returned at all
+        std::vector<bool> missing(keys.size(), false);
+        for (auto &prefix : prefixes) {
+            // one MultiGet per column family instead of a Get per key
+            std::vector<bufferlist> bls;
+            std::vector<int> rs;
+            int r = db->get_many(prefix, keys, &bls, &rs);
+            if (r < 0) {
+                return r;
+            }
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (missing[i]) {
+                    continue;
+                }
+                if (rs[i] < 0) {
+                    ret = CabinDB::kErrorNoData;
+                    missing[i] = true;
+                    results[i].clear();
+                    continue;
+                }
+                std::vector<KVPair> values;
+                decode(values, bls[i]);
+                Project(values, fields, results[i]);
+            }
+        }
+        return ret;
+    }
 
-            KeyValueDB::Transaction tx_cf = db->get_transaction();
-            tx_cf->set("cf"+std::to_string(i+1), key, bl_val_cf);
-            int ret_cf = db->submit_transaction_sync(tx_cf);
-            if (ret_cf != CabinDB::kOK) {
-                ret = -1;
+    int CabinDB::AsyncInsert(const std::string &table, const std::string &key,
+                             std::vector<KVPair> &values, Callback cb)
+    {
+        KeyValueDB::Transaction tx = db->get_transaction();
+        AppendInsert(tx, key, values);
+        {
+            std::unique_lock l{async_lock};
+            async_cond.wait(l, [this] { return async_inflight == 0 || async_inflight < async_depth; });
+            async_inflight++;
+        }
+        // the store groups queued transactions into one WAL sync
+        int r = db->submit_transaction_async(tx, [this, cb = std::move(cb)](int r) {
+            cb(r);
+            std::lock_guard l{async_lock};
+            if (r < 0 && async_error == CabinDB::kOK) {
+                async_error = r;
             }
+            async_inflight--;
+            async_cond.notify_all();
+        });
+        if (r < 0) {
+            std::lock_guard l{async_lock};
+            async_inflight--;
+            async_cond.notify_all();
+            return r;
         }
-        return ret == CabinDB::kOK;
+        return CabinDB::kOK;
     }
 
-    int CabinDB::Update(const std::string &table, const std::string &key, std::vector<KVPair> &values)
+    int CabinDB::WaitForCompletions()
     {
-        return Insert(table, key, values);
+        std::unique_lock l{async_lock};
+        async_cond.wait(l, [this] { return async_inflight == 0; });
+        int r = async_error;
+        async_error = CabinDB::kOK;
+        return r;
     }
 
-    int CabinDB::Delete(const std::string &table, const std::string &key)
+    int CabinDB::Update(const std::string &table, const std::string &key, std::vector<KVPair> &values)
     {
+        std::lock_guard l{KeyLock(key)};
         KeyValueDB::Transaction tx = db->get_transaction();
-        tx->rmkey("row-wise", key);
-        int ret = db->submit_transaction_sync(tx);
+        if (StoresRows()) {
+            bufferlist bl_res;
+            std::vector<KVPair> row;
+            if (db->get(row_prefix, key, &bl_res) == 0) {
+                decode(row, bl_res);
+            }
+            Merge(row, values);
+            bufferlist bl_val;
+            encode(row, bl_val);
+            tx->set(row_prefix, key, bl_val);
+        }
 
-        for (int i=0; i < vec_cf.size(); i++) {
-            KeyValueDB::Transaction tx_cf = db->get_transaction();
-            tx_cf->rmkey(vec_cf[i], key);
-            int ret_cf = db->submit_transaction_sync(tx_cf);
+        if (StoresColumns()) {
+            // only the groups holding an updated field are rewritten
+            std::map<size_t, std::vector<KVPair>> touched;
+            for (auto &value : values) {
+                auto it = field_group.find(value.first);
+                if (it != field_group.end()) {
+                    touched[it->second].push_back(value);
+                }
+            }
+            for (auto &t : touched) {
+                std::vector<KVPair> cols;
+                if (t.second.size() < groups[t.first].size()) {
+                    bufferlist bl_res;
+                    if (db->get(vec_cf[t.first], key, &bl_res) == 0) {
+                        decode(cols, bl_res);
+                    }
+                }
+                Merge(cols, t.second);
+                bufferlist bl_val;
+                encode(cols, bl_val);
+                tx->set(vec_cf[t.first], key, bl_val);
+            }
+        }
+        return db->submit_transaction_sync(tx);
+    }
 
-            if (ret_cf != CabinDB::kOK) {
-                ret = -1;
+    int CabinDB::Delete(const std::string &table, const std::string &key)
+    {
+        KeyValueDB::Transaction tx = db->get_transaction();
+        if (StoresRows()) {
+            tx->rmkey(row_prefix, key);
+        }
+        if (StoresColumns()) {
+            for (size_t i = 0; i < vec_cf.size(); i++) {
+                tx->rmkey(vec_cf[i], key);
             }
         }
-        return ret == CabinDB::kOK;
+        std::lock_guard l{KeyLock(key)};
+        return db->submit_transaction_sync(tx);
     }
 
-    CabinDB::~CabinDB() {}
+    CabinDB::~CabinDB() {
+        WaitForCompletions();
+        if (kv_trace) {
+            db->end_trace();
+        }
+    }
 }
\ No newline at end of file
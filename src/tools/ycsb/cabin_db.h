@@ -5,7 +5,11 @@
 
 #include <stdlib.h>
 #include <errno.h>
+#include <array>
+#include <map>
 #include <string>
+#include <mutex>
+#include <condition_variable>
 
 #include "include/types.h"
 #include "gtest/gtest.h"
@@ -40,11 +44,63 @@ namespace ycsbc {
 
         int Delete(const std::string &table, const std::string &key);
 
+        int BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                      const std::vector<std::string> *fields,
+                      std::vector<std::vector<KVPair>> &results);
+
+        int BatchInsert(const std::string &table, const std::vector<std::string> &keys,
+                        std::vector<std::vector<KVPair>> &values);
+
+        int AsyncInsert(const std::string &table, const std::string &key,
+                        std::vector<KVPair> &values, Callback cb);
+
+        int WaitForCompletions();
+
+        bool GetIOStats(IOStats &stats);
+
         ~CabinDB();
     
     private:
+        /// how records are laid out over the KV prefixes
+        enum Layout {
+            LAYOUT_ROW,     ///< whole record under "row-wise"
+            LAYOUT_COLUMN,  ///< one column family per column group
+            LAYOUT_HYBRID   ///< both; full reads use the row, projections the groups
+        };
+
         std::unique_ptr<CabinDBStore> db;
-        std::vector<std::string> vec_cf;
+        Layout layout;
+        std::vector<std::string> vec_cf;                 // prefix of every column group
+        std::vector<std::vector<std::string>> groups;    // fields of every column group
+        std::map<std::string, size_t> field_group;       // field -> index into groups
+
+        // AsyncInsert transactions queued in the store and not yet committed;
+        // at most async_depth are outstanding
+        std::mutex async_lock;
+        std::condition_variable async_cond;
+        size_t async_inflight;
+        int async_error;
+        size_t async_depth;
+        bool kv_trace;
+
+        // Update reads the stored record and writes it back merged, so
+        // Insert, Update and Delete of one key serialize on its stripe.
+        // The load phase calls (BatchInsert, AsyncInsert) never overlap
+        // the run phase and do not take them.
+        std::array<std::mutex, 64> key_locks;
+        std::mutex &KeyLock(const std::string &key) {
+            return key_locks[std::hash<std::string>{}(key) % key_locks.size()];
+        }
+
+        int ParseLayout(utils::Properties &props);
+        std::string ShardingDef(utils::Properties &props);
+        bool StoresRows() const { return layout != LAYOUT_COLUMN; }
+        bool StoresColumns() const { return layout != LAYOUT_ROW; }
+        bool UseRows(const std::vector<std::string> *fields) const;
+        std::vector<size_t> NeededGroups(const std::vector<std::string> *fields) const;
+
+        void AppendInsert(KeyValueDB::Transaction tx, const std::string &key,
+                          std::vector<KVPair> &values);
 
         void SetOptions(const char *dbfilename, utils::Properties &props);
         void SerializeValues(std::vector<KVPair> &kvs, std::string &value);
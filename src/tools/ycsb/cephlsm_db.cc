@@ -1,4 +1,5 @@
 #include "core/core_workload.h"
+#include "coordinator.h"
 #include "cephlsm_db.h"
 
 using namespace std;
@@ -7,10 +8,8 @@ namespace ycsbc {
 
     CephLsmDB::CephLsmDB(utils::Properties& props) {
 
-        std::string pool_name = props.GetProperty(CoreWorkload::POOLNAME_PROPERTY,CoreWorkload::POOLNAME_DEFAULT);
-        create_one_pool_pp(pool_name, cluster);
-
-        int s = cluster.ioctx_create(pool_name.c_str(), ioctx);
+        pool_name = props.GetProperty(CoreWorkload::POOLNAME_PROPERTY,CoreWorkload::POOLNAME_DEFAULT);
+        int s = OpenPool(pool_name, cluster, ioctx);
         if (s != 0) {
             cerr << "Cannot open ceph db " << pool_name << endl;
             exit(0);
@@ -42,21 +41,33 @@ namespace ycsbc {
             col_map[i] = cols_0;
         }
 
-        dbClient.InitClient(props["dbname"], props["dbname"], 0, 10240000000000000, 8, levels, field_count, col_map);
+        dbClient.InitClient(props["dbname"], props.GetProperty("treename", props["dbname"]), 0, 10240000000000000, 8, levels, field_count, col_map);
+
+        async_depth = stoul(props.GetProperty("asyncdepth", "64"));
     }
 
     int CephLsmDB::Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
                       std::vector<KVPair> &result) 
     {
         cls_lsm_entry return_entry;
-        dbClient.cls_lsm_read(ioctx, table, strtoul(key.c_str(), nullptr, 10), fields, return_entry);
+        {
+            std::lock_guard l{client_lock};
+            dbClient.cls_lsm_read(ioctx, table, strtoul(key.c_str(), nullptr, 10), fields, return_entry);
+        }
+        EntryFields(return_entry, result);
         return CephLsmDB::kOK;
     }
 
+    bool CephLsmDB::GetIOStats(IOStats &stats)
+    {
+        return PoolIOStats(cluster, pool_name, stats);
+    }
+
     int CephLsmDB::Scan(const std::string &table, const std::string &key, const std::string &max_key, int len,
                         const std::vector<std::string> *fields, std::vector<std::vector<KVPair>> &result) 
     {
         cls_lsm_entry return_entry;
+        std::lock_guard l{client_lock};
         dbClient.cls_lsm_read(ioctx, table, std::stoul(key.c_str(), nullptr, 10), fields, return_entry);
         return CephLsmDB::kOK;
     }
@@ -64,19 +75,93 @@ namespace ycsbc {
     int CephLsmDB::Insert(const std::string &table, const std::string &key, std::vector<KVPair> &values)
     {
         cls_lsm_entry entry;
-        entry.key = strtoul(key.c_str(), nullptr, 10);
-        
-        for (auto value : values) {
-            bufferlist bl;
-            encode(value.second, bl);
-            entry.value.insert(std::pair<std::string, bufferlist>(value.first, bl));
-        }
+        EntryFromValues(key, values, entry);
 
+        std::lock_guard l{client_lock};
         dbClient.cls_lsm_write(ioctx, table, entry);
 
         return CephLsmDB::kOK;
     }
 
+    int CephLsmDB::BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                             const std::vector<std::string> *fields,
+                             std::vector<std::vector<KVPair>> &results)
+    {
+        return AioBatchRead(keys, results,
+            [&](uint64_t key, librados::AioCompletion *c, bufferlist *out, bool *gathered) {
+                std::lock_guard l{client_lock};
+                return dbClient.cls_lsm_aio_read(ioctx, table, key, fields, c, out, gathered);
+            });
+    }
+
+    int CephLsmDB::BatchInsert(const std::string &table, const std::vector<std::string> &keys,
+                               std::vector<std::vector<KVPair>> &values)
+    {
+        int ret = CephLsmDB::kOK;
+        std::lock_guard l{client_lock};
+        for (size_t i = 0; i < keys.size(); i++) {
+            cls_lsm_entry entry;
+            EntryFromValues(keys[i], values[i], entry);
+
+            int r = dbClient.cls_lsm_aio_write(ioctx, table, entry);
+            if (r < 0) {
+                ret = r;
+            }
+        }
+
+        // the rows are only stored once level 0 is written out too
+        int r = dbClient.cls_lsm_flush(ioctx);
+        return r < 0 ? r : ret;
+    }
+
+    int CephLsmDB::AsyncInsert(const std::string &table, const std::string &key,
+                               std::vector<KVPair> &values, Callback cb)
+    {
+        cls_lsm_entry entry;
+        EntryFromValues(key, values, entry);
+
+        int r;
+        {
+            std::lock_guard l{client_lock};
+            r = dbClient.cls_lsm_aio_write(ioctx, table, entry);
+        }
+        if (r < 0) {
+            return r;
+        }
+
+        bool flush;
+        {
+            std::lock_guard l{async_lock};
+            async_cbs.push_back(std::move(cb));
+            flush = async_cbs.size() >= async_depth;
+        }
+        if (flush) {
+            WaitForCompletions();
+        }
+        return CephLsmDB::kOK;
+    }
+
+    int CephLsmDB::WaitForCompletions()
+    {
+        std::vector<Callback> cbs;
+        {
+            std::lock_guard l{async_lock};
+            cbs.swap(async_cbs);
+        }
+
+        // the entries still buffered in level 0 are written out too, so
+        // every callback below reports a stored row
+        int r;
+        {
+            std::lock_guard l{client_lock};
+            r = dbClient.cls_lsm_flush(ioctx);
+        }
+        for (auto &cb : cbs) {
+            cb(r < 0 ? r : CephLsmDB::kOK);
+        }
+        return r;
+    }
+
     int CephLsmDB::Update(const std::string &table, const std::string &key, std::vector<KVPair> &values)
     {
         return Insert(table, key, values);
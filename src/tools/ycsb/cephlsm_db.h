@@ -5,6 +5,7 @@
 
 #include <stdlib.h>
 #include <errno.h>
+#include <mutex>
 #include <string>
 
 #include "include/types.h"
@@ -18,6 +19,8 @@
 #include "cls/lsm/cls_lsm_client.h"
 #include "cls/lsm/cls_lsm_ops.h"
 
+#include "rados_aio.h"
+
 using namespace librados;
 
 namespace ycsbc {
@@ -40,6 +43,20 @@ namespace ycsbc {
 
         int Delete(const std::string &table, const std::string &key);
 
+        int BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                      const std::vector<std::string> *fields,
+                      std::vector<std::vector<KVPair>> &results);
+
+        int BatchInsert(const std::string &table, const std::vector<std::string> &keys,
+                        std::vector<std::vector<KVPair>> &values);
+
+        int AsyncInsert(const std::string &table, const std::string &key,
+                        std::vector<KVPair> &values, Callback cb);
+
+        int WaitForCompletions();
+
+        bool GetIOStats(IOStats &stats);
+
         ~CephLsmDB();
     
     private:
@@ -48,6 +65,10 @@ namespace ycsbc {
         IoCtx ioctx;
         ClsLsmClient dbClient;
         unsigned noResult;
+        std::mutex client_lock;  //< the client keeps level 0 in memory
+        std::mutex async_lock;
+        std::vector<Callback> async_cbs;
+        size_t async_depth;
     };
 }
 
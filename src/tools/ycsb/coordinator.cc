@@ -0,0 +1,227 @@
+#include "coordinator.h"
+
+#include <unistd.h>
+#include <errno.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include "include/encoding.h"
+#include "test/librados/test_cxx.h"
+
+using namespace std;
+using namespace librados;
+
+namespace ycsbc {
+
+    static const char *op_names[Coordinator::kNumOps] = {
+        "insert", "read", "update", "scan", "rmw"
+    };
+
+    int OpenPool(const std::string &pool_name, Rados &cluster, IoCtx &ioctx)
+    {
+        std::string err = connect_cluster_pp(cluster);
+        if (err.length()) {
+            cerr << err << endl;
+            return -ENOTCONN;
+        }
+
+        int r = cluster.pool_create(pool_name.c_str());
+        if (r < 0 && r != -EEXIST) {
+            cerr << "cluster.pool_create(" << pool_name << ") failed with error " << r << endl;
+            return r;
+        }
+
+        r = cluster.ioctx_create(pool_name.c_str(), ioctx);
+        if (r < 0) {
+            return r;
+        }
+        ioctx.application_enable("rados", true);
+        return 0;
+    }
+
+    Coordinator::Coordinator(utils::Properties &props) :
+        client_id(stoi(props.GetProperty("clientid", "0"))),
+        client_count(stoi(props.GetProperty("clientcount", "1"))),
+        barrier_oid(props.GetProperty("barrier", "")),
+        result_file(props.GetProperty("resultfile", "")),
+        pool_name(props.GetProperty(CoreWorkload::POOLNAME_PROPERTY, CoreWorkload::POOLNAME_DEFAULT)),
+        connected(false)
+    {
+        if (Enabled() && barrier_oid.empty()) {
+            barrier_oid = "ycsb_barrier";
+        }
+    }
+
+    Coordinator::~Coordinator()
+    {
+        if (connected) {
+            ioctx.close();
+            cluster.shutdown();
+        }
+    }
+
+    void Coordinator::PartitionKeyspace(utils::Properties &props) const
+    {
+        if (!Enabled()) {
+            return;
+        }
+
+        uint64_t records = stoull(props[CoreWorkload::RECORD_COUNT_PROPERTY]);
+        uint64_t per_client = records / client_count;
+        uint64_t start = client_id * per_client;
+        uint64_t count = (client_id == client_count - 1) ? records - start : per_client;
+
+        props.SetProperty(CoreWorkload::INSERT_START_PROPERTY, to_string(start));
+        props.SetProperty(CoreWorkload::INSERT_COUNT_PROPERTY, to_string(count));
+
+        // every client owns its own tree, so in-memory client state such as
+        // the bloom filters and level inventories is never shared
+        props.SetProperty("treename", props["dbname"] + "-client" + to_string(client_id));
+    }
+
+    int Coordinator::Barrier(const std::string &phase)
+    {
+        if (!Enabled()) {
+            return 0;
+        }
+
+        if (!connected) {
+            int r = OpenPool(pool_name, cluster, ioctx);
+            if (r < 0) {
+                cerr << "barrier: cannot open pool " << pool_name << endl;
+                return r;
+            }
+            connected = true;
+        }
+
+        std::string oid = barrier_oid + "." + phase;
+        std::map<std::string, bufferlist> arrival;
+        encode(client_id, arrival["client." + to_string(client_id)]);
+        int r = ioctx.omap_set(oid, arrival);
+        if (r < 0) {
+            cerr << "barrier: cannot register at " << oid << ": " << r << endl;
+            return r;
+        }
+
+        std::map<std::string, bufferlist> arrived;
+        do {
+            bool more = false;
+            arrived.clear();
+            r = ioctx.omap_get_vals2(oid, "", "client.", client_count, &arrived, &more);
+            if (r < 0) {
+                return r;
+            }
+            if ((int)arrived.size() < client_count) {
+                usleep(100000);
+            }
+        } while ((int)arrived.size() < client_count);
+
+        // every client has registered, so nobody polls for a "client." key
+        // any more; the last one to leave removes the barrier object
+        std::map<std::string, bufferlist> departure;
+        encode(client_id, departure["left." + to_string(client_id)]);
+        r = ioctx.omap_set(oid, departure);
+        if (r < 0) {
+            return r;
+        }
+
+        std::map<std::string, bufferlist> left;
+        bool more = false;
+        r = ioctx.omap_get_vals2(oid, "", "left.", client_count, &left, &more);
+        if (r == 0 && (int)left.size() == client_count) {
+            r = ioctx.remove(oid);
+            if (r < 0 && r != -ENOENT) {
+                cerr << "barrier: cannot remove " << oid << ": " << r << endl;
+            }
+        }
+        return 0;
+    }
+
+    void Coordinator::WriteResult(const std::string &phase, int ops, uint64_t use_time,
+                                  const uint64_t *cnt, const uint64_t *time) const
+    {
+        if (result_file.empty()) {
+            return;
+        }
+
+        ofstream out(result_file, ios::app);
+        out << "phase " << phase << " client " << client_id
+            << " ops " << ops << " time_us " << use_time << endl;
+        if (!cnt) {
+            return;
+        }
+        for (int i = 0; i < kNumOps; i++) {
+            if (cnt[i]) {
+                out << "op " << phase << " " << op_names[i]
+                    << " cnt " << cnt[i] << " time_us " << time[i] << endl;
+            }
+        }
+    }
+
+    int MergeResults(const std::vector<std::string> &files)
+    {
+        struct phase_result {
+            int clients = 0;
+            uint64_t ops = 0;
+            uint64_t max_time = 0;
+            std::map<std::string, std::pair<uint64_t, uint64_t>> op_stats;
+        };
+        std::map<std::string, phase_result> phases;
+        std::vector<std::string> order;
+
+        for (auto &file : files) {
+            ifstream in(file);
+            if (!in.is_open()) {
+                cerr << "cannot open result file " << file << endl;
+                return -ENOENT;
+            }
+
+            std::string line;
+            while (getline(in, line)) {
+                istringstream ss(line);
+                std::string kind, phase, tag;
+                ss >> kind >> phase;
+                if (kind.empty()) {
+                    continue;
+                }
+                if (!phases.count(phase)) {
+                    order.push_back(phase);
+                }
+                phase_result &res = phases[phase];
+                if (kind == "phase") {
+                    int client;
+                    uint64_t ops, use_time;
+                    ss >> tag >> client >> tag >> ops >> tag >> use_time;
+                    res.clients++;
+                    res.ops += ops;
+                    res.max_time = max(res.max_time, use_time);
+                } else if (kind == "op") {
+                    std::string name;
+                    uint64_t cnt, time;
+                    ss >> name >> tag >> cnt >> tag >> time;
+                    res.op_stats[name].first += cnt;
+                    res.op_stats[name].second += time;
+                }
+            }
+        }
+
+        for (auto &phase : order) {
+            phase_result &res = phases[phase];
+            if (!res.max_time) {
+                continue;
+            }
+            printf("********** merged %s result (%d clients) **********\n", phase.c_str(), res.clients);
+            printf("all operation records:%lu  use time:%.3f s  IOPS:%.2f iops\n",
+                   res.ops, 1.0 * res.max_time * 1e-6, 1.0 * res.ops * 1e6 / res.max_time);
+            for (auto &op : res.op_stats) {
+                printf("%-10s:%7lu  IOPS:%7.2f iops (%.2f us/op)\n", op.first.c_str(), op.second.first,
+                       1.0 * op.second.first * 1e6 / res.max_time, 1.0 * op.second.second / op.second.first);
+            }
+            printf("********************************\n");
+        }
+        return 0;
+    }
+}
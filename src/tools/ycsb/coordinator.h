@@ -0,0 +1,65 @@
+#ifndef YCSB_C_COORDINATOR_H
+#define YCSB_C_COORDINATOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "include/rados/librados.hpp"
+
+#include "core/properties.h"
+#include "core/core_workload.h"
+
+namespace ycsbc {
+
+    /**
+     * Opens pool_name through a cluster handle owned by the caller, creating
+     * the pool if no other client has done so yet.
+     */
+    int OpenPool(const std::string &pool_name, librados::Rados &cluster, librados::IoCtx &ioctx);
+
+    /**
+     * Lets several ycsbc processes, each with its own Rados instance, run one
+     * workload together. Client <clientid> of <clientcount> owns a contiguous
+     * slice of the keyspace, and every phase starts once all clients have
+     * registered themselves in the omap of the <barrier> RADOS object.
+     * The last client to pass a barrier removes its object.
+     */
+    class Coordinator {
+    public:
+        static const int kNumOps = Operation::READMODIFYWRITE + 1;
+
+        Coordinator(utils::Properties &props);
+        ~Coordinator();
+
+        bool Enabled() const { return client_count > 1; }
+
+        /// restrict the workload in props to this client's slice of the keys
+        void PartitionKeyspace(utils::Properties &props) const;
+
+        /// block until every client has reached the named phase
+        int Barrier(const std::string &phase);
+
+        /// append this client's numbers for one phase to the result file
+        void WriteResult(const std::string &phase, int ops, uint64_t use_time,
+                         const uint64_t *cnt, const uint64_t *time) const;
+
+    private:
+        int client_id;
+        int client_count;
+        std::string barrier_oid;
+        std::string result_file;
+        std::string pool_name;
+        librados::Rados cluster;
+        librados::IoCtx ioctx;
+        bool connected;
+    };
+
+    /**
+     * Combines the result files written by every client and prints aggregate
+     * throughput and latency per phase and per operation type.
+     */
+    int MergeResults(const std::vector<std::string> &files);
+}
+
+#endif
@@ -19,6 +19,8 @@ using namespace std;
 
 extern atomic<uint64_t> ops_cnt[ycsbc::Operation::READMODIFYWRITE + 1] ;    //操作个数
 extern atomic<uint64_t> ops_time[ycsbc::Operation::READMODIFYWRITE + 1] ;   //微秒
+extern atomic<uint64_t> logical_bytes_written;  // user key/value bytes written
+extern atomic<uint64_t> logical_bytes_read;     // user key/value bytes returned
 
 namespace ycsbc {
 
@@ -27,6 +29,8 @@ class Client {
   Client(DB &db, CoreWorkload &wl) : db_(db), workload_(wl) { }
   
   virtual bool DoInsert();
+  virtual int DoInsertBatch(int batch_size);
+  virtual bool DoAsyncInsert(std::atomic<int> &oks);
   virtual bool DoTransaction();
   
   virtual ~Client() { }
@@ -38,18 +42,68 @@ class Client {
   virtual int TransactionScan();
   virtual int TransactionUpdate();
   virtual int TransactionInsert();
+
+  static uint64_t RecordBytes(const std::string &key,
+                              const std::vector<DB::KVPair> &values);
+  static void AddWritten(const std::string &key,
+                         const std::vector<DB::KVPair> &values) {
+    logical_bytes_written.fetch_add(RecordBytes(key, values), std::memory_order_relaxed);
+  }
+  static void AddRead(const std::string &key,
+                      const std::vector<DB::KVPair> &values) {
+    if (values.empty()) {
+      return;
+    }
+    logical_bytes_read.fetch_add(RecordBytes(key, values), std::memory_order_relaxed);
+  }
   
   DB &db_;
   CoreWorkload &workload_;
 };
 
+inline uint64_t Client::RecordBytes(const std::string &key,
+                                    const std::vector<DB::KVPair> &values) {
+  uint64_t bytes = key.size();
+  for (auto &v : values) {
+    bytes += v.first.size() + v.second.size();
+  }
+  return bytes;
+}
+
 inline bool Client::DoInsert() {
   std::string key = workload_.NextSequenceKey();
   std::vector<DB::KVPair> pairs;
   workload_.BuildValues(pairs);
+  AddWritten(key, pairs);
   return (db_.Insert(workload_.NextTable(), key, pairs) == DB::kOK);
 }
 
+inline int Client::DoInsertBatch(int batch_size) {
+  std::vector<std::string> keys;
+  std::vector<std::vector<DB::KVPair>> values(batch_size);
+  for (int i = 0; i < batch_size; ++i) {
+    keys.push_back(workload_.NextSequenceKey());
+    workload_.BuildValues(values[i]);
+    AddWritten(keys[i], values[i]);
+  }
+  if (db_.BatchInsert(workload_.NextTable(), keys, values) != DB::kOK) {
+    return 0;
+  }
+  return batch_size;
+}
+
+inline bool Client::DoAsyncInsert(std::atomic<int> &oks) {
+  std::string key = workload_.NextSequenceKey();
+  std::vector<DB::KVPair> pairs;
+  workload_.BuildValues(pairs);
+  AddWritten(key, pairs);
+  return (db_.AsyncInsert(workload_.NextTable(), key, pairs, [&oks](int r) {
+    if (r == DB::kOK) {
+      oks.fetch_add(1, std::memory_order_relaxed);
+    }
+  }) == DB::kOK);
+}
+
 inline bool Client::DoTransaction() {
   int status = -1;
   uint64_t start_time = get_now_micros();
@@ -91,14 +145,17 @@ inline int Client::TransactionRead() {
   const std::string &table = workload_.NextTable();
   const std::string &key = workload_.NextTransactionKey();
   std::vector<DB::KVPair> result;
+  int r;
   if (!workload_.read_all_fields()) {
     std::vector<std::string> fields;
     //fields.push_back("field" + workload_.NextFieldName());
     fields.push_back("field1");
-    return db_.Read(table, key, &fields, result);
+    r = db_.Read(table, key, &fields, result);
   } else {
-    return db_.Read(table, key, NULL, result);
+    r = db_.Read(table, key, NULL, result);
   }
+  AddRead(key, result);
+  return r;
 }
 
 inline int Client::TransactionReadModifyWrite() {
@@ -114,6 +171,7 @@ inline int Client::TransactionReadModifyWrite() {
   } else {
     db_.Read(table, key, NULL, result);
   }
+  AddRead(key, result);
 
   std::vector<DB::KVPair> values;
   if (workload_.write_all_fields()) {
@@ -121,6 +179,7 @@ inline int Client::TransactionReadModifyWrite() {
   } else {
     workload_.BuildUpdate(values);
   }
+  AddWritten(key, values);
   return db_.Update(table, key, values);
 }
 
@@ -133,14 +192,19 @@ inline int Client::TransactionScan() {
   workload_.NextTransactionScanKey(key, max_key);
   int len = workload_.NextScanLength();
   std::vector<std::vector<DB::KVPair>> result;
+  int r;
   if (!workload_.read_all_fields()) {
     std::vector<std::string> fields;
     //fields.push_back("field" + workload_.NextFieldName());
     fields.push_back("field1");
-    return db_.Scan(table, key, max_key, len, &fields, result);
+    r = db_.Scan(table, key, max_key, len, &fields, result);
   } else {
-    return db_.Scan(table, key, max_key, len, NULL, result);
+    r = db_.Scan(table, key, max_key, len, NULL, result);
+  }
+  for (auto &record : result) {
+    AddRead("", record);
   }
+  return r;
 }
 
 inline int Client::TransactionUpdate() {
@@ -152,6 +216,7 @@ inline int Client::TransactionUpdate() {
   } else {
     workload_.BuildUpdate(values);
   }
+  AddWritten(key, values);
   return db_.Update(table, key, values);
 }
 
@@ -160,6 +225,7 @@ inline int Client::TransactionInsert() {
   const std::string &key = workload_.NextSequenceKey();
   std::vector<DB::KVPair> values;
   workload_.BuildValues(values);
+  AddWritten(key, values);
   return db_.Insert(table, key, values);
 } 
 
@@ -76,6 +76,8 @@ const string CoreWorkload::INSERT_ORDER_DEFAULT = "hashed";
 const string CoreWorkload::INSERT_START_PROPERTY = "insertstart";
 const string CoreWorkload::INSERT_START_DEFAULT = "0";
 
+const string CoreWorkload::INSERT_COUNT_PROPERTY = "insertcount";
+
 const string CoreWorkload::RECORD_COUNT_PROPERTY = "recordcount";
 const string CoreWorkload::OPERATION_COUNT_PROPERTY = "operationcount";
 
@@ -111,6 +113,8 @@ void CoreWorkload::Init(const utils::Properties &p) {
                                             SCAN_LENGTH_DISTRIBUTION_DEFAULT);
   int insert_start = std::stoi(p.GetProperty(INSERT_START_PROPERTY,
                                              INSERT_START_DEFAULT));
+  size_t insert_count = std::stoul(p.GetProperty(INSERT_COUNT_PROPERTY,
+                                   std::to_string(record_count_ - insert_start)));
   
   read_all_fields_ = utils::StrToBool(p.GetProperty(READ_ALL_FIELDS_PROPERTY,
                                                     READ_ALL_FIELDS_DEFAULT));
@@ -141,10 +145,10 @@ void CoreWorkload::Init(const utils::Properties &p) {
     op_chooser_.AddValue(READMODIFYWRITE, readmodifywrite_proportion);
   }
   
-  insert_key_sequence_.Set(record_count_);
+  insert_key_sequence_.Set(insert_start + insert_count);
   
   if (request_dist == "uniform") {
-    key_chooser_ = new UniformGenerator(0, record_count_ - 1);
+    key_chooser_ = new UniformGenerator(insert_start, insert_start + insert_count - 1);
     
   } else if (request_dist == "zipfian") {
     // If the number of keys changes, we don't want to change popular keys.
@@ -154,7 +158,8 @@ void CoreWorkload::Init(const utils::Properties &p) {
     // and pick another key.
     int op_count = std::stoi(p.GetProperty(OPERATION_COUNT_PROPERTY));
     int new_keys = (int)(op_count * insert_proportion * 2); // a fudge factor
-    key_chooser_ = new ScrambledZipfianGenerator(record_count_ + new_keys);
+    key_chooser_ = new ScrambledZipfianGenerator(insert_start,
+        insert_start + insert_count + new_keys - 1);
     
   } else if (request_dist == "latest") {
     key_chooser_ = new SkewedLatestGenerator(insert_key_sequence_);
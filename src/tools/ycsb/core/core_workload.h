@@ -140,6 +140,13 @@ class CoreWorkload {
 
   static const std::string INSERT_START_PROPERTY;
   static const std::string INSERT_START_DEFAULT;
+
+  ///
+  /// The name of the property for the number of records, starting at
+  /// insertstart, that this client loads and runs transactions against.
+  /// Defaults to recordcount - insertstart.
+  ///
+  static const std::string INSERT_COUNT_PROPERTY;
   
   static const std::string RECORD_COUNT_PROPERTY;
   static const std::string OPERATION_COUNT_PROPERTY;
@@ -11,12 +11,25 @@
 
 #include <vector>
 #include <string>
+#include <functional>
+#include <cstdint>
 
 namespace ycsbc {
 
 class DB {
  public:
   typedef std::pair<std::string, std::string> KVPair;
+  typedef std::function<void(int)> Callback;
+  ///
+  /// Cumulative storage-level I/O of a back-end, used to derive
+  /// write/read/space amplification per phase.
+  ///
+  struct IOStats {
+    uint64_t bytes_written = 0; ///< bytes written to storage, incl. WAL, flush and compaction
+    uint64_t bytes_read = 0;    ///< bytes read from storage, incl. compaction
+    uint64_t space_used = 0;    ///< bytes currently occupied on storage
+    uint64_t live_bytes = 0;    ///< back-end estimate of live user data, 0 if unknown
+  };
   static const int kOK = 0;
   static const int kErrorNoData = 1;
   static const int kErrorConflict = 2;
@@ -89,10 +102,80 @@ class DB {
   /// @return Zero on success, a non-zero error code on error.
   ///
   virtual int Delete(const std::string &table, const std::string &key) = 0;
+  ///
+  /// Reads a batch of records from the database.
+  /// The default implementation issues one Read per key.
+  ///
+  /// @param table The name of the table.
+  /// @param keys The keys of the records to read.
+  /// @param fields The list of fields to read, or NULL for all of them.
+  /// @param results One vector of field/value pairs per key, in key order.
+  /// @return Zero on success, or a non-zero error code if any read failed.
+  ///
+  virtual int BatchRead(const std::string &table,
+                        const std::vector<std::string> &keys,
+                        const std::vector<std::string> *fields,
+                        std::vector<std::vector<KVPair>> &results) {
+    int ret = kOK;
+    results.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      int r = Read(table, keys[i], fields, results[i]);
+      if (r != kOK) {
+        ret = r;
+      }
+    }
+    return ret;
+  }
+  ///
+  /// Inserts a batch of records into the database.
+  /// The default implementation issues one Insert per record.
+  ///
+  /// @param table The name of the table.
+  /// @param keys The keys of the records to insert.
+  /// @param values One vector of field/value pairs per key.
+  /// @return Zero on success, or a non-zero error code if any insert failed.
+  ///
+  virtual int BatchInsert(const std::string &table,
+                          const std::vector<std::string> &keys,
+                          std::vector<std::vector<KVPair>> &values) {
+    int ret = kOK;
+    for (size_t i = 0; i < keys.size(); i++) {
+      int r = Insert(table, keys[i], values[i]);
+      if (r != kOK) {
+        ret = r;
+      }
+    }
+    return ret;
+  }
+  ///
+  /// Starts inserting a record; cb is invoked with the Insert return code
+  /// once the record is durable. The default implementation is synchronous.
+  ///
+  /// @return Zero if the insert was issued, a non-zero error code otherwise.
+  ///
+  virtual int AsyncInsert(const std::string &table, const std::string &key,
+                          std::vector<KVPair> &values, Callback cb) {
+    cb(Insert(table, key, values));
+    return kOK;
+  }
+  ///
+  /// Waits for every outstanding AsyncInsert to complete and for its
+  /// callback to run.
+  ///
+  /// @return Zero on success, or the first non-zero completion code.
+  ///
+  virtual int WaitForCompletions() { return kOK; }
 
   virtual bool HaveBalancedDistribution() { return true; };
 
   virtual void PrintStats() {};
+
+  ///
+  /// Fills stats with the back-end's cumulative I/O counters.
+  ///
+  /// @return false if the back-end cannot account for its I/O.
+  ///
+  virtual bool GetIOStats(IOStats &stats) { return false; }
   
   virtual ~DB() { }
 };
@@ -0,0 +1,169 @@
+#ifndef YCSB_C_RADOS_AIO_H
+#define YCSB_C_RADOS_AIO_H
+
+#include "core/db.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "include/rados/librados.hpp"
+#include "cls/lsm/cls_lsm_types.h"
+
+namespace ycsbc {
+
+    /**
+     * Tracks the librados completions issued by the cls_lsm back-ends and
+     * the callbacks waiting on them. Shared by all client threads.
+     */
+    class AioTracker {
+    public:
+        void Add(librados::AioCompletion *c, DB::Callback cb) {
+            std::lock_guard l{lock};
+            pending.emplace_back(c, std::move(cb));
+        }
+
+        size_t Pending() {
+            std::lock_guard l{lock};
+            return pending.size();
+        }
+
+        /// wait for every tracked completion, run its callback and release it;
+        /// returns only after a concurrent Drain has finished too
+        int Drain() {
+            std::lock_guard dl{drain_lock};
+            std::vector<std::pair<librados::AioCompletion*, DB::Callback>> ops;
+            {
+                std::lock_guard l{lock};
+                ops.swap(pending);
+            }
+
+            int ret = DB::kOK;
+            for (auto &op : ops) {
+                op.first->wait_for_complete();
+                int r = op.first->get_return_value();
+                if (r < 0 && ret == DB::kOK) {
+                    ret = r;
+                }
+                op.second(r < 0 ? r : DB::kOK);
+                op.first->release();
+            }
+            return ret;
+        }
+
+    private:
+        std::mutex drain_lock;
+        std::mutex lock;
+        std::vector<std::pair<librados::AioCompletion*, DB::Callback>> pending;
+    };
+
+    inline void EntryFromValues(const std::string &key, std::vector<DB::KVPair> &values,
+                                cls_lsm_entry &entry)
+    {
+        entry.key = strtoul(key.c_str(), nullptr, 10);
+
+        for (auto value : values) {
+            bufferlist bl;
+            encode(value.second, bl);
+            entry.value.insert(std::pair<std::string, bufferlist>(value.first, bl));
+        }
+    }
+
+    inline int EntryFields(const cls_lsm_entry &entry, std::vector<DB::KVPair> &result)
+    {
+        try {
+            for (auto &value : entry.value) {
+                std::string field;
+                auto vit = value.second.cbegin();
+                decode(field, vit);
+                result.emplace_back(value.first, field);
+            }
+        } catch (ceph::buffer::error &err) {
+            return -EIO;
+        }
+        return DB::kOK;
+    }
+
+    inline int EntryToValues(bufferlist &bl, std::vector<DB::KVPair> &result)
+    {
+        cls_lsm_entry entry;
+        try {
+            auto it = bl.cbegin();
+            decode(entry, it);
+        } catch (ceph::buffer::error &err) {
+            return -EIO;
+        }
+        return EntryFields(entry, result);
+    }
+
+    /**
+     * Fills the amplification counters from the pool statistics. These are
+     * cluster-wide, include every client of the pool and are refreshed lazily
+     * by the OSDs, so deltas over a short phase are approximate.
+     */
+    inline bool PoolIOStats(librados::Rados &cluster, const std::string &pool_name,
+                            DB::IOStats &stats)
+    {
+        std::list<std::string> pools = { pool_name };
+        std::map<std::string, librados::pool_stat_t> pool_stats;
+        if (cluster.get_pool_stats(pools, pool_stats) < 0 || !pool_stats.count(pool_name)) {
+            return false;
+        }
+        const librados::pool_stat_t &s = pool_stats[pool_name];
+        stats.bytes_written = s.num_wr_kb * 1024;
+        stats.bytes_read = s.num_rd_kb * 1024;
+        stats.space_used = s.num_bytes;
+        stats.live_bytes = 0;
+        return true;
+    }
+
+    /**
+     * Issues one asynchronous read per key through read_fn and waits for all
+     * of them. read_fn has the signature of the cls_*_aio_read client calls.
+     */
+    template <typename ReadFn>
+    int AioBatchRead(const std::vector<std::string> &keys,
+                     std::vector<std::vector<DB::KVPair>> &results,
+                     ReadFn &&read_fn)
+    {
+        std::vector<librados::AioCompletion*> completions(keys.size(), nullptr);
+        std::vector<bufferlist> outs(keys.size());
+        std::vector<char> gathered(keys.size(), false);
+        results.resize(keys.size());
+
+        int ret = DB::kOK;
+        for (size_t i = 0; i < keys.size(); i++) {
+            bool g = false;
+            completions[i] = librados::Rados::aio_create_completion();
+            int r = read_fn(strtoul(keys[i].c_str(), nullptr, 10), completions[i], &outs[i], &g);
+            gathered[i] = g;
+            if (r < 0) {
+                completions[i]->release();
+                completions[i] = nullptr;
+                ret = DB::kErrorNoData;
+            }
+        }
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (!completions[i]) {
+                continue;
+            }
+            completions[i]->wait_for_complete();
+            int r = completions[i]->get_return_value();
+            completions[i]->release();
+            if (r < 0) {
+                ret = r;
+                continue;
+            }
+            // gather results are not an encoded entry; like Read, leave them undecoded
+            if (!gathered[i] && EntryToValues(outs[i], results[i]) < 0) {
+                ret = -EIO;
+            }
+        }
+        return ret;
+    }
+}
+
+#endif
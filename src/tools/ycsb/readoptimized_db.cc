@@ -1,4 +1,5 @@
 #include "core/core_workload.h"
+#include "coordinator.h"
 #include "readoptimized_db.h"
 
 using namespace std;
@@ -7,10 +8,8 @@ namespace ycsbc {
 
     ReadOptimizedDB::ReadOptimizedDB(utils::Properties& props) {
 
-        std::string pool_name = props.GetProperty(CoreWorkload::POOLNAME_PROPERTY,CoreWorkload::POOLNAME_DEFAULT);
-        create_one_pool_pp(pool_name, cluster);
-
-        int s = cluster.ioctx_create(pool_name.c_str(), ioctx);
+        pool_name = props.GetProperty(CoreWorkload::POOLNAME_PROPERTY,CoreWorkload::POOLNAME_DEFAULT);
+        int s = OpenPool(pool_name, cluster, ioctx);
         if (s != 0) {
             cerr << "Cannot open ceph db " << pool_name << endl;
             exit(0);
@@ -42,7 +41,13 @@ namespace ycsbc {
             col_map[i] = cols_0;
         }
 
-        dbClient.InitClient(props["dbname"], 0, 10240000000000000, field_count, levels, col_map);
+        dbClient.InitClient(props.GetProperty("treename", props["dbname"]), 0, 10240000000000000, field_count, levels, col_map);
+
+        async_depth = stoul(props.GetProperty("asyncdepth", "64"));
+
+        // only on request, and never while other clients still use the pool
+        destroy_pool = props.GetProperty("destroypool", "false") == "true" &&
+                       stoi(props.GetProperty("clientcount", "1")) <= 1;
     }
 
     int ReadOptimizedDB::Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
@@ -50,9 +55,15 @@ namespace ycsbc {
     {
         cls_lsm_entry return_entry;
         dbClient.cls_read_optimized_read(ioctx, table, strtoul(key.c_str(), nullptr, 10), fields, return_entry);
+        EntryFields(return_entry, result);
         return ReadOptimizedDB::kOK;
     }
 
+    bool ReadOptimizedDB::GetIOStats(IOStats &stats)
+    {
+        return PoolIOStats(cluster, pool_name, stats);
+    }
+
     int ReadOptimizedDB::Scan(const std::string &table, const std::string &key, const std::string &max_key, int len,
                         const std::vector<std::string> *fields, std::vector<std::vector<KVPair>> &result) 
     {
@@ -64,13 +75,7 @@ namespace ycsbc {
     int ReadOptimizedDB::Insert(const std::string &table, const std::string &key, std::vector<KVPair> &values)
     {
         cls_lsm_entry entry;
-        entry.key = strtoul(key.c_str(), nullptr, 10);
-        
-        for (auto value : values) {
-            bufferlist bl;
-            encode(value.second, bl);
-            entry.value.insert(std::pair<std::string, bufferlist>(value.first, bl));
-        }
+        EntryFromValues(key, values, entry);
 
         dbClient.cls_read_optimized_write(ioctx, table, entry);
 
@@ -93,9 +98,75 @@ namespace ycsbc {
         return ReadOptimizedDB::kOK;
     }
 
+    int ReadOptimizedDB::BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                      const std::vector<std::string> *fields,
+                      std::vector<std::vector<KVPair>> &results)
+    {
+        return AioBatchRead(keys, results,
+            [&](uint64_t key, librados::AioCompletion *c, bufferlist *out, bool *gathered) {
+                return dbClient.cls_read_optimized_aio_read(ioctx, table, key, fields, c, out, gathered);
+            });
+    }
+
+    int ReadOptimizedDB::BatchInsert(const std::string &table, const std::vector<std::string> &keys,
+                        std::vector<std::vector<KVPair>> &values)
+    {
+        std::vector<librados::AioCompletion*> completions;
+        int ret = ReadOptimizedDB::kOK;
+        for (size_t i = 0; i < keys.size(); i++) {
+            cls_lsm_entry entry;
+            EntryFromValues(keys[i], values[i], entry);
+
+            librados::AioCompletion *c = librados::Rados::aio_create_completion();
+            int r = dbClient.cls_read_optimized_aio_write(ioctx, table, entry, c);
+            if (r < 0) {
+                c->release();
+                ret = r;
+                continue;
+            }
+            completions.push_back(c);
+        }
+
+        for (auto c : completions) {
+            c->wait_for_complete();
+            int r = c->get_return_value();
+            if (r < 0) {
+                ret = r;
+            }
+            c->release();
+        }
+        return ret;
+    }
+
+    int ReadOptimizedDB::AsyncInsert(const std::string &table, const std::string &key,
+                        std::vector<KVPair> &values, Callback cb)
+    {
+        cls_lsm_entry entry;
+        EntryFromValues(key, values, entry);
+
+        librados::AioCompletion *c = librados::Rados::aio_create_completion();
+        int r = dbClient.cls_read_optimized_aio_write(ioctx, table, entry, c);
+        if (r < 0) {
+            c->release();
+            return r;
+        }
+        aio_tracker.Add(c, std::move(cb));
+        if (aio_tracker.Pending() >= async_depth) {
+            aio_tracker.Drain();
+        }
+        return ReadOptimizedDB::kOK;
+    }
+
+    int ReadOptimizedDB::WaitForCompletions()
+    {
+        return aio_tracker.Drain();
+    }
+
     ReadOptimizedDB::~ReadOptimizedDB() {
         ioctx.close();
-        destroy_one_pool_pp(pool_name, cluster);
+        if (destroy_pool) {
+            destroy_one_pool_pp(pool_name, cluster);
+        }
     }
 
 }
\ No newline at end of file
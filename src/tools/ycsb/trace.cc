@@ -0,0 +1,297 @@
+#include "trace.h"
+
+#include <errno.h>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include "core/core_workload.h"
+
+using namespace std;
+
+namespace ycsbc {
+
+    static const char trace_magic[] = "YCSBTRC1";
+
+    int TraceWriter::Open(const std::string &path)
+    {
+        out.open(path, ios::binary | ios::trunc);
+        if (!out.is_open()) {
+            cerr << "cannot create trace file " << path << endl;
+            return -EIO;
+        }
+        out.write(trace_magic, sizeof(trace_magic) - 1);
+        start = chrono::steady_clock::now();
+        return 0;
+    }
+
+    void TraceWriter::Append(TraceRecord &rec)
+    {
+        std::lock_guard l{lock};
+        rec.ts = chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - start).count();
+        bufferlist bl;
+        encode(rec, bl);
+        uint32_t len = bl.length();
+        out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        bl.write_stream(out);
+    }
+
+    void TraceWriter::Close()
+    {
+        std::lock_guard l{lock};
+        if (out.is_open()) {
+            out.close();
+        }
+    }
+
+    void TracingDB::RecordRead(uint8_t op, const std::string &table, const std::string &key,
+                               const std::vector<std::string> *fields)
+    {
+        TraceRecord rec;
+        rec.op = op;
+        rec.table = table;
+        rec.key = key;
+        if (fields) {
+            rec.all_fields = false;
+            rec.fields = *fields;
+        }
+        writer->Append(rec);
+    }
+
+    void TracingDB::RecordWrite(uint8_t op, const std::string &table, const std::string &key,
+                                const std::vector<KVPair> &values)
+    {
+        TraceRecord rec;
+        rec.op = op;
+        rec.table = table;
+        rec.key = key;
+        for (auto &value : values) {
+            rec.values.emplace_back(value.first, value.second.size());
+        }
+        writer->Append(rec);
+    }
+
+    int TracingDB::Read(const std::string &table, const std::string &key,
+                        const std::vector<std::string> *fields,
+                        std::vector<KVPair> &result)
+    {
+        RecordRead(TRACE_READ, table, key, fields);
+        return db->Read(table, key, fields, result);
+    }
+
+    int TracingDB::Scan(const std::string &table, const std::string &key, const std::string &max_key,
+                        int len, const std::vector<std::string> *fields,
+                        std::vector<std::vector<KVPair>> &result)
+    {
+        TraceRecord rec;
+        rec.op = TRACE_SCAN;
+        rec.table = table;
+        rec.key = key;
+        rec.max_key = max_key;
+        rec.len = len;
+        if (fields) {
+            rec.all_fields = false;
+            rec.fields = *fields;
+        }
+        writer->Append(rec);
+        return db->Scan(table, key, max_key, len, fields, result);
+    }
+
+    int TracingDB::Insert(const std::string &table, const std::string &key,
+                          std::vector<KVPair> &values)
+    {
+        RecordWrite(TRACE_INSERT, table, key, values);
+        return db->Insert(table, key, values);
+    }
+
+    int TracingDB::Update(const std::string &table, const std::string &key,
+                          std::vector<KVPair> &values)
+    {
+        RecordWrite(TRACE_UPDATE, table, key, values);
+        return db->Update(table, key, values);
+    }
+
+    int TracingDB::Delete(const std::string &table, const std::string &key)
+    {
+        TraceRecord rec;
+        rec.op = TRACE_DELETE;
+        rec.table = table;
+        rec.key = key;
+        writer->Append(rec);
+        return db->Delete(table, key);
+    }
+
+    int TracingDB::BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                             const std::vector<std::string> *fields,
+                             std::vector<std::vector<KVPair>> &results)
+    {
+        for (auto &key : keys) {
+            RecordRead(TRACE_READ, table, key, fields);
+        }
+        return db->BatchRead(table, keys, fields, results);
+    }
+
+    int TracingDB::BatchInsert(const std::string &table, const std::vector<std::string> &keys,
+                               std::vector<std::vector<KVPair>> &values)
+    {
+        for (size_t i = 0; i < keys.size(); i++) {
+            RecordWrite(TRACE_INSERT, table, keys[i], values[i]);
+        }
+        return db->BatchInsert(table, keys, values);
+    }
+
+    int TracingDB::AsyncInsert(const std::string &table, const std::string &key,
+                               std::vector<KVPair> &values, Callback cb)
+    {
+        RecordWrite(TRACE_INSERT, table, key, values);
+        return db->AsyncInsert(table, key, values, cb);
+    }
+
+    TracingDB::~TracingDB()
+    {
+        writer->Close();
+        delete db;
+    }
+
+    int TraceReplayer::Load(const std::string &path)
+    {
+        ifstream in(path, ios::binary);
+        if (!in.is_open()) {
+            cerr << "cannot open trace file " << path << endl;
+            return -ENOENT;
+        }
+
+        char magic[sizeof(trace_magic) - 1];
+        if (!in.read(magic, sizeof(magic)) ||
+            string(magic, sizeof(magic)) != string(trace_magic, sizeof(magic))) {
+            cerr << path << " is not a ycsb trace" << endl;
+            return -EINVAL;
+        }
+
+        records.clear();
+        uint32_t len;
+        while (in.read(reinterpret_cast<char*>(&len), sizeof(len))) {
+            bufferptr bp(len);
+            if (!in.read(bp.c_str(), len)) {
+                cerr << "truncated trace record at " << records.size() << endl;
+                break;
+            }
+            bufferlist bl;
+            bl.append(std::move(bp));
+            auto p = bl.cbegin();
+            TraceRecord rec;
+            try {
+                decode(rec, p);
+            } catch (ceph::buffer::error &err) {
+                cerr << "corrupt trace record at " << records.size() << endl;
+                return -EIO;
+            }
+            records.push_back(std::move(rec));
+        }
+        return 0;
+    }
+
+    /// field values of the captured length, identical on every replay
+    static void BuildValues(const TraceRecord &rec, std::vector<DB::KVPair> &values)
+    {
+        std::minstd_rand gen(std::hash<std::string>()(rec.key));
+        std::uniform_int_distribution<int> dist(' ', '~');
+        for (auto &field : rec.values) {
+            std::string value;
+            value.reserve(field.second);
+            for (uint32_t i = 0; i < field.second; i++) {
+                value.push_back(dist(gen));
+            }
+            values.emplace_back(field.first, value);
+        }
+    }
+
+    int TraceReplayer::ReplayPart(DB *db, int part, int threads, double speed,
+                                  chrono::steady_clock::time_point start,
+                                  std::atomic<uint64_t> *cnt, std::atomic<uint64_t> *time)
+    {
+        db->Init();
+        std::hash<std::string> hasher;
+        int oks = 0;
+
+        for (auto &rec : records) {
+            if ((int)(hasher(rec.key) % threads) != part) {
+                continue;
+            }
+            if (speed > 0) {
+                this_thread::sleep_until(start + chrono::microseconds((uint64_t)(rec.ts / speed)));
+            }
+
+            auto op_start = chrono::steady_clock::now();
+            int r = DB::kOK;
+            int counted = -1;
+            const std::vector<std::string> *fields = rec.all_fields ? nullptr : &rec.fields;
+            switch (rec.op) {
+                case TRACE_READ: {
+                    std::vector<DB::KVPair> result;
+                    r = db->Read(rec.table, rec.key, fields, result);
+                    counted = READ;
+                    break;
+                }
+                case TRACE_SCAN: {
+                    std::vector<std::vector<DB::KVPair>> result;
+                    r = db->Scan(rec.table, rec.key, rec.max_key, rec.len, fields, result);
+                    counted = SCAN;
+                    break;
+                }
+                case TRACE_INSERT: {
+                    std::vector<DB::KVPair> values;
+                    BuildValues(rec, values);
+                    r = db->Insert(rec.table, rec.key, values);
+                    counted = INSERT;
+                    break;
+                }
+                case TRACE_UPDATE: {
+                    std::vector<DB::KVPair> values;
+                    BuildValues(rec, values);
+                    r = db->Update(rec.table, rec.key, values);
+                    counted = UPDATE;
+                    break;
+                }
+                case TRACE_DELETE:
+                    r = db->Delete(rec.table, rec.key);
+                    break;
+                default:
+                    cerr << "unknown trace op " << (int)rec.op << endl;
+                    continue;
+            }
+
+            if (counted >= 0) {
+                uint64_t us = chrono::duration_cast<chrono::microseconds>(
+                    chrono::steady_clock::now() - op_start).count();
+                cnt[counted].fetch_add(1, std::memory_order_relaxed);
+                time[counted].fetch_add(us, std::memory_order_relaxed);
+            }
+            if (r == DB::kOK) {
+                oks++;
+            }
+        }
+        db->Close();
+        return oks;
+    }
+
+    int TraceReplayer::Replay(DB *db, int threads, double speed,
+                              std::atomic<uint64_t> *cnt, std::atomic<uint64_t> *time)
+    {
+        // all threads share one time origin so cross-key ordering follows the trace
+        auto start = chrono::steady_clock::now();
+        std::vector<future<int>> parts;
+        for (int i = 0; i < threads; i++) {
+            parts.emplace_back(async(launch::async, &TraceReplayer::ReplayPart, this,
+                                     db, i, threads, speed, start, cnt, time));
+        }
+        int oks = 0;
+        for (auto &part : parts) {
+            oks += part.get();
+        }
+        return oks;
+    }
+}
@@ -0,0 +1,172 @@
+#ifndef YCSB_C_TRACE_H
+#define YCSB_C_TRACE_H
+
+#include "core/db.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "include/types.h"
+
+namespace ycsbc {
+
+    enum TraceOp : uint8_t {
+        TRACE_READ = 1,
+        TRACE_SCAN,
+        TRACE_INSERT,
+        TRACE_UPDATE,
+        TRACE_DELETE
+    };
+
+    /**
+     * One DB call as seen by the back-end. Values are not kept, only the
+     * length of every field; replay regenerates them deterministically.
+     */
+    struct TraceRecord {
+        uint8_t op = 0;
+        uint64_t ts = 0;            // microseconds since the trace was opened
+        std::string table;
+        std::string key;
+        std::string max_key;        // scan only
+        int32_t len = 0;            // scan only
+        bool all_fields = true;     // read/scan: fields == NULL
+        std::vector<std::string> fields;
+        std::vector<std::pair<std::string, uint32_t>> values;   // insert/update
+
+        void encode(ceph::buffer::list& bl) const {
+            ENCODE_START(1, 1, bl);
+            encode(op, bl);
+            encode(ts, bl);
+            encode(table, bl);
+            encode(key, bl);
+            encode(max_key, bl);
+            encode(len, bl);
+            encode(all_fields, bl);
+            encode(fields, bl);
+            encode(values, bl);
+            ENCODE_FINISH(bl);
+        }
+
+        void decode(ceph::buffer::list::const_iterator& bl) {
+            DECODE_START(1, bl);
+            decode(op, bl);
+            decode(ts, bl);
+            decode(table, bl);
+            decode(key, bl);
+            decode(max_key, bl);
+            decode(len, bl);
+            decode(all_fields, bl);
+            decode(fields, bl);
+            decode(values, bl);
+            DECODE_FINISH(bl);
+        }
+    };
+    WRITE_CLASS_ENCODER(TraceRecord)
+
+    /**
+     * Appends TraceRecords to a binary file:
+     *   "YCSBTRC1" { u32 length, encoded TraceRecord }*
+     * Safe to share between client threads.
+     */
+    class TraceWriter {
+    public:
+        int Open(const std::string &path);
+        void Append(TraceRecord &rec);
+        void Close();
+
+    private:
+        std::mutex lock;
+        std::ofstream out;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /**
+     * Wraps any DB and records every call made through it. Batched and
+     * asynchronous inserts are recorded per key and still issued as a batch.
+     */
+    class TracingDB : public DB {
+    public:
+        TracingDB(DB *db, TraceWriter *writer) : db(db), writer(writer) {}
+
+        void Init() { db->Init(); }
+        void Close() { db->Close(); }
+
+        int Read(const std::string &table, const std::string &key,
+                 const std::vector<std::string> *fields,
+                 std::vector<KVPair> &result);
+
+        int Scan(const std::string &table, const std::string &key, const std::string &max_key,
+                 int len, const std::vector<std::string> *fields,
+                 std::vector<std::vector<KVPair>> &result);
+
+        int Insert(const std::string &table, const std::string &key,
+                   std::vector<KVPair> &values);
+
+        int Update(const std::string &table, const std::string &key,
+                   std::vector<KVPair> &values);
+
+        int Delete(const std::string &table, const std::string &key);
+
+        int BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                      const std::vector<std::string> *fields,
+                      std::vector<std::vector<KVPair>> &results);
+
+        int BatchInsert(const std::string &table, const std::vector<std::string> &keys,
+                        std::vector<std::vector<KVPair>> &values);
+
+        int AsyncInsert(const std::string &table, const std::string &key,
+                        std::vector<KVPair> &values, Callback cb);
+
+        int WaitForCompletions() { return db->WaitForCompletions(); }
+
+        bool HaveBalancedDistribution() { return db->HaveBalancedDistribution(); }
+
+        void PrintStats() { db->PrintStats(); }
+
+        bool GetIOStats(IOStats &stats) { return db->GetIOStats(stats); }
+
+        ~TracingDB();
+
+    private:
+        DB *db;
+        TraceWriter *writer;
+
+        void RecordRead(uint8_t op, const std::string &table, const std::string &key,
+                        const std::vector<std::string> *fields);
+        void RecordWrite(uint8_t op, const std::string &table, const std::string &key,
+                         const std::vector<KVPair> &values);
+    };
+
+    /**
+     * Replays a trace against a DB. Records are spread over the threads by
+     * key hash, so every key sees its operations in the captured order.
+     */
+    class TraceReplayer {
+    public:
+        int Load(const std::string &path);
+
+        size_t Size() const { return records.size(); }
+
+        /**
+         * speed 0 issues the records as fast as possible; otherwise the
+         * captured inter-arrival times are kept, scaled by 1/speed.
+         * Per-operation counts and latencies are added to cnt[] and time[],
+         * indexed like ycsbc::Operation. Returns the number of successful ops.
+         */
+        int Replay(DB *db, int threads, double speed,
+                   std::atomic<uint64_t> *cnt, std::atomic<uint64_t> *time);
+
+    private:
+        std::vector<TraceRecord> records;
+
+        int ReplayPart(DB *db, int part, int threads, double speed,
+                       std::chrono::steady_clock::time_point start,
+                       std::atomic<uint64_t> *cnt, std::atomic<uint64_t> *time);
+    };
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "core/core_workload.h"
+#include "coordinator.h"
 #include "writeoptimized_db.h"
 
 using namespace std;
@@ -7,10 +8,8 @@ namespace ycsbc {
 
     WriteOptimizedDB::WriteOptimizedDB(utils::Properties& props) {
 
-        std::string pool_name = props.GetProperty(CoreWorkload::POOLNAME_PROPERTY,CoreWorkload::POOLNAME_DEFAULT);
-        create_one_pool_pp(pool_name, cluster);
-
-        int s = cluster.ioctx_create(pool_name.c_str(), ioctx);
+        pool_name = props.GetProperty(CoreWorkload::POOLNAME_PROPERTY,CoreWorkload::POOLNAME_DEFAULT);
+        int s = OpenPool(pool_name, cluster, ioctx);
         if (s != 0) {
             cerr << "Cannot open ceph db " << pool_name << endl;
             exit(0);
@@ -37,7 +36,13 @@ namespace ycsbc {
             col_map[i] = cols_0;
         }
 
-        dbClient.InitClient(props["dbname"], 0, 10240000000000000, field_count, levels, col_map);
+        dbClient.InitClient(props.GetProperty("treename", props["dbname"]), 0, 10240000000000000, field_count, levels, col_map);
+
+        async_depth = stoul(props.GetProperty("asyncdepth", "64"));
+
+        // only on request, and never while other clients still use the pool
+        destroy_pool = props.GetProperty("destroypool", "false") == "true" &&
+                       stoi(props.GetProperty("clientcount", "1")) <= 1;
     }
 
     int WriteOptimizedDB::Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
@@ -45,9 +50,15 @@ namespace ycsbc {
     {
         cls_lsm_entry return_entry;
         dbClient.cls_write_optimized_read(ioctx, table, strtoul(key.c_str(), nullptr, 10), fields, return_entry);
+        EntryFields(return_entry, result);
         return WriteOptimizedDB::kOK;
     }
 
+    bool WriteOptimizedDB::GetIOStats(IOStats &stats)
+    {
+        return PoolIOStats(cluster, pool_name, stats);
+    }
+
     int WriteOptimizedDB::Scan(const std::string &table, const std::string &key, const std::string &max_key, int len,
                         const std::vector<std::string> *fields, std::vector<std::vector<KVPair>> &result) 
     {
@@ -59,13 +70,7 @@ namespace ycsbc {
     int WriteOptimizedDB::Insert(const std::string &table, const std::string &key, std::vector<KVPair> &values)
     {
         cls_lsm_entry entry;
-        entry.key = strtoul(key.c_str(), nullptr, 10);
-        
-        for (auto value : values) {
-            bufferlist bl;
-            encode(value.second, bl);
-            entry.value.insert(std::pair<std::string, bufferlist>(value.first, bl));
-        }
+        EntryFromValues(key, values, entry);
 
         dbClient.cls_write_optimized_write(ioctx, table, entry);
 
@@ -88,9 +93,75 @@ namespace ycsbc {
         return WriteOptimizedDB::kOK;
     }
 
+    int WriteOptimizedDB::BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                      const std::vector<std::string> *fields,
+                      std::vector<std::vector<KVPair>> &results)
+    {
+        return AioBatchRead(keys, results,
+            [&](uint64_t key, librados::AioCompletion *c, bufferlist *out, bool *gathered) {
+                return dbClient.cls_write_optimized_aio_read(ioctx, table, key, fields, c, out, gathered);
+            });
+    }
+
+    int WriteOptimizedDB::BatchInsert(const std::string &table, const std::vector<std::string> &keys,
+                        std::vector<std::vector<KVPair>> &values)
+    {
+        std::vector<librados::AioCompletion*> completions;
+        int ret = WriteOptimizedDB::kOK;
+        for (size_t i = 0; i < keys.size(); i++) {
+            cls_lsm_entry entry;
+            EntryFromValues(keys[i], values[i], entry);
+
+            librados::AioCompletion *c = librados::Rados::aio_create_completion();
+            int r = dbClient.cls_write_optimized_aio_write(ioctx, table, entry, c);
+            if (r < 0) {
+                c->release();
+                ret = r;
+                continue;
+            }
+            completions.push_back(c);
+        }
+
+        for (auto c : completions) {
+            c->wait_for_complete();
+            int r = c->get_return_value();
+            if (r < 0) {
+                ret = r;
+            }
+            c->release();
+        }
+        return ret;
+    }
+
+    int WriteOptimizedDB::AsyncInsert(const std::string &table, const std::string &key,
+                        std::vector<KVPair> &values, Callback cb)
+    {
+        cls_lsm_entry entry;
+        EntryFromValues(key, values, entry);
+
+        librados::AioCompletion *c = librados::Rados::aio_create_completion();
+        int r = dbClient.cls_write_optimized_aio_write(ioctx, table, entry, c);
+        if (r < 0) {
+            c->release();
+            return r;
+        }
+        aio_tracker.Add(c, std::move(cb));
+        if (aio_tracker.Pending() >= async_depth) {
+            aio_tracker.Drain();
+        }
+        return WriteOptimizedDB::kOK;
+    }
+
+    int WriteOptimizedDB::WaitForCompletions()
+    {
+        return aio_tracker.Drain();
+    }
+
     WriteOptimizedDB::~WriteOptimizedDB() {
         ioctx.close();
-        destroy_one_pool_pp(pool_name, cluster);
+        if (destroy_pool) {
+            destroy_one_pool_pp(pool_name, cluster);
+        }
     }
 
 }
\ No newline at end of file
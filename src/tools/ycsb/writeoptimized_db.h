@@ -18,6 +18,8 @@
 #include "cls/lsm/cls_lsm_ops.h"
 #include "cls/lsm/cls_lsm_write_optimized.h"
 
+#include "rados_aio.h"
+
 using namespace librados;
 
 namespace ycsbc {
@@ -42,6 +44,20 @@ namespace ycsbc {
 
         int Compact(const std::string &table);
 
+        int BatchRead(const std::string &table, const std::vector<std::string> &keys,
+                      const std::vector<std::string> *fields,
+                      std::vector<std::vector<KVPair>> &results);
+
+        int BatchInsert(const std::string &table, const std::vector<std::string> &keys,
+                        std::vector<std::vector<KVPair>> &values);
+
+        int AsyncInsert(const std::string &table, const std::string &key,
+                        std::vector<KVPair> &values, Callback cb);
+
+        int WaitForCompletions();
+
+        bool GetIOStats(IOStats &stats);
+
         ~WriteOptimizedDB();
     
     private:
@@ -50,6 +66,9 @@ namespace ycsbc {
         IoCtx ioctx;
         ClsWriteOptimizedClient dbClient;
         unsigned noResult;
+        AioTracker aio_tracker;
+        size_t async_depth;
+        bool destroy_pool;
     };
 }
 
@@ -18,27 +18,44 @@
 #include "core/client.h"
 #include "core/core_workload.h"
 #include "db_factory.h"
+#include "coordinator.h"
+#include "trace.h"
 
 using namespace std;
 
 ////statistics
 atomic<uint64_t> ops_cnt[ycsbc::Operation::READMODIFYWRITE + 1];
 atomic<uint64_t> ops_time[ycsbc::Operation::READMODIFYWRITE + 1]; 
+atomic<uint64_t> logical_bytes_written(0);
+atomic<uint64_t> logical_bytes_read(0);
 ////
 
+struct PhaseIO {
+  bool valid;
+  ycsbc::DB::IOStats io;
+  uint64_t logical_written;
+  uint64_t logical_read;
+};
+
 void UsageMessage(const char *command);
 bool StrStartWith(const char *str, const char *pre);
 string ParseCommandLine(int argc, const char *argv[], utils::Properties &props);
-void Init(utils::Properties &props, std::string dbname, std::string dbpath);
+void Init(utils::Properties &props);
 void PrintInfo(utils::Properties &props);
+PhaseIO SnapshotIO(ycsbc::DB *db);
+void PrintAmplification(const PhaseIO &start, const PhaseIO &end, uint64_t loaded_bytes);
+void SplitFileNames(const string &list, vector<string> &filenames);
+void PrintRunResult(const char *title, int sum, uint64_t use_time,
+                    const uint64_t *cnt, const uint64_t *time);
 
 int DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops,
-    bool is_loading) {
+    bool is_loading, const int batch_size = 1, const bool async_load = false) {
   db->Init();
   ycsbc::Client client(*db, *wl);
   int oks = 0;
+  atomic<int> async_oks(0);
   int next_report_ = 0;
-  for (int i = 0; i < num_ops; ++i) {
+  for (int i = 0; i < num_ops; ) {
 
     if (i >= next_report_) {
         if      (next_report_ < 1000)   next_report_ += 100;
@@ -51,11 +68,24 @@ int DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops,
         fprintf(stderr, "... finished %d ops%30s\r", i, "");
         fflush(stderr);
     }
-    if (is_loading) {
+    if (is_loading && batch_size > 1) {
+      int n = min(batch_size, num_ops - i);
+      oks += client.DoInsertBatch(n);
+      i += n;
+      continue;
+    }
+    if (is_loading && async_load) {
+      client.DoAsyncInsert(async_oks);
+    } else if (is_loading) {
       oks += client.DoInsert();
     } else {
       oks += client.DoTransaction();
     }
+    ++i;
+  }
+  if (async_load) {
+    db->WaitForCompletions();
+    oks += async_oks.load();
   }
   db->Close();
   return oks;
@@ -63,17 +93,24 @@ int DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops,
 
 int main( const int argc, const char *argv[]) {
   utils::Properties props;
-  std::string databasepath = "";
-  if (argv[2] == std::string("leveldb")) {
-    databasepath = "/tmp/test-leveldb";
-  } else if (argv[2] == std::string("rocksdb")) {
-    databasepath = "/tmp/test-rocksdb";
-  } else if (argv[2] == std::string("cabindb")) {
-    databasepath = "/tmp/test-cabindb";
+  Init(props);
+  string file_name = ParseCommandLine(argc, argv, props);
+
+  if (!props["mergeresults"].empty()) {
+    vector<string> resultfiles;
+    SplitFileNames(props["mergeresults"], resultfiles);
+    return ycsbc::MergeResults(resultfiles) < 0 ? 1 : 0;
   }
 
-  Init(props, argv[2], databasepath);
-  string file_name = ParseCommandLine(argc, argv, props);
+  ycsbc::Coordinator coordinator(props);
+  coordinator.PartitionKeyspace(props);
+  if (props["dbpath"].empty()) {
+    string databasepath = "/tmp/test-" + props["dbname"];
+    if (coordinator.Enabled()) {
+      databasepath += "-" + props["clientid"];
+    }
+    props.SetProperty("dbpath", databasepath);
+  }
 
   ycsbc::DB *db = ycsbc::DBFactory::CreateDB(props);
   if (!db) {
@@ -82,17 +119,29 @@ int main( const int argc, const char *argv[]) {
   }
   std::cout << "db name: " << props["dbname"] << std::endl;
 
+  // record every DB call of this process; closed when db is deleted
+  ycsbc::TraceWriter trace_writer;
+  if (!props["tracefile"].empty()) {
+    if (trace_writer.Open(props["tracefile"]) < 0) {
+      exit(0);
+    }
+    db = new ycsbc::TracingDB(db, &trace_writer);
+  }
+
   const bool load = utils::StrToBool(props.GetProperty("load","false"));
   const bool run = utils::StrToBool(props.GetProperty("run","false"));
   const int num_threads = stoi(props.GetProperty("threadcount", "1"));
   const bool print_stats = utils::StrToBool(props["dbstatistics"]);
   const bool wait_for_balance = utils::StrToBool(props["dbwaitforbalance"]);
+  const int batch_size = stoi(props.GetProperty("batchsize", "1"));
+  const bool async_load = utils::StrToBool(props.GetProperty("asyncload", "false"));
 
   string morerun = props["morerun"];
 
   vector<future<int>> actual_ops;
   int total_ops = 0;
   int sum = 0;
+  uint64_t loaded_bytes = 0;
   utils::Timer<double> timer;
 
   PrintInfo(props);
@@ -102,11 +151,15 @@ int main( const int argc, const char *argv[]) {
     ycsbc::CoreWorkload wl;
     wl.Init(props);
 
+    total_ops = stoi(props.GetProperty(ycsbc::CoreWorkload::INSERT_COUNT_PROPERTY,
+                                       props[ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY]));
+    coordinator.Barrier("load");
+    PhaseIO load_io = SnapshotIO(db);
     uint64_t load_start = get_now_micros();
-    total_ops = stoi(props[ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY]);
     for (int i = 0; i < num_threads; ++i) {
       actual_ops.emplace_back(async(launch::async,
-          DelegateClient, db, &wl, total_ops / num_threads, true));
+          DelegateClient, db, &wl, total_ops / num_threads, true,
+          batch_size, async_load));
     }
     assert((int)actual_ops.size() == num_threads);
 
@@ -120,10 +173,14 @@ int main( const int argc, const char *argv[]) {
     printf("********** load result **********\n");
     printf("loading records:%d  use time:%.3f s  IOPS:%.2f iops (%.2f us/op)\n", sum, 1.0 * use_time*1e-6, 1.0 * sum * 1e6 / use_time, 1.0 * use_time / sum);
     printf("*********************************\n");
+    coordinator.WriteResult("load", sum, use_time, nullptr, nullptr);
+    PhaseIO load_end_io = SnapshotIO(db);
+    loaded_bytes = load_end_io.logical_written - load_io.logical_written;
 
     if ( print_stats ) {
       printf("-------------- db statistics --------------\n");
       db->PrintStats();
+      PrintAmplification(load_io, load_end_io, loaded_bytes);
       printf("-------------------------------------------\n");
     }
 
@@ -140,6 +197,8 @@ int main( const int argc, const char *argv[]) {
 
     actual_ops.clear();
     total_ops = stoi(props[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
+    coordinator.Barrier("run");
+    PhaseIO run_io = SnapshotIO(db);
     uint64_t run_start = get_now_micros();
     for (int i = 0; i < num_threads; ++i) {
       actual_ops.emplace_back(async(launch::async,
@@ -162,35 +221,20 @@ int main( const int argc, const char *argv[]) {
       temp_time[j] = ops_time[j].load(std::memory_order_relaxed);
     }
 
-    printf("********** run result **********\n");
-    printf("all opeartion records:%d  use time:%.3f s  IOPS:%.2f iops (%.2f us/op)\n\n", sum, 1.0 * use_time*1e-6, 1.0 * sum * 1e6 / use_time, 1.0 * use_time / sum);
-    if ( temp_cnt[ycsbc::INSERT] )          printf("insert ops:%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::INSERT], 1.0 * temp_time[ycsbc::INSERT]*1e-6, 1.0 * temp_cnt[ycsbc::INSERT] * 1e6 / temp_time[ycsbc::INSERT], 1.0 * temp_time[ycsbc::INSERT] / temp_cnt[ycsbc::INSERT]);
-    if ( temp_cnt[ycsbc::READ] )            printf("read ops  :%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::READ], 1.0 * temp_time[ycsbc::READ]*1e-6, 1.0 * temp_cnt[ycsbc::READ] * 1e6 / temp_time[ycsbc::READ], 1.0 * temp_time[ycsbc::READ] / temp_cnt[ycsbc::READ]);
-    if ( temp_cnt[ycsbc::UPDATE] )          printf("update ops:%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::UPDATE], 1.0 * temp_time[ycsbc::UPDATE]*1e-6, 1.0 * temp_cnt[ycsbc::UPDATE] * 1e6 / temp_time[ycsbc::UPDATE], 1.0 * temp_time[ycsbc::UPDATE] / temp_cnt[ycsbc::UPDATE]);
-    if ( temp_cnt[ycsbc::SCAN] )            printf("scan ops  :%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::SCAN], 1.0 * temp_time[ycsbc::SCAN]*1e-6, 1.0 * temp_cnt[ycsbc::SCAN] * 1e6 / temp_time[ycsbc::SCAN], 1.0 * temp_time[ycsbc::SCAN] / temp_cnt[ycsbc::SCAN]);
-    if ( temp_cnt[ycsbc::READMODIFYWRITE] ) printf("rmw ops   :%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::READMODIFYWRITE], 1.0 * temp_time[ycsbc::READMODIFYWRITE]*1e-6, 1.0 * temp_cnt[ycsbc::READMODIFYWRITE] * 1e6 / temp_time[ycsbc::READMODIFYWRITE], 1.0 * temp_time[ycsbc::READMODIFYWRITE] / temp_cnt[ycsbc::READMODIFYWRITE]);
-    printf("********************************\n");
+    PrintRunResult("run", sum, use_time, temp_cnt, temp_time);
+    coordinator.WriteResult("run", sum, use_time, temp_cnt, temp_time);
 
     if ( print_stats ) {
       printf("-------------- db statistics --------------\n");
       db->PrintStats();
+      PrintAmplification(run_io, SnapshotIO(db), loaded_bytes);
       printf("-------------------------------------------\n");
     }
     
   }
   if( !morerun.empty() ) {
     vector<string> runfilenames;
-    size_t start=0,index=morerun.find_first_of(':', 0);
-    while(index!=morerun.npos)
-    {
-        if(start!=index)
-            runfilenames.push_back(morerun.substr(start,index-start));
-        start=index+1;
-        index=morerun.find_first_of(':',start);
-    }
-    if(!morerun.substr(start).empty()) {
-      runfilenames.push_back(morerun.substr(start));
-    }
+    SplitFileNames(morerun, runfilenames);
     for(unsigned int i = 0; i < runfilenames.size(); i++){
       for(int j = 0; j < ycsbc::Operation::READMODIFYWRITE + 1; j++){
         ops_cnt[j].store(0);
@@ -205,6 +249,7 @@ int main( const int argc, const char *argv[]) {
         exit(0);
       }
       input.close();
+      coordinator.PartitionKeyspace(props);
       printf("------ run:%s ------\n",runfilenames[i].c_str());
       PrintInfo(props);
       // Peforms transactions
@@ -213,6 +258,8 @@ int main( const int argc, const char *argv[]) {
 
       actual_ops.clear();
       total_ops = stoi(props[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
+      coordinator.Barrier("morerun" + to_string(i + 1));
+      PhaseIO run_io = SnapshotIO(db);
       uint64_t run_start = get_now_micros();
       for (int i = 0; i < num_threads; ++i) {
         actual_ops.emplace_back(async(launch::async,
@@ -235,18 +282,13 @@ int main( const int argc, const char *argv[]) {
         temp_time[j] = ops_time[j].load(std::memory_order_relaxed);
       }
 
-      printf("********** more run result **********\n");
-      printf("all opeartion records:%d  use time:%.3f s  IOPS:%.2f iops (%.2f us/op)\n\n", sum, 1.0 * use_time*1e-6, 1.0 * sum * 1e6 / use_time, 1.0 * use_time / sum);
-      if ( temp_cnt[ycsbc::INSERT] )          printf("insert ops:%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::INSERT], 1.0 * temp_time[ycsbc::INSERT]*1e-6, 1.0 * temp_cnt[ycsbc::INSERT] * 1e6 / temp_time[ycsbc::INSERT], 1.0 * temp_time[ycsbc::INSERT] / temp_cnt[ycsbc::INSERT]);
-      if ( temp_cnt[ycsbc::READ] )            printf("read ops  :%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::READ], 1.0 * temp_time[ycsbc::READ]*1e-6, 1.0 * temp_cnt[ycsbc::READ] * 1e6 / temp_time[ycsbc::READ], 1.0 * temp_time[ycsbc::READ] / temp_cnt[ycsbc::READ]);
-      if ( temp_cnt[ycsbc::UPDATE] )          printf("update ops:%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::UPDATE], 1.0 * temp_time[ycsbc::UPDATE]*1e-6, 1.0 * temp_cnt[ycsbc::UPDATE] * 1e6 / temp_time[ycsbc::UPDATE], 1.0 * temp_time[ycsbc::UPDATE] / temp_cnt[ycsbc::UPDATE]);
-      if ( temp_cnt[ycsbc::SCAN] )            printf("scan ops  :%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::SCAN], 1.0 * temp_time[ycsbc::SCAN]*1e-6, 1.0 * temp_cnt[ycsbc::SCAN] * 1e6 / temp_time[ycsbc::SCAN], 1.0 * temp_time[ycsbc::SCAN] / temp_cnt[ycsbc::SCAN]);
-      if ( temp_cnt[ycsbc::READMODIFYWRITE] ) printf("rmw ops   :%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", temp_cnt[ycsbc::READMODIFYWRITE], 1.0 * temp_time[ycsbc::READMODIFYWRITE]*1e-6, 1.0 * temp_cnt[ycsbc::READMODIFYWRITE] * 1e6 / temp_time[ycsbc::READMODIFYWRITE], 1.0 * temp_time[ycsbc::READMODIFYWRITE] / temp_cnt[ycsbc::READMODIFYWRITE]);
-      printf("********************************\n");
+      PrintRunResult("more run", sum, use_time, temp_cnt, temp_time);
+      coordinator.WriteResult("morerun" + to_string(i + 1), sum, use_time, temp_cnt, temp_time);
 
       if ( print_stats ) {
         printf("-------------- db statistics --------------\n");
         db->PrintStats();
+        PrintAmplification(run_io, SnapshotIO(db), loaded_bytes);
         printf("-------------------------------------------\n");
       }
 
@@ -254,6 +296,45 @@ int main( const int argc, const char *argv[]) {
     }
     
   }
+  if( !props["replay"].empty() ) {
+    ycsbc::TraceReplayer replayer;
+    if (replayer.Load(props["replay"]) < 0) {
+      exit(0);
+    }
+    const double speed = stod(props["replayspeed"]);
+    printf("------ replay:%s (%lu records, %s) ------\n", props["replay"].c_str(),
+           replayer.Size(), speed > 0 ? "captured timing" : "as fast as possible");
+
+    for(int j = 0; j < ycsbc::Operation::READMODIFYWRITE + 1; j++){
+      ops_cnt[j].store(0);
+      ops_time[j].store(0);
+    }
+
+    coordinator.Barrier("replay");
+    PhaseIO run_io = SnapshotIO(db);
+    uint64_t run_start = get_now_micros();
+    sum = replayer.Replay(db, num_threads, speed, ops_cnt, ops_time);
+    uint64_t run_end = get_now_micros();
+    uint64_t use_time = run_end - run_start;
+
+    uint64_t temp_cnt[ycsbc::Operation::READMODIFYWRITE + 1];
+    uint64_t temp_time[ycsbc::Operation::READMODIFYWRITE + 1];
+
+    for(int j = 0; j < ycsbc::Operation::READMODIFYWRITE + 1; j++){
+      temp_cnt[j] = ops_cnt[j].load(std::memory_order_relaxed);
+      temp_time[j] = ops_time[j].load(std::memory_order_relaxed);
+    }
+
+    PrintRunResult("replay", sum, use_time, temp_cnt, temp_time);
+    coordinator.WriteResult("replay", sum, use_time, temp_cnt, temp_time);
+
+    if ( print_stats ) {
+      printf("-------------- db statistics --------------\n");
+      db->PrintStats();
+      PrintAmplification(run_io, SnapshotIO(db), loaded_bytes);
+      printf("-------------------------------------------\n");
+    }
+  }
   // if ( print_stats ) {
   //   printf("-------------- db statistics --------------\n");
   //   db->PrintStats();
@@ -391,6 +472,126 @@ string ParseCommandLine(int argc, const char *argv[], utils::Properties &props)
       }
       props.SetProperty("columnfamilyshards",argv[argindex]);
       argindex++;
+    } else if(strcmp(argv[argindex],"-cabindblayout")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("cabindblayout",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-columngroups")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("columngroups",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-cfoptions")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("cfoptions",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-batchsize")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("batchsize",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-asyncload")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("asyncload",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-destroypool")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("destroypool",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-clientid")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("clientid",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-clientcount")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("clientcount",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-barrier")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("barrier",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-resultfile")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("resultfile",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-tracefile")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("tracefile",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-replay")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("replay",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-kvtracefile")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("kvtracefile",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-replayspeed")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("replayspeed",argv[argindex]);
+      argindex++;
+    } else if(strcmp(argv[argindex],"-mergeresults")==0){
+      argindex++;
+      if(argindex >= argc){
+        UsageMessage(argv[0]);
+        exit(0);
+      }
+      props.SetProperty("mergeresults",argv[argindex]);
+      argindex++;
     } else if (strcmp(argv[argindex], "-P") == 0) {
       argindex++;
       if (argindex >= argc) {
@@ -426,6 +627,29 @@ void UsageMessage(const char *command) {
   cout << "Options:" << endl;
   cout << "  -threads n: execute using n threads (default: 1)" << endl;
   cout << "  -db dbname: specify the name of the DB to use (default: basic)" << endl;
+  cout << "  -batchsize n: insert n records per DB call during load (default: 1)" << endl;
+  cout << "  -asyncload true/false: issue load inserts asynchronously (default: false)" << endl;
+  cout << "  -destroypool true/false: (readoptimized, writeoptimized) delete the pool" << endl;
+  cout << "                   when the run ends, unless -clientcount > 1 (default: false)" << endl;
+  cout << "  -clientid n -clientcount m: run as client n of m cooperating processes," << endl;
+  cout << "                   each loading and querying its own slice of the keyspace" << endl;
+  cout << "  -barrier name: RADOS object prefix the clients meet at before each phase" << endl;
+  cout << "                   (use a fresh name per run)" << endl;
+  cout << "  -resultfile file: append this client's per-phase results to file" << endl;
+  cout << "  -mergeresults f1:f2:...: print aggregate results of several clients and exit" << endl;
+  cout << "  -tracefile file: record every DB operation of this run to file" << endl;
+  cout << "  -replay file: after the other phases, replay a recorded trace against the db" << endl;
+  cout << "  -replayspeed x: 0 replays as fast as possible, 1 with the captured timing," << endl;
+  cout << "                   2 twice as fast, ... (default: 0)" << endl;
+  cout << "  -kvtracefile file: (cabindb) also write cabindb's native trace of the KV ops" << endl;
+  cout << "  -cabindblayout row/column/hybrid: (cabindb) store records whole, one column" << endl;
+  cout << "                   family per column group, or both (default: hybrid)" << endl;
+  cout << "  -columngroups \"field0,field1 field2 ...\": (cabindb) fields sharing a column" << endl;
+  cout << "                   family; ungrouped fields get one each" << endl;
+  cout << "  -columnfamilyshards n: (cabindb) shards per column family, 0 keeps all data in" << endl;
+  cout << "                   the default column family (default: 0)" << endl;
+  cout << "  -cfoptions opts: (cabindb) cabindb options of every generated column family," << endl;
+  cout << "                   e.g. \"memtable=prefix_hash:100000;prefix_extractor=capped:8\"" << endl;
   cout << "  -P propertyfile: load properties from the given file. Multiple files can" << endl;
   cout << "                   be specified, and will be processed in the order specified" << endl;
 }
@@ -434,11 +658,11 @@ inline bool StrStartWith(const char *str, const char *pre) {
   return strncmp(str, pre, strlen(pre)) == 0;
 }
 
-void Init(utils::Properties &props, std::string dbname, std::string dbpath){
+void Init(utils::Properties &props){
   //props.SetProperty("dbname","leveldb");
   //props.SetProperty("dbpath","/tmp/test-leveldb");
-  props.SetProperty("dbname", dbname);
-  props.SetProperty("dbpath", dbpath);
+  props.SetProperty("dbname", "");
+  props.SetProperty("dbpath", "");
   props.SetProperty("load","false");
   props.SetProperty("run","false");
   props.SetProperty("threadcount","1");
@@ -448,6 +672,63 @@ void Init(utils::Properties &props, std::string dbname, std::string dbpath){
   props.SetProperty("morerun","");
   props.SetProperty("createdb", "false");
   props.SetProperty("columnfamilyshards","0");
+  props.SetProperty("batchsize","1");
+  props.SetProperty("asyncload","false");
+  props.SetProperty("destroypool","false");
+  props.SetProperty("clientid","0");
+  props.SetProperty("clientcount","1");
+  props.SetProperty("barrier","");
+  props.SetProperty("resultfile","");
+  props.SetProperty("mergeresults","");
+  props.SetProperty("tracefile","");
+  props.SetProperty("replay","");
+  props.SetProperty("replayspeed","0");
+  props.SetProperty("kvtracefile","");
+}
+
+void SplitFileNames(const string &list, vector<string> &filenames) {
+  size_t start=0,index=list.find_first_of(':', 0);
+  while(index!=list.npos)
+  {
+      if(start!=index)
+          filenames.push_back(list.substr(start,index-start));
+      start=index+1;
+      index=list.find_first_of(':',start);
+  }
+  if(!list.substr(start).empty()) {
+    filenames.push_back(list.substr(start));
+  }
+}
+
+PhaseIO SnapshotIO(ycsbc::DB *db) {
+  PhaseIO snap;
+  snap.valid = db->GetIOStats(snap.io);
+  snap.logical_written = logical_bytes_written.load();
+  snap.logical_read = logical_bytes_read.load();
+  return snap;
+}
+
+void PrintAmplification(const PhaseIO &start, const PhaseIO &end, uint64_t loaded_bytes) {
+  if (!start.valid || !end.valid) {
+    printf("amplification: not reported by this db\n");
+    return;
+  }
+  uint64_t storage_written = end.io.bytes_written - start.io.bytes_written;
+  uint64_t storage_read = end.io.bytes_read - start.io.bytes_read;
+  uint64_t logical_written = end.logical_written - start.logical_written;
+  uint64_t logical_read = end.logical_read - start.logical_read;
+  // prefer the back-end's own live data estimate, else what the load wrote
+  uint64_t live = end.io.live_bytes ? end.io.live_bytes : loaded_bytes;
+
+  printf("write amplification:%7.2f  (%lu storage / %lu logical bytes written)\n",
+         logical_written ? 1.0 * storage_written / logical_written : 0.0,
+         storage_written, logical_written);
+  printf("read amplification :%7.2f  (%lu storage / %lu logical bytes read)\n",
+         logical_read ? 1.0 * storage_read / logical_read : 0.0,
+         storage_read, logical_read);
+  printf("space amplification:%7.2f  (%lu bytes used / %lu live bytes)\n",
+         live ? 1.0 * end.io.space_used / live : 0.0,
+         end.io.space_used, live);
 }
 
 void PrintInfo(utils::Properties &props) {
@@ -455,4 +736,16 @@ void PrintInfo(utils::Properties &props) {
   printf("%s", props.DebugString().c_str());
   printf("----------------------------------------\n");
   fflush(stdout);
-}
\ No newline at end of file
+}
+
+void PrintRunResult(const char *title, int sum, uint64_t use_time,
+                    const uint64_t *cnt, const uint64_t *time) {
+  printf("********** %s result **********\n", title);
+  printf("all opeartion records:%d  use time:%.3f s  IOPS:%.2f iops (%.2f us/op)\n\n", sum, 1.0 * use_time*1e-6, 1.0 * sum * 1e6 / use_time, 1.0 * use_time / sum);
+  if ( cnt[ycsbc::INSERT] )          printf("insert ops:%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", cnt[ycsbc::INSERT], 1.0 * time[ycsbc::INSERT]*1e-6, 1.0 * cnt[ycsbc::INSERT] * 1e6 / time[ycsbc::INSERT], 1.0 * time[ycsbc::INSERT] / cnt[ycsbc::INSERT]);
+  if ( cnt[ycsbc::READ] )            printf("read ops  :%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", cnt[ycsbc::READ], 1.0 * time[ycsbc::READ]*1e-6, 1.0 * cnt[ycsbc::READ] * 1e6 / time[ycsbc::READ], 1.0 * time[ycsbc::READ] / cnt[ycsbc::READ]);
+  if ( cnt[ycsbc::UPDATE] )          printf("update ops:%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", cnt[ycsbc::UPDATE], 1.0 * time[ycsbc::UPDATE]*1e-6, 1.0 * cnt[ycsbc::UPDATE] * 1e6 / time[ycsbc::UPDATE], 1.0 * time[ycsbc::UPDATE] / cnt[ycsbc::UPDATE]);
+  if ( cnt[ycsbc::SCAN] )            printf("scan ops  :%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", cnt[ycsbc::SCAN], 1.0 * time[ycsbc::SCAN]*1e-6, 1.0 * cnt[ycsbc::SCAN] * 1e6 / time[ycsbc::SCAN], 1.0 * time[ycsbc::SCAN] / cnt[ycsbc::SCAN]);
+  if ( cnt[ycsbc::READMODIFYWRITE] ) printf("rmw ops   :%7lu  use time:%7.3f s  IOPS:%7.2f iops (%.2f us/op)\n", cnt[ycsbc::READMODIFYWRITE], 1.0 * time[ycsbc::READMODIFYWRITE]*1e-6, 1.0 * cnt[ycsbc::READMODIFYWRITE] * 1e6 / time[ycsbc::READMODIFYWRITE], 1.0 * time[ycsbc::READMODIFYWRITE] / cnt[ycsbc::READMODIFYWRITE]);
+  printf("********************************\n");
+}